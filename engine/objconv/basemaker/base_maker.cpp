@@ -65,7 +65,7 @@ bool run_only_player_starsystem = true;
 NetClient *Network = NULL;
 NetServer *VSServer = NULL;
 FILE *fpread = NULL;
-float simulation_atom_var = (float) (1.0 / 10.0);
+thread_local float simulation_atom_var = (float) (1.0 / 10.0);
 Mission *mission = NULL;
 double benchmark = -1.0;
 bool STATIC_VARS_DESTROYED = false;
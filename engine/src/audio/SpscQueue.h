@@ -0,0 +1,107 @@
+/**
+ * SpscQueue.h
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+//
+// C++ Interface: Audio::SpscQueue
+//
+#ifndef __AUDIO_SPSCQUEUE_H__INCLUDED__
+#define __AUDIO_SPSCQUEUE_H__INCLUDED__
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace Audio {
+
+/**
+ * Single producer, single consumer queue
+ *
+ * @remarks A fixed size ring that one thread pushes into while another pops from,
+ *      without locks: each side only writes its own index, and reads the other's.
+ *      Pushing onto a full queue or popping from an empty one fails rather than
+ *      waits, so neither thread ever blocks on the other.
+ *      @par Only one thread may push, and only one may pop.
+ *
+ */
+template<typename T>
+class SpscQueue {
+    std::vector<T> slots;
+    size_t mask;
+
+    // Next slot to pop, written by the consumer only
+    std::atomic<size_t> head;
+    // Next slot to push, written by the producer only
+    std::atomic<size_t> tail;
+
+public:
+    /** Make a queue that holds at least capacity items */
+    explicit SpscQueue(size_t capacity) : head(0), tail(0) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    /** Add an item at the back; false, with nothing added, if the queue is full */
+    bool push(const T &item) {
+        const size_t back = tail.load(std::memory_order_relaxed);
+        if (back - head.load(std::memory_order_acquire) > mask) {
+            return false;
+        }
+        slots[back & mask] = item;
+        tail.store(back + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Take the item at the front; false, leaving item alone, if the queue is empty */
+    bool pop(T &item) {
+        const size_t front = head.load(std::memory_order_relaxed);
+        if (front == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = slots[front & mask];
+        head.store(front + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Whether the queue was empty; by the time it returns, the other thread may have changed that */
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const {
+        return slots.size();
+    }
+
+private:
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+};
+
+};
+
+#endif//__AUDIO_SPSCQUEUE_H__INCLUDED__
@@ -0,0 +1,240 @@
+/**
+ * StreamDecoder.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+//
+// C++ Implementation: Audio::StreamDecoder
+//
+
+#include "StreamDecoder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <system_error>
+
+#include "vs_logging.h"
+
+template<> Audio::StreamDecoder *Singleton<Audio::StreamDecoder>::_singletonInstance = 0;
+
+namespace Audio {
+
+// How long the decoder thread sleeps when nobody wakes it up
+static const std::chrono::milliseconds kDecodeInterval(20);
+
+DecodedStream::DecodedStream(unsigned int bufferCount, unsigned int bufferSamples, const Format &format,
+        const ReadFunction &read, const SeekFunction &seek, const PositionFunction &position)
+        : buffers(bufferCount),
+        ready(bufferCount),
+        empty(bufferCount),
+        readFunction(read),
+        seekFunction(seek),
+        positionFunction(position),
+        requestedGeneration(0),
+        requestedPosition(0.0),
+        pending(0),
+        generation(0),
+        atEnd(false) {
+    for (Buffer &buffer : buffers) {
+        buffer.data.reserve(bufferSamples, format);
+        buffer.start = 0;
+        buffer.generation = 0;
+        buffer.endOfStream = false;
+        empty.push(&buffer);
+    }
+}
+
+void DecodedStream::seek(double position) {
+    requestedPosition.store(position, std::memory_order_relaxed);
+    requestedGeneration.fetch_add(1, std::memory_order_release);
+
+    // Give what was decoded so far back right away, so the decoder has room to start over.
+    // It may already have decoded from the new position, though, so keep that.
+    if (pending) {
+        empty.push(pending);
+    }
+    pending = takeCurrent();
+}
+
+DecodedStream::Buffer *DecodedStream::takeCurrent() {
+    const unsigned int current = requestedGeneration.load(std::memory_order_relaxed);
+    Buffer *buffer;
+    while (ready.pop(buffer)) {
+        if (buffer->generation == current) {
+            return buffer;
+        }
+        // Decoded before the last seek
+        empty.push(buffer);
+    }
+    return 0;
+}
+
+DecodedStream::Buffer *DecodedStream::acquire() {
+    if (pending) {
+        Buffer *buffer = pending;
+        pending = 0;
+        return buffer;
+    }
+    return takeCurrent();
+}
+
+void DecodedStream::release(Buffer *buffer) {
+    empty.push(buffer);
+}
+
+bool DecodedStream::decode(unsigned int maxBuffers) {
+    std::lock_guard<std::mutex> lock(decodeMutex);
+    bool worked = false;
+    unsigned int wanted = requestedGeneration.load(std::memory_order_acquire);
+    if (wanted != generation) {
+        generation = wanted;
+        atEnd = false;
+        seekFunction(requestedPosition.load(std::memory_order_relaxed));
+        worked = true;
+    }
+
+    Buffer *buffer;
+    for (unsigned int decoded = 0; decoded < maxBuffers && !atEnd && empty.pop(buffer); ++decoded) {
+        buffer->generation = generation;
+        buffer->start = positionFunction();
+        try {
+            readFunction(buffer->data);
+            buffer->endOfStream = (buffer->data.getUsedBytes() == 0);
+        } catch (const EndOfStreamException &) {
+            buffer->data.setUsedBytes(0);
+            buffer->endOfStream = true;
+        } catch (const Exception &e) {
+            VS_LOG(error, (boost::format("Audio::StreamDecoder: cannot decode, ending the stream: %1%") % e.what()));
+            buffer->data.setUsedBytes(0);
+            buffer->endOfStream = true;
+        }
+        atEnd = buffer->endOfStream;
+        ready.push(buffer);
+        worked = true;
+
+        // A seek makes the rest of the ring useless, so see to it first
+        if (requestedGeneration.load(std::memory_order_acquire) != generation) {
+            break;
+        }
+    }
+    return worked;
+}
+
+StreamDecoder::StreamDecoder() : stopping(false), woken(false) {
+    start();
+}
+
+StreamDecoder::~StreamDecoder() {
+    stop();
+}
+
+void StreamDecoder::start() {
+    if (isRunning()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+    }
+    try {
+        thread = std::thread(&StreamDecoder::run, this);
+    } catch (const std::system_error &e) {
+        VS_LOG(error, (boost::format("Audio::StreamDecoder: cannot start the decoder thread, "
+                                     "streams will be decoded as they play: %1%") % e.what()));
+    }
+}
+
+void StreamDecoder::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_one();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void StreamDecoder::shutdown() {
+    // Don't create the decoder just to stop it
+    if (_singletonInstance != 0) {
+        _singletonInstance->stop();
+    }
+}
+
+void StreamDecoder::add(const vega_types::SharedPtr<DecodedStream> &stream) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        streams.push_back(stream);
+    }
+    wake();
+}
+
+void StreamDecoder::seek(const vega_types::SharedPtr<DecodedStream> &stream, double position) {
+    stream->seek(position);
+
+    // The thread decodes a buffer at a time, so this waits for one at most
+    stream->decode(1);
+    wake();
+}
+
+void StreamDecoder::remove(const vega_types::SharedPtr<DecodedStream> &stream) {
+    std::unique_lock<std::mutex> lock(mutex);
+    streams.erase(std::remove(streams.begin(), streams.end(), stream), streams.end());
+    doneWithStream.wait(lock, [this, &stream] {
+        return current != stream;
+    });
+}
+
+void StreamDecoder::wake() {
+    woken.store(true, std::memory_order_release);
+    wakeUp.notify_one();
+}
+
+void StreamDecoder::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        woken.store(false, std::memory_order_relaxed);
+
+        // A buffer of each stream in turn, letting go of the lock while decoding, so that
+        // seek(), add() and remove() never wait for other streams, nor a stream for the others
+        bool worked = false;
+        for (size_t next = 0; next < streams.size() && !stopping; ++next) {
+            current = streams[next];
+            lock.unlock();
+            const bool decoded = current->decode(1);
+            lock.lock();
+            worked = decoded || worked;
+            current.reset();
+            doneWithStream.notify_all();
+        }
+
+        if (!worked) {
+            wakeUp.wait_for(lock, kDecodeInterval, [this] {
+                return stopping || woken.load(std::memory_order_acquire);
+            });
+        }
+    }
+}
+
+};
@@ -0,0 +1,230 @@
+/**
+ * StreamDecoder.h
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+//
+// C++ Interface: Audio::StreamDecoder
+//
+#ifndef __AUDIO_STREAMDECODER_H__INCLUDED__
+#define __AUDIO_STREAMDECODER_H__INCLUDED__
+
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Exceptions.h"
+#include "Types.h"
+#include "Format.h"
+#include "SoundBuffer.h"
+#include "SpscQueue.h"
+#include "Singleton.h"
+
+namespace Audio {
+
+/**
+ * Decoded stream class
+ *
+ * @remarks A ring of PCM buffers decoded ahead of a stream that is being played.
+ *      The StreamDecoder thread fills free buffers from the stream and hands them
+ *      to the thread playing the sound through a lock-free queue; the player hands
+ *      them back, once copied out, through another. Neither side waits on the other.
+ *      @par The decoder thread is the only one to touch the stream once the ring has
+ *      been added to the StreamDecoder, so seeks are requests: buffers decoded
+ *      before the latest seek are handed back to be decoded again. StreamDecoder::seek()
+ *      carries the request out at once, for players that can't wait for the thread.
+ *
+ */
+class DecodedStream {
+public:
+    struct Buffer {
+        SoundBuffer data;
+
+        /** The stream's position at the start of the buffer */
+        Timestamp start;
+
+        /** The seek the buffer was decoded after */
+        unsigned int generation;
+
+        /** The buffer marks the end of the stream, and holds no data */
+        bool endOfStream;
+    };
+
+    /** Fill the buffer from the stream; throws EndOfStreamException past the end */
+    typedef std::function<void(SoundBuffer &)> ReadFunction;
+    typedef std::function<void(double)> SeekFunction;
+    typedef std::function<double()> PositionFunction;
+
+    /**
+     * Make a ring of decoded buffers
+     * @param buffers How many buffers to decode ahead.
+     * @param bufferSamples The capacity of each buffer, in samples of format.
+     * @param format The format the buffers are decoded to.
+     */
+    DecodedStream(unsigned int buffers, unsigned int bufferSamples, const Format &format,
+            const ReadFunction &read, const SeekFunction &seek, const PositionFunction &position);
+
+    // The following section is for the thread playing the sound.
+
+    /**
+     * Ask for the stream to continue from position, dropping whatever was decoded before
+     * @remarks Until the decoder gets to it, acquire() returns 0.
+     */
+    void seek(double position);
+
+    /**
+     * Take the next decoded buffer
+     * @returns The buffer, or 0 if none has been decoded since the last seek yet.
+     *      It must be given back through release() when done with.
+     */
+    Buffer *acquire();
+
+    /** Give back a buffer returned by acquire() */
+    void release(Buffer *buffer);
+
+    // The following section is for the decoder thread.
+
+    /**
+     * Carry out any pending seek, and decode until the ring is full, the stream ends
+     * or maxBuffers buffers have been decoded.
+     * @remarks Safe to call from several threads; they take turns.
+     * @returns Whether there was any work to do.
+     */
+    bool decode(unsigned int maxBuffers = UINT_MAX);
+
+private:
+    /** Take the first ready buffer decoded since the last seek, handing back older ones */
+    Buffer *takeCurrent();
+
+    std::vector<Buffer> buffers;
+
+    // Decoded buffers, decoder to player
+    SpscQueue<Buffer *> ready;
+    // Buffers to decode into, player to decoder
+    SpscQueue<Buffer *> empty;
+
+    ReadFunction readFunction;
+    SeekFunction seekFunction;
+    PositionFunction positionFunction;
+
+    // The latest seek asked for; the position is written before the generation
+    std::atomic<unsigned int> requestedGeneration;
+    std::atomic<double> requestedPosition;
+
+    // A buffer decoded since the last seek, taken off ready by seek(); player thread only
+    Buffer *pending;
+
+    // Decoder state, guarded by decodeMutex
+    std::mutex decodeMutex;
+    unsigned int generation;
+    bool atEnd;
+
+    DecodedStream(const DecodedStream &) = delete;
+    DecodedStream &operator=(const DecodedStream &) = delete;
+};
+
+/**
+ * Stream decoder class
+ *
+ * @remarks A background thread that keeps the DecodedStream of every streaming sound
+ *      being played decoded ahead, so Ogg pages (and other codecs' packets) are
+ *      never decoded by the thread running the frame. It decodes whenever it is
+ *      woken up, and every few milliseconds anyway in case a wake up was missed.
+ *
+ */
+class StreamDecoder : public Singleton<StreamDecoder> {
+public:
+    /** Construct and start the decoder thread
+     * @remarks End-users of the class shouldn't be using this. Singletons need it */
+    StreamDecoder();
+
+    ~StreamDecoder();
+
+    /** Whether the thread is running; if it isn't, decode() must be called by the player */
+    bool isRunning() const {
+        return thread.joinable();
+    }
+
+    /** Start the decoder thread again after stop(), if it isn't running */
+    void start();
+
+    /**
+     * Stop the decoder thread, waiting for it to finish the buffer it is decoding
+     * @remarks Streams stay registered, and are decoded by their players until start().
+     */
+    void stop();
+
+    /**
+     * Stop the decoder thread, if there is one
+     * @remarks The renderer calls this when torn down, so the thread never outlives the
+     *      sounds it decodes, or runs into static destruction.
+     */
+    static void shutdown();
+
+    /** Start decoding a stream */
+    void add(const vega_types::SharedPtr<DecodedStream> &stream);
+
+    /**
+     * Seek a stream, and decode its first buffer from there before returning
+     * @remarks Waits for the thread if it's decoding a buffer of this stream, so the first
+     *      buffer after the seek is ready for acquire() when this returns; the rest of the
+     *      ring is left to the thread. A looping sound that has reached its end seeks back
+     *      through here, so it goes on playing without a gap.
+     */
+    void seek(const vega_types::SharedPtr<DecodedStream> &stream, double position);
+
+    /**
+     * Stop decoding a stream
+     * @remarks Returns once the decoder thread is done with the stream, which may mean
+     *      waiting for the buffer it is decoding.
+     */
+    void remove(const vega_types::SharedPtr<DecodedStream> &stream);
+
+    /** Have the thread look for work now; never blocks */
+    void wake();
+
+private:
+    void run();
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    // Notified whenever the thread is done with a stream
+    std::condition_variable doneWithStream;
+
+    // Guarded by mutex, which the thread lets go of while it decodes
+    std::vector<vega_types::SharedPtr<DecodedStream> > streams;
+    // The stream the thread is decoding, if any
+    vega_types::SharedPtr<DecodedStream> current;
+    bool stopping;
+
+    std::atomic<bool> woken;
+};
+
+};
+
+#endif//__AUDIO_STREAMDECODER_H__INCLUDED__
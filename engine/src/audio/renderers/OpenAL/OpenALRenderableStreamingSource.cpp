@@ -170,6 +170,21 @@ void OpenALRenderableStreamingSource::updateImpl(int flags, const Listener &scen
         startedPlaying = true;
     } else {
         queueALBuffers();
+
+        // The decoder thread may not have had anything ready when we started,
+        // or fell behind, and the AL stops a starved source - kick it again
+        // once there are buffers to play
+        if (shouldBePlaying() && startedPlaying && !atEos) {
+            ALint state = 0;
+            ALint queued = 0;
+            alGetSourcei(als, AL_SOURCE_STATE, &state);
+            alGetSourcei(als, AL_BUFFERS_QUEUED, &queued);
+            if ((state == AL_STOPPED || state == AL_INITIAL) && queued > 0) {
+                clearAlError();
+                alSourcePlay(als);
+                checkAlError();
+            }
+        }
     }
 
     // Update various attributes if required
@@ -37,6 +37,7 @@
 #include "../../Sound.h"
 #include "../../Source.h"
 #include "../../Listener.h"
+#include "../../StreamDecoder.h"
 
 #include "OpenALSimpleSound.h"
 #include "OpenALStreamingSound.h"
@@ -246,9 +247,12 @@ using namespace __impl::OpenAL;
 
 OpenALRenderer::OpenALRenderer() :
         data(new RendererData) {
+    StreamDecoder::getSingleton()->start();
 }
 
 OpenALRenderer::~OpenALRenderer() {
+    // Streaming sounds outliving the renderer decode on their own from now on
+    StreamDecoder::shutdown();
 }
 
 vega_types::SharedPtr<Sound> OpenALRenderer::getSound(
@@ -32,6 +32,7 @@
 
 #include "../../CodecRegistry.h"
 #include "../../Stream.h"
+#include "../../StreamDecoder.h"
 #include "al.h"
 
 #ifdef max
@@ -47,6 +48,9 @@ using namespace Audio::__impl::OpenAL;
 // Handy macro
 #define NUM_BUFFERS (sizeof(bufferHandles) / sizeof(bufferHandles[0]))
 
+// How many buffers the decoder thread keeps ahead of the AL buffers
+#define NUM_DECODED_BUFFERS 4
+
 namespace Audio {
 
 OpenALStreamingSound::OpenALStreamingSound(const std::string &name, VSFileSystem::VSFileType type,
@@ -59,6 +63,8 @@ OpenALStreamingSound::OpenALStreamingSound(const std::string &name, VSFileSystem
 }
 
 OpenALStreamingSound::~OpenALStreamingSound() {
+    // The decoder thread calls back into this sound, so it must be done with it first
+    stopDecoding();
 }
 
 void OpenALStreamingSound::loadImpl(bool wait) {
@@ -93,9 +99,6 @@ void OpenALStreamingSound::loadImpl(bool wait) {
         // TODO: make it configurable. But first, implement a central configuration repository.
         bufferSamples = std::max(16384U, targetFormat.sampleFrequency / 4);
 
-        // Prepare a buffer, so we avoid repeated allocation/deallocation
-        buffer.reserve(bufferSamples, targetFormat);
-
         // Prepare AL buffers
         clearAlError();
         alGenBuffers(NUM_BUFFERS, bufferHandles);
@@ -104,13 +107,37 @@ void OpenALStreamingSound::loadImpl(bool wait) {
         // Initialize the buffer queue
         flushBuffers();
 
+        // Prepare the decoded buffers, so we avoid repeated allocation/deallocation,
+        // and have the decoder thread fill them from here on. This comes last, so that
+        // nothing can fail once the decoder thread shares the stream.
+        stopDecoding();
+        decoded = vega_types::MakeShared<DecodedStream>(NUM_DECODED_BUFFERS, bufferSamples, targetFormat,
+                [this](SoundBuffer &buffer) {
+                    readBuffer(buffer);
+                },
+                [this](double position) {
+                    getStream()->seek(position);
+                },
+                [this]() {
+                    return getStream()->getPosition();
+                });
+        StreamDecoder::getSingleton()->add(decoded);
+
         onLoaded(true);
     } catch (const Exception &e) {
+        stopDecoding();
         onLoaded(false);
         throw e;
     }
 }
 
+void OpenALStreamingSound::stopDecoding() {
+    if (decoded) {
+        StreamDecoder::getSingleton()->remove(decoded);
+        decoded.reset();
+    }
+}
+
 void OpenALStreamingSound::flushBuffers() {
     // Mark as detached, so that readAndFlip() knows to initialize the source
     // and streaming indices
@@ -122,6 +149,7 @@ void OpenALStreamingSound::flushBuffers() {
 }
 
 void OpenALStreamingSound::unloadImpl() {
+    stopDecoding();
     if (isStreamLoaded()) {
         closeStream();
     }
@@ -140,22 +168,36 @@ ALBufferHandle OpenALStreamingSound::readAndFlip() {
         return AL_NULL_BUFFER;
     }
 
-    bufferStarts[readBufferIndex] = getStream()->getPosition();
+    StreamDecoder *decoder = StreamDecoder::getSingleton();
+    if (!decoder->isRunning()) {
+        decoded->decode();
+    }
 
-    readBuffer(buffer);
+    // Nothing decoded yet, try again on the next update - acquire() may have
+    // given stale buffers back, though, so let the decoder at them
+    DecodedStream::Buffer *decodedBuffer = decoded->acquire();
+    if (!decodedBuffer) {
+        decoder->wake();
+        return AL_NULL_BUFFER;
+    }
 
     // Break if there's no more data
-    if (buffer.getUsedBytes() == 0) {
+    if (decodedBuffer->endOfStream) {
+        decoded->release(decodedBuffer);
         throw EndOfStreamException();
     }
 
+    bufferStarts[readBufferIndex] = decodedBuffer->start;
+
     ALBufferHandle bufferHandle = bufferHandles[readBufferIndex];
 
     clearAlError();
     alBufferData(bufferHandle,
             asALFormat(targetFormat),
-            buffer.getBuffer(), buffer.getUsedBytes(),
+            decodedBuffer->data.getBuffer(), decodedBuffer->data.getUsedBytes(),
             targetFormat.sampleFrequency);
+    decoded->release(decodedBuffer);
+    decoder->wake();
     checkAlError();
 
     if (playBufferIndex == NUM_BUFFERS) {
@@ -177,7 +219,9 @@ void OpenALStreamingSound::seek(double position) {
         throw ResourceNotLoadedException(getName());
     }
 
-    getStream()->seek(position);
+    // Decode the first buffer from there now, so a source that plays on
+    // (a looping one, most of all) has it when it asks
+    StreamDecoder::getSingleton()->seek(decoded, position);
 }
 
 Timestamp OpenALStreamingSound::getTimeBase() const {
@@ -36,6 +36,7 @@
 #include "../../Format.h"
 #include "../../SimpleSound.h"
 #include "../../SoundBuffer.h"
+#include "../../StreamDecoder.h"
 
 #include "al.h"
 
@@ -54,6 +55,8 @@ class OpenALRenderableSource;
  *      A package-private function is called to fill buffers
  *      for a configurable amount of buffer time - whenever a source
  *      is playing this sound, this has to happen regularly.
+ *      @par The stream itself is decoded ahead by the StreamDecoder
+ *      thread, so filling a buffer only copies already decoded samples.
  *
  * @see Sound, SimpleSound
  *
@@ -62,7 +65,7 @@ class OpenALStreamingSound : public SimpleSound {
     ALBufferHandle bufferHandles[2];
     Timestamp bufferStarts[2];
 
-    SoundBuffer buffer;
+    vega_types::SharedPtr<DecodedStream> decoded;
 
     Format targetFormat;
 
@@ -95,6 +98,10 @@ protected:
     /** @copydoc Sound::unloadImpl */
     virtual void unloadImpl();
 
+private:
+    /** Take the decoded ring away from the decoder thread, waiting for it if it's decoding */
+    void stopDecoding();
+
     // The following section contains package-private methods.
     // Only OpenAL renderer classes should access them, NOT YOU
 public:
@@ -102,7 +109,8 @@ public:
      *
      * @returns An AL buffer handle that can be queued in an AL streaming source, or
      *      AL_NULL_BUFFER if there's no available buffer for the operation (which means
-     *      the source should free some buffers)
+     *      the source should free some buffers), or nothing has been decoded yet (which
+     *      means the source should try again later)
      * @remarks It will check the buffer queue, and if there are free buffers, it will
      *      free one with new data.
      *          Basically, if you call this function often enough, you'll keep the source
@@ -0,0 +1,284 @@
+/*
+ * stream_decoder_tests.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "audio/SpscQueue.h"
+#include "audio/StreamDecoder.h"
+
+using Audio::DecodedStream;
+using Audio::SpscQueue;
+
+TEST(SpscQueue, RoundsUpAndFillsInOrder) {
+    SpscQueue<int> queue(5);
+    EXPECT_EQ(queue.capacity(), 8u);
+    EXPECT_TRUE(queue.empty());
+
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_TRUE(queue.push(i));
+    }
+    EXPECT_FALSE(queue.push(8));
+
+    int item = -1;
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_TRUE(queue.pop(item));
+        EXPECT_EQ(item, i);
+    }
+    EXPECT_FALSE(queue.pop(item));
+    EXPECT_EQ(item, 7);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(SpscQueue, HandsOverEverythingBetweenThreads) {
+    const int count = 100000;
+    SpscQueue<int> queue(16);
+    std::thread producer([&queue] {
+        for (int i = 0; i < count;) {
+            if (queue.push(i)) {
+                ++i;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    while (expected < count) {
+        int item;
+        if (queue.pop(item)) {
+            ASSERT_EQ(item, expected);
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(queue.empty());
+}
+
+// A stream of length samples counting up from 0, one byte each
+class CountingStream {
+public:
+    unsigned int position;
+    unsigned int length;
+    unsigned int seeks;
+
+    explicit CountingStream(unsigned int length) : position(0), length(length), seeks(0) {
+    }
+
+    void read(Audio::SoundBuffer &buffer) {
+        if (position >= length) {
+            throw Audio::EndOfStreamException();
+        }
+        unsigned int bytes = std::min(buffer.getByteCapacity(), length - position);
+        unsigned char *data = static_cast<unsigned char *>(buffer.getBuffer());
+        for (unsigned int i = 0; i < bytes; ++i) {
+            data[i] = static_cast<unsigned char>(position++);
+        }
+        buffer.setUsedBytes(bytes);
+    }
+
+    DecodedStream *ring(unsigned int buffers, unsigned int samples) {
+        Audio::Format format(8000, 8, 1);
+        return new DecodedStream(buffers, samples, format,
+                [this](Audio::SoundBuffer &buffer) {
+                    read(buffer);
+                },
+                [this](double to) {
+                    position = static_cast<unsigned int>(to);
+                    ++seeks;
+                },
+                [this]() {
+                    return double(position);
+                });
+    }
+};
+
+TEST(DecodedStream, DecodesAheadUntilTheEnd) {
+    CountingStream stream(40);
+    std::unique_ptr<DecodedStream> decoded(stream.ring(2, 16));
+
+    EXPECT_EQ(decoded->acquire(), nullptr);
+    EXPECT_TRUE(decoded->decode());
+    // The ring is full
+    EXPECT_FALSE(decoded->decode());
+    EXPECT_EQ(stream.position, 32u);
+
+    std::vector<unsigned int> starts;
+    unsigned int bytes = 0;
+    bool ended = false;
+    while (!ended) {
+        decoded->decode();
+        DecodedStream::Buffer *buffer = decoded->acquire();
+        ASSERT_NE(buffer, nullptr);
+        ended = buffer->endOfStream;
+        if (!ended) {
+            starts.push_back(static_cast<unsigned int>(buffer->start));
+            const unsigned char *data = static_cast<const unsigned char *>(buffer->data.getBuffer());
+            EXPECT_EQ(data[0], bytes);
+            bytes += buffer->data.getUsedBytes();
+        }
+        decoded->release(buffer);
+    }
+    EXPECT_EQ(bytes, 40u);
+    EXPECT_EQ(starts, std::vector<unsigned int>({0, 16, 32}));
+    // Nothing more is decoded past the end
+    EXPECT_FALSE(decoded->decode());
+    EXPECT_EQ(decoded->acquire(), nullptr);
+}
+
+TEST(DecodedStream, SeeksDropWhatWasDecodedBefore) {
+    CountingStream stream(1000);
+    std::unique_ptr<DecodedStream> decoded(stream.ring(4, 16));
+    decoded->decode();
+
+    decoded->seek(500);
+    // The seek is only a request until the decoder sees it, and the
+    // buffers decoded before it go back to be decoded again
+    EXPECT_EQ(stream.seeks, 0u);
+    EXPECT_EQ(decoded->acquire(), nullptr);
+
+    EXPECT_TRUE(decoded->decode());
+    EXPECT_EQ(stream.seeks, 1u);
+    DecodedStream::Buffer *buffer = decoded->acquire();
+    ASSERT_NE(buffer, nullptr);
+    EXPECT_EQ(buffer->start, 500.0);
+    EXPECT_EQ(static_cast<const unsigned char *>(buffer->data.getBuffer())[0], static_cast<unsigned char>(500));
+    decoded->release(buffer);
+
+    // Seeking back from the end decodes again
+    decoded->seek(990);
+    decoded->decode();
+    buffer = decoded->acquire();
+    ASSERT_NE(buffer, nullptr);
+    EXPECT_EQ(buffer->data.getUsedBytes(), 10u);
+    decoded->release(buffer);
+    decoded->decode();
+    buffer = decoded->acquire();
+    ASSERT_NE(buffer, nullptr);
+    EXPECT_TRUE(buffer->endOfStream);
+    decoded->release(buffer);
+
+    decoded->seek(0);
+    decoded->decode();
+    buffer = decoded->acquire();
+    ASSERT_NE(buffer, nullptr);
+    EXPECT_FALSE(buffer->endOfStream);
+    EXPECT_EQ(buffer->start, 0.0);
+    decoded->release(buffer);
+}
+
+// Waits for the decoder thread to hand over a buffer
+static DecodedStream::Buffer *AcquireWhenReady(DecodedStream &decoded) {
+    DecodedStream::Buffer *buffer = decoded.acquire();
+    for (int tries = 0; tries < 1000 && !buffer; ++tries) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        buffer = decoded.acquire();
+    }
+    return buffer;
+}
+
+TEST(StreamDecoder, LoopsWithoutAGap) {
+    Audio::StreamDecoder decoder;
+    CountingStream stream(40);
+    vega_types::SharedPtr<DecodedStream> decoded(stream.ring(2, 16));
+    decoder.add(decoded);
+
+    DecodedStream::Buffer *buffer = AcquireWhenReady(*decoded);
+    for (int loop = 0; loop < 3; ++loop) {
+        ASSERT_NE(buffer, nullptr);
+        EXPECT_EQ(buffer->start, 0.0);
+        unsigned int bytes = 0;
+        while (!buffer->endOfStream) {
+            EXPECT_EQ(static_cast<const unsigned char *>(buffer->data.getBuffer())[0], bytes);
+            bytes += buffer->data.getUsedBytes();
+            decoded->release(buffer);
+            buffer = AcquireWhenReady(*decoded);
+            ASSERT_NE(buffer, nullptr);
+        }
+        decoded->release(buffer);
+        EXPECT_EQ(bytes, 40u);
+
+        // What a looping source does at the end: the first buffer from the
+        // start has to be there right away, or the source falls silent
+        decoder.seek(decoded, 0);
+        buffer = decoded->acquire();
+    }
+    ASSERT_NE(buffer, nullptr);
+    decoded->release(buffer);
+    EXPECT_EQ(stream.seeks, 3u);
+
+    // Stopped, the seek is decoded all the same
+    decoder.stop();
+    decoder.seek(decoded, 24);
+    buffer = decoded->acquire();
+    ASSERT_NE(buffer, nullptr);
+    EXPECT_EQ(buffer->start, 24.0);
+    decoded->release(buffer);
+    // and only its first buffer: the rest of the ring is left to the thread
+    decoder.seek(decoded, 0);
+    EXPECT_EQ(stream.position, 16u);
+    decoder.remove(decoded);
+}
+
+TEST(StreamDecoder, StopsAndStartsAgain) {
+    Audio::StreamDecoder decoder;
+    ASSERT_TRUE(decoder.isRunning());
+
+    CountingStream stream(100);
+    vega_types::SharedPtr<DecodedStream> decoded(stream.ring(2, 16));
+    decoder.add(decoded);
+
+    // The thread fills the ring without anyone decoding
+    DecodedStream::Buffer *buffer = nullptr;
+    for (int tries = 0; tries < 1000 && !buffer; ++tries) {
+        buffer = decoded->acquire();
+        if (!buffer) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    ASSERT_NE(buffer, nullptr);
+    EXPECT_EQ(buffer->start, 0.0);
+    decoded->release(buffer);
+
+    decoder.stop();
+    EXPECT_FALSE(decoder.isRunning());
+    // Nothing touches the stream any more until decoded by hand
+    const unsigned int position = stream.position;
+    decoder.wake();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(stream.position, position);
+
+    decoder.start();
+    EXPECT_TRUE(decoder.isRunning());
+    decoder.remove(decoded);
+    decoder.stop();
+    Audio::StreamDecoder::shutdown();
+}
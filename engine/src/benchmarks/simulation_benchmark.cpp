@@ -0,0 +1,226 @@
+/*
+ * simulation_benchmark.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Simulates one star system without a window, sound or player: loads the
+ * system, adds AI ships from units.json, runs it for a fixed number of
+ * simulation atoms and writes SimulationBenchmark's JSON report. Rendering
+ * and audio go to the null drivers in gfxlib_headless.cpp and
+ * libaudioserver.cpp.
+ *
+ * usage: vegastrike-sim-benchmark -d<data dir> [--system <sector/system>] [--atoms <M>] [--ships <N>]
+ *            [--seed <S>] [--searches-per-frame <K>] [--report <file>]
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "cmd/script/mission.h"
+#include "cmd/unit_generic.h"
+#include "configuration/configuration.h"
+#include "config_xml.h"
+#include "gfx/animation.h"
+#include "lin_time.h"
+#include "options.h"
+#include "python/init.h"
+#include "sim_benchmark.h"
+#include "star_system.h"
+#include "universe.h"
+#include "vegastrike.h"
+#include "vs_exit.h"
+#include "vs_globals.h"
+#include "vs_logging.h"
+#include "vs_random.h"
+#include "vsfilesystem.h"
+
+/*
+ * What main.cpp provides the rest of the game. There is nothing to draw
+ * and no player here, so most of it does nothing.
+ */
+Universe *_Universe;
+char SERVER = 0;
+bool legacy_data_dir_mode = false;
+bool isVista = false;
+Unit *TheTopLevelUnit;
+LeakVector<Mission *> active_missions;
+static bool star_system_loading = false;
+
+extern void InitUnitTables();
+
+void enableNetwork(bool usenetwork) {
+}
+
+VegaConfig *createVegaConfig(const char *file) {
+    return new GameVegaConfig(file);
+}
+
+void VSExit(int code) {
+    VegaStrikeLogging::vega_logger()->FlushLogs();
+    exit(code);
+}
+
+void SetStarSystemLoading(bool value) {
+    star_system_loading = value;
+}
+
+bool GetStarSystemLoading() {
+    return star_system_loading;
+}
+
+vega_types::SharedPtr<Animation> GetSplashScreen() {
+    return vega_types::SharedPtr<Animation>();
+}
+
+void SetStartupView(Cockpit *cp) {
+}
+
+void bootstrap_draw(const std::string &message, vega_types::SharedPtr<Animation> newSplashScreen) {
+}
+
+void bootstrap_first_loop() {
+}
+
+void bootstrap_main_loop() {
+}
+
+//Returns the value following option i, and skips over it
+static const char *OptionValue(int argc, char **argv, int &i) {
+    if (i + 1 >= argc) {
+        std::cerr << "Option " << argv[i] << " requires an argument" << std::endl;
+        exit(1);
+    }
+    return argv[++i];
+}
+
+template<typename T>
+static T NumericOptionValue(int argc, char **argv, int &i) {
+    const char *option = argv[i];
+    std::istringstream value(OptionValue(argc, argv, i));
+    T result;
+    if (!(value >> result)) {
+        std::cerr << "Error parsing value of " << option << ": " << value.str() << std::endl;
+        exit(1);
+    }
+    return result;
+}
+
+static void ParseCommandLine(int argc, char **argv) {
+    SimulationBenchmark &benchmark = SimulationBenchmark::Instance();
+    for (int i = 1; i < argc; ++i) {
+        if ((argv[i][0] == '-' && (argv[i][1] == 'd' || argv[i][1] == 'D')) && argv[i][2] != 0) {
+            if (!VSFileSystem::DirectoryExists(&argv[i][2])) {
+                std::cerr << "Specified data directory not found... exiting" << std::endl;
+                exit(1);
+            }
+            VSFileSystem::datadir = &argv[i][2];
+        } else if (strcmp(argv[i], "--system") == 0) {
+            benchmark.star_system = OptionValue(argc, argv, i);
+        } else if (strcmp(argv[i], "--atoms") == 0) {
+            benchmark.atoms = NumericOptionValue<uint64_t>(argc, argv, i);
+        } else if (strcmp(argv[i], "--ships") == 0) {
+            benchmark.ships = NumericOptionValue<unsigned int>(argc, argv, i);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            benchmark.seed = NumericOptionValue<unsigned int>(argc, argv, i);
+        } else if (strcmp(argv[i], "--searches-per-frame") == 0) {
+            benchmark.searches_per_frame = NumericOptionValue<unsigned int>(argc, argv, i);
+        } else if (strcmp(argv[i], "--report") == 0) {
+            benchmark.report_path = OptionValue(argc, argv, i);
+        } else {
+            std::cerr << "usage: " << argv[0] << " -d<data dir> [--system <sector/system>] [--atoms <M>] [--ships <N>]"
+                    " [--seed <S>] [--searches-per-frame <K>] [--report <file>]" << std::endl;
+            exit(1);
+        }
+    }
+    if (benchmark.atoms == 0) {
+        std::cerr << "--atoms must be at least 1" << std::endl;
+        exit(1);
+    }
+}
+
+/* Where ships come into the system: its first jump point, well away from the star */
+static QVector ShipsCenter(StarSystem *system) {
+    Unit *unit;
+    for (un_iter iter = system->gravitationalUnits().createIterator(); (unit = *iter) != nullptr; ++iter) {
+        if (!unit->GetDestinations().empty()) {
+            return unit->Position();
+        }
+    }
+    return QVector(0, 0, 0);
+}
+
+int main(int argc, char **argv) {
+    SimulationBenchmark &benchmark = SimulationBenchmark::Instance();
+    ParseCommandLine(argc, argv);
+
+    g_game.sound_enabled = 0;
+    g_game.use_textures = 0;
+    g_game.use_sprites = 0;
+    g_game.use_animations = 0;
+    g_game.use_videos = 0;
+    g_game.x_resolution = 1024;
+    g_game.y_resolution = 768;
+    g_game.fov = 78;
+    VSFileSystem::InitPaths("vegastrike.config", "");
+    ReloadConfiguration();
+    VegaStrikeLogging::vega_logger()->InitLoggingPart2(configuration()->logging.vsdebug,
+            boost::filesystem::absolute(VSFileSystem::homedir), configuration()->logging.asynchronous);
+
+    srand(benchmark.seed);
+    vsrandom.init_genrand(benchmark.seed);
+
+    InitUnitTables();
+#ifdef HAVE_PYTHON
+    Python::init();
+#endif
+    // no scripts, and no director without a player: the ships added here are all that is launched
+    active_missions.push_back(mission = new Mission(game_options()->default_mission.c_str(), false));
+    mission->initMission(false);
+
+    _Universe = new Universe(argc, argv, game_options()->galaxy.c_str());
+    TheTopLevelUnit = new Unit(0);
+    InitTime();
+    StarSystem *system = _Universe->Init(benchmark.star_system, Vector(0, 0, 0), std::string());
+    _Universe->pushActiveStarSystem(system);
+
+    benchmark.SpawnShips(system, SimulationBenchmark::ShipTypes(), ShipsCenter(system));
+    benchmark.Start();
+    while (!benchmark.IsFinished()) {
+        UpdateTime();
+        system->Update(1, false);
+        StarSystem::ProcessPendingJumps();
+    }
+    benchmark.WriteReport(system);
+
+    VegaStrikeLogging::vega_logger()->FlushLogs();
+    return 0;
+}
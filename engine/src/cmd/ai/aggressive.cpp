@@ -1285,7 +1285,7 @@ static Unit *ChooseNavPoint(Unit *parent, Unit **otherdest, float *lurk_on_arriv
     bool asteroidhide = false;
     if (stats->friendlycount > 0 && stats->enemycount > 0) {
         asteroidhide = (secondRand < stats->enemycount / (float) stats->friendlycount)
-                && (secondRand < num_ships_per_roid * stats->navs[2].size() / (float) stats->enemycount);
+                && (secondRand < num_ships_per_roid * stats->Navs()[2].size() / (float) stats->enemycount);
     }
     bool siege = stats->enemycount > 2 * stats->friendlycount;       //rough approx
     int whichlist = 1;  //friendly
@@ -1294,38 +1294,38 @@ static Unit *ChooseNavPoint(Unit *parent, Unit **otherdest, float *lurk_on_arriv
     bool insys = (parent->GetJumpStatus().drive == -2) || fgname.find(insysString) != std::string::npos;
     std::string::size_type whereconvoy = fgname.find(arrowString);
     bool convoy = (whereconvoy != std::string::npos);
-    size_t total_size = stats->navs[0].size() + stats->navs[whichlist].size();     //friendly and neutral
+    size_t total_size = stats->Navs()[0].size() + stats->Navs()[whichlist].size();     //friendly and neutral
     static bool bad_units_lurk = XMLSupport::parse_bool(vs_config->getVariable("AI", "hostile_lurk", "true"));
     if (hostile && bad_units_lurk) {
         if (anarchy && !siege) {
             whichlist = 2;
-            total_size = stats->navs[0].size() + stats->navs[whichlist].size();             //asteroids and neutrals
+            total_size = stats->Navs()[0].size() + stats->Navs()[whichlist].size();             //asteroids and neutrals
         } else {
             whichlist = 2;
-            total_size = stats->navs[whichlist].size();             //just asteroids
+            total_size = stats->Navs()[whichlist].size();             //just asteroids
         }
     } else if (civilian) {
         if (anarchy || siege) {
             whichlist = 0;
-            total_size = stats->navs[0].size();
+            total_size = stats->Navs()[0].size();
         } else if (insys || convoy) {
             whichlist = 1;
-            total_size = stats->navs[1].size();             //don't go to jump point
+            total_size = stats->Navs()[1].size();             //don't go to jump point
         }
     }
     if (hostile && ((anarchy == false && asteroidhide == false) || total_size == 0) && civilian == false
             && bad_units_lurk) {
         //hit and run
-        Unit *a = GetRandomNav(stats->navs, firstRand);
-        Unit *b = GetRandomNav(stats->navs, thirdRand);
+        Unit *a = GetRandomNav(stats->Navs(), firstRand);
+        Unit *b = GetRandomNav(stats->Navs(), thirdRand);
         if (a == b) {
-            b = GetRandomNav(stats->navs, thirdRand + 1);
+            b = GetRandomNav(stats->Navs(), thirdRand + 1);
         }
         if (a != b) {
             int retrycount = maxrand;
             while (--retrycount > 0
                     && (UnitUtil::getDistance(a, b) < parent->GetComputerData().radar.maxrange * 4 || a == b)) {
-                b = GetRandomNav(stats->navs, additionalrand[retrycount]);
+                b = GetRandomNav(stats->Navs(), additionalrand[retrycount]);
             }
             if (retrycount != 0) {
                 *otherdest = b;
@@ -1350,19 +1350,19 @@ static Unit *ChooseNavPoint(Unit *parent, Unit **otherdest, float *lurk_on_arriv
                         return un;
                     }
                 } else {
-                    total_size = stats->navs[whichlist].size()
-                            + stats->navs[0].size();                     //no such jump point--have to random-walk it
+                    total_size = stats->Navs()[whichlist].size()
+                            + stats->Navs()[0].size();                     //no such jump point--have to random-walk it
                     //maybe one day we can incorporate some sort of route planning
                 }
             }
         }
         if (total_size > 0) {
             firstRand %= total_size;
-            if (firstRand >= stats->navs[whichlist].size()) {
-                firstRand -= stats->navs[whichlist].size();
+            if (firstRand >= stats->Navs()[whichlist].size()) {
+                firstRand -= stats->Navs()[whichlist].size();
                 whichlist = 0;                 //allows you to look for both neutral and ally lists
             }
-            return stats->navs[whichlist][firstRand].GetUnit();
+            return stats->Navs()[whichlist][firstRand].GetUnit();
         }
     }
     return NULL;
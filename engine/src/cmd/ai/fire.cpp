@@ -34,6 +34,7 @@
 #include "cmd/script/flightgroup.h"
 #include "cmd/role_bitmask.h"
 #include "cmd/ai/communication.h"
+#include "cmd/ai/targeting_service.h"
 #include "universe_util.h"
 #include <algorithm>
 #include "cmd/unit_find.h"
@@ -473,67 +474,19 @@ public:
     }
 };
 
-int numpolled[2] = {0, 0};   //number of units that searched for a target
-
-int prevpollindex[2] = {10000, 10000};   //previous number of units touched (doesn't need to be precise)
-
-int pollindex[2] = {1,
-        1};   //current count of number of units touched (doesn't need to be precise)  -- used for "fairness" heuristic
-
 void FireAt::ChooseTargets(int numtargs, bool force) {
-    float gunspeed, gunrange, missilerange;
-    parent->getAverageGunSpeed(gunspeed, gunrange, missilerange);
-    static float targettimer = UniverseUtil::GetGameTime();    //timer used to determine passage of physics frames
     static float mintimetoswitch =
             XMLSupport::parse_float(vs_config->getVariable("AI", "Targetting", "MinTimeToSwitchTargets", "3"));
-    static float minnulltimetoswitch =
-            XMLSupport::parse_float(vs_config->getVariable("AI", "Targetting", "MinNullTimeToSwitchTargets", "5"));
-    static int minnumpollers =
-            float_to_int(XMLSupport::parse_float(vs_config->getVariable("AI",
-                    "Targetting",
-                    "MinNumberofpollersperframe",
-                    "5")));                    //maximum number of vessels allowed to search for a target in a given physics frame
-    static int maxnumpollers =
-            float_to_int(XMLSupport::parse_float(vs_config->getVariable("AI",
-                    "Targetting",
-                    "MaxNumberofpollersperframe",
-                    "49")));                    //maximum number of vessels allowed to search for a target in a given physics frame
-    static int numpollers[2] = {maxnumpollers, maxnumpollers};
-
-    static int nextframenumpollers[2] = {maxnumpollers, maxnumpollers};
     if (lastchangedtarg + mintimetoswitch > 0) {
         return;
     }          //don't switch if switching too soon
 
     Unit *curtarg = parent->Target();
-    int hastarg = (curtarg == NULL) ? 0 : 1;
-    //Following code exists to limit the number of craft polling for a target in a given frame - this is an expensive operation, and needs to be spread out, or there will be pauses.
-    if ((UniverseUtil::GetGameTime()) - targettimer >= SIMULATION_ATOM * .99) {
-        //Check if one or more physics frames have passed
-        numpolled[0] = numpolled[1] = 0;         //reset counters
-        prevpollindex[0] = pollindex[0];
-        prevpollindex[1] = pollindex[1];
-        pollindex[hastarg] = 0;
-        targettimer = UniverseUtil::GetGameTime();
-        numpollers[0] = float_to_int(nextframenumpollers[0]);
-        numpollers[1] = float_to_int(nextframenumpollers[1]);
-    }
-    pollindex[hastarg]++;     //count number of craft touched - will use in the next physics frame to spread out the vessels actually chosen to be processed among all of the vessels being touched
-    if (numpolled[hastarg] > numpollers[hastarg]) {      //over quota, wait until next physics frame
-        return;
-    }
-    if (!(pollindex[hastarg] % ((prevpollindex[hastarg] / numpollers[hastarg])
-            + 1))) {      //spread out, in modulo fashion, the possibility of changing one's target. Use previous physics frame count of craft to estimate current number of craft
-        numpolled[hastarg]++;          //if a more likely candidate, we're going to search for a target.
-    } else {
-        return;
-    }          //skipped to achieve better fairness - see comment on modulo distribution above
     if (curtarg) {
         if (isJumpablePlanet(curtarg)) {
             return;
         }
     }
-    bool wasnull = (curtarg == NULL);
     Flightgroup *fg = parent->getFlightgroup();
     lastchangedtarg = 0 + targrand.uniformInc(0, 1)
             * mintimetoswitch;     //spread out next valid time to switch targets - helps to ease per-frame loads.
@@ -544,7 +497,24 @@ void FireAt::ChooseTargets(int numtargs, bool force) {
             }
         }
     }
-    //not   allowed to switch targets
+    //the search is expensive, so it waits its turn in the targeting service, which spreads them over the frames
+    parent->getStarSystem()->getTargetingService().Submit(this);
+}
+
+SearchQueue *FireAt::HomeQueue() {
+    return TargetingService::QueueOf(parent);
+}
+
+void FireAt::SearchForTargets() {
+    if (parent == NULL || parent->Killed()) {
+        return;
+    }
+    float gunspeed, gunrange, missilerange;
+    parent->getAverageGunSpeed(gunspeed, gunrange, missilerange);
+    static float minnulltimetoswitch =
+            XMLSupport::parse_float(vs_config->getVariable("AI", "Targetting", "MinNullTimeToSwitchTargets", "5"));
+    Unit *curtarg = parent->Target();
+    bool wasnull = (curtarg == NULL);
     numprocessed++;
     vector<TurretBin> tbin;
     Unit *su = NULL;
@@ -579,7 +549,8 @@ void FireAt::ChooseTargets(int numtargs, bool force) {
             "Targetting",
             "search_max_candidates",
             "64"));   //Cutoff candidate count (if that many hostiles found, stop search - performance/quality tradeoff, 0=no cutoff)
-    UnitWithinRangeLocator<ChooseTargetClass<2> > unitLocator(parent->GetComputerData().radar.maxrange, unitRad);
+    float radarrange = parent->GetComputerData().radar.maxrange;
+    UnitWithinRangeLocator<ChooseTargetClass<2> > unitLocator(radarrange, unitRad);
     StaticTuple<float, 2> maxranges{};
 
     maxranges[0] = gunrange;
@@ -615,11 +586,33 @@ void FireAt::ChooseTargets(int numtargs, bool force) {
             gcounter = 0;
         }
     }
-    if (unitLocator.action.mytarg == NULL) {      //decided to rechoose or did not have initial target
-        findObjects(
-                _Universe->activeStarSystem()->collide_map[Unit::UNIT_ONLY],
-                parent->location[Unit::UNIT_ONLY],
-                &unitLocator);
+    if (unitLocator.action.mytarg == NULL
+            && !is_null(parent->location[Unit::UNIT_ONLY])) {      //decided to rechoose or did not have initial target
+        //same walk as findObjects, over the units wingmates nearby may have already found;
+        //each side stops on its own once the locator has had enough of it
+        double mykey = parent->location[Unit::UNIT_ONLY]->getKey();
+        bool workless = true;
+        bool workmore = true;
+        for (Unit *un : parent->getStarSystem()->getTargetingService().CandidatesNear(parent, radarrange, unitRad)) {
+            if (un == parent || is_null(un->location[Unit::UNIT_ONLY])) {
+                continue;
+            }
+            bool less = un->location[Unit::UNIT_ONLY]->getKey() < mykey;
+            if (!(less ? workless : workmore)) {
+                continue;
+            }
+            float dist = UnitUtil::getDistance(parent, un);
+            if (dist < radarrange && !unitLocator.action.acquire(un, dist)) {
+                if (less) {
+                    workless = false;
+                } else {
+                    workmore = false;
+                }
+                if (!workless && !workmore) {
+                    break;
+                }
+            }
+        }
     }
     Unit *mytarg = unitLocator.action.mytarg;
     targetpick += queryTime() - pretable;
@@ -632,31 +625,8 @@ void FireAt::ChooseTargets(int numtargs, bool force) {
         k->AssignTargets(my_target, parent->cumulative_transformation_matrix);
     }
     parent->LockTarget(false);
-    if (wasnull) {
-        if (mytarg) {
-            nextframenumpollers[hastarg] += 2;
-            if (nextframenumpollers[hastarg] > maxnumpollers) {
-                nextframenumpollers[hastarg] = maxnumpollers;
-            }
-        } else {
-            lastchangedtarg += targrand.uniformInc(0, 1) * minnulltimetoswitch;
-            nextframenumpollers[hastarg] -= .05;
-            if (nextframenumpollers[hastarg] < minnumpollers) {
-                nextframenumpollers[hastarg] = minnumpollers;
-            }
-        }
-    } else {
-        if (parent->Target() != mytarg) {
-            nextframenumpollers[hastarg] += 2;
-            if (nextframenumpollers[hastarg] > maxnumpollers) {
-                nextframenumpollers[hastarg] = maxnumpollers;
-            }
-        } else {
-            nextframenumpollers[hastarg] -= .01;
-            if (nextframenumpollers[hastarg] < minnumpollers) {
-                nextframenumpollers[hastarg] = minnumpollers;
-            }
-        }
+    if (wasnull && !mytarg) {
+        lastchangedtarg += targrand.uniformInc(0, 1) * minnulltimetoswitch;
     }
     parent->Target(mytarg);
     parent->LockTarget(true);
@@ -726,6 +696,7 @@ bool FireAt::ShouldFire(Unit *targ, bool &missilelock) {
 }
 
 FireAt::~FireAt() {
+    SearchQueue::Cancel(this);
 #ifdef ORDERDEBUG
     VS_LOG_AND_FLUSH(trace, (boost::format("fire%1$x") % this));
 #endif
@@ -29,11 +29,12 @@
 #define _CMD_TARGET_AI_H_
 #include "comm_ai.h"
 #include "event_xml.h"
+#include "search_queue.h"
 //all unified AI's should inherit from FireAt, so they can choose targets together.
 bool RequestClearence(class Unit *parent, class Unit *targ, unsigned char sex);
 Unit *getAtmospheric(Unit *targ);
 namespace Orders {
-class FireAt : public CommunicatingAI {
+class FireAt : public CommunicatingAI, public QueuedSearch {
 protected:
     bool ShouldFire(Unit *targ, bool &missilelock);
     float missileprobability{};
@@ -44,8 +45,13 @@ protected:
     float lastchangedtarg{};
     bool had_target{};
     void FireWeapons(bool shouldfire, bool lockmissile);
+    //asks the targeting service to choose n targets and put the best to attack in unit's target container
     virtual void ChooseTargets(int num,
-            bool force = false); //chooses n targets and puts the best to attack in unit's target container
+            bool force = false);
+    //the search itself, run by the targeting service of the ship's system within its frame budget
+    virtual void SearchForTargets();
+    //the targeting queue of the system the ship is in now
+    virtual SearchQueue *HomeQueue();
     bool isJumpablePlanet(Unit *);
     void ReInit(float agglevel);
     virtual void SignalChosenTarget();
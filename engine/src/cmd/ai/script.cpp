@@ -27,9 +27,12 @@
 #include "navigation.h"
 #include "xml_support.h"
 #include "flybywire.h"
+#include <chrono>
 #include <cstdio>
+#include <memory>
 #include <vector>
 #include <stack>
+#include <sys/stat.h>
 #include "vsfilesystem.h"
 #include "vs_logging.h"
 #include "tactics.h"
@@ -168,14 +171,6 @@ void AIScript::popv() {
     xml->vectors.pop();
 }
 
-void AIScript::beginElement(void *userData, const XML_Char *name, const XML_Char **atts) {
-    ((AIScript *) userData)->beginElement(name, AttributeList(atts));
-}
-
-void AIScript::endElement(void *userData, const XML_Char *name) {
-    ((AIScript *) userData)->endElement(name);
-}
-
 namespace AiXml {
 enum Names {
     SCRIPT,
@@ -290,18 +285,128 @@ const EnumMap element_map(element_names, 32);
 const EnumMap attribute_map(attribute_names, 19);
 }
 
-void AIScript::beginElement(const string &name, const AttributeList &attributes) {
+struct AIScriptAttribute {
+    // an AiXml::Names value, kept as the int lookup() returns, as the switches on it handle a few names each
+    int name;
+    string value;
+};
+
+///One element of a script file, with its element and attribute names already looked up
+struct AIScriptEvent {
+    bool begin;
+    AiXml::Names element;
+    vector<AIScriptAttribute> attributes;
+};
+
+///A script file as expat saw it. It doesn't depend on the unit running it, so every AIScript of that file shares it
+struct AIScriptProgram {
+    vector<AIScriptEvent> events;
+};
+
+static void CompileBeginElement(void *userData, const XML_Char *name, const XML_Char **atts) {
+    using namespace AiXml;
+    AIScriptProgram *program = static_cast<AIScriptProgram *>(userData);
+    program->events.push_back(AIScriptEvent());
+    AIScriptEvent &event = program->events.back();
+    event.begin = true;
+    event.element = (Names) element_map.lookup(name);
+    AttributeList attributes(atts);
+    for (AttributeList::const_iterator iter = attributes.begin(); iter != attributes.end(); iter++) {
+        AIScriptAttribute attribute = {attribute_map.lookup((*iter).name), (*iter).value};
+        event.attributes.push_back(attribute);
+    }
+}
+
+static void CompileEndElement(void *userData, const XML_Char *name) {
+    AIScriptProgram *program = static_cast<AIScriptProgram *>(userData);
+    program->events.push_back(AIScriptEvent());
+    AIScriptEvent &event = program->events.back();
+    event.begin = false;
+    event.element = (AiXml::Names) AiXml::element_map.lookup(name);
+}
+
+struct CompiledScript {
+    ///NULL when the file could not be opened
+    std::shared_ptr<const AIScriptProgram> program;
+    ///Where the file is on disk, empty when it came out of a volume and can't be edited
+    string path;
+    time_t modified;
+    std::chrono::steady_clock::time_point checked;
+};
+
+///Only touched from AIScript::Execute, which runs on the main thread
+static vsUMap<string, CompiledScript> compiled_scripts;
+
+static time_t ModificationTime(const string &path) {
+    struct stat s{};
+    if (path.empty() || stat(path.c_str(), &s) != 0) {
+        return 0;
+    }
+    return s.st_mtime;
+}
+
+static void CompileScript(const char *filename, CompiledScript &entry) {
+    using namespace VSFileSystem;
+    entry.program.reset();
+    entry.path.clear();
+    entry.modified = 0;
+    VSFile f;
+    VSError err = f.OpenReadOnly(filename, AiFile);
+    if (err > Ok) {
+        return;
+    }
+    std::shared_ptr<AIScriptProgram> program = std::make_shared<AIScriptProgram>();
+    XML_Parser parser = XML_ParserCreate(NULL);
+    XML_SetUserData(parser, program.get());
+    XML_SetElementHandler(parser, &CompileBeginElement, &CompileEndElement);
+    XML_Parse(parser, (f.ReadFull()).c_str(), f.Size(), 1);
+    XML_ParserFree(parser);
+    if (!f.UseVolume()) {
+        entry.path = f.GetFullPath();
+        entry.modified = ModificationTime(entry.path);
+    }
+    f.Close();
+    entry.program = program;
+}
+
+/*
+ * Returns the parsed script file, reading it only the first time it is asked
+ * for. The file on disk is looked at again at most once a second, and parsed
+ * again when its modification time has changed (or when it was missing).
+ */
+static std::shared_ptr<const AIScriptProgram> GetCompiledScript(const char *filename) {
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    vsUMap<string, CompiledScript>::iterator found = compiled_scripts.find(filename);
+    if (found != compiled_scripts.end()) {
+        CompiledScript &entry = found->second;
+        if (now - entry.checked < std::chrono::seconds(1)) {
+            return entry.program;
+        }
+        entry.checked = now;
+        if (entry.program && (entry.path.empty() || ModificationTime(entry.path) == entry.modified)) {
+            return entry.program;
+        }
+        CompileScript(filename, entry);
+        return entry.program;
+    }
+    CompiledScript &entry = compiled_scripts[filename];
+    entry.checked = now;
+    CompileScript(filename, entry);
+    return entry.program;
+}
+
+void AIScript::beginElement(const AIScriptEvent &event) {
     using namespace AiXml;
     xml->itts = false;
     Unit *tmp;
 #ifdef AIDBG
     VS_LOG(debug, "0");
 #endif
-    Names elem = (Names) element_map.lookup(name);
+    Names elem = event.element;
 #ifdef AIDBG
     VS_LOG(debug, (boost::format("1%1$x ") % &elem));
 #endif
-    AttributeList::const_iterator iter;
+    vector<AIScriptAttribute>::const_iterator iter;
     switch (elem) {
         case DEFAULT:
             xml->unitlevel += 2;         //pretend it's at a reasonable level
@@ -318,8 +423,8 @@ void AIScript::beginElement(const string &name, const AttributeList &attributes)
         case VECTOR:
             xml->unitlevel++;
             xml->vectors.push(QVector(0, 0, 0));
-            for (iter = attributes.begin(); iter != attributes.end(); iter++) {
-                switch (attribute_map.lookup((*iter).name)) {
+            for (iter = event.attributes.begin(); iter != event.attributes.end(); iter++) {
+                switch ((*iter).name) {
                     case X:
                         topv().i = parse_float((*iter).value);
                         break;
@@ -388,8 +493,8 @@ void AIScript::beginElement(const string &name, const AttributeList &attributes)
             xml->unitlevel++;
             xml->acc = 2;
             xml->afterburn = true;
-            for (iter = attributes.begin(); iter != attributes.end(); iter++) {
-                switch (attribute_map.lookup((*iter).name)) {
+            for (iter = event.attributes.begin(); iter != event.attributes.end(); iter++) {
+                switch ((*iter).name) {
                     case AFTERBURN:
                         xml->afterburn = parse_bool((*iter).value);
                     case ACCURACY:
@@ -407,8 +512,8 @@ void AIScript::beginElement(const string &name, const AttributeList &attributes)
             xml->itts = false;
             xml->afterburn = true;
             xml->terminate = true;
-            for (iter = attributes.begin(); iter != attributes.end(); iter++) {
-                switch (attribute_map.lookup((*iter).name)) {
+            for (iter = event.attributes.begin(); iter != event.attributes.end(); iter++) {
+                switch ((*iter).name) {
                     case TERMINATE:
                         xml->terminate = parse_bool((*iter).value);
                         break;
@@ -431,8 +536,8 @@ void AIScript::beginElement(const string &name, const AttributeList &attributes)
             xml->acc = 2;
             xml->afterburn = true;
             xml->terminate = true;
-            for (iter = attributes.begin(); iter != attributes.end(); iter++) {
-                switch (attribute_map.lookup((*iter).name)) {
+            for (iter = event.attributes.begin(); iter != event.attributes.end(); iter++) {
+                switch ((*iter).name) {
                     case TERMINATE:
                         xml->terminate = parse_bool((*iter).value);
                         break;
@@ -483,8 +588,8 @@ void AIScript::beginElement(const string &name, const AttributeList &attributes)
         case FFLOAT:
             xml->unitlevel++;
             xml->floats.push(0);
-            for (iter = attributes.begin(); iter != attributes.end(); iter++) {
-                switch (attribute_map.lookup((*iter).name)) {
+            for (iter = event.attributes.begin(); iter != event.attributes.end(); iter++) {
+                switch ((*iter).name) {
                     case VALUE:
                         topf() = parse_float((*iter).value);
                         break;
@@ -508,8 +613,8 @@ void AIScript::beginElement(const string &name, const AttributeList &attributes)
             xml->acc = 0;
             xml->afterburn = false;
             xml->terminate = true;
-            for (iter = attributes.begin(); iter != attributes.end(); iter++) {
-                switch (attribute_map.lookup((*iter).name)) {
+            for (iter = event.attributes.begin(); iter != event.attributes.end(); iter++) {
+                switch ((*iter).name) {
                     case AFTERBURN:
                         xml->afterburn = parse_bool((*iter).value);
                         break;
@@ -530,8 +635,8 @@ void AIScript::beginElement(const string &name, const AttributeList &attributes)
             xml->unitlevel++;
             xml->executefor.push_back(0);
             xml->terminate = true;
-            for (iter = attributes.begin(); iter != attributes.end(); iter++) {
-                switch (attribute_map.lookup((*iter).name)) {
+            for (iter = event.attributes.begin(); iter != event.attributes.end(); iter++) {
+                switch ((*iter).name) {
                     case TERMINATE:
                         xml->terminate = parse_bool((*iter).value);
                         break;
@@ -544,8 +649,8 @@ void AIScript::beginElement(const string &name, const AttributeList &attributes)
         case EXECUTEFOR:
             xml->unitlevel++;
             xml->executefor.push_back(0);
-            for (iter = attributes.begin(); iter != attributes.end(); iter++) {
-                switch (attribute_map.lookup((*iter).name)) {
+            for (iter = event.attributes.begin(); iter != event.attributes.end(); iter++) {
+                switch ((*iter).name) {
                     case TIME:
                         xml->executefor.back() = parse_float((*iter).value);
                         break;
@@ -559,10 +664,10 @@ void AIScript::beginElement(const string &name, const AttributeList &attributes)
     }
 }
 
-void AIScript::endElement(const string &name) {
+void AIScript::endElement(const AIScriptEvent &event) {
     using namespace AiXml;
     QVector temp(0, 0, 0);
-    Names elem = (Names) element_map.lookup(name);
+    Names elem = event.element;
     Unit *tmp;
     switch (elem) {
         case UNKNOWN:
@@ -844,76 +949,37 @@ void AIScript::LoadXML() {
                     filename) + " threat " + XMLSupport::tostring(parent->GetComputerData().threatlevel));
         }
     }
-#ifdef AIDBG
-    VS_LOG(debug, "chd");
-#endif
-
-#ifdef AIDBG
-    VS_LOG(debug, "echd");
-#endif
-    VSFile f;
-    VSError err = f.OpenReadOnly(filename, AiFile);
-#ifdef AIDBG
-    VS_LOG(debug, "backup ");
-#endif
-    if (err > Ok) {
+    std::shared_ptr<const AIScriptProgram> program = GetCompiledScript(filename);
+    if (!program) {
         VS_LOG(error, (boost::format("cannot find AI script %1%") % filename));
         if (hard_coded_scripts.find(filename) != hard_coded_scripts.end()) {
             assert(0);
         }
         return;
     }
-#ifdef BIDBG
-    VS_LOG(debug, "nxml");
-#endif
     xml = new AIScriptXML;
     xml->unitlevel = 0;
     xml->terminate = true;
     xml->afterburn = true;
     xml->acc = 2;
+    xml->lin = 0;
     xml->defaultvec = QVector(0, 0, 0);
     xml->defaultf = 0;
-#ifdef BIDBG
-    VS_LOG(debug, "parscrea");
-#endif
-    XML_Parser parser = XML_ParserCreate(NULL);
-#ifdef BIDBG
-    VS_LOG(debug, (boost::format("usdat %1$x") % parser));
-#endif
-    XML_SetUserData(parser, this);
-#ifdef BIDBG
-    VS_LOG(debug, "elha");
-#endif
-    XML_SetElementHandler(parser, &AIScript::beginElement, &AIScript::endElement);
-#ifdef BIDBG
-    VS_LOG(debug, "do");
-#endif
-    XML_Parse(parser, (f.ReadFull()).c_str(), f.Size(), 1);
-#ifdef BIDBG
-    VS_LOG_AND_FLUSH(debug, (boost::format("%1$xxml_free") % parser));
-#endif
-    XML_ParserFree(parser);
-#ifdef BIDBG
-    VS_LOG(debug, "xml_freed");
-#endif
-    f.Close();
+    //replays the file's elements against this unit, the way expat used to call us while reading it
+    for (vector<AIScriptEvent>::const_iterator event = program->events.begin(); event != program->events.end();
+            ++event) {
+        if (event->begin) {
+            beginElement(*event);
+        } else {
+            endElement(*event);
+        }
+    }
     for (unsigned int i = 0; i < xml->orders.size(); i++) {
-#ifdef BIDBG
-        VS_LOG(debug, "parset");
-#endif
         xml->orders[i]->SetParent(parent);
         EnqueueOrder(xml->orders[i]);
-#ifdef BIDBG
-        VS_LOG(debug, "cachunkx");
-#endif
     }
-#ifdef BIDBG
-    VS_LOG_AND_FLUSH(debug, (boost::format("xml%1$x") % xml));
-#endif
     delete xml;
-#ifdef BIDBG
-    VS_LOG_AND_FLUSH(debug, "\\xml\n");
-#endif
+    xml = NULL;
 }
 
 AIScript::AIScript(const char *scriptname) : Order(Order::MOVEMENT | Order::FACING, STARGET) {
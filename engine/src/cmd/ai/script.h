@@ -33,21 +33,18 @@
 
 /**
  * Loads a script from a given XML file
- * FIXME: This data is not cached and is streamed
- * from harddrive and expat'ed each time a script is loaded
+ * Each file is parsed only once (and again after it is edited); every
+ * AIScript of that file builds its orders from the shared parsed copy.
  */
 struct AIScriptXML;
+struct AIScriptEvent;
 class AIScript : public Order {
 ///File name the AI script takes, to be loaded upon first execute (needs ref to parent)
     char *filename;
 ///Temporary data to hold while AI script loads
     AIScriptXML *xml;
-///Loads the XML file, filename when Execute() is called
+///Builds the orders of the script file, filename when Execute() is called
     void LoadXML(); //load the xml
-///Internal functions to expat
-    static void beginElement(void *userData, const XML_Char *name, const XML_Char **atts);
-///internal functions for use of expat
-    static void endElement(void *userData, const XML_Char *name);
 ///The top float on the current stack
     float &topf();
 ///Rid of the top float on the current stack
@@ -56,10 +53,10 @@ class AIScript : public Order {
     QVector &topv();
 ///Pop the top vector of teh current stack
     void popv();
-///member function begin elements... deals with pushing vectors on stack
-    void beginElement(const string &name, const XMLSupport::AttributeList &attributes);
-///member function end elements...deals with calling AI scripts from the stack
-    void endElement(const string &name);
+///begin elements of the parsed file... deals with pushing vectors on stack
+    void beginElement(const AIScriptEvent &event);
+///end elements of the parsed file...deals with calling AI scripts from the stack
+    void endElement(const AIScriptEvent &event);
 public:
 ///saves scriptname in the filename var
     AIScript(const char *scriptname);
@@ -0,0 +1,90 @@
+/*
+ * search_queue.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "cmd/ai/search_queue.h"
+
+#include <algorithm>
+
+SearchQueue::~SearchQueue() {
+    for (QueuedSearch *search : queue) {
+        search->queued_in = nullptr;
+    }
+}
+
+void SearchQueue::Submit(QueuedSearch *search) {
+    if (search->queued_in) {
+        return;
+    }
+    search->queued_in = this;
+    queue.push_back(search);
+}
+
+void SearchQueue::Cancel(QueuedSearch *search) {
+    SearchQueue *owner = search->queued_in;
+    if (!owner) {
+        return;
+    }
+    search->queued_in = nullptr;
+    owner->queue.erase(std::remove(owner->queue.begin(), owner->queue.end(), search), owner->queue.end());
+}
+
+template<typename Done>
+SearchQueue::RunStats SearchQueue::RunUntil(Done done) {
+    RunStats stats;
+    while (!queue.empty()) {
+        if (stats.searched > 0 && done(stats)) {
+            break;
+        }
+        QueuedSearch *search = queue.front();
+        queue.pop_front();
+        search->queued_in = nullptr;
+        SearchQueue *home = search->HomeQueue();
+        if (home != this) {
+            //the ship has jumped since; its new system runs the search when it is updated
+            if (home) {
+                home->Submit(search);
+                ++stats.handed_over;
+            }
+            continue;
+        }
+        search->SearchForTargets();
+        ++stats.searched;
+    }
+    stats.deferred = queue.size();
+    return stats;
+}
+
+SearchQueue::RunStats SearchQueue::Run(double budget, double (*clock)()) {
+    double start = clock();
+    return RunUntil([budget, clock, start](const RunStats &) {
+        return clock() - start >= budget;
+    });
+}
+
+SearchQueue::RunStats SearchQueue::Run(unsigned int searches) {
+    return RunUntil([searches](const RunStats &stats) {
+        return stats.searched >= searches;
+    });
+}
@@ -0,0 +1,109 @@
+/*
+ * search_queue.h
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SEARCH_QUEUE_H
+#define SEARCH_QUEUE_H
+
+#include <cstddef>
+#include <deque>
+
+class SearchQueue;
+
+/* A search that waits its turn in the SearchQueue of the star system it looks in */
+class QueuedSearch {
+public:
+    /* The queue of the system the search has to look in now, or null if it has nowhere to look */
+    virtual SearchQueue *HomeQueue() = 0;
+    virtual void SearchForTargets() = 0;
+
+protected:
+    QueuedSearch() : queued_in(nullptr) {
+    }
+
+    QueuedSearch(const QueuedSearch &) : queued_in(nullptr) {
+    }
+
+    QueuedSearch &operator=(const QueuedSearch &) {
+        return *this;
+    }
+
+    // whoever goes away while queued must SearchQueue::Cancel first
+    ~QueuedSearch() {
+    }
+
+private:
+    friend class SearchQueue;
+    SearchQueue *queued_in;
+};
+
+/*
+ * The searches of one star system, run oldest first a frame's budget at a
+ * time. A search may be queued in one queue only; one whose ship has left
+ * the system by the time its turn comes is handed to the queue of the
+ * system the ship is in now, so it never looks in a system that isn't
+ * being updated.
+ */
+class SearchQueue {
+public:
+    struct RunStats {
+        unsigned int searched = 0;      // searches run
+        unsigned int handed_over = 0;   // searches passed on to the queue of another system
+        unsigned int deferred = 0;      // searches left for the next frame
+    };
+
+    SearchQueue() = default;
+    // forgets the searches still queued
+    ~SearchQueue();
+
+    /* Queues the search, unless it is queued already, here or elsewhere */
+    void Submit(QueuedSearch *search);
+    /* Drops the search from whichever queue it is in, if any */
+    static void Cancel(QueuedSearch *search);
+
+    static bool IsQueued(const QueuedSearch *search) {
+        return search->queued_in != nullptr;
+    }
+
+    /* Runs queued searches until budget seconds by clock have gone by; at least one runs */
+    RunStats Run(double budget, double (*clock)());
+    /* Runs at most searches queued searches, at least one, whatever the time they take */
+    RunStats Run(unsigned int searches);
+
+    size_t size() const {
+        return queue.size();
+    }
+
+private:
+    SearchQueue(const SearchQueue &) = delete;
+    SearchQueue &operator=(const SearchQueue &) = delete;
+
+    /* Runs queued searches until done(stats) says the budget is used up */
+    template<typename Done>
+    RunStats RunUntil(Done done);
+
+    std::deque<QueuedSearch *> queue;
+};
+
+#endif // SEARCH_QUEUE_H
@@ -0,0 +1,116 @@
+/*
+ * targeting_service.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "cmd/ai/targeting_service.h"
+
+#include <algorithm>
+
+#include "cmd/ai/fire.h"
+#include "cmd/unit_generic.h"
+#include "cmd/unit_find.h"
+#include "configuration/configuration.h"
+#include "lin_time.h"
+#include "star_system.h"
+
+namespace {
+
+class CollectUnits {
+public:
+    std::vector<Unit *> *units = nullptr;
+
+    bool acquire(Unit *un, float distance) {
+        units->push_back(un);
+        return true;
+    }
+};
+
+}
+
+SearchQueue *TargetingService::QueueOf(Unit *unit) {
+    if (unit == nullptr || unit->Killed()) {
+        return nullptr;
+    }
+    StarSystem *system = unit->getStarSystem();
+    return system ? &system->getTargetingService().GetQueue() : nullptr;
+}
+
+void TargetingService::Submit(Orders::FireAt *ai) {
+    if (SearchQueue::IsQueued(ai)) {
+        return;
+    }
+    queue.Submit(ai);
+    ++this_frame.submitted;
+}
+
+static unsigned int fixed_budget = 0;
+
+void TargetingService::SetFixedBudget(unsigned int searches) {
+    fixed_budget = searches;
+}
+
+void TargetingService::RunFrame() {
+    double budget = configuration()->ai.targeting_config.search_budget_microseconds * 1.0e-6;
+    double start = queryTime();
+    SearchQueue::RunStats run = fixed_budget > 0 ? queue.Run(fixed_budget) : queue.Run(budget, queryTime);
+    candidate_lists.clear();
+    this_frame.searched = run.searched;
+    this_frame.handed_over = run.handed_over;
+    this_frame.deferred = run.deferred;
+    this_frame.seconds = queryTime() - start;
+    last_frame = this_frame;
+    this_frame = FrameStats();
+}
+
+const std::vector<Unit *> &TargetingService::CandidatesNear(Unit *searcher, float radius, float max_unit_radius) {
+    static const std::vector<Unit *> none;
+    if (is_null(searcher->location[Unit::UNIT_ONLY])) {
+        return none;
+    }
+    const Flightgroup *flightgroup = searcher->getFlightgroup();
+    float shared_radius = configuration()->ai.targeting_config.shared_search_radius;
+    QVector position = searcher->Position();
+    for (CandidateList &list : candidate_lists) {
+        if (list.flightgroup == flightgroup && list.faction == searcher->faction && list.radius >= radius
+                && (list.position - position).Magnitude() <= shared_radius) {
+            ++this_frame.shared;
+            return list.units;
+        }
+    }
+    candidate_lists.push_back(CandidateList());
+    CandidateList &list = candidate_lists.back();
+    list.flightgroup = flightgroup;
+    list.faction = searcher->faction;
+    list.position = position;
+    list.radius = radius;
+    list.units.push_back(searcher);
+    //anyone sharing the list is within shared_radius of here, so look that much further
+    UnitWithinRangeLocator<CollectUnits> locator(radius + shared_radius, max_unit_radius);
+    locator.action.units = &list.units;
+    //location is an iterator into the collide map of the searcher's own system, whichever is being updated
+    findObjects(searcher->getStarSystem()->collide_map[Unit::UNIT_ONLY],
+            searcher->location[Unit::UNIT_ONLY],
+            &locator);
+    return list.units;
+}
@@ -0,0 +1,127 @@
+/*
+ * targeting_service.h
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TARGETING_SERVICE_H
+#define TARGETING_SERVICE_H
+
+#include <deque>
+#include <vector>
+
+#include "cmd/ai/search_queue.h"
+#include "gfx/vec.h"
+
+class Flightgroup;
+class Unit;
+
+namespace Orders {
+class FireAt;
+}
+
+/*
+ * Runs the target searches of the AIs of one star system, a frame's budget
+ * at a time.
+ *
+ * FireAt::ChooseTargets only queues a request with the system its ship is
+ * in; the system's RunFrame then works through the queue, oldest first,
+ * until AI.Targetting.SearchBudgetMicroseconds is used up, or a fixed
+ * number of searches have run (see SetFixedBudget), and leaves the rest
+ * for the next physics frame. Each search that is run sets the ship's
+ * target and calls its SignalChosenTarget; one whose ship has jumped since
+ * is passed on to the system the ship is in now.
+ *
+ * Sweeping the collide map is the expensive part of a search, so the units
+ * found are kept for the rest of the frame and handed to any other ship of
+ * the same flightgroup and faction that searches from within
+ * AI.Targetting.SharedSearchRadius of the first one.
+ */
+class TargetingService {
+public:
+    struct FrameStats {
+        unsigned int submitted = 0;     // requests queued since the previous frame
+        unsigned int searched = 0;      // requests run this frame
+        unsigned int shared = 0;        // of which used a list of units found by another ship
+        unsigned int handed_over = 0;   // requests passed on to the system their ship jumped to
+        unsigned int deferred = 0;      // requests left for the next frame
+        double seconds = 0.0;           // time spent on the searches
+    };
+
+    TargetingService() = default;
+
+    /* The queue of the system the unit is in, or null if it is in none */
+    static SearchQueue *QueueOf(Unit *unit);
+
+    /* Queues a search for the AI, unless one is queued already, here or in another system */
+    void Submit(Orders::FireAt *ai);
+
+    /* Runs queued searches until this frame's budget is used up; at least one runs. Once per system frame */
+    void RunFrame();
+
+    /*
+     * Gives every system a budget of this many searches a frame instead of
+     * AI.Targetting.SearchBudgetMicroseconds, so that which ships search when
+     * does not depend on how fast the machine is; 0 goes back to the time.
+     * For the simulation benchmark.
+     */
+    static void SetFixedBudget(unsigned int searches);
+
+    /*
+     * The units a search from the searcher should look at: everything the collide map of its system
+     * has within radius of it, plus ships up to max_unit_radius big just beyond, starting with the
+     * searcher itself and then outwards the way findObjects goes
+     */
+    const std::vector<Unit *> &CandidatesNear(Unit *searcher, float radius, float max_unit_radius);
+
+    const FrameStats &GetLastFrameStats() const {
+        return last_frame;
+    }
+
+    size_t GetQueueLength() const {
+        return queue.size();
+    }
+
+    SearchQueue &GetQueue() {
+        return queue;
+    }
+
+private:
+    TargetingService(const TargetingService &) = delete;
+    TargetingService &operator=(const TargetingService &) = delete;
+
+    struct CandidateList {
+        const Flightgroup *flightgroup;
+        int faction;
+        QVector position;
+        float radius;
+        std::vector<Unit *> units;
+    };
+
+    SearchQueue queue;
+    // only valid while RunFrame is running, since the units may die after it
+    std::deque<CandidateList> candidate_lists;
+    FrameStats this_frame;
+    FrameStats last_frame;
+};
+
+#endif // TARGETING_SERVICE_H
@@ -0,0 +1,158 @@
+/*
+ * search_queue_tests.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "cmd/ai/search_queue.h"
+
+// every reading of the clock is a millisecond later than the last
+static double now = 0.0;
+
+static double TickingClock() {
+    now += 0.001;
+    return now;
+}
+
+// a search that records the queue it ran from, and lives in whichever queue home points at
+class FakeSearch : public QueuedSearch {
+public:
+    explicit FakeSearch(SearchQueue *home) : home(home) {
+    }
+
+    ~FakeSearch() {
+        SearchQueue::Cancel(this);
+    }
+
+    SearchQueue *HomeQueue() override {
+        return home;
+    }
+
+    void SearchForTargets() override {
+        ran_in.push_back(home);
+    }
+
+    SearchQueue *home;
+    std::vector<SearchQueue *> ran_in;
+};
+
+TEST(SearchQueue, RunsOldestFirstWithinTheBudget) {
+    SearchQueue queue;
+    std::vector<FakeSearch> searches(5, FakeSearch(&queue));
+    for (FakeSearch &search : searches) {
+        queue.Submit(&search);
+        queue.Submit(&search);
+    }
+    EXPECT_EQ(5u, queue.size());
+
+    // the clock is read once before every search but the first, so 1.5 ms fits in two
+    SearchQueue::RunStats stats = queue.Run(0.0015, TickingClock);
+    EXPECT_EQ(2u, stats.searched);
+    EXPECT_EQ(3u, stats.deferred);
+    EXPECT_EQ(1u, searches[0].ran_in.size());
+    EXPECT_EQ(1u, searches[1].ran_in.size());
+    EXPECT_TRUE(searches[2].ran_in.empty());
+    EXPECT_FALSE(SearchQueue::IsQueued(&searches[0]));
+    EXPECT_TRUE(SearchQueue::IsQueued(&searches[2]));
+
+    // however small the budget, a search runs
+    stats = queue.Run(0.0, TickingClock);
+    EXPECT_EQ(1u, stats.searched);
+    EXPECT_EQ(1u, searches[2].ran_in.size());
+
+    SearchQueue::Cancel(&searches[3]);
+    stats = queue.Run(1.0, TickingClock);
+    EXPECT_EQ(1u, stats.searched);
+    EXPECT_TRUE(searches[3].ran_in.empty());
+    EXPECT_EQ(1u, searches[4].ran_in.size());
+    EXPECT_EQ(0u, queue.size());
+}
+
+TEST(SearchQueue, RunsAFixedNumberOfSearches) {
+    SearchQueue queue;
+    std::vector<FakeSearch> searches(5, FakeSearch(&queue));
+    for (FakeSearch &search : searches) {
+        queue.Submit(&search);
+    }
+
+    SearchQueue::RunStats stats = queue.Run(3u);
+    EXPECT_EQ(3u, stats.searched);
+    EXPECT_EQ(2u, stats.deferred);
+    EXPECT_EQ(1u, searches[2].ran_in.size());
+    EXPECT_TRUE(searches[3].ran_in.empty());
+
+    // at least one, as with the time budget
+    stats = queue.Run(0u);
+    EXPECT_EQ(1u, stats.searched);
+    stats = queue.Run(3u);
+    EXPECT_EQ(1u, stats.searched);
+    EXPECT_EQ(0u, stats.deferred);
+}
+
+TEST(SearchQueue, HandsSearchesOfShipsThatJumpedToTheirNewSystem) {
+    SearchQueue here;
+    SearchQueue there;
+    FakeSearch staying(&here);
+    FakeSearch jumping(&here);
+    FakeSearch lost(&here);
+    here.Submit(&jumping);
+    here.Submit(&staying);
+    here.Submit(&lost);
+
+    jumping.home = &there;
+    lost.home = nullptr;
+    SearchQueue::RunStats stats = here.Run(1.0, TickingClock);
+    EXPECT_EQ(1u, stats.searched);
+    EXPECT_EQ(1u, stats.handed_over);
+    EXPECT_TRUE(jumping.ran_in.empty());
+    EXPECT_TRUE(lost.ran_in.empty());
+    EXPECT_FALSE(SearchQueue::IsQueued(&lost));
+    ASSERT_EQ(1u, there.size());
+
+    // it only runs when its new system is updated, and it can be cancelled there
+    stats = there.Run(1.0, TickingClock);
+    EXPECT_EQ(1u, stats.searched);
+    ASSERT_EQ(1u, jumping.ran_in.size());
+    EXPECT_EQ(&there, jumping.ran_in[0]);
+
+    there.Submit(&jumping);
+    SearchQueue::Cancel(&jumping);
+    EXPECT_EQ(0u, there.size());
+}
+
+TEST(SearchQueue, ForgetsItsSearchesWhenGone) {
+    FakeSearch search(nullptr);
+    {
+        SearchQueue queue;
+        search.home = &queue;
+        queue.Submit(&search);
+        EXPECT_TRUE(SearchQueue::IsQueued(&search));
+    }
+    EXPECT_FALSE(SearchQueue::IsQueued(&search));
+    SearchQueue other;
+    other.Submit(&search);
+    EXPECT_EQ(1u, other.size());
+}
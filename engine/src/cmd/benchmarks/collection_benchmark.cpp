@@ -0,0 +1,136 @@
+/*
+ * collection_benchmark.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Times the UnitCollection operations a star system leans on every frame,
+ * against the mock units of testcollection/unit.h. It is built once per
+ * collection implementation (see BUILD_BENCHMARKS in CMakeLists.txt), so
+ * running both binaries with the same arguments compares them:
+ *
+ *   iterate   walk the whole collection, the way UpdateUnitPhysics does
+ *   requeue   move a tenth of the units to the front of another queue,
+ *             the way RequestPhysics reschedules them
+ *   churn     kill a hundredth of the units and append as many new ones,
+ *             then walk once so the killed ones are dropped
+ *
+ * usage: vegastrike-collection-benchmark-<kind> [units [frames]]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "testcollection/unit.h"
+#include "collection.h"
+
+#if defined (USE_CONTIGUOUS_COLLECTION)
+static const char *const collection_kind = "contiguous";
+#else
+static const char *const collection_kind = "list";
+#endif
+
+struct PhaseTime {
+    const char *name;
+    double seconds;
+};
+
+static double Since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv) {
+    size_t count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 5000;
+    int frames = argc > 2 ? atoi(argv[2]) : 200;
+    if (count == 0 || frames <= 0) {
+        fprintf(stderr, "usage: %s [units [frames]]\n", argv[0]);
+        return 1;
+    }
+
+    std::mt19937 random(31337);
+    std::vector<Unit *> units;
+    units.reserve(count * 2);
+    // same layout as the physics queues in StarSystem: a handful of tracked buckets
+    UnitCollection queues[7];
+    for (size_t q = 0; q < 7; ++q) {
+        queues[q].trackUnits();
+    }
+    for (size_t i = 0; i < count; ++i) {
+        units.push_back(new Unit(false));
+        queues[i % 7].append(units.back());
+    }
+
+    PhaseTime phases[] = {{"iterate", 0.0}, {"requeue", 0.0}, {"churn", 0.0}};
+    size_t visited = 0;
+    for (int frame = 0; frame < frames; ++frame) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t q = 0; q < 7; ++q) {
+            for (un_iter iter = queues[q].createIterator(); !iter.isDone(); ++iter) {
+                visited += (*iter)->ucref;
+            }
+        }
+        phases[0].seconds += Since(start);
+
+        start = std::chrono::steady_clock::now();
+        UnitCollection &target = queues[frame % 7];
+        for (size_t n = 0; n < count / 10; ++n) {
+            Unit *unit = units[random() % units.size()];
+            UnitCollection *queue = unit->physics_queue_slot.col;
+            if (queue && !unit->Killed()) {
+                queue->moveToFront(unit, target);
+            }
+        }
+        phases[1].seconds += Since(start);
+
+        start = std::chrono::steady_clock::now();
+        for (size_t n = 0; n < count / 100; ++n) {
+            Unit *unit = units[random() % units.size()];
+            if (unit->physics_queue_slot.col && !unit->Killed()) {
+                unit->Kill();
+                Unit *replacement = new Unit(false);
+                units.push_back(replacement);
+                queues[random() % 7].append(replacement);
+            }
+        }
+        for (size_t q = 0; q < 7; ++q) {
+            for (un_iter iter = queues[q].createIterator(); !iter.isDone(); ++iter) {
+            }
+        }
+        phases[2].seconds += Since(start);
+    }
+
+    printf("%-10s %-8s %12s\n", "collection", "phase", "ms/frame");
+    for (size_t i = 0; i < sizeof(phases) / sizeof(*phases); ++i) {
+        printf("%-10s %-8s %12.4f\n", collection_kind, phases[i].name, phases[i].seconds * 1000.0 / frames);
+    }
+    for (size_t q = 0; q < 7; ++q) {
+        queues[q].clear();
+    }
+    for (size_t i = 0; i < units.size(); ++i) {
+        delete units[i];
+    }
+    return visited == 0 ? 2 : 0;
+}
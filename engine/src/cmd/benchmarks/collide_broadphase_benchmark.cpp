@@ -0,0 +1,183 @@
+/*
+ * collide_broadphase_benchmark.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Compares the x-sorted sweep used by CollideMap with the CollideGrid
+ * broadphase on a few unit layouts. For every collidable it runs the same
+ * query CollideChecker does for a unit (x window of 2.0625 radii, sphere
+ * overlap as the narrow test) and reports how many candidates each
+ * broadphase had to examine, how many overlapping pairs it found and how
+ * long it took.
+ *
+ * usage: vegastrike-collide-benchmark [units [repeats [cell size]]]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "collide_map.h"
+#include "collide_grid.h"
+
+struct BroadphaseResult {
+    size_t candidates;
+    size_t pairs;
+    double seconds;
+};
+
+static bool Overlap(const Collidable &a, const Collidable &b) {
+    double dx = a.position.i - b.position.i;
+    double dy = a.position.j - b.position.j;
+    double dz = a.position.k - b.position.k;
+    double reach = a.radius + b.radius;
+    return dx * dx + dy * dy + dz * dz < reach * reach;
+}
+
+static BroadphaseResult RunSweep(const std::vector<Collidable> &sorted, int repeats) {
+    BroadphaseResult result = {0, 0, 0.0};
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        result.candidates = result.pairs = 0;
+        for (size_t i = 0; i < sorted.size(); ++i) {
+            const Collidable &a = sorted[i];
+            double minlook = a.getKey() - 2.0625 * a.radius;
+            double maxlook = a.getKey() + 2.0625 * a.radius;
+            for (size_t j = i; j-- > 0 && sorted[j].getKey() >= minlook;) {
+                ++result.candidates;
+                result.pairs += Overlap(a, sorted[j]);
+            }
+            for (size_t j = i + 1; j < sorted.size() && sorted[j].getKey() <= maxlook; ++j) {
+                ++result.candidates;
+                result.pairs += Overlap(a, sorted[j]);
+            }
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repeats;
+    return result;
+}
+
+static BroadphaseResult RunGrid(const std::vector<Collidable> &sorted, int repeats, double cell_size) {
+    BroadphaseResult result = {0, 0, 0.0};
+    CollideGrid grid;
+    grid.SetCellSize(cell_size);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        // the engine rebuilds the grid on every flatten, so the build is part of the cost
+        grid.Build(&sorted[0], sorted.size());
+        result.candidates = result.pairs = 0;
+        for (size_t i = 0; i < sorted.size(); ++i) {
+            const Collidable &a = sorted[i];
+            double minlook = a.getKey() - 2.0625 * a.radius;
+            double maxlook = a.getKey() + 2.0625 * a.radius;
+            auto visit = [&](uint32_t index) -> bool {
+                const Collidable &b = sorted[index];
+                if (index != i && b.getKey() >= minlook && b.getKey() <= maxlook) {
+                    ++result.candidates;
+                    result.pairs += Overlap(a, b);
+                }
+                return false;
+            };
+            grid.Query(a.position, 2.0625 * a.radius, a.radius + grid.GetCellSize(), visit);
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repeats;
+    return result;
+}
+
+struct Sphere {
+    double x, y, z;
+    float radius;
+
+    bool operator<(const Sphere &other) const {
+        return x < other.x;
+    }
+};
+
+// fills elements in x order, the way CollideArray::flatten leaves its sorted array
+static void MakeLayout(const std::string &layout, std::vector<Collidable> &elements) {
+    std::mt19937 random(31337);
+    std::uniform_real_distribution<double> radius(5.0, 200.0);
+    std::uniform_real_distribution<double> spread(-200000.0, 200000.0);
+    std::uniform_real_distribution<double> jitter(-50.0, 50.0);
+    std::vector<Sphere> spheres(elements.size());
+    for (size_t i = 0; i < spheres.size(); ++i) {
+        Sphere &sphere = spheres[i];
+        if (layout == "random") {
+            sphere.x = spread(random);
+            sphere.y = spread(random);
+            sphere.z = spread(random);
+        } else if (layout == "y-axis") {
+            // a fleet in line astern along y
+            sphere.x = jitter(random);
+            sphere.y = i * 300.0;
+            sphere.z = jitter(random);
+        } else {
+            // parked around a station, everyone at similar x
+            sphere.x = jitter(random);
+            sphere.y = spread(random) * 0.1;
+            sphere.z = spread(random) * 0.1;
+        }
+        sphere.radius = static_cast<float>(radius(random));
+    }
+    std::sort(spheres.begin(), spheres.end());
+    for (size_t i = 0; i < spheres.size(); ++i) {
+        elements[i].position.i = spheres[i].x;
+        elements[i].position.j = spheres[i].y;
+        elements[i].position.k = spheres[i].z;
+        elements[i].radius = spheres[i].radius;
+        elements[i].ref.unit = nullptr;
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 2000;
+    int repeats = argc > 2 ? atoi(argv[2]) : 10;
+    double cell_size = argc > 3 ? atof(argv[3]) : 1000.0;
+    if (count == 0 || repeats <= 0) {
+        fprintf(stderr, "usage: %s [units [repeats [cell size]]]\n", argv[0]);
+        return 1;
+    }
+
+    const char *layouts[] = {"random", "y-axis", "station"};
+    printf("%-8s %-6s %12s %10s %12s\n", "layout", "phase", "candidates", "pairs", "ms/frame");
+    for (size_t l = 0; l < sizeof(layouts) / sizeof(*layouts); ++l) {
+        std::vector<Collidable> elements(count);
+        MakeLayout(layouts[l], elements);
+        BroadphaseResult sweep = RunSweep(elements, repeats);
+        BroadphaseResult grid = RunGrid(elements, repeats, cell_size);
+        printf("%-8s %-6s %12zu %10zu %12.3f\n", layouts[l], "sweep", sweep.candidates, sweep.pairs,
+                sweep.seconds * 1000.0);
+        printf("%-8s %-6s %12zu %10zu %12.3f\n", layouts[l], "grid", grid.candidates, grid.pairs,
+                grid.seconds * 1000.0);
+        if (sweep.pairs != grid.pairs) {
+            fprintf(stderr, "%s: broadphases disagree on the number of overlapping pairs\n", layouts[l]);
+            return 2;
+        }
+    }
+    return 0;
+}
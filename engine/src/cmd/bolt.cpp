@@ -26,6 +26,7 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <functional>
 
 #include "bolt.h"
 
@@ -57,10 +58,10 @@ inline void BlendTrans(Matrix &drawmat, const QVector &cur_position, const QVect
 int Bolt::AddTexture(BoltDrawManager *q, std::string file) {
     int decal = q->boltdecals.AddTexture(file.c_str(), MIPMAP);
     if (decal >= (int) q->bolts.size()) {
-        q->bolts.push_back(vector<Bolt>());
+        q->bolts.push_back(BoltPool());
         int blargh = q->boltdecals.AddTexture(file.c_str(), MIPMAP);
         if (blargh >= (int) q->bolts.size()) {
-            q->bolts.push_back(vector<Bolt>());
+            q->bolts.push_back(BoltPool());
         }
     }
 
@@ -85,7 +86,7 @@ int Bolt::AddAnimation(BoltDrawManager *q, std::string file, QVector cur_positio
                         MIPMAP,
                         false));         //balls have their own orientation
         q->animations.back()->SetPosition(cur_position);
-        q->balls.push_back(vector<Bolt>());
+        q->balls.push_back(BoltPool());
     }
     return decal;
 }
@@ -121,11 +122,11 @@ void Bolt::DrawAllBolts() {
             continue;
         }
 
-        Bolt bolt = bolt_types[0];
+        const std::string &bolt_name = bolt_types.bolts[0].type->file;
 
-        vega_types::SharedPtr<Texture> texture = TextureManager::GetInstance().GetTexture(bolt.bolt_name, MIPMAP);
+        vega_types::SharedPtr<Texture> texture = TextureManager::GetInstance().GetTexture(bolt_name, MIPMAP);
         if (!texture) {
-            VS_LOG(error, (boost::format("No texture found for bolt named %1$s") % bolt.bolt_name));
+            VS_LOG(error, (boost::format("No texture found for bolt named %1$s") % bolt_name));
             continue;
         }
 
@@ -134,8 +135,8 @@ void Bolt::DrawAllBolts() {
             if (texture->SetupPass(0, bsrc, bdst)) {
                 texture->MakeActive();
                 GFXToggleTexture(true, 0);
-                for (auto &&bolt : bolt_types) {
-                    bolt.DrawBolt(qmesh);
+                for (size_t i = 0; i < bolt_types.size(); ++i) {
+                    bolt_types.bolts[i].DrawBolt(qmesh, bolt_types.Position(i), bolt_types.PreviousPosition(i));
                 }
             }
         }
@@ -156,19 +157,19 @@ void Bolt::DrawAllBalls() {
 
         Animation *cur = (*k).get();
 
-        float bolt_size = 2 * ball_types[0].type->radius * 2;
+        float bolt_size = 2 * ball_types.bolts[0].type->radius * 2;
         bolt_size *= bolt_size;
         //Matrix result;
         //FIXME::MuST USE DRAWNO	TRANSFORMNOW cur->CalculateOrientation (result);
 
         // Iterate over specific balls
-        for (auto &&bolt : ball_types) { // really ball
-            bolt.DrawBall(bolt_size, cur);
+        for (size_t i = 0; i < ball_types.size(); ++i) { // really ball
+            ball_types.bolts[i].DrawBall(bolt_size, cur, ball_types.Position(i), ball_types.PreviousPosition(i));
         }
     }
 }
 
-void Bolt::DrawBolt(GFXVertexList *qmesh) {
+void Bolt::DrawBolt(GFXVertexList *qmesh, const QVector &cur_position, const QVector &prev_position) {
     float distance = (cur_position - BoltDrawManager::camera_position).MagnitudeSquared();
 
     if (distance * BoltDrawManager::pixel_angle >= bolt_size) {
@@ -190,7 +191,7 @@ void Bolt::DrawBolt(GFXVertexList *qmesh) {
     qmesh->Draw();
 }
 
-void Bolt::DrawBall(float &bolt_size, Animation *cur) {
+void Bolt::DrawBall(float &bolt_size, Animation *cur, const QVector &cur_position, const QVector &prev_position) {
     // TODO: move up to DrawBalls
     Vector p, q, r;
     _Universe->AccessCamera()->GetOrientation(p, q, r);
@@ -208,38 +209,54 @@ void Bolt::DrawBall(float &bolt_size, Animation *cur) {
     }
 }
 
-void Bolt::Destroy(unsigned int index) {
-    bool isBall = true;
+BoltPool &Bolt::Pool() const {
+    BoltDrawManager &q = BoltDrawManager::GetInstance();
     if (type->type == WEAPON_TYPE::BOLT) {
-        isBall = false;
+        return q.bolts[decal];
     } else {
+        return q.balls[decal];
     }
-    //BoltDestroyGeneric( this, index, decal, isBall );
+}
 
-    BoltDrawManager &q = BoltDrawManager::GetInstance();
-    vector<vector<Bolt> > *target;
-    if (!isBall) {
-        target = &q.bolts;
+void Bolt::Destroy(unsigned int index) {
+    BoltPool &pool = Pool();
+    if (index < pool.size() && &pool.bolts[index] == this) {
+        pool.Remove(index);
     } else {
-        target = &q.balls;
+        VS_LOG_AND_FLUSH(fatal, "Bolt Fault Nouveau! Not found in draw queue! No Chance to recover");
+        assert(0);
     }
+}
 
-    vector<Bolt> *vec = &(*target)[decal];
-    if (&(*vec)[index] == this) {
-        unsigned int tsize = vec->size();
-        CollideMap *cm = _Universe->activeStarSystem()->collide_map[Unit::UNIT_BOLT];
-        cm->UpdateBoltInfo(vec->back().location, (*(*vec)[index].location)->ref);
+void BoltPool::Add(const Bolt &bolt,
+        StarSystem *system,
+        const QVector &position,
+        const Vector &velocity,
+        float speed,
+        float range) {
+    bolts.push_back(bolt);
+    systems.push_back(system);
+    kinematics.Add(position.i, position.j, position.k, velocity.i, velocity.j, velocity.k, speed, range);
+}
 
-        assert(index < tsize);
-        cm->erase((*vec)[index].location);
-        if (index + 1 != vec->size()) {
-            (*vec)[index] = vec->back();                //just a memcopy, yo
-        }
+void BoltPool::Remove(size_t index) {
+    assert(index < bolts.size());
+    const size_t last = bolts.size() - 1;
+    //the last bolt takes over this one's index, and so its collide ref
+    systems[last]->collide_map[Unit::UNIT_BOLT]->UpdateBoltInfo(bolts[last].location, (*bolts[index].location)->ref);
+    systems[index]->collide_map[Unit::UNIT_BOLT]->erase(bolts[index].location);
+    if (index != last) {
+        bolts[index] = bolts[last];
+        systems[index] = systems[last];
+    }
+    bolts.pop_back();
+    systems.pop_back();
+    kinematics.Remove(index);
+}
 
-        vec->pop_back();         //pop that back up
-    } else {
-        VS_LOG_AND_FLUSH(fatal, "Bolt Fault Nouveau! Not found in draw queue! No Chance to recover");
-        assert(0);
+void BoltPool::Clear() {
+    for (size_t i = bolts.size(); i-- > 0;) {
+        Remove(i);
     }
 }
 
@@ -248,16 +265,13 @@ Bolt::Bolt(const WeaponInfo *typ,
         const Matrix &orientationpos,
         const Vector &shipspeed,
         void *owner,
-        CollideMap::iterator hint) : cur_position(orientationpos.p), ShipSpeed(shipspeed) {
+        CollideMap::iterator hint) {
     VSCONSTRUCT2('t')
     BoltDrawManager &q = BoltDrawManager::GetInstance();
-    prev_position = cur_position;
+    const QVector &cur_position = orientationpos.p;
     this->owner = owner;
     this->type = typ;
-    bolt_name = typ->file;
-    curdist = 0;
     bolt_size = std::pow(2 * type->radius + type->length, 2);
-    ball_size = std::pow(4 * type->radius, 2);
 
     CopyMatrix(drawmat, orientationpos);
     Vector vel = shipspeed + orientationpos.getR() * typ->speed;
@@ -280,10 +294,7 @@ Bolt::Bolt(const WeaponInfo *typ,
                         cur_position + vel * simulation_atom_var * .5),
                 hint);
 
-        q.bolts[decal].push_back(*this);
-
-        BoltDrawManager &bolt_draw_manager = BoltDrawManager::GetInstance();
-        bolt_texture = bolt_draw_manager.boltdecals.GetTexture(decal);
+        q.bolts[decal].Add(*this, current_star_system, cur_position, vel, typ->speed, typ->range);
     } else {
         ScaleMatrix(drawmat, Vector(typ->radius, typ->radius, typ->radius));
         decal = Bolt::AddAnimation(&q, typ->file, cur_position);
@@ -296,7 +307,7 @@ Bolt::Bolt(const WeaponInfo *typ,
                         * typ->speed).Magnitude() * .5,
                 cur_position + vel * simulation_atom_var * .5);
         this->location = bolt_collide_map->insert(collidable, hint);
-        q.balls[decal].push_back(*this);
+        q.balls[decal].Add(*this, current_star_system, cur_position, vel, typ->speed, typ->range);
     }
 }
 
@@ -304,41 +315,55 @@ size_t nondecal_index(Collidable::CollideRef b) {
     return b.bolt_index >> 8;
 }
 
-bool Bolt::Update(Collidable::CollideRef index) {
-    const WeaponInfo *type = this->type;
-    float speed = type->speed;
-    curdist += speed * simulation_atom_var;
-    prev_position = cur_position;
-    cur_position +=
-            ((ShipSpeed + drawmat.getR() * speed
-                    / ((type->type
-                            == WEAPON_TYPE::BALL) * type->radius
-                            + (type->type != WEAPON_TYPE::BALL) * type->length)).Cast() * simulation_atom_var);
-    if (curdist > type->range) {
-        this->Destroy(nondecal_index(index));         //risky
-        return false;
+void BoltPool::UpdatePhysics(StarSystem *ss, CollideMap *collide_map, float elapsed) {
+    //bolts of other star systems are moved when those get updated, with their own atom; in practice
+    //all the bolts in the pool are in one system, so this finds a single run covering the whole pool
+    auto for_each_run = [this, ss](const std::function<void(size_t, size_t)> &run) {
+        const size_t count = size();
+        for (size_t begin = 0; begin < count;) {
+            if (systems[begin] != ss) {
+                ++begin;
+                continue;
+            }
+            size_t end = begin + 1;
+            while (end < count && systems[end] == ss) {
+                ++end;
+            }
+            run(begin, end);
+            begin = end;
+        }
+    };
+    for_each_run([this, elapsed](size_t begin, size_t end) {
+        kinematics.Advance(begin, end, elapsed);
+    });
+    //from the back, so that the bolt moved into a hole has already been looked at
+    for (size_t i = size(); i-- > 0;) {
+        if (systems[i] == ss && kinematics.Expired(i)) {
+            Remove(i);
+        }
     }
-    Collidable updated(**location);
-    updated.SetPosition(.5 * (prev_position + cur_position));
-    location = _Universe->activeStarSystem()->collide_map[Unit::UNIT_BOLT]->changeKey(location, updated);
-    return true;
+    for_each_run([this, collide_map](size_t begin, size_t end) {
+        const Bolt *run_bolts = &bolts[begin];
+        collide_map->changePositions(end - begin,
+                [run_bolts](size_t n) {
+                    return run_bolts[n].location;
+                },
+                &kinematics.middle_x[begin],
+                &kinematics.middle_y[begin],
+                &kinematics.middle_z[begin]);
+    });
 }
 
-class UpdateBolt {
+class CollideBolt {
     CollideMap *collide_map;
-    StarSystem *starSystem;
 public:
-    UpdateBolt(StarSystem *ss, CollideMap *collide_map) {
-        this->starSystem = ss;
+    CollideBolt(CollideMap *collide_map) {
         this->collide_map = collide_map;
     }
 
     void operator()(Collidable &collidable) {
         if (collidable.radius < 0) {
-            Bolt *thus = Bolt::BoltFromIndex(collidable.ref);
-            if (!collide_map->CheckCollisions(thus, collidable)) {
-                thus->Update(collidable.ref);
-            }
+            collide_map->CheckCollisions(Bolt::BoltFromIndex(collidable.ref), collidable);
         }
     }
 };
@@ -358,10 +383,10 @@ void for_each(IT start, IT end, F f) {
 //
 }
 
-class UpdateBolts {
-    UpdateBolt sub;
+class CollideBolts {
+    CollideBolt sub;
 public:
-    UpdateBolts(StarSystem *ss, CollideMap *collide_map) : sub(ss, collide_map) {
+    CollideBolts(CollideMap *collide_map) : sub(collide_map) {
     }
 
     template<class T>
@@ -372,14 +397,41 @@ public:
 
 void Bolt::UpdatePhysics(StarSystem *ss) {
     CollideMap *cm = ss->collide_map[Unit::UNIT_BOLT];
-    vsalg::for_each(cm->sorted.begin(), cm->sorted.end(), UpdateBolt(ss, cm));
-    vsalg::for_each(cm->toflattenhints.begin(), cm->toflattenhints.end(), UpdateBolts(ss, cm));
+    //hits are found along the path of the last atom, so every bolt is checked before any of them moves;
+    //the ones that hit something are destroyed on the spot
+    vsalg::for_each(cm->sorted.begin(), cm->sorted.end(), CollideBolt(cm));
+    vsalg::for_each(cm->toflattenhints.begin(), cm->toflattenhints.end(), CollideBolts(cm));
+
+    BoltDrawManager &q = BoltDrawManager::GetInstance();
+    for (auto &&pool : q.bolts) {
+        pool.UpdatePhysics(ss, cm, simulation_atom_var);
+    }
+    for (auto &&pool : q.balls) {
+        pool.UpdatePhysics(ss, cm, simulation_atom_var);
+    }
+}
+
+void Bolt::DestroyAll(StarSystem *ss) {
+    BoltDrawManager &q = BoltDrawManager::GetInstance();
+    for (auto &&pools : {&q.bolts, &q.balls}) {
+        for (auto &&pool : *pools) {
+            for (size_t i = pool.size(); i-- > 0;) {
+                if (pool.systems[i] == ss) {
+                    pool.Remove(i);
+                }
+            }
+        }
+    }
 }
 
 bool Bolt::Collide(Unit *target) {
     Vector normal;
     float distance;
     Unit *affectedSubUnit;
+    const BoltPool &pool = Pool();
+    const size_t index = nondecal_index((*location)->ref);
+    const QVector prev_position = pool.PreviousPosition(index);
+    const QVector cur_position = pool.Position(index);
     if ((affectedSubUnit = target->rayCollide(prev_position, cur_position, normal, distance))) {
         //ignore return
         if (target == owner) {
@@ -400,7 +452,7 @@ bool Bolt::Collide(Unit *target) {
         }
         QVector tmp = (cur_position - prev_position).Normalize();
         tmp = tmp.Scale(distance);
-        distance = curdist / this->type->range;
+        distance = pool.kinematics.distance[index] / this->type->range;
         GFXColor coltmp(this->type->r, this->type->g, this->type->b, this->type->a);
         Damage damage(this->type->damage * ((1 - distance) + distance * this->type->long_range),
                 this->type->phase_damage * ((1 - distance) + distance * this->type->long_range));
@@ -420,9 +472,9 @@ Bolt *Bolt::BoltFromIndex(Collidable::CollideRef b) {
     BoltDrawManager &bolt_draw_manager = BoltDrawManager::GetInstance();
     size_t ind = nondecal_index(b);
     if (b.bolt_index & 128) {
-        return &bolt_draw_manager.balls[b.bolt_index & 0x7f][ind];
+        return &bolt_draw_manager.balls[b.bolt_index & 0x7f].bolts[ind];
     } else {
-        return &bolt_draw_manager.bolts[b.bolt_index & 0x7f][ind];
+        return &bolt_draw_manager.bolts[b.bolt_index & 0x7f].bolts[ind];
     }
 }
 
@@ -32,31 +32,26 @@
 #include "gfx/quaternion.h"
 #include "collide_map.h"
 #include "gfx/animation.h"
+#include "bolt_kinematics.h"
+
+#include <vector>
 
 class Unit;
 class StarSystem;
 class BoltDrawManager;
 class Animation;
 class Texture;
+class BoltPool;
 
 class Bolt {
 private:
     const WeaponInfo *type;//beam or bolt;
     Matrix drawmat;
-    QVector cur_position;
-    Vector ShipSpeed;
-    QVector prev_position;//beams don't change heading.
     void *owner;
-    float curdist;
     int decal;//which image it uses
     float bolt_size; // actually squared
-    std::string bolt_name;
-
-    float ball_size;
-    std::string ball_name;
 
-    vega_types::SharedPtr<Texture> bolt_texture;
-    Animation animation;
+    BoltPool &Pool() const;
 
 public:
     CollideMap::iterator location;
@@ -67,14 +62,6 @@ public:
     static Bolt *BoltFromIndex(Collidable::CollideRef bolt_name);
     static Collidable::CollideRef BoltIndex(int index, int decal, bool isBall);
 
-    bool operator==(const Bolt &b) const {
-
-        return owner == b.owner
-                && curdist == b.curdist
-                && cur_position == b.cur_position
-                && prev_position == b.prev_position;
-    }
-
     Bolt(const WeaponInfo *type,
             const Matrix &orientationpos,
             const Vector &ShipSpeed,
@@ -84,13 +71,51 @@ public:
     //static void Draw();
     static void DrawAllBolts();
     static void DrawAllBalls();
-    void DrawBolt(GFXVertexList *qmesh);
-    void DrawBall(float &bolt_size, Animation *cur);
-    bool Update(Collidable::CollideRef index);
+    void DrawBolt(GFXVertexList *qmesh, const QVector &cur_position, const QVector &prev_position);
+    void DrawBall(float &bolt_size, Animation *cur, const QVector &cur_position, const QVector &prev_position);
     bool Collide(Collidable::CollideRef index);
     static void UpdatePhysics(StarSystem *ss);//updates all physics in the starsystem
+    static void DestroyAll(StarSystem *ss);//removes the bolts flying in a star system that goes away
     void noop() const {
     }
 };
 
+/*
+ * All the bolts, or all the balls, drawn with one decal. The Bolt objects
+ * keep what drawing and damage need; their motion lives in kinematics, whose
+ * row n belongs to bolts[n], so UpdatePhysics moves them all in one pass.
+ */
+class BoltPool {
+public:
+    std::vector<Bolt> bolts;
+    BoltKinematics kinematics;
+    // the star system whose collide map holds each bolt
+    std::vector<StarSystem *> systems;
+
+    size_t size() const {
+        return bolts.size();
+    }
+
+    void Add(const Bolt &bolt,
+            StarSystem *system,
+            const QVector &position,
+            const Vector &velocity,
+            float speed,
+            float range);
+    /* Takes the bolt out of its collide map, and moves the last one into its place */
+    void Remove(size_t index);
+    void Clear();
+
+    QVector Position(size_t index) const {
+        return QVector(kinematics.x[index], kinematics.y[index], kinematics.z[index]);
+    }
+
+    QVector PreviousPosition(size_t index) const {
+        return QVector(kinematics.previous_x[index], kinematics.previous_y[index], kinematics.previous_z[index]);
+    }
+
+    /* Advances the bolts of ss, removes the ones out of range and moves the rest in its collide map */
+    void UpdatePhysics(StarSystem *ss, CollideMap *collide_map, float elapsed);
+};
+
 #endif
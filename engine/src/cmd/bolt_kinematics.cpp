@@ -0,0 +1,125 @@
+/*
+ * bolt_kinematics.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "bolt_kinematics.h"
+
+void BoltKinematics::Add(double x,
+        double y,
+        double z,
+        float velocity_x,
+        float velocity_y,
+        float velocity_z,
+        float speed,
+        float range) {
+    this->x.push_back(x);
+    this->y.push_back(y);
+    this->z.push_back(z);
+    previous_x.push_back(x);
+    previous_y.push_back(y);
+    previous_z.push_back(z);
+    middle_x.push_back(x);
+    middle_y.push_back(y);
+    middle_z.push_back(z);
+    this->velocity_x.push_back(velocity_x);
+    this->velocity_y.push_back(velocity_y);
+    this->velocity_z.push_back(velocity_z);
+    distance.push_back(0.0f);
+    this->speed.push_back(speed);
+    this->range.push_back(range);
+}
+
+template<typename T>
+static void RemoveRow(std::vector<T> &column, size_t index) {
+    column[index] = column.back();
+    column.pop_back();
+}
+
+void BoltKinematics::Remove(size_t index) {
+    RemoveRow(x, index);
+    RemoveRow(y, index);
+    RemoveRow(z, index);
+    RemoveRow(previous_x, index);
+    RemoveRow(previous_y, index);
+    RemoveRow(previous_z, index);
+    RemoveRow(middle_x, index);
+    RemoveRow(middle_y, index);
+    RemoveRow(middle_z, index);
+    RemoveRow(velocity_x, index);
+    RemoveRow(velocity_y, index);
+    RemoveRow(velocity_z, index);
+    RemoveRow(distance, index);
+    RemoveRow(speed, index);
+    RemoveRow(range, index);
+}
+
+void BoltKinematics::Clear() {
+    x.clear();
+    y.clear();
+    z.clear();
+    previous_x.clear();
+    previous_y.clear();
+    previous_z.clear();
+    middle_x.clear();
+    middle_y.clear();
+    middle_z.clear();
+    velocity_x.clear();
+    velocity_y.clear();
+    velocity_z.clear();
+    distance.clear();
+    speed.clear();
+    range.clear();
+}
+
+// one axis at a time, so that every loop only streams through a few arrays
+static void AdvanceAxis(double *position,
+        double *previous,
+        double *middle,
+        const float *velocity,
+        size_t count,
+        float elapsed) {
+    for (size_t i = 0; i < count; ++i) {
+        const double start = position[i];
+        const double end = start + static_cast<double>(velocity[i]) * elapsed;
+        previous[i] = start;
+        position[i] = end;
+        middle[i] = .5 * (start + end);
+    }
+}
+
+void BoltKinematics::Advance(size_t begin, size_t end, float elapsed) {
+    if (begin >= end) {
+        return;
+    }
+    const size_t count = end - begin;
+    AdvanceAxis(&x[begin], &previous_x[begin], &middle_x[begin], &velocity_x[begin], count, elapsed);
+    AdvanceAxis(&y[begin], &previous_y[begin], &middle_y[begin], &velocity_y[begin], count, elapsed);
+    AdvanceAxis(&z[begin], &previous_z[begin], &middle_z[begin], &velocity_z[begin], count, elapsed);
+    float *travelled = &distance[begin];
+    const float *muzzle_speed = &speed[begin];
+    for (size_t i = 0; i < count; ++i) {
+        travelled[i] += muzzle_speed[i] * elapsed;
+    }
+}
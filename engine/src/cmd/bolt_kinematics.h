@@ -0,0 +1,77 @@
+/*
+ * bolt_kinematics.h
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef BOLT_KINEMATICS_H
+#define BOLT_KINEMATICS_H
+
+#include <cstddef>
+#include <vector>
+
+/*
+ * What Bolt::UpdatePhysics reads and writes for every bolt in every atom,
+ * stored column by column so that moving a run of bolts is a few straight
+ * loops over contiguous arrays, which the compiler vectorises. Row n belongs
+ * to the n-th bolt of a BoltPool; Remove moves the last row into the hole,
+ * the same way the pool's vector of Bolt objects is kept dense.
+ */
+class BoltKinematics {
+public:
+    // where the bolt is at the end of the last atom
+    std::vector<double> x, y, z;
+    // where it was at the start of it
+    std::vector<double> previous_x, previous_y, previous_z;
+    // halfway between the two, which is where the collide map keeps it
+    std::vector<double> middle_x, middle_y, middle_z;
+    std::vector<float> velocity_x, velocity_y, velocity_z;
+    // distance covered at muzzle speed, compared against range
+    std::vector<float> distance;
+    std::vector<float> speed;
+    std::vector<float> range;
+
+    size_t size() const {
+        return x.size();
+    }
+
+    void Add(double x,
+            double y,
+            double z,
+            float velocity_x,
+            float velocity_y,
+            float velocity_z,
+            float speed,
+            float range);
+    void Remove(size_t index);
+    void Clear();
+
+    /* Moves rows [begin, end) along their velocity for elapsed seconds */
+    void Advance(size_t begin, size_t end, float elapsed);
+
+    bool Expired(size_t index) const {
+        return distance[index] > range[index];
+    }
+};
+
+#endif // BOLT_KINEMATICS_H
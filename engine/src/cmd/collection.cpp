@@ -28,6 +28,8 @@
 
 #if defined (USE_OLD_COLLECTION)
 #include "oldcollection.cpp"
+#elif defined (USE_CONTIGUOUS_COLLECTION)
+#include "contiguous_collection.cpp"
 #elif defined (USE_STL_COLLECTION)
 
 #include <list>
@@ -221,6 +223,40 @@ UnitCollection::UnitCollection(const UnitCollection &uc) {
     }
 }
 
+inline void UnitCollection::track(list<Unit *>::iterator it) {
+    if (tracks_units) {
+        (*it)->physics_queue_slot.col = this;
+        (*it)->physics_queue_slot.it = it;
+    }
+}
+
+inline void UnitCollection::untrack(list<Unit *>::iterator it) {
+    //the unit may have been moved to another tracking collection already
+    if (tracks_units && (*it)->physics_queue_slot.col == this && (*it)->physics_queue_slot.it == it) {
+        (*it)->physics_queue_slot.col = NULL;
+    }
+}
+
+bool UnitCollection::moveToFront(Unit *unit, UnitCollection &target) {
+    if (!unit || unit->physics_queue_slot.col != this) {
+        return false;
+    }
+    list<Unit *>::iterator node = unit->physics_queue_slot.it;
+    //the target holds its reference before we drop ours
+    target.prepend(unit);
+    erase(node);
+    return true;
+}
+
+bool UnitCollection::removeTracked(Unit *unit) {
+    if (!unit || unit->physics_queue_slot.col != this) {
+        return false;
+    }
+    list<Unit *>::iterator node = unit->physics_queue_slot.it;
+    erase(node);
+    return true;
+}
+
 void UnitCollection::insert_unique(Unit *unit) {
     if (unit) {
         for (list<Unit *>::iterator it = u.begin(); it != u.end(); ++it) {
@@ -230,6 +266,7 @@ void UnitCollection::insert_unique(Unit *unit) {
         }
         unit->Ref();
         u.push_front(unit);
+        track(u.begin());
     }
 }
 
@@ -237,6 +274,7 @@ void UnitCollection::prepend(Unit *unit) {
     if (unit) {
         unit->Ref();
         u.push_front(unit);
+        track(u.begin());
     }
 }
 
@@ -248,7 +286,7 @@ void UnitCollection::prepend(UnitIterator *it) {
     list<Unit *>::iterator tmpI = u.begin();
     while ((tmp = **it)) {
         tmp->Ref();
-        u.insert(tmpI, tmp);
+        track(u.insert(tmpI, tmp));
         ++tmpI;
         it->advance();
     }
@@ -258,6 +296,7 @@ void UnitCollection::append(Unit *un) {
     if (un) {
         un->Ref();
         u.push_back(un);
+        track(--u.end());
     }
 }
 
@@ -269,6 +308,7 @@ void UnitCollection::append(UnitIterator *it) {
     while ((tmp = **it)) {
         tmp->Ref();
         u.push_back(tmp);
+        track(--u.end());
         it->advance();
     }
 }
@@ -277,6 +317,7 @@ void UnitCollection::insert(list<Unit *>::iterator &temp, Unit *unit) {
     if (unit) {
         unit->Ref();
         temp = u.insert(temp, unit);
+        track(temp);
     }
     temp = u.end();
 }
@@ -288,15 +329,20 @@ void UnitCollection::clear() {
     }
 
     for (list<Unit *>::iterator it = u.begin(); it != u.end(); ++it) {
-        (*it)->UnRef();
-        (*it) = NULL;
+        if (*it) {
+            untrack(it);
+            (*it)->UnRef();
+            (*it) = NULL;
+        }
     }
+    removedIters.clear();
     u.clear();
 }
 
 void UnitCollection::destr() {
     for (list<Unit *>::iterator it = u.begin(); it != u.end(); ++it) {
         if (*it) {
+            untrack(it);
             (*it)->UnRef();
             (*it) = NULL;
         }
@@ -323,6 +369,7 @@ inline void UnitCollection::erase(list<Unit *>::iterator &it2) {
         ++it2;
         return;
     }
+    untrack(it2);
     //If we have more than 4 iterators, just push node onto vector.
     if (activeIters.size() > 3) {
         removedIters.push_back(it2);
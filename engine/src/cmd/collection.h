@@ -32,12 +32,17 @@
 #ifndef _UNITCOLLECTION_H_
 #define _UNITCOLLECTION_H_
 
-//Collection type:
+//Collection type, the list unless one of the others is defined:
 //#define USE_OLD_COLLECTION
+//#define USE_CONTIGUOUS_COLLECTION
+#if !defined (USE_OLD_COLLECTION) && !defined (USE_CONTIGUOUS_COLLECTION)
 #define USE_STL_COLLECTION
+#endif
 
 #if defined (USE_OLD_COLLECTION)
 #include "oldcollection.h"
+#elif defined (USE_CONTIGUOUS_COLLECTION)
+#include "contiguous_collection.h"
 #elif defined (USE_STL_COLLECTION)
 
 #include <cstddef>
@@ -173,6 +178,15 @@ public:
         std::list<class Unit *>::const_iterator it;
     };
 
+    /* Where a unit sits in the collection that tracks it, see trackUnits */
+    struct Slot {
+        UnitCollection *col;
+        std::list<class Unit *>::iterator it;
+
+        Slot() : col(NULL) {
+        }
+    };
+
     /* backwards compatibility only.  Typedefs suck. dont use them. */
     typedef ConstIterator ConstFastIterator;
     typedef UnitIterator FastIterator;
@@ -201,6 +215,20 @@ public:
         return ConstFastIterator(this);
     }
 
+    /* Makes every unit in this collection keep its node in unit->physics_queue_slot,
+     * so that it can be found and moved without walking the list. A unit can be
+     * in only one tracking collection at a time; copies don't track. */
+    void trackUnits() {
+        tracks_units = true;
+    }
+
+    /* Moves a unit this collection tracks to the front of target, in constant time.
+     * Returns false, and does nothing, if the unit isn't in this collection */
+    bool moveToFront(Unit *unit, UnitCollection &target);
+
+    /* Same as remove, in constant time, for a unit this collection tracks */
+    bool removeTracked(Unit *unit);
+
     /* Traverses entire list and only inserts if no matches are found
      * Do not use in any fast-code paths */
     void insert_unique(Unit *);
@@ -295,6 +323,10 @@ private:
      * we are down to our last active iterator */
     void unreg(UnitCollection::UnitIterator *);
 
+    /* Point the unit at node it, or forget about it, when we track units */
+    void track(std::list<class Unit *>::iterator it);
+    void untrack(std::list<class Unit *>::iterator it);
+
     /* This is a list of the current iterators being held */
     std::vector<class UnitCollection::UnitIterator *> activeIters;
 
@@ -305,6 +337,8 @@ private:
 
     /* Main collection */
     std::list<class Unit *> u;
+
+    bool tracks_units = false;
 };
 
 /* Typedefs.   We really should not use them but we're lazy */
@@ -78,6 +78,7 @@ csOPCODECollider *collideTrees::colTree(Unit *un, const Vector &othervelocity) {
         return NULL;
     }
     //Force pow to 0 in order to avoid nan problems...
+    //units too fast for an unstretched tree are swept through it instead, see Unit::SweptCollideTree
     unsigned int pow = 0;
     if (pow >= collideTreesMaxTrees || pow >= max_collide_trees) {
         pow = collideTreesMaxTrees - 1;
@@ -31,6 +31,8 @@
 
 
 #include "CSopcodecollider.h"
+#include "collision_tree_cache.h"
+#include "swept_sphere.h"
 #include "opcodeqsqrt.h"
 #include "opcodeqint.h"
 #include "vs_logging.h"
@@ -42,20 +44,11 @@
 using namespace Opcode;
 using namespace VegaStrike;
 
-static vs_vector<csCollisionPair> pairs;
-
 csOPCODECollider::csOPCODECollider(vega_types::SequenceContainer<mesh_polygon> & polygons) {
     m_pCollisionModel = nullptr;
     vertholder = nullptr;
-    //pairs.IncRef();
-    TreeCollider.SetFirstContact(true);
-    TreeCollider.SetFullBoxBoxTest(false);
-    TreeCollider.SetTemporalCoherence(false);
     opcMeshInt.SetCallback(&MeshCallback, this);
     GeometryInitialize(polygons);
-    CollisionFace collFace;
-    rCollider.SetFirstContact(true);
-
 }
 
 inline float min3(float a, float b, float c) {
@@ -99,6 +92,9 @@ void csOPCODECollider::GeometryInitialize(const vega_types::SequenceContainer<me
                 tmp.MaxZ() - tmp.MinZ());
         opcMeshInt.SetNbTriangles(tri_count);
         opcMeshInt.SetNbVertices(last);
+        if (CollisionTreeCache::Load(vertholder, last, &opcMeshInt, *m_pCollisionModel)) {
+            return;
+        }
 
         // Mesh data
         OPCC.mIMesh = &opcMeshInt;
@@ -111,8 +107,9 @@ void csOPCODECollider::GeometryInitialize(const vega_types::SequenceContainer<me
         return;
     }
 
-    //bool status = m_pCollisionModel->Build (OPCC);
-    m_pCollisionModel->Build(OPCC);
+    if (m_pCollisionModel->Build(OPCC)) {
+        CollisionTreeCache::Store(vertholder, opcMeshInt.GetNbVertices(), *m_pCollisionModel);
+    }
 }
 
 csOPCODECollider::~csOPCODECollider() {
@@ -136,13 +133,63 @@ void csOPCODECollider::MeshCallback(uint32_t triangle_index,
     triangle.Vertex[2] = &vertholder[index + 2];
 }
 
-bool csOPCODECollider::rayCollide(const Ray &boltbeam, Vector &norm, float &distance) {
-    rCollider.SetHitCallback(&csOPCODECollider::RayCallback);
+bool csOPCODECollider::rayCollide(const Ray &boltbeam, Vector &norm, float &distance) const {
+    return csOPCODECollisionContext::ForThisThread().rayCollide(*this, boltbeam, norm, distance);
+}
+
+bool csOPCODECollider::Collide(const csOPCODECollider &otherCollider,
+        const csReversibleTransform *trans1,
+        const csReversibleTransform *trans2) const {
+    return csOPCODECollisionContext::ForThisThread().Collide(*this, otherCollider, trans1, trans2);
+}
+
+void csOPCODECollider::ResetCollisionPairs() {
+    csOPCODECollisionContext::ForThisThread().ResetCollisionPairs();
+}
+
+csCollisionPair *csOPCODECollider::GetCollisions() {
+    return csOPCODECollisionContext::ForThisThread().GetCollisions();
+}
+
+size_t csOPCODECollider::GetCollisionPairCount() {
+    return csOPCODECollisionContext::ForThisThread().GetCollisionPairCount();
+}
+
+void csOPCODECollider::SetOneHitOnly(bool on) {
+    one_hit_only = on;
+}
+
+Vector csOPCODECollider::getVertex(unsigned int which) const {
+    // This function is used to position the damage particles
+    if (!vertholder) {
+        return Vector(0, 0, 0);
+    }
+    return Vector(vertholder[which].x, vertholder[which].y, vertholder[which].z);
+}
+
+csOPCODECollisionContext::csOPCODECollisionContext() {
+    TreeCollider.SetFirstContact(true);
+    TreeCollider.SetFullBoxBoxTest(false);
+    TreeCollider.SetTemporalCoherence(false);
+    sweepCollider.SetFirstContact(false);
+    sweepCollider.SetTemporalCoherence(false);
+}
+
+csOPCODECollisionContext &csOPCODECollisionContext::ForThisThread() {
+    static thread_local csOPCODECollisionContext context;
+    return context;
+}
+
+bool csOPCODECollisionContext::rayCollide(const csOPCODECollider &collider,
+        const Ray &boltbeam,
+        Vector &norm,
+        float &distance) {
+    rCollider.SetHitCallback(&csOPCODECollisionContext::RayCallback);
     rCollider.SetUserData(this);
     rCollider.SetFirstContact(false);
     //rCollider.SetClosestHit(true);
     collFace.mDistance = FLT_MAX;
-    bool retval = rCollider.Collide(boltbeam, *m_pCollisionModel);
+    bool retval = rCollider.Collide(boltbeam, *collider.m_pCollisionModel);
     rCollider.SetUserData(NULL);
     if (retval) {
         retval = collFace.mDistance != FLT_MAX;
@@ -159,21 +206,22 @@ bool csOPCODECollider::rayCollide(const Ray &boltbeam, Vector &norm, float &dist
     return retval;
 }
 
-void csOPCODECollider::RayCallback(const CollisionFace &faceHit, void *user_data) {
-    csOPCODECollider *collider = (csOPCODECollider *) user_data;
-    if (collider) {
-        if (collider->collFace.mDistance > faceHit.mDistance) {
-            collider->collFace = faceHit;
+void csOPCODECollisionContext::RayCallback(const CollisionFace &faceHit, void *user_data) {
+    csOPCODECollisionContext *context = (csOPCODECollisionContext *) user_data;
+    if (context) {
+        if (context->collFace.mDistance > faceHit.mDistance) {
+            context->collFace = faceHit;
         }
     }
 }
 
-bool csOPCODECollider::Collide(csOPCODECollider &otherCollider,
+bool csOPCODECollisionContext::Collide(const csOPCODECollider &first,
+        const csOPCODECollider &second,
         const csReversibleTransform *trans1,
         const csReversibleTransform *trans2) {
-    csOPCODECollider *col2 = (csOPCODECollider *) &otherCollider;
-    ColCache.Model0 = this->m_pCollisionModel;
-    ColCache.Model1 = col2->m_pCollisionModel;
+    ColCache.Model0 = first.m_pCollisionModel;
+    ColCache.Model1 = second.m_pCollisionModel;
+    TreeCollider.SetFirstContact(first.one_hit_only);
     csMatrix3 m1;
     if (trans1) {
         m1 = trans1->GetT2O();
@@ -237,7 +285,7 @@ bool csOPCODECollider::Collide(csOPCODECollider &otherCollider,
     if (TreeCollider.Collide(ColCache, &transform1, &transform2)) {
         bool status = (TreeCollider.GetContactStatus() != FALSE);
         if (status) {
-            CopyCollisionPairs(this, col2);
+            CopyCollisionPairs(first, second);
         }
         return status;
     } else {
@@ -245,45 +293,52 @@ bool csOPCODECollider::Collide(csOPCODECollider &otherCollider,
     }
 }
 
-void csOPCODECollider::ResetCollisionPairs() {
-    pairs.clear();
-}
-
-csCollisionPair *csOPCODECollider::GetCollisions() {
-    return pairs.data();
-}
-
-size_t csOPCODECollider::GetCollisionPairCount() {
-    return pairs.size();
-}
-
-void csOPCODECollider::SetOneHitOnly(bool on) {
-    TreeCollider.SetFirstContact(on);
-    rCollider.SetFirstContact(on);
-}
-
-Vector csOPCODECollider::getVertex(unsigned int which) const {
-    // This function is used to position the damage particles
-    if (!vertholder) {
-        return Vector(0, 0, 0);
+bool csOPCODECollisionContext::SweptSphereCollide(const csOPCODECollider &collider,
+        const csVector3 &start,
+        const csVector3 &end,
+        float radius,
+        float &fraction,
+        csVector3 &contact,
+        csVector3 &normal) {
+    if (!collider.m_pCollisionModel) {
+        return false;
     }
-    return Vector(vertholder[which].x, vertholder[which].y, vertholder[which].z);
-}
-
-void csOPCODECollider::CopyCollisionPairs(csOPCODECollider *col1,
-        csOPCODECollider *col2) {
-    if (!col1 || !col2) {
-        return;
+    const LSS sweep(Segment(Point(start.x, start.y, start.z), Point(end.x, end.y, end.z)), radius);
+    if (!sweepCollider.Collide(sweepCache, sweep, *collider.m_pCollisionModel)
+            || !sweepCollider.GetContactStatus()) {
+        return false;
+    }
+    const csVector3 motion = end - start;
+    const uint32_t *touched = sweepCollider.GetTouchedPrimitives();
+    fraction = 2;
+    for (uint32_t i = 0; i < sweepCollider.GetNbTouchedPrimitives(); ++i) {
+        const Point *triangle = collider.vertholder + 3 * touched[i];
+        const csVector3 a(triangle[0].x, triangle[0].y, triangle[0].z);
+        const csVector3 b(triangle[1].x, triangle[1].y, triangle[1].z);
+        const csVector3 c(triangle[2].x, triangle[2].y, triangle[2].z);
+        float when;
+        csVector3 point;
+        csVector3 touched_normal;
+        if (SweptSphereTouchesTriangle(start, motion, radius, a, b, c, when, point, touched_normal)
+                && when < fraction) {
+            fraction = when;
+            contact = point;
+            normal = touched_normal;
+        }
     }
+    return fraction <= 1;
+}
 
+void csOPCODECollisionContext::CopyCollisionPairs(const csOPCODECollider &col1,
+        const csOPCODECollider &col2) {
     unsigned int N_pairs = TreeCollider.GetNbPairs();
     if (N_pairs == 0) {
         return;
     }
 
     const Pair *colPairs = TreeCollider.GetPairs();
-    Point *vertholder0 = col1->vertholder;
-    Point *vertholder1 = col2->vertholder;
+    const Point *vertholder0 = col1.vertholder;
+    const Point *vertholder1 = col2.vertholder;
     int j;
     size_t oldlen = pairs.size();
     pairs.resize(oldlen + N_pairs);
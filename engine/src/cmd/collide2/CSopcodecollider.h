@@ -39,6 +39,7 @@
 // #include "opcodegarray.h"
 #include "basecollider.h"
 #include "gfx/mesh.h"
+#include "vs_vector.h"
 
 /*
  	How to use Collider.
@@ -52,22 +53,31 @@
 	It defaults to not.
 	csOPCODECollider.SetOneHitOnly(bool);
 
-	The rest of the calls occur in your physics loops
+	After that the collider is only read from, so any number of threads may
+	use it at once.   The state of a query lives in a csOPCODECollisionContext,
+	and each thread has to use its own.   The rest of the calls occur in your
+	physics loops
+
+	Get the calling thread's context (or keep one of your own around).
+	csOPCODECollisionContext &context = csOPCODECollisionContext::ForThisThread();
 
 	Reset our list of collided pairs of vectors.
-	csOPCODECollider.ResetCollisionPairs();
+	context.ResetCollisionPairs();
 
-	Check if a collision occurred, sending the other collider and transforms for
-	both colliders.   Returns true if we collided.
-	csOPCODECollider.Collide(csOPCODECollider&, const csReversibleTransform* first,
-	                                            const csReversibleTransform* second);
+	Check if a collision occurred, sending both colliders and their transforms.
+	Returns true if we collided.
+	context.Collide(const csOPCODECollider&, const csOPCODECollider&,
+	                const csReversibleTransform* first, const csReversibleTransform* second);
 
 	If true, retrieve the vectors that collided so we can act upon them.
-	csOPCODECollider.GetCollisions();
+	context.GetCollisions();
 
 	We also need the number of collided vectors in case we dont have
 	first hit set to true.
-	csOPCodeCollider.GetCollisionPairCount();
+	context.GetCollisionPairCount();
+
+	The older csOPCODECollider.Collide() and the static pair functions of
+	csOPCODECollider do the same through the calling thread's context.
 */
 
 
@@ -84,31 +94,20 @@ private:
     static void MeshCallback(uint32_t triangle_index,
             Opcode::VertexPointers &triangle, void *user_data);
 
-    /* returns face of mesh where ray collided */
-    static void RayCallback(const Opcode::CollisionFace &, void *);
-
     /* Radius around unit using center of unit and furthest part of unit */
     float radius{};
 
+    /* Whether Collide stops at the first contact found against this collider */
+    bool one_hit_only{true};
+
     /* Array of Point's corresponding to vertices of triangles given by mesh_polygon */
     Opcode::Point *vertholder;
 
     /* OPCODE interfaces. */
     Opcode::Model *m_pCollisionModel;
     Opcode::MeshInterface opcMeshInt;
-    Opcode::BVTCache ColCache;
-    Opcode::CollisionFace collFace;
-    /* Collider type: Tree - Used primarily for mesh on mesh collisions */
-    Opcode::AABBTreeCollider TreeCollider;
 
-    /* Collider type: Ray - used to check if a ray collided with the tree collider above */
-    Opcode::RayCollider rCollider;
-
-    /* We have to copy our Points to csVector3's because opcode likes Point
-    * and VS likes Vector.  */
-    void CopyCollisionPairs(csOPCODECollider *col1, csOPCODECollider *col2);
-
-    // std::shared_ptr<VegaStrike::vs_vector<csCollisionPair>> pairs = std::make_shared<VegaStrike::vs_vector<csCollisionPair>>();
+    friend class csOPCODECollisionContext;
 
 public:
     explicit csOPCODECollider(vega_types::SequenceContainer<mesh_polygon> & polygons);
@@ -120,24 +119,24 @@ public:
     }
 
     /* Collides the bolt or beam with this collider, returning true if it occurred */
-    bool rayCollide(const Opcode::Ray &boltbeam, Vector &norm, float &distance);
+    bool rayCollide(const Opcode::Ray &boltbeam, Vector &norm, float &distance) const;
 
     /* Collides the argument collider with this collider, returning true if it occurred */
-    bool Collide(csOPCODECollider &pOtherCollider,
+    bool Collide(const csOPCODECollider &pOtherCollider,
             const csReversibleTransform *pThisTransform = nullptr,
-            const csReversibleTransform *pOtherTransform = nullptr);
+            const csReversibleTransform *pOtherTransform = nullptr) const;
 
-    /* Returns the pair array, as of 0.5 this is a global static var
+    /* Returns the pair array of the calling thread's context
     * The pair array contains the vertices that have collided as returned
     * by the last collision.   This is concatenated, meaning, if it's not
     * cleared by the client code, the collisions just get pushed onto the
     * array indefinitely.   It should be cleared between collide calls */
     static csCollisionPair *GetCollisions();
 
-    /* clears the pair array */
+    /* clears the pair array of the calling thread's context */
     static void ResetCollisionPairs();
 
-    /* Returns the size of the pair array */
+    /* Returns the size of the pair array of the calling thread's context */
     static size_t GetCollisionPairCount();
 
     /* Sets First contact to argument.
@@ -147,7 +146,7 @@ public:
     void SetOneHitOnly(bool fh);
 
     inline bool GetOneHitOnly() const {
-        return (TreeCollider.FirstContactEnabled());
+        return one_hit_only;
     }
 
     /* Returns the radius of our collision mesh.  This is the max radius
@@ -166,4 +165,75 @@ public:
     }
 };
 
+/* The mutable side of a collision query: the OPCODE colliders with their
+* scratch state and the pairs found so far.   A context must only be used
+* by one thread at a time; the colliders it is given are only read. */
+class csOPCODECollisionContext {
+private:
+    Opcode::BVTCache ColCache;
+    Opcode::CollisionFace collFace;
+    /* Collider type: Tree - Used primarily for mesh on mesh collisions */
+    Opcode::AABBTreeCollider TreeCollider;
+
+    /* Collider type: Ray - used to check if a ray collided with a tree */
+    Opcode::RayCollider rCollider;
+
+    /* Collider type: LSS - a sphere swept along a segment, for fast movers */
+    Opcode::LSSCollider sweepCollider;
+    Opcode::LSSCache sweepCache;
+
+    VegaStrike::vs_vector<csCollisionPair> pairs;
+
+    /* returns face of mesh where ray collided */
+    static void RayCallback(const Opcode::CollisionFace &, void *);
+
+    /* We have to copy our Points to csVector3's because opcode likes Point
+    * and VS likes Vector.  */
+    void CopyCollisionPairs(const csOPCODECollider &col1, const csOPCODECollider &col2);
+
+public:
+    csOPCODECollisionContext();
+
+    /* The context the csOPCODECollider shortcuts use, one per thread */
+    static csOPCODECollisionContext &ForThisThread();
+
+    /* Collides the bolt or beam with the collider, returning true if it occurred */
+    bool rayCollide(const csOPCODECollider &collider, const Opcode::Ray &boltbeam, Vector &norm, float &distance);
+
+    /* Collides the two colliders, returning true if they touch; the pairs
+    * found are added to the pair array.   Stops at the first contact when
+    * the first collider is set to one hit only */
+    bool Collide(const csOPCODECollider &first,
+            const csOPCODECollider &second,
+            const csReversibleTransform *pFirstTransform = nullptr,
+            const csReversibleTransform *pSecondTransform = nullptr);
+
+    /* Sweeps a sphere of the given radius from start to end, both in the
+    * collider's space, returning true if it touches the mesh on the way.
+    * fraction is then how far along the sweep the sphere first touches a
+    * triangle, on its face, an edge or a corner; contact is the point of the
+    * triangle it touches, and normal points from there to the sphere's
+    * center */
+    bool SweptSphereCollide(const csOPCODECollider &collider,
+            const csVector3 &start,
+            const csVector3 &end,
+            float radius,
+            float &fraction,
+            csVector3 &contact,
+            csVector3 &normal);
+
+    /* Returns the pairs found since the last reset */
+    inline csCollisionPair *GetCollisions() {
+        return pairs.data();
+    }
+
+    inline size_t GetCollisionPairCount() const {
+        return pairs.size();
+    }
+
+    inline void ResetCollisionPairs() {
+        pairs.clear();
+    }
+};
+
 #endif
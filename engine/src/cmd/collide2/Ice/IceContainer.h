@@ -19,7 +19,8 @@
 #ifndef __ICECONTAINER_H__
 #define __ICECONTAINER_H__
 
-#define CONTAINER_STATS
+// The counters are shared by every container and not thread safe, and nothing reads them
+// #define CONTAINER_STATS
 
 enum FindMode {
     FIND_CLAMP,
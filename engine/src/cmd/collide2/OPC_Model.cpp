@@ -222,6 +222,32 @@ bool Model::Build(const OPCODECREATE &create) {
     return true;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Sets the model up with a saved quantized no-leaf tree.
+ *	\param		imesh		[in] the mesh the tree was built from
+ *	\param		buffer		[in] saved tree
+ *	\param		length		[in] size of the buffer
+ *	\return		true if success
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Model::Restore(const MeshInterface *imesh, const uint8_t *buffer, size_t length) {
+    if (!imesh || !imesh->IsValid()) {
+        return false;
+    }
+    Release();
+    SetMeshInterface(imesh);
+    mModelCode &= ~OPC_SINGLE_NODE;
+    if (!CreateTree(true, true)) {
+        return false;
+    }
+    if (!static_cast<AABBQuantizedNoLeafTree *>(mTree)->Load(buffer, length, imesh->GetNbTriangles())) {
+        Release();
+        return false;
+    }
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  *	Gets the number of bytes used by the tree.
@@ -42,6 +42,18 @@ public:
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     override(BaseModel) bool Build(const OPCODECREATE &create);
 
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     *	Sets the model up with a quantized no-leaf tree saved by AABBQuantizedNoLeafTree::Save(),
+     *	instead of building one.
+     *	\param		imesh		[in] the mesh the tree was built from
+     *	\param		buffer		[in] saved tree
+     *	\param		length		[in] size of the buffer
+     *	\return		true if success, else the model is left empty
+     */
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    bool Restore(const MeshInterface *imesh, const uint8_t *buffer, size_t length);
+
 #ifdef __MESHMERIZER_H__
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     /**
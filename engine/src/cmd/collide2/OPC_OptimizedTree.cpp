@@ -796,3 +796,93 @@ bool AABBQuantizedNoLeafTree::Walk(GenericWalkingCallback callback, void *user_d
     return true;
 }
 
+// Saved layout: node count, the two quantization coefficients, then per node its box and both links
+static const size_t SAVED_HEADER_SIZE = sizeof(uint32_t) + 6 * sizeof(float);
+static const size_t SAVED_NODE_SIZE = 6 * sizeof(uint16_t) + 2 * sizeof(uint32_t);
+
+static inline_ void SaveBytes(uint8_t *&buffer, const void *data, size_t size) {
+    memcpy(buffer, data, size);
+    buffer += size;
+}
+
+static inline_ void LoadBytes(const uint8_t *&buffer, void *data, size_t size) {
+    memcpy(data, buffer, size);
+    buffer += size;
+}
+
+size_t AABBQuantizedNoLeafTree::GetSaveSize() const {
+    return SAVED_HEADER_SIZE + mNbNodes * SAVED_NODE_SIZE;
+}
+
+void AABBQuantizedNoLeafTree::Save(uint8_t *buffer) const {
+    SaveBytes(buffer, &mNbNodes, sizeof(mNbNodes));
+    SaveBytes(buffer, &mCenterCoeff.x, sizeof(float));
+    SaveBytes(buffer, &mCenterCoeff.y, sizeof(float));
+    SaveBytes(buffer, &mCenterCoeff.z, sizeof(float));
+    SaveBytes(buffer, &mExtentsCoeff.x, sizeof(float));
+    SaveBytes(buffer, &mExtentsCoeff.y, sizeof(float));
+    SaveBytes(buffer, &mExtentsCoeff.z, sizeof(float));
+    for (uint32_t i = 0; i < mNbNodes; i++) {
+        const AABBQuantizedNoLeafNode &Node = mNodes[i];
+        SaveBytes(buffer, Node.mAABB.mCenter, sizeof(Node.mAABB.mCenter));
+        SaveBytes(buffer, Node.mAABB.mExtents, sizeof(Node.mAABB.mExtents));
+        // Leaves keep their primitive index, children become node indices
+        const uint32_t Pos = Node.HasPosLeaf() ? uint32_t(Node.mPosData)
+                : uint32_t(Node.GetPos() - mNodes) << 1;
+        const uint32_t Neg = Node.HasNegLeaf() ? uint32_t(Node.mNegData)
+                : uint32_t(Node.GetNeg() - mNodes) << 1;
+        SaveBytes(buffer, &Pos, sizeof(Pos));
+        SaveBytes(buffer, &Neg, sizeof(Neg));
+    }
+}
+
+bool AABBQuantizedNoLeafTree::Load(const uint8_t *buffer, size_t length, uint32_t nb_primitives) {
+    if (length < SAVED_HEADER_SIZE) {
+        return false;
+    }
+    uint32_t NbNodes;
+    LoadBytes(buffer, &NbNodes, sizeof(NbNodes));
+    // A complete no-leaf tree has one node less than there are triangles
+    if (nb_primitives < 2 || NbNodes != nb_primitives - 1 || length != SAVED_HEADER_SIZE + NbNodes * SAVED_NODE_SIZE) {
+        return false;
+    }
+    LoadBytes(buffer, &mCenterCoeff.x, sizeof(float));
+    LoadBytes(buffer, &mCenterCoeff.y, sizeof(float));
+    LoadBytes(buffer, &mCenterCoeff.z, sizeof(float));
+    LoadBytes(buffer, &mExtentsCoeff.x, sizeof(float));
+    LoadBytes(buffer, &mExtentsCoeff.y, sizeof(float));
+    LoadBytes(buffer, &mExtentsCoeff.z, sizeof(float));
+
+    DELETEARRAY(mNodes);
+    mNbNodes = 0;
+    AABBQuantizedNoLeafNode *Nodes = new AABBQuantizedNoLeafNode[NbNodes];
+    CHECKALLOC(Nodes);
+    for (uint32_t i = 0; i < NbNodes; i++) {
+        AABBQuantizedNoLeafNode &Node = Nodes[i];
+        LoadBytes(buffer, Node.mAABB.mCenter, sizeof(Node.mAABB.mCenter));
+        LoadBytes(buffer, Node.mAABB.mExtents, sizeof(Node.mAABB.mExtents));
+        uint32_t Links[2];
+        LoadBytes(buffer, Links, sizeof(Links));
+        uintptr_t *Data[2] = {&Node.mPosData, &Node.mNegData};
+        for (int j = 0; j < 2; j++) {
+            const uint32_t Index = Links[j] >> 1;
+            if (Links[j] & 1) {
+                if (Index >= nb_primitives) {
+                    DELETEARRAY(Nodes);
+                    return false;
+                }
+                *Data[j] = Links[j];
+            } else {
+                // Children always come after their parent, which also rules out cycles
+                if (Index <= i || Index >= NbNodes) {
+                    DELETEARRAY(Nodes);
+                    return false;
+                }
+                *Data[j] = uintptr_t(&Nodes[Index]);
+            }
+        }
+    }
+    mNodes = Nodes;
+    mNbNodes = NbNodes;
+    return true;
+}
@@ -214,6 +214,27 @@ class OPCODE_API AABBQuantizedNoLeafTree : public AABBOptimizedTree {
 IMPLEMENT_COLLISION_TREE(AABBQuantizedNoLeafTree, AABBQuantizedNoLeafNode)
 
 public:
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     *	Flat copy of the tree, for keeping it on disk. Child links are stored as node indices,
+     *	so the copy doesn't depend on where the nodes were allocated. Host byte order.
+     *	\param		buffer			[out] GetSaveSize() bytes
+     */
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    size_t GetSaveSize() const;
+    void Save(uint8_t *buffer) const;
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     *	Rebuilds the tree from what Save() wrote.
+     *	\param		buffer			[in] saved tree
+     *	\param		length			[in] size of the buffer
+     *	\param		nb_primitives	[in] number of triangles of the mesh the tree will be used with
+     *	\return		false if the buffer doesn't hold a well formed tree for that many triangles
+     */
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    bool Load(const uint8_t *buffer, size_t length, uint32_t nb_primitives);
+
     Point mCenterCoeff;
     Point mExtentsCoeff;
 };
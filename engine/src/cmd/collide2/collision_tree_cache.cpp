@@ -0,0 +1,353 @@
+/*
+ * collision_tree_cache.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "collision_tree_cache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+
+#include "Stdafx.h"
+#include "vs_logging.h"
+
+using Opcode::AABBQuantizedNoLeafTree;
+using Opcode::MeshInterface;
+using Opcode::Model;
+using Opcode::Point;
+
+namespace CollisionTreeCache {
+
+// Bump whenever the saved tree layout or the way csOPCODECollider builds its trees changes
+static const uint32_t kFormatVersion = 1;
+static const uint32_t kByteOrderMark = 0x01020304;
+// Smaller trees are built faster than their file is found and read
+static const uint32_t kMinTriangles = 512;
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t nb_vertices;
+    uint64_t vertex_hash;
+    uint64_t tree_checksum;
+    uint64_t tree_bytes;
+};
+
+static std::string cache_directory;
+static uint64_t cache_max_bytes = 0;
+
+// How many bytes of trees the directory holds, as far as Store knows: counted by Prune, which
+// only walks the directory again once stores take the count past cache_max_bytes
+static std::mutex size_mutex;
+static uint64_t known_bytes = 0;
+static bool known_bytes_counted = false;
+
+void SetDirectory(const std::string &directory, uint64_t max_bytes) {
+    std::lock_guard<std::mutex> lock(size_mutex);
+    cache_directory = directory;
+    cache_max_bytes = max_bytes;
+    known_bytes_counted = false;
+}
+
+// FNV-1a
+static uint64_t Hash(const void *data, size_t length) {
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static std::string FileName(uint64_t vertex_hash) {
+    return (boost::format("%1%/%2$016x.opc") % cache_directory % vertex_hash).str();
+}
+
+static thread_local std::string current_source;
+// Trees are built on several threads at once; their sources' lists are read and added to one at a time
+static std::mutex list_mutex;
+
+/* Where the trees of source are listed, one file name per line */
+static std::string SourceListName(const std::string &source) {
+    std::string name = source;
+    for (char &c : name) {
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '_' && c != '-') {
+            c = '_';
+        }
+    }
+    return cache_directory + "/" + name + ".trees";
+}
+
+static std::vector<std::string> ReadSourceList(const std::string &list_path) {
+    std::vector<std::string> names;
+    std::ifstream list(list_path);
+    std::string name;
+    while (std::getline(list, name)) {
+        if (!name.empty()) {
+            names.push_back(name);
+        }
+    }
+    return names;
+}
+
+/* Lists the tree at path under the current source, if there is one */
+static void ListUnderSource(const std::string &path) {
+    if (current_source.empty()) {
+        return;
+    }
+    const std::string name = boost::filesystem::path(path).filename().string();
+    const std::string list_path = SourceListName(current_source);
+    std::lock_guard<std::mutex> lock(list_mutex);
+    const std::vector<std::string> names = ReadSourceList(list_path);
+    if (std::find(names.begin(), names.end(), name) != names.end()) {
+        return;
+    }
+    std::ofstream list(list_path, std::ios::app);
+    list << name << '\n';
+}
+
+static void FillHeader(FileHeader &header) {
+    memcpy(header.magic, "VSCT", sizeof(header.magic));
+    header.version = kFormatVersion;
+    header.byte_order = kByteOrderMark;
+}
+
+bool Load(const Point *vertices, uint32_t nb_vertices, const MeshInterface *imesh, Model &model) {
+    if (cache_directory.empty() || imesh->GetNbTriangles() < kMinTriangles) {
+        return false;
+    }
+    const size_t vertex_bytes = nb_vertices * sizeof(Point);
+    const uint64_t vertex_hash = Hash(vertices, vertex_bytes);
+    const std::string path = FileName(vertex_hash);
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    std::vector<uint8_t> contents;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        const long length = ftell(file);
+        if (length > 0 && fseek(file, 0, SEEK_SET) == 0) {
+            contents.resize(length);
+            if (fread(contents.data(), 1, contents.size(), file) != contents.size()) {
+                contents.clear();
+            }
+        }
+    }
+    fclose(file);
+
+    FileHeader expected{};
+    FillHeader(expected);
+    FileHeader header{};
+    if (contents.size() >= sizeof(header)) {
+        memcpy(&header, contents.data(), sizeof(header));
+    }
+    if (contents.size() < sizeof(header)
+            || memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0
+            || header.version != expected.version
+            || header.byte_order != expected.byte_order
+            || header.nb_vertices != nb_vertices
+            || header.vertex_hash != vertex_hash
+            || contents.size() != sizeof(header) + vertex_bytes + header.tree_bytes) {
+        VS_LOG(info, (boost::format("Collision tree cache: ignoring stale or truncated %1%") % path));
+        return false;
+    }
+    const uint8_t *stored_vertices = contents.data() + sizeof(header);
+    const uint8_t *tree = stored_vertices + vertex_bytes;
+    if (Hash(tree, header.tree_bytes) != header.tree_checksum) {
+        VS_LOG(warning, (boost::format("Collision tree cache: %1% is corrupt") % path));
+        return false;
+    }
+    if (memcmp(stored_vertices, vertices, vertex_bytes) != 0) {
+        // a different mesh with the same hash
+        return false;
+    }
+    if (!model.Restore(imesh, tree, header.tree_bytes)) {
+        VS_LOG(warning, (boost::format("Collision tree cache: %1% does not hold a usable tree") % path));
+        return false;
+    }
+    // the modification time is when the tree was last used, which is what Prune goes by
+    boost::system::error_code error;
+    boost::filesystem::last_write_time(path, std::time(nullptr), error);
+    ListUnderSource(path);
+    return true;
+}
+
+struct StoredTree {
+    std::time_t last_used;
+    uint64_t bytes;
+    boost::filesystem::path path;
+
+    bool operator<(const StoredTree &other) const {
+        return last_used < other.last_used;
+    }
+};
+
+/*
+ * Deletes the trees that went longest without being used until the rest fit within cache_max_bytes,
+ * and counts what is left in known_bytes. Called with size_mutex held
+ */
+static void Prune() {
+    std::vector<StoredTree> trees;
+    uint64_t total_bytes = 0;
+    boost::system::error_code error;
+    boost::filesystem::directory_iterator end;
+    for (boost::filesystem::directory_iterator it(cache_directory, error); !error && it != end;
+            it.increment(error)) {
+        if (it->path().extension() != ".opc") {
+            continue;
+        }
+        boost::system::error_code file_error;
+        StoredTree tree;
+        tree.bytes = boost::filesystem::file_size(it->path(), file_error);
+        if (!file_error) {
+            tree.last_used = boost::filesystem::last_write_time(it->path(), file_error);
+        }
+        if (file_error) {
+            // gone since, or not a plain file
+            continue;
+        }
+        tree.path = it->path();
+        total_bytes += tree.bytes;
+        trees.push_back(tree);
+    }
+    if (total_bytes > cache_max_bytes) {
+        std::sort(trees.begin(), trees.end());
+        for (const StoredTree &tree : trees) {
+            if (total_bytes <= cache_max_bytes) {
+                break;
+            }
+            boost::system::error_code remove_error;
+            if (boost::filesystem::remove(tree.path, remove_error)) {
+                total_bytes -= tree.bytes;
+            }
+        }
+    }
+    known_bytes = total_bytes;
+    known_bytes_counted = true;
+}
+
+/* Counts a file of stored_bytes that replaced one of replaced_bytes, and prunes once past the limit */
+static void CountStored(uint64_t stored_bytes, uint64_t replaced_bytes) {
+    std::lock_guard<std::mutex> lock(size_mutex);
+    if (cache_max_bytes == 0) {
+        return;
+    }
+    if (known_bytes_counted) {
+        known_bytes += stored_bytes - std::min(replaced_bytes, known_bytes);
+        if (known_bytes <= cache_max_bytes) {
+            return;
+        }
+    }
+    Prune();
+}
+
+void Store(const Point *vertices, uint32_t nb_vertices, const Model &model) {
+    if (cache_directory.empty() || model.HasSingleNode() || model.HasLeafNodes() || !model.IsQuantized()
+            || !model.GetTree() || model.GetMeshInterface()->GetNbTriangles() < kMinTriangles) {
+        return;
+    }
+    const AABBQuantizedNoLeafTree *tree = static_cast<const AABBQuantizedNoLeafTree *>(model.GetTree());
+    const size_t vertex_bytes = nb_vertices * sizeof(Point);
+    const size_t tree_bytes = tree->GetSaveSize();
+
+    std::vector<uint8_t> contents(sizeof(FileHeader) + vertex_bytes + tree_bytes);
+    uint8_t *saved_tree = contents.data() + sizeof(FileHeader) + vertex_bytes;
+    tree->Save(saved_tree);
+    FileHeader header{};
+    FillHeader(header);
+    header.nb_vertices = nb_vertices;
+    header.vertex_hash = Hash(vertices, vertex_bytes);
+    header.tree_checksum = Hash(saved_tree, tree_bytes);
+    header.tree_bytes = tree_bytes;
+    memcpy(contents.data(), &header, sizeof(header));
+    memcpy(contents.data() + sizeof(header), vertices, vertex_bytes);
+
+    // written aside and renamed into place, so that nobody ever reads half a file. The name is
+    // this writer's own, as another thread or game may be storing the same tree at the same time
+    const std::string path = FileName(header.vertex_hash);
+    const std::string temporary = path + "." + boost::filesystem::unique_path().string() + ".tmp";
+    boost::system::error_code size_error;
+    const uintmax_t replaced_bytes = boost::filesystem::file_size(path, size_error);
+    FILE *file = fopen(temporary.c_str(), "wb");
+    if (!file) {
+        VS_LOG(warning, (boost::format("Collision tree cache: cannot write %1%") % temporary));
+        return;
+    }
+    const bool written = fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+    if (fclose(file) != 0 || !written) {
+        VS_LOG(warning, (boost::format("Collision tree cache: cannot write %1%") % temporary));
+        remove(temporary.c_str());
+        return;
+    }
+    // unlike std::rename, this replaces an existing file on Windows too
+    boost::system::error_code rename_error;
+    boost::filesystem::rename(temporary, path, rename_error);
+    if (rename_error) {
+        VS_LOG(warning, (boost::format("Collision tree cache: cannot write %1%") % path));
+        remove(temporary.c_str());
+        return;
+    }
+    ListUnderSource(path);
+    CountStored(contents.size(), size_error ? 0 : replaced_bytes);
+}
+
+SourceScope::SourceScope(const std::string &source) : previous(current_source) {
+    current_source = source;
+}
+
+SourceScope::~SourceScope() {
+    current_source = previous;
+}
+
+std::vector<std::string> Files(const std::string &source) {
+    std::vector<std::string> files;
+    if (cache_directory.empty()) {
+        return files;
+    }
+    std::vector<std::string> names;
+    {
+        std::lock_guard<std::mutex> lock(list_mutex);
+        names = ReadSourceList(SourceListName(source));
+    }
+    for (const std::string &name : names) {
+        const std::string path = cache_directory + "/" + name;
+        boost::system::error_code error;
+        if (boost::filesystem::is_regular_file(path, error)) {
+            files.push_back(path);
+        }
+    }
+    return files;
+}
+
+}
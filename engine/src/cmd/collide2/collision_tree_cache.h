@@ -0,0 +1,88 @@
+/*
+ * collision_tree_cache.h
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef COLLISION_TREE_CACHE_H
+#define COLLISION_TREE_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Opcode {
+class MeshInterface;
+class Model;
+class Point;
+}
+
+/*
+ * Collision trees kept on disk, so that a mesh's tree is only built the
+ * first time the mesh is seen, not on every spawn and every run.
+ *
+ * A tree is filed under a hash of the vertices it was built from (already
+ * scaled), and the file holds those vertices too: it is only used when they
+ * are exactly the ones being loaded, so a changed mesh or a different scale
+ * is just a miss. Files that are truncated, corrupt, or were written by
+ * another version are ignored and replaced by the rebuilt tree.
+ *
+ * Every tree used is marked as such, and when storing one takes the
+ * directory past its limit, the trees that went longest without being
+ * used are deleted.
+ *
+ * Trees loaded or stored while a SourceScope is open are also listed under
+ * its source, so that Files can tell which trees a unit will want before
+ * its meshes are loaded.
+ */
+namespace CollisionTreeCache {
+
+/* Where the trees are kept, and how many bytes of them at most, 0 for no limit; an empty directory, the default, turns the cache off */
+void SetDirectory(const std::string &directory, uint64_t max_bytes = 0);
+
+/* Sets model up with the stored tree for these vertices; false if there is no usable one */
+bool Load(const Opcode::Point *vertices, uint32_t nb_vertices, const Opcode::MeshInterface *imesh,
+        Opcode::Model &model);
+
+/* Stores the tree just built for these vertices */
+void Store(const Opcode::Point *vertices, uint32_t nb_vertices, const Opcode::Model &model);
+
+/* Lists the trees this thread loads or stores, while it lives, under source (a unit's key, say) */
+class SourceScope {
+public:
+    explicit SourceScope(const std::string &source);
+    ~SourceScope();
+
+private:
+    SourceScope(const SourceScope &) = delete;
+    SourceScope &operator=(const SourceScope &) = delete;
+
+    std::string previous;
+};
+
+/* The files of the trees listed under source that are still kept */
+std::vector<std::string> Files(const std::string &source);
+
+}
+
+#endif // COLLISION_TREE_CACHE_H
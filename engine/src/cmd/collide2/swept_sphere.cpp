@@ -0,0 +1,183 @@
+/*
+ * swept_sphere.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "swept_sphere.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+double Dot(const csVector3 &u, const csVector3 &v) {
+    return double(u.x) * v.x + double(u.y) * v.y + double(u.z) * v.z;
+}
+
+/* Whether point, on the plane of a, b, c, lies within the triangle; face is (b - a) % (c - a) */
+bool Inside(const csVector3 &point, const csVector3 &a, const csVector3 &b, const csVector3 &c,
+        const csVector3 &face) {
+    return Dot((b - a) % (point - a), face) >= 0
+            && Dot((c - b) % (point - b), face) >= 0
+            && Dot((a - c) % (point - c), face) >= 0;
+}
+
+/*
+ * The earliest time in [0, 1] at which q(t) = qa t^2 + qb t + qc, a squared
+ * distance less the squared radius, drops to 0; q(0) is positive
+ */
+bool FirstRoot(double qa, double qb, double qc, double &t) {
+    if (qa <= 0) {
+        //not closing in along this feature
+        return false;
+    }
+    const double discriminant = qb * qb - 4 * qa * qc;
+    if (discriminant < 0) {
+        return false;
+    }
+    //q(0) > 0, so both roots are on the same side of 0
+    const double root = (-qb - std::sqrt(discriminant)) / (2 * qa);
+    if (root < 0 || root > 1) {
+        return false;
+    }
+    t = root;
+    return true;
+}
+
+class FirstTouch {
+public:
+    double when = 2;
+    csVector3 contact;
+
+    void Offer(double t, const csVector3 &point) {
+        if (t < when) {
+            when = t;
+            contact = point;
+        }
+    }
+};
+
+/* The sphere against the corner v; false when the sphere already overlaps it at the start */
+bool TouchCorner(const csVector3 &start, const csVector3 &motion, double radius, const csVector3 &v,
+        FirstTouch &first) {
+    const csVector3 from = start - v;
+    const double qc = Dot(from, from) - radius * radius;
+    if (qc <= 0) {
+        return false;
+    }
+    double t = 0;
+    if (FirstRoot(Dot(motion, motion), 2 * Dot(from, motion), qc, t)) {
+        first.Offer(t, v);
+    }
+    return true;
+}
+
+/*
+ * The sphere against the edge from p to q, leaving its ends to TouchCorner; false when the sphere
+ * already overlaps the edge at the start
+ */
+bool TouchEdge(const csVector3 &start, const csVector3 &motion, double radius, const csVector3 &p,
+        const csVector3 &q, FirstTouch &first) {
+    const csVector3 edge = q - p;
+    const csVector3 from = start - p;
+    const double ee = Dot(edge, edge);
+    if (ee == 0) {
+        return true;
+    }
+    const double em = Dot(edge, motion);
+    const double ef = Dot(edge, from);
+    //ee times the squared distance of the center from the edge's line, less ee radius^2
+    const double qa = ee * Dot(motion, motion) - em * em;
+    const double qb = 2 * (ee * Dot(from, motion) - ef * em);
+    const double qc = ee * (Dot(from, from) - radius * radius) - ef * ef;
+    if (qc <= 0) {
+        //within reach of the line already: overlapping the edge, or the touch comes at one of its ends
+        return ef < 0 || ef > ee;
+    }
+    double t = 0;
+    if (FirstRoot(qa, qb, qc, t)) {
+        const double along = (ef + em * t) / ee;
+        if (along >= 0 && along <= 1) {
+            first.Offer(t, p + edge * float(along));
+        }
+    }
+    return true;
+}
+
+}
+
+bool SweptSphereTouchesTriangle(const csVector3 &start,
+        const csVector3 &motion,
+        float radius,
+        const csVector3 &a,
+        const csVector3 &b,
+        const csVector3 &c,
+        float &when,
+        csVector3 &contact,
+        csVector3 &normal) {
+    const csVector3 face = (b - a) % (c - a);
+    const double area = std::sqrt(Dot(face, face));
+    if (area == 0) {
+        return false;
+    }
+    csVector3 plane_normal = face / float(area);
+    double from = Dot(start - a, plane_normal);
+    if (from < 0) {
+        plane_normal = -plane_normal;
+        from = -from;
+    }
+    //a sphere already overlapping the triangle is left to the mesh against mesh test
+    if (from <= radius && Inside(start - plane_normal * float(from), a, b, c, face)) {
+        return false;
+    }
+    //nothing of the triangle can be touched before its plane is, so a touch inside the face is the first
+    const double approach = -Dot(motion, plane_normal);
+    if (from > radius && approach > 0 && from - radius <= approach) {
+        const double t = (from - radius) / approach;
+        const csVector3 touched = start + motion * float(t) - plane_normal * float(radius);
+        if (Inside(touched, a, b, c, face)) {
+            when = float(t);
+            contact = touched;
+            normal = plane_normal;
+            return true;
+        }
+    }
+    FirstTouch first;
+    if (!TouchEdge(start, motion, radius, a, b, first)
+            || !TouchEdge(start, motion, radius, b, c, first)
+            || !TouchEdge(start, motion, radius, c, a, first)
+            || !TouchCorner(start, motion, radius, a, first)
+            || !TouchCorner(start, motion, radius, b, first)
+            || !TouchCorner(start, motion, radius, c, first)) {
+        return false;
+    }
+    if (first.when > 1) {
+        return false;
+    }
+    when = float(first.when);
+    contact = first.contact;
+    normal = start + motion * when - contact;
+    const double length = std::sqrt(Dot(normal, normal));
+    normal = length > 0 ? normal / float(length) : plane_normal;
+    return true;
+}
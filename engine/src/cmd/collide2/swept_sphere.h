@@ -0,0 +1,53 @@
+/*
+ * swept_sphere.h
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SWEPT_SPHERE_H
+#define SWEPT_SPHERE_H
+
+#include "csgeom2/opvector3.h"
+
+/*
+ * Whether a sphere of the given radius, its center moving from start to
+ * start + motion, touches the triangle a, b, c on the way, and if so when
+ * it first does: through the face, one of the edges or one of the corners.
+ *
+ * when is then the fraction of the motion done at that moment, above 0;
+ * contact is the point of the triangle touched, and normal points from it
+ * to the sphere's center, which for the face is the triangle's normal
+ * facing start. A sphere that already overlaps the triangle at start is
+ * not reported, as the mesh against mesh test finds those; nor are
+ * triangles with no area.
+ */
+bool SweptSphereTouchesTriangle(const csVector3 &start,
+        const csVector3 &motion,
+        float radius,
+        const csVector3 &a,
+        const csVector3 &b,
+        const csVector3 &c,
+        float &when,
+        csVector3 &contact,
+        csVector3 &normal);
+
+#endif // SWEPT_SPHERE_H
@@ -0,0 +1,348 @@
+/*
+ * collision_tree_cache_tests.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "cmd/collide2/Stdafx.h"
+#include "cmd/collide2/collision_tree_cache.h"
+
+using namespace Opcode;
+
+// a wavy sheet of 800 triangles, three vertices each, laid out like csOPCODECollider keeps them
+class Sheet {
+public:
+    static const int kSide = 20;
+
+    explicit Sheet(float wave) {
+        for (int i = 0; i < kSide; ++i) {
+            for (int j = 0; j < kSide; ++j) {
+                const Point p00 = At(i, j, wave);
+                const Point p10 = At(i + 1, j, wave);
+                const Point p01 = At(i, j + 1, wave);
+                const Point p11 = At(i + 1, j + 1, wave);
+                vertices.insert(vertices.end(), {p00, p10, p11, p00, p11, p01});
+            }
+        }
+        mesh.SetCallback(&Triangle, this);
+        mesh.SetNbTriangles(vertices.size() / 3);
+        mesh.SetNbVertices(vertices.size());
+    }
+
+    // builds the tree the way csOPCODECollider does
+    bool Build(Model &model) {
+        OPCODECREATE create;
+        create.mIMesh = &mesh;
+        create.mSettings.mRules = SPLIT_SPLATTER_POINTS | SPLIT_GEOM_CENTER;
+        create.mNoLeaf = true;
+        create.mQuantized = true;
+        return model.Build(create);
+    }
+
+    bool Load(Model &model) {
+        return CollisionTreeCache::Load(vertices.data(), vertices.size(), &mesh, model);
+    }
+
+    void Store(const Model &model) {
+        CollisionTreeCache::Store(vertices.data(), vertices.size(), model);
+    }
+
+    std::vector<Point> vertices;
+    MeshInterface mesh;
+
+private:
+    static Point At(int i, int j, float wave) {
+        return Point(float(i), float(j), wave * std::sin(0.7f * i) * std::cos(0.3f * j));
+    }
+
+    static void Triangle(uint32_t triangle_index, VertexPointers &triangle, void *user_data) {
+        Point *vertices = static_cast<Sheet *>(user_data)->vertices.data();
+        triangle.Vertex[0] = &vertices[3 * triangle_index];
+        triangle.Vertex[1] = &vertices[3 * triangle_index + 1];
+        triangle.Vertex[2] = &vertices[3 * triangle_index + 2];
+    }
+};
+
+static std::vector<uint8_t> Saved(const Model &model) {
+    const AABBQuantizedNoLeafTree *tree = static_cast<const AABBQuantizedNoLeafTree *>(model.GetTree());
+    std::vector<uint8_t> saved(tree->GetSaveSize());
+    tree->Save(saved.data());
+    return saved;
+}
+
+// the triangles a sphere at each point of the sheet's grid touches
+static std::vector<std::vector<uint32_t>> Touched(const Model &model) {
+    SphereCollider collider;
+    collider.SetFirstContact(false);
+    collider.SetTemporalCoherence(false);
+    SphereCache cache;
+    std::vector<std::vector<uint32_t>> touched;
+    for (int i = 0; i <= Sheet::kSide; i += 3) {
+        for (int j = 0; j <= Sheet::kSide; j += 3) {
+            EXPECT_TRUE(collider.Collide(cache, Sphere(Point(float(i), float(j), 0.5f), 1.5f), model));
+            std::vector<uint32_t> primitives(collider.GetTouchedPrimitives(),
+                    collider.GetTouchedPrimitives() + collider.GetNbTouchedPrimitives());
+            std::sort(primitives.begin(), primitives.end());
+            touched.push_back(primitives);
+        }
+    }
+    return touched;
+}
+
+class CollisionTreeCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        directory = boost::filesystem::temp_directory_path()
+                / boost::filesystem::unique_path("vs-collision-trees-%%%%-%%%%-%%%%");
+        boost::filesystem::create_directories(directory);
+        CollisionTreeCache::SetDirectory(directory.string());
+    }
+
+    void TearDown() override {
+        CollisionTreeCache::SetDirectory("");
+        boost::system::error_code error;
+        boost::filesystem::remove_all(directory, error);
+    }
+
+    std::vector<boost::filesystem::path> Files() const {
+        std::vector<boost::filesystem::path> files;
+        boost::filesystem::directory_iterator end;
+        for (boost::filesystem::directory_iterator it(directory); it != end; ++it) {
+            files.push_back(it->path());
+        }
+        return files;
+    }
+
+    boost::filesystem::path directory;
+};
+
+TEST_F(CollisionTreeCacheTest, LoadsBackTheTreeItStored) {
+    Sheet sheet(2.0f);
+    Model built;
+    ASSERT_TRUE(sheet.Build(built));
+    Model loaded;
+    EXPECT_FALSE(sheet.Load(loaded));
+
+    sheet.Store(built);
+    ASSERT_EQ(1u, Files().size());
+    ASSERT_TRUE(sheet.Load(loaded));
+    EXPECT_EQ(Saved(built), Saved(loaded));
+    EXPECT_EQ(built.GetUsedBytes(), loaded.GetUsedBytes());
+
+    const std::vector<std::vector<uint32_t>> expected = Touched(built);
+    size_t touching = 0;
+    for (const std::vector<uint32_t> &primitives : expected) {
+        touching += primitives.empty() ? 0 : 1;
+    }
+    EXPECT_GT(touching, expected.size() / 2);
+    EXPECT_EQ(expected, Touched(loaded));
+}
+
+TEST_F(CollisionTreeCacheTest, IgnoresTruncatedAndMismatchedFiles) {
+    Sheet sheet(2.0f);
+    Model built;
+    ASSERT_TRUE(sheet.Build(built));
+    sheet.Store(built);
+    ASSERT_EQ(1u, Files().size());
+    const boost::filesystem::path file = Files()[0];
+    const uintmax_t length = boost::filesystem::file_size(file);
+
+    Model loaded;
+    boost::filesystem::resize_file(file, length - 1);
+    EXPECT_FALSE(sheet.Load(loaded));
+    boost::filesystem::resize_file(file, 16);
+    EXPECT_FALSE(sheet.Load(loaded));
+
+    // written by another version
+    sheet.Store(built);
+    FILE *stream = fopen(file.string().c_str(), "r+b");
+    ASSERT_NE(nullptr, stream);
+    const uint32_t version = 0xffffffffU;
+    ASSERT_EQ(0, fseek(stream, 4, SEEK_SET));
+    ASSERT_EQ(1u, fwrite(&version, sizeof(version), 1, stream));
+    fclose(stream);
+    EXPECT_FALSE(sheet.Load(loaded));
+
+    // another mesh's tree under this one's name
+    Sheet other(3.0f);
+    Model other_built;
+    ASSERT_TRUE(other.Build(other_built));
+    boost::filesystem::remove(file);
+    other.Store(other_built);
+    ASSERT_EQ(1u, Files().size());
+    boost::filesystem::rename(Files()[0], file);
+    EXPECT_FALSE(sheet.Load(loaded));
+
+    // and a good file again after all that
+    sheet.Store(built);
+    EXPECT_TRUE(sheet.Load(loaded));
+}
+
+TEST_F(CollisionTreeCacheTest, DropsTheLeastRecentlyUsedTreesPastItsLimit) {
+    Sheet first(1.0f);
+    Sheet second(2.0f);
+    Sheet third(3.0f);
+    Model first_built;
+    Model second_built;
+    Model third_built;
+    ASSERT_TRUE(first.Build(first_built));
+    ASSERT_TRUE(second.Build(second_built));
+    ASSERT_TRUE(third.Build(third_built));
+
+    first.Store(first_built);
+    second.Store(second_built);
+    ASSERT_EQ(2u, Files().size());
+    // both a while ago, the first one earlier, and then the first is used again
+    const std::time_t now = std::time(nullptr);
+    boost::filesystem::last_write_time(Files()[0], now - 300);
+    boost::filesystem::last_write_time(Files()[1], now - 300);
+    Model loaded;
+    ASSERT_TRUE(first.Load(loaded));
+
+    // room for two of them
+    uintmax_t one = boost::filesystem::file_size(Files()[0]);
+    CollisionTreeCache::SetDirectory(directory.string(), 2 * one + one / 2);
+    third.Store(third_built);
+    EXPECT_EQ(2u, Files().size());
+    Model first_loaded;
+    Model second_loaded;
+    Model third_loaded;
+    EXPECT_TRUE(first.Load(first_loaded));
+    EXPECT_FALSE(second.Load(second_loaded));
+    EXPECT_TRUE(third.Load(third_loaded));
+}
+
+TEST_F(CollisionTreeCacheTest, StoringATreeAgainTakesNoMoreRoom) {
+    Sheet first(1.0f);
+    Sheet second(2.0f);
+    Model first_built;
+    Model second_built;
+    ASSERT_TRUE(first.Build(first_built));
+    ASSERT_TRUE(second.Build(second_built));
+
+    first.Store(first_built);
+    const uintmax_t one = boost::filesystem::file_size(Files()[0]);
+    CollisionTreeCache::SetDirectory(directory.string(), 2 * one + one / 2);
+    second.Store(second_built);
+    // each replaces its own file, so the two always fit
+    for (int i = 0; i < 3; ++i) {
+        first.Store(first_built);
+        second.Store(second_built);
+    }
+    EXPECT_EQ(2u, Files().size());
+    Model loaded;
+    EXPECT_TRUE(first.Load(loaded));
+    EXPECT_TRUE(second.Load(loaded));
+}
+
+TEST_F(CollisionTreeCacheTest, ListsTheTreesOfASource) {
+    Sheet first(1.0f);
+    Sheet second(2.0f);
+    Model first_built;
+    Model second_built;
+    ASSERT_TRUE(first.Build(first_built));
+    ASSERT_TRUE(second.Build(second_built));
+
+    first.Store(first_built);
+    second.Store(second_built);
+    EXPECT_TRUE(CollisionTreeCache::Files("llama.blank").empty());
+    {
+        CollisionTreeCache::SourceScope scope("llama.blank");
+        Model loaded;
+        ASSERT_TRUE(first.Load(loaded));
+        // listed once however often it is used
+        ASSERT_TRUE(first.Load(loaded));
+    }
+    Model loaded;
+    ASSERT_TRUE(second.Load(loaded));
+    const std::vector<std::string> files = CollisionTreeCache::Files("llama.blank");
+    ASSERT_EQ(1u, files.size());
+
+    // the first sheet's tree, which is no longer listed once it is gone
+    boost::filesystem::remove(files[0]);
+    EXPECT_TRUE(CollisionTreeCache::Files("llama.blank").empty());
+    EXPECT_FALSE(first.Load(loaded));
+    EXPECT_TRUE(second.Load(loaded));
+}
+
+TEST_F(CollisionTreeCacheTest, ListsTreesLoadedOnSeveralThreadsOnce) {
+    // reserved, as a sheet's mesh points back at it
+    std::vector<Sheet> sheets;
+    sheets.reserve(4);
+    for (int i = 0; i < 4; ++i) {
+        sheets.emplace_back(1.0f + i);
+    }
+    for (Sheet &sheet : sheets) {
+        Model built;
+        ASSERT_TRUE(sheet.Build(built));
+        sheet.Store(built);
+    }
+    // every thread loads every tree, all of them under the same source
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&sheets] {
+            CollisionTreeCache::SourceScope scope("llama.blank");
+            for (int pass = 0; pass < 10; ++pass) {
+                for (Sheet &sheet : sheets) {
+                    Model loaded;
+                    EXPECT_TRUE(sheet.Load(loaded));
+                }
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(sheets.size(), CollisionTreeCache::Files("llama.blank").size());
+}
+
+TEST_F(CollisionTreeCacheTest, StoresTheSameTreeOnSeveralThreads) {
+    Sheet sheet(2.0f);
+    Model built;
+    ASSERT_TRUE(sheet.Build(built));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&sheet, &built] {
+            for (int pass = 0; pass < 10; ++pass) {
+                sheet.Store(built);
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    // one whole tree, and nothing left over from writing it
+    ASSERT_EQ(1u, Files().size());
+    EXPECT_EQ(".opc", Files()[0].extension().string());
+    Model loaded;
+    EXPECT_TRUE(sheet.Load(loaded));
+}
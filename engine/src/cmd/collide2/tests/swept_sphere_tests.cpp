@@ -0,0 +1,126 @@
+/*
+ * swept_sphere_tests.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "cmd/collide2/swept_sphere.h"
+
+// a triangle in the z = 0 plane, its corners at the origin, (10, 0, 0) and (0, 10, 0)
+static const csVector3 a(0, 0, 0);
+static const csVector3 b(10, 0, 0);
+static const csVector3 c(0, 10, 0);
+
+TEST(SweptSphere, HeadOnHitsTheFace) {
+    float when = -1;
+    csVector3 contact;
+    csVector3 normal;
+    ASSERT_TRUE(SweptSphereTouchesTriangle(csVector3(2, 2, 10), csVector3(0, 0, -20), 1,
+            a, b, c, when, contact, normal));
+    // the sphere's surface reaches the face when its center is 1 above it
+    EXPECT_NEAR(9.0f / 20.0f, when, 1e-5f);
+    EXPECT_NEAR(2.0f, contact.x, 1e-4f);
+    EXPECT_NEAR(2.0f, contact.y, 1e-4f);
+    EXPECT_NEAR(0.0f, contact.z, 1e-4f);
+    EXPECT_NEAR(1.0f, normal.z, 1e-5f);
+}
+
+TEST(SweptSphere, GrazingTouchesTheEdge) {
+    float when = -1;
+    csVector3 contact;
+    csVector3 normal;
+    // passes beside the edge from a to b, 0.5 off it sideways and coming down past it
+    ASSERT_TRUE(SweptSphereTouchesTriangle(csVector3(5, -0.5f, 10), csVector3(0, 0, -20), 1,
+            a, b, c, when, contact, normal));
+    // the center comes within 1 of the edge when it is sqrt(0.75) above it
+    EXPECT_NEAR((10.0f - std::sqrt(0.75f)) / 20.0f, when, 1e-5f);
+    EXPECT_NEAR(5.0f, contact.x, 1e-4f);
+    EXPECT_NEAR(0.0f, contact.y, 1e-4f);
+    EXPECT_NEAR(0.0f, contact.z, 1e-4f);
+    EXPECT_NEAR(-0.5f, normal.y, 1e-4f);
+    EXPECT_NEAR(std::sqrt(0.75f), normal.z, 1e-4f);
+}
+
+TEST(SweptSphere, GrazingTouchesACorner) {
+    float when = -1;
+    csVector3 contact;
+    csVector3 normal;
+    ASSERT_TRUE(SweptSphereTouchesTriangle(csVector3(-0.3f, -0.4f, 10), csVector3(0, 0, -20), 1,
+            a, b, c, when, contact, normal));
+    // 0.5 off the corner sideways, so it touches the corner when sqrt(0.75) above it
+    EXPECT_NEAR((10.0f - std::sqrt(0.75f)) / 20.0f, when, 1e-5f);
+    EXPECT_EQ(0.0f, contact.x);
+    EXPECT_EQ(0.0f, contact.y);
+    EXPECT_EQ(0.0f, contact.z);
+}
+
+TEST(SweptSphere, MissesBesideTheTriangle) {
+    float when = -1;
+    csVector3 contact;
+    csVector3 normal;
+    EXPECT_FALSE(SweptSphereTouchesTriangle(csVector3(5, -1.5f, 10), csVector3(0, 0, -20), 1,
+            a, b, c, when, contact, normal));
+    EXPECT_FALSE(SweptSphereTouchesTriangle(csVector3(20, 20, 10), csVector3(0, 0, -20), 1,
+            a, b, c, when, contact, normal));
+    // stops short of the face
+    EXPECT_FALSE(SweptSphereTouchesTriangle(csVector3(2, 2, 10), csVector3(0, 0, -8.5f), 1,
+            a, b, c, when, contact, normal));
+    EXPECT_EQ(-1, when);
+}
+
+TEST(SweptSphere, NearThePlaneButFarFromTheTriangleIsNoHitAtTheStart) {
+    float when = -1;
+    csVector3 contact;
+    csVector3 normal;
+    // starts within its radius of the plane, away from the triangle, and moves in to the edge from b to c
+    ASSERT_TRUE(SweptSphereTouchesTriangle(csVector3(10, 10, 0.5f), csVector3(-10, -10, 0), 1,
+            a, b, c, when, contact, normal));
+    // the center comes within 1 of the edge when sqrt(0.75) from it in the plane
+    EXPECT_NEAR((10.0f - std::sqrt(1.5f)) / 20.0f, when, 1e-5f);
+    EXPECT_NEAR(5.0f, contact.x, 1e-3f);
+    EXPECT_NEAR(5.0f, contact.y, 1e-3f);
+    EXPECT_NEAR(0.0f, contact.z, 1e-4f);
+
+}
+
+TEST(SweptSphere, AlreadyOverlappingIsNoHit) {
+    float when = -1;
+    csVector3 contact;
+    csVector3 normal;
+    // overlapping the face, and moving away from it
+    EXPECT_FALSE(SweptSphereTouchesTriangle(csVector3(2, 2, 0.5f), csVector3(0, 0, 5), 1,
+            a, b, c, when, contact, normal));
+    // overlapping the face, and moving across it
+    EXPECT_FALSE(SweptSphereTouchesTriangle(csVector3(2, 2, 0.5f), csVector3(5, 0, 0), 1,
+            a, b, c, when, contact, normal));
+    // overlapping only the edge from a to b, and moving away from it
+    EXPECT_FALSE(SweptSphereTouchesTriangle(csVector3(5, -0.5f, 0.5f), csVector3(0, -5, 5), 1,
+            a, b, c, when, contact, normal));
+    // overlapping only the corner a, and moving away from it
+    EXPECT_FALSE(SweptSphereTouchesTriangle(csVector3(-0.5f, -0.5f, 0), csVector3(-5, -5, 0), 1,
+            a, b, c, when, contact, normal));
+    EXPECT_EQ(-1, when);
+}
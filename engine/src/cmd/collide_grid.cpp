@@ -0,0 +1,77 @@
+/*
+ * collide_grid.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "collide_grid.h"
+
+#include <algorithm>
+
+#include "collide_map.h"
+
+const int64_t GridCellKey::MAX_CELL;
+
+void CollideGrid::SetCellSize(double cell_size) {
+    if (!(cell_size > 0.0)) {
+        cell_size = 1000.0;
+    }
+    this->cell_size = cell_size;
+    inverse_cell_size = 1.0 / cell_size;
+}
+
+void CollideGrid::Clear() {
+    indices.clear();
+    scratch.clear();
+    cells.clear();
+    oversized.clear();
+}
+
+void CollideGrid::Build(const Collidable *elements, size_t count) {
+    Clear();
+    for (size_t i = 0; i < count; ++i) {
+        const float radius = std::fabs(elements[i].radius);
+        if (radius == 0.0f) {
+            continue;
+        }
+        const QVector &position = elements[i].position;
+        // NaN radii and positions never pass the cell test below, so they land in the always-visited list
+        if (radius <= cell_size && position.i == position.i && position.j == position.j && position.k == position.k) {
+            scratch.push_back(std::make_pair(GridCellKey(position, inverse_cell_size), static_cast<uint32_t>(i)));
+        } else {
+            oversized.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    std::sort(scratch.begin(), scratch.end());
+
+    indices.resize(scratch.size());
+    Range *range = NULL;
+    for (size_t i = 0; i < scratch.size(); ++i) {
+        indices[i] = scratch[i].second;
+        if (i == 0 || !(scratch[i].first == scratch[i - 1].first)) {
+            // map nodes never move, so the pointer stays valid as the map grows
+            range = &cells[scratch[i].first];
+            *range = Range(static_cast<uint32_t>(i), static_cast<uint32_t>(i));
+        }
+        ++range->second;
+    }
+}
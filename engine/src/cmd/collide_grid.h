@@ -0,0 +1,206 @@
+/*
+ * collide_grid.h
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef COLLIDE_GRID_H
+#define COLLIDE_GRID_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "gfx/vec.h"
+#include "gnuhash.h"
+
+class Collidable;
+
+/* Integer coordinates of a cell in a uniform 3D grid */
+struct GridCellKey {
+    int64_t i;
+    int64_t j;
+    int64_t k;
+
+    GridCellKey() : i(0), j(0), k(0) {
+    }
+
+    GridCellKey(double x, double y, double z, double inverse_cell_size) :
+            i(Cell(x * inverse_cell_size)),
+            j(Cell(y * inverse_cell_size)),
+            k(Cell(z * inverse_cell_size)) {
+    }
+
+    GridCellKey(const QVector &position, double inverse_cell_size) :
+            GridCellKey(position.i, position.j, position.k, inverse_cell_size) {
+    }
+
+    bool operator==(const GridCellKey &other) const {
+        return i == other.i && j == other.j && k == other.k;
+    }
+
+    bool operator<(const GridCellKey &other) const {
+        return i != other.i ? i < other.i : (j != other.j ? j < other.j : k < other.k);
+    }
+
+    /*
+     * The cell of a coordinate already divided by the cell size. Coordinates
+     * past MAX_CELL cells, infinities included, share the outermost cell, so
+     * anything that overlaps a box still has its cell inside the box's cells.
+     * NaN has no place in the grid and goes to cell 0; callers that care keep
+     * NaN positions out of the cells.
+     */
+    static int64_t Cell(double scaled) {
+        static const double max_cell = static_cast<double>(MAX_CELL);
+        const double cell = std::floor(scaled);
+        if (cell >= max_cell) {
+            return MAX_CELL;
+        }
+        if (cell <= -max_cell) {
+            return -MAX_CELL;
+        }
+        if (!(cell == cell)) {
+            return 0;
+        }
+        return static_cast<int64_t>(cell);
+    }
+
+    // far enough out for any sensible cell size, near enough that spans and hashes cannot overflow
+    static const int64_t MAX_CELL = static_cast<int64_t>(1) << 40;
+};
+
+struct GridCellKeyHash {
+    size_t operator()(const GridCellKey &key) const {
+        // Large primes from the classic spatial hashing paper (Teschner et al.)
+        return static_cast<size_t>((static_cast<uint64_t>(key.i) * 73856093u)
+                ^ (static_cast<uint64_t>(key.j) * 19349663u)
+                ^ (static_cast<uint64_t>(key.k) * 83492791u));
+    }
+};
+
+/*
+ * CollideGrid is a uniform hashed grid over the sorted array of a CollideArray.
+ * It is the alternative to sweeping the x-sorted array: a query only visits
+ * the cells around the query position on all three axes, so collidables lined
+ * up along y or z, or clustered at similar x, no longer degrade every query
+ * to a walk over most of the array.
+ *
+ * The grid is rebuilt from scratch on every flatten() and refers to
+ * collidables by their index in the array it was built from. Collidables
+ * wider than a cell are kept in a separate list that every query visits.
+ */
+class CollideGrid {
+public:
+    CollideGrid() {
+        SetCellSize(1000.0);
+    }
+
+    void SetCellSize(double cell_size);
+
+    double GetCellSize() const {
+        return cell_size;
+    }
+
+    /* Rebuilds the grid over elements[0, count); to-be-deleted entries (radius 0) are left out */
+    void Build(const Collidable *elements, size_t count);
+    void Clear();
+
+    bool empty() const {
+        return indices.empty() && oversized.empty();
+    }
+
+    /*
+     * Calls visit(index) for every oversized element and for every element
+     * whose cell overlaps the box of the given center and half extents.
+     * The caller does the exact test. Returns true as soon as visit returns
+     * true, which lets callers stop at the first hit.
+     */
+    template<class Visitor>
+    bool Query(const QVector &center, double half_x, double half_yz, Visitor &visit) const {
+        for (std::vector<uint32_t>::const_iterator it = oversized.begin(); it != oversized.end(); ++it) {
+            if (visit(*it)) {
+                return true;
+            }
+        }
+        if (cells.empty()) {
+            return false;
+        }
+        const GridCellKey lo(center.i - half_x, center.j - half_yz, center.k - half_yz, inverse_cell_size);
+        const GridCellKey hi(center.i + half_x, center.j + half_yz, center.k + half_yz, inverse_cell_size);
+        const double span = static_cast<double>(hi.i - lo.i + 1)
+                * static_cast<double>(hi.j - lo.j + 1)
+                * static_cast<double>(hi.k - lo.k + 1);
+        if (!(span <= static_cast<double>(cells.size()))) {
+            // More cells in the box than occupied cells; walk the occupied ones instead
+            for (CellMap::const_iterator cell = cells.begin(); cell != cells.end(); ++cell) {
+                if (cell->first.i < lo.i || cell->first.i > hi.i
+                        || cell->first.j < lo.j || cell->first.j > hi.j
+                        || cell->first.k < lo.k || cell->first.k > hi.k) {
+                    continue;
+                }
+                if (VisitRange(cell->second, visit)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        GridCellKey key;
+        for (key.i = lo.i; key.i <= hi.i; ++key.i) {
+            for (key.j = lo.j; key.j <= hi.j; ++key.j) {
+                for (key.k = lo.k; key.k <= hi.k; ++key.k) {
+                    CellMap::const_iterator cell = cells.find(key);
+                    if (cell != cells.end() && VisitRange(cell->second, visit)) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+private:
+    typedef std::pair<uint32_t, uint32_t> Range;
+    typedef vsUMap<GridCellKey, Range, GridCellKeyHash> CellMap;
+
+    template<class Visitor>
+    bool VisitRange(const Range &range, Visitor &visit) const {
+        for (uint32_t i = range.first; i != range.second; ++i) {
+            if (visit(indices[i])) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    double cell_size;
+    double inverse_cell_size;
+
+    // element indices grouped by cell; cells maps each occupied cell to its slice
+    std::vector<uint32_t> indices;
+    std::vector<std::pair<GridCellKey, uint32_t> > scratch;
+    CellMap cells;
+    std::vector<uint32_t> oversized;
+};
+
+#endif // COLLIDE_GRID_H
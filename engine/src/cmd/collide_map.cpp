@@ -29,6 +29,7 @@
 #include "star_system.h"
 #include "universe.h"
 #include "vs_logging.h"
+#include "configuration/configuration.h"
 
 volatile bool apart_return = true;
 
@@ -81,6 +82,15 @@ CollideArray::iterator CollideArray::changeKey(CollideArray::iterator iter, cons
 
 float CollideArray::max_bolt_radius = 0;
 
+void CollideArray::ConfigureBroadphase() {
+    const std::string broadphase = configuration()->physics_config.collide_map_broadphase;
+    use_grid = (broadphase == "grid");
+    if (!use_grid && broadphase != "sweep") {
+        VS_LOG(warning, (boost::format("Unknown physics.collide_map_broadphase '%1%', using sweep") % broadphase));
+    }
+    grid.SetCellSize(configuration()->physics_config.collide_grid_cell_size);
+}
+
 CollideArray::iterator CollideArray::changeKey(CollideArray::iterator iter,
         const Collidable &newKey,
         CollideArray::iterator tless,
@@ -193,6 +203,9 @@ void CollideArray::flatten() {
         assert(0
                 && "Only Support arrays of units_only and mixed units bolts");         //right now only support 2 array types;
     }
+    if (use_grid) {
+        grid.Build(this->begin(), sorted.size());
+    }
 }
 
 class CopyExample : public UpdateBackpointers<Unit::UNIT_ONLY> {
@@ -231,6 +244,9 @@ void CollideArray::flatten(CollideArray &hint) {
         toflattenhints.resize(count + 1);
 
         for_each(sorted.begin(), sorted.end(), CopyExample(hint.sorted.begin(), hint.sorted.end()));
+        if (use_grid) {
+            grid.Build(this->begin(), sorted.size());
+        }
     } else {
         VS_LOG(info, "Trying to use flatten hint on a array with both bolts and units");
         flatten();
@@ -480,6 +496,9 @@ public:
         if (ComputeMaxLookMinLook(un, cm, startIter, cmbegin, cmend, sortedloc, rad, minlook, maxlook)) {
             return false;
         }  //no units in area
+        if (cm->UsesGrid()) {
+            return CheckCollisionsGrid(cm, un, collider, location_index, startIter, minlook, maxlook);
+        }
         if (!cm->Iterable(startIter)) {
             CollideArray::CollidableBackref *br = static_cast< CollideArray::CollidableBackref * > (startIter);
             CollideMap::iterator tmploc = cmbegin + br->toflattenhints_offset;
@@ -500,6 +519,37 @@ public:
                 minlook, maxlook);
     }
 
+    //Same candidates as the sweep (x key within [minlook, maxlook]), but only those whose grid cells are near on y and z
+    static bool CheckCollisionsGrid(CollideMap *cm,
+            T *un,
+            const Collidable &collider,
+            unsigned int location_index,
+            CollideMap::iterator self,
+            double minlook,
+            double maxlook) {
+        CollideMap::iterator cmbegin = cm->begin();
+        double sortedloc = collider.getKey();
+        double half_x = std::max(maxlook - sortedloc, sortedloc - minlook);
+        //anything that can touch the collider is within both radii of it, and binned collidables are at most a cell wide
+        double half_yz = fabs(collider.radius) + cm->grid.GetCellSize();
+        auto visit = [&](uint32_t index) -> bool {
+            CollideMap::iterator candidate = cmbegin + index;
+            double key = candidate->getKey();
+            if (candidate == self || key < minlook || key > maxlook) {
+                return false;
+            }
+            float rad = candidate->radius;
+            if (canbebolt && rad < 0) {
+                return CheckCollision(un, collider, candidate->ref, *candidate) && endAfterCollide(un, location_index);
+            } else if (rad > 0) {
+                return CheckCollision(un, collider, candidate->ref.unit, *candidate)
+                        && endAfterCollide(un, location_index);
+            }
+            return false;
+        };
+        return cm->grid.Query(collider.GetPosition(), half_x, half_yz, visit);
+    }
+
     static bool doUpdateKey(Bolt *b) {
         return true;
     }
@@ -583,13 +633,26 @@ bool CollideMap::CheckUnitCollisions(Bolt *bol, const Collidable &updated) {
     return CollideChecker<Bolt, false>::CheckCollisions(this, bol, updated, Unit::UNIT_ONLY);
 }
 
+//A unit that moves further than its size in an atom has to find everything along the way, so its own
+//query is widened by the distance; the radius it is stored with, which others look at, stays its size
+static Collidable SweptCollider(Unit *un, const Collidable &updated) {
+    Collidable swept(updated);
+    if (configuration()->physics_config.continuous_collision && swept.radius > 0) {
+        const float travel = un->GetWarpVelocity().Magnitude() * simulation_atom_var;
+        if (travel > swept.radius) {
+            swept.radius += travel;
+        }
+    }
+    return swept;
+}
+
 bool CollideMap::CheckCollisions(Unit *un, const Collidable &updated) {
     //need to check beams
     if (un->activeStarSystem == NULL) {
         un->activeStarSystem = _Universe->activeStarSystem();
     } else
         assert(un->activeStarSystem == _Universe->activeStarSystem());
-    return CollideChecker<Unit, true>::CheckCollisions(this, un, updated, Unit::UNIT_BOLT);
+    return CollideChecker<Unit, true>::CheckCollisions(this, un, SweptCollider(un, updated), Unit::UNIT_BOLT);
 }
 
 bool CollideMap::CheckUnitCollisions(Unit *un, const Collidable &updated) {
@@ -598,6 +661,6 @@ bool CollideMap::CheckUnitCollisions(Unit *un, const Collidable &updated) {
         un->activeStarSystem = _Universe->activeStarSystem();
     } else
         assert(un->activeStarSystem == _Universe->activeStarSystem());
-    return CollideChecker<Unit, false>::CheckCollisions(this, un, updated, Unit::UNIT_ONLY);
+    return CollideChecker<Unit, false>::CheckCollisions(this, un, SweptCollider(un, updated), Unit::UNIT_ONLY);
 }
 
@@ -28,6 +28,7 @@
 #ifndef _COLLIDE_MAP_H_
 #define _COLLIDE_MAP_H_
 #include "key_mutable_set.h"
+#include "collide_grid.h"
 #include "vegastrike.h"
 #include "gfx/vec.h"
 #if defined (_WIN32) || __GNUC__ != 2
@@ -66,6 +67,21 @@ public:
 #endif
     }
 
+    //same as SetPosition, without going through a QVector
+    void SetPosition(double x, double y, double z) {
+#ifdef __APPLE__
+        if ( !FINITE( x ) )
+#else
+        if (ISNAN(x))
+#endif
+        {
+            x = y = z = 0;      //same hack as above
+        }
+        position.i = x;
+        position.j = y;
+        position.k = z;
+    }
+
     Collidable &operator*() {
         return *this;
     }
@@ -149,6 +165,15 @@ public:
     ResizableArray unsorted;
     std::vector<std::list<CollidableBackref> > toflattenhints;
     unsigned int count;
+    //alternative broadphase over sorted, rebuilt on flatten when physics.collide_map_broadphase is "grid"
+    CollideGrid grid;
+    bool use_grid;
+
+    bool UsesGrid() const {
+        return use_grid;
+    }
+
+    void ConfigureBroadphase();
     void UpdateBoltInfo(iterator iter, Collidable::CollideRef ref);
     void flatten();
     void flatten(CollideArray &example); //maybe it has some xtra bolts
@@ -157,6 +182,22 @@ public:
     iterator changeKey(iterator iter, const Collidable &newKey);
     iterator changeKey(iterator iter, const Collidable &newKey, iterator tless, iterator tmore);
 
+    //Moves count bolts at once, the n-th one from location(n) to (x[n], y[n], z[n]). Like changeKey, for
+    //the ones in the sorted range only the unsorted copy moves, and flatten puts them back in order.
+    template<class LocationF>
+    void changePositions(size_t count, LocationF location, const double *x, const double *y, const double *z) {
+        iterator first = this->begin();
+        iterator last = this->end();
+        iterator shadow = unsorted.empty() ? NULL : &unsorted[0];
+        for (size_t n = 0; n < count; ++n) {
+            iterator iter = location(n);
+            if (iter >= first && iter < last) {
+                iter = shadow + (iter - first);
+            }
+            iter->SetPosition(x[n], y[n], z[n]);
+        }
+    }
+
     iterator begin() {
         return sorted.size() != 0 ? &*sorted.begin() : NULL;
     }
@@ -171,6 +212,7 @@ public:
 
     CollideArray(unsigned int location_index) : toflattenhints(1), count(0) {
         this->location_index = location_index;
+        ConfigureBroadphase();
     }
 };
 
@@ -0,0 +1,581 @@
+/*
+ * contiguous_collection.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+/* Included by collection.cpp when USE_CONTIGUOUS_COLLECTION is chosen */
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#ifndef LIST_TESTING
+#include "unit_util.h"
+#include "unit_generic.h"
+
+#else
+#include "testcollection/unit.h"
+#endif
+
+#include "vs_logging.h"
+
+using std::vector;
+//UnitIterator  BEGIN:
+
+UnitCollection::UnitIterator &UnitCollection::UnitIterator::operator=(const UnitCollection::UnitIterator &orig) {
+    if (col != orig.col) {
+        if (col) {
+            col->unreg(this);
+        }
+        col = orig.col;
+        if (col) {
+            col->reg(this);
+        }
+    }
+    pos = orig.pos;
+    moved_on = orig.moved_on;
+    return *this;
+}
+
+UnitCollection::UnitIterator::UnitIterator(const UnitIterator &orig) {
+    col = orig.col;
+    pos = orig.pos;
+    moved_on = orig.moved_on;
+    if (col) {
+        col->reg(this);
+    }
+}
+
+UnitCollection::UnitIterator::UnitIterator(UnitCollection *orig) {
+    col = orig;
+    pos = col->head;
+    moved_on = false;
+    col->reg(this);
+    settle();
+}
+
+UnitCollection::UnitIterator::~UnitIterator() {
+    if (col) {
+        col->unreg(this);
+    }
+}
+
+void UnitCollection::UnitIterator::settle() {
+    while (col && pos < col->u.size()) {
+        Unit *unit = col->u[pos];
+        if (unit == NULL) {
+            ++pos;
+        } else if (unit->Killed()) {
+            //we are registered, so this only leaves a tombstone behind
+            col->erase(pos);
+        } else {
+            break;
+        }
+    }
+    moved_on = false;
+}
+
+void UnitCollection::UnitIterator::remove() {
+    if (col && col->skipTombstones(pos) < col->u.size()) {
+        col->erase(pos);
+        settle();
+    }
+}
+
+void UnitCollection::UnitIterator::moveBefore(UnitCollection &otherlist) {
+    if (col && col->skipTombstones(pos) < col->u.size()) {
+        Unit *unit = col->u[pos];
+        //keep it alive between leaving this list and joining the other
+        unit->Ref();
+        col->erase(pos);
+        otherlist.prepend(unit);
+        unit->UnRef();
+        settle();
+    }
+}
+
+void UnitCollection::UnitIterator::preinsert(Unit *unit) {
+    if (col && unit) {
+        col->insert(std::min(pos, col->u.size()), unit);
+        pos = col->u.size();
+        moved_on = false;
+    }
+}
+
+void UnitCollection::UnitIterator::postinsert(Unit *unit) {
+    if (col && unit && pos < col->u.size()) {
+        col->insert(pos + 1, unit);
+    }
+}
+
+void UnitCollection::UnitIterator::advance() {
+    if (!col || pos >= col->u.size()) {
+        return;
+    }
+    if (!moved_on) {
+        ++pos;
+    }
+    settle();
+}
+
+Unit *UnitCollection::UnitIterator::next() {
+    advance();
+    return **this;
+}
+
+//UnitIterator END:
+
+//ConstIterator Begin:
+
+UnitCollection::ConstIterator &UnitCollection::ConstIterator::operator=(const UnitCollection::ConstIterator &orig) {
+    if (col != orig.col) {
+        if (col) {
+            col->unreg(this);
+        }
+        col = orig.col;
+        if (col) {
+            col->reg(this);
+        }
+    }
+    pos = orig.pos;
+    moved_on = orig.moved_on;
+    return *this;
+}
+
+UnitCollection::ConstIterator::ConstIterator(const ConstIterator &orig) {
+    col = orig.col;
+    pos = orig.pos;
+    moved_on = orig.moved_on;
+    if (col) {
+        col->reg(this);
+    }
+}
+
+UnitCollection::ConstIterator::ConstIterator(const UnitCollection *orig) {
+    col = orig;
+    pos = col->head;
+    moved_on = false;
+    col->reg(this);
+    settle();
+}
+
+UnitCollection::ConstIterator::~ConstIterator() {
+    if (col) {
+        col->unreg(this);
+    }
+}
+
+inline void UnitCollection::ConstIterator::settle() {
+    while (pos < col->u.size() && (col->u[pos] == NULL || col->u[pos]->Killed())) {
+        ++pos;
+    }
+}
+
+Unit *UnitCollection::ConstIterator::next() {
+    advance();
+    return **this;
+}
+
+void UnitCollection::ConstIterator::advance() {
+    if (!col || pos >= col->u.size()) {
+        return;
+    }
+    if (!moved_on) {
+        ++pos;
+    }
+    moved_on = false;
+    settle();
+}
+
+const UnitCollection::ConstIterator &UnitCollection::ConstIterator::operator++() {
+    advance();
+    return *this;
+}
+
+const UnitCollection::ConstIterator UnitCollection::ConstIterator::operator++(int) {
+    UnitCollection::ConstIterator tmp(*this);
+    advance();
+    return tmp;
+}
+
+//ConstIterator  END:
+
+//UnitCollection  BEGIN:
+
+UnitCollection::UnitCollection() {
+    activeIters.reserve(20);
+}
+
+UnitCollection::UnitCollection(const UnitCollection &uc) {
+    for (size_t i = uc.head; i < uc.u.size(); ++i) {
+        append(uc.u[i]);
+    }
+}
+
+inline void UnitCollection::track(size_t position) {
+    if (tracks_units) {
+        u[position]->physics_queue_slot.col = this;
+        u[position]->physics_queue_slot.position = position;
+    }
+}
+
+inline void UnitCollection::untrack(size_t position) {
+    //the unit may have been moved to another tracking collection already
+    if (tracks_units && u[position]->physics_queue_slot.col == this
+            && u[position]->physics_queue_slot.position == position) {
+        u[position]->physics_queue_slot.col = NULL;
+    }
+}
+
+void UnitCollection::shiftPositions(size_t from, ptrdiff_t shift) {
+    for (vector<un_iter *>::iterator t = activeIters.begin(); t != activeIters.end(); ++t) {
+        if ((*t)->pos >= from) {
+            (*t)->pos += shift;
+        }
+    }
+    for (vector<un_kiter *>::iterator t = activeConstIters.begin(); t != activeConstIters.end(); ++t) {
+        if ((*t)->pos >= from) {
+            (*t)->pos += shift;
+        }
+    }
+    if (tracks_units) {
+        for (size_t i = std::max(from, head); i < u.size(); ++i) {
+            if (u[i]) {
+                track(i);
+            }
+        }
+    }
+}
+
+bool UnitCollection::moveToFront(Unit *unit, UnitCollection &target) {
+    if (!unit || unit->physics_queue_slot.col != this) {
+        return false;
+    }
+    unit->Ref();
+    erase(unit->physics_queue_slot.position);
+    target.prepend(unit);
+    unit->UnRef();
+    return true;
+}
+
+bool UnitCollection::removeTracked(Unit *unit) {
+    if (!unit || unit->physics_queue_slot.col != this) {
+        return false;
+    }
+    erase(unit->physics_queue_slot.position);
+    return true;
+}
+
+void UnitCollection::insert_unique(Unit *unit) {
+    if (unit) {
+        for (size_t i = head; i < u.size(); ++i) {
+            if (u[i] == unit) {
+                return;
+            }
+        }
+        prepend(unit);
+    }
+}
+
+void UnitCollection::growFront() {
+    //as much room as the list takes up now, so prepending is amortized constant time
+    const size_t gap = std::max<size_t>(16, u.size() - head);
+    u.insert(u.begin(), gap, NULL);
+    head += gap;
+    shiftPositions(0, gap);
+}
+
+void UnitCollection::prepend(Unit *unit) {
+    if (unit) {
+        if (head == 0) {
+            growFront();
+        }
+        unit->Ref();
+        u[--head] = unit;
+        ++live;
+        track(head);
+    }
+}
+
+void UnitCollection::prepend(UnitIterator *it) {
+    if (!it) {
+        return;
+    }
+    vector<Unit *> units;
+    Unit *tmp = NULL;
+    while ((tmp = **it)) {
+        units.push_back(tmp);
+        it->advance();
+    }
+    //keeping their order, in front of the units already there
+    for (vector<Unit *>::reverse_iterator unit = units.rbegin(); unit != units.rend(); ++unit) {
+        prepend(*unit);
+    }
+}
+
+void UnitCollection::append(Unit *un) {
+    if (un) {
+        un->Ref();
+        u.push_back(un);
+        ++live;
+        track(u.size() - 1);
+    }
+}
+
+void UnitCollection::append(UnitIterator *it) {
+    if (!it) {
+        return;
+    }
+    Unit *tmp = NULL;
+    while ((tmp = **it)) {
+        append(tmp);
+        it->advance();
+    }
+}
+
+void UnitCollection::insert(size_t position, Unit *unit) {
+    if (position <= head) {
+        prepend(unit);
+    } else if (position >= u.size()) {
+        append(unit);
+    } else {
+        unit->Ref();
+        u.insert(u.begin() + position, unit);
+        ++live;
+        shiftPositions(position, 1);
+        track(position);
+    }
+}
+
+void UnitCollection::clear() {
+    if (!activeIters.empty()) {
+        VS_LOG(warning, "WARNING! Attempting to clear a collection with active iterators!\n");
+        return;
+    }
+    vector<Unit *> units;
+    units.reserve(live);
+    for (size_t i = head; i < u.size(); ++i) {
+        if (u[i]) {
+            untrack(i);
+            units.push_back(u[i]);
+        }
+    }
+    u.clear();
+    head = live = tombstones = 0;
+    //read-only loops over what was there are done now
+    for (vector<un_kiter *>::iterator t = activeConstIters.begin(); t != activeConstIters.end(); ++t) {
+        (*t)->col = NULL;
+    }
+    activeConstIters.clear();
+    for (vector<Unit *>::iterator unit = units.begin(); unit != units.end(); ++unit) {
+        (*unit)->UnRef();
+    }
+}
+
+void UnitCollection::destr() {
+    for (size_t i = head; i < u.size(); ++i) {
+        if (u[i]) {
+            untrack(i);
+            u[i]->UnRef();
+            u[i] = NULL;
+        }
+    }
+    tombstones += live;
+    live = 0;
+    for (vector<un_iter *>::iterator t = activeIters.begin(); t != activeIters.end(); ++t) {
+        (*t)->col = NULL;
+    }
+    activeIters.clear();
+    for (vector<un_kiter *>::iterator t = activeConstIters.begin(); t != activeConstIters.end(); ++t) {
+        (*t)->col = NULL;
+    }
+    activeConstIters.clear();
+}
+
+bool UnitCollection::contains(const Unit *unit) const {
+    if (!unit) {
+        return false;
+    }
+    for (size_t i = head; i < u.size(); ++i) {
+        if (u[i] == unit && !u[i]->Killed()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void UnitCollection::erase(size_t position) {
+    Unit *unit = u[position];
+    if (!unit) {
+        return;
+    }
+    untrack(position);
+    u[position] = NULL;
+    --live;
+    ++tombstones;
+    compactIfWorthIt();
+    //last, as it may delete the unit, and that may come back to us
+    unit->UnRef();
+}
+
+void UnitCollection::compactIfWorthIt() {
+    while (head < u.size() && !u[head]) {
+        ++head;
+        --tombstones;
+    }
+    while (u.size() > head && !u.back()) {
+        u.pop_back();
+        --tombstones;
+    }
+    if (live == 0) {
+        u.clear();
+        head = 0;
+    }
+    //iterators past the units that are left are done
+    for (vector<un_iter *>::iterator t = activeIters.begin(); t != activeIters.end(); ++t) {
+        (*t)->pos = std::min((*t)->pos, u.size());
+    }
+    for (vector<un_kiter *>::iterator t = activeConstIters.begin(); t != activeConstIters.end(); ++t) {
+        (*t)->pos = std::min((*t)->pos, u.size());
+    }
+    if (tombstones < 16 || tombstones * 4 < live) {
+        return;
+    }
+    //an iterator goes with the first unit at or after it, which is where it would settle anyway.
+    //One that was on a tombstone is marked, so that its next advance stops on that unit
+    struct Held {
+        size_t pos;
+        size_t *at;
+        bool *moved_on;
+
+        bool operator<(const Held &other) const {
+            return pos < other.pos;
+        }
+    };
+    vector<Held> iters;
+    iters.reserve(activeIters.size() + activeConstIters.size());
+    for (vector<un_iter *>::iterator t = activeIters.begin(); t != activeIters.end(); ++t) {
+        Held held = {(*t)->pos, &(*t)->pos, &(*t)->moved_on};
+        iters.push_back(held);
+    }
+    for (vector<un_kiter *>::iterator t = activeConstIters.begin(); t != activeConstIters.end(); ++t) {
+        Held held = {(*t)->pos, &(*t)->pos, &(*t)->moved_on};
+        iters.push_back(held);
+    }
+    std::sort(iters.begin(), iters.end());
+    vector<Held>::reverse_iterator iter = iters.rbegin();
+    //slide the units to the back, which leaves the room in front for prepending
+    size_t to = u.size();
+    while (iter != iters.rend() && iter->pos >= u.size()) {
+        ++iter;
+    }
+    for (size_t from = u.size(); from-- > head;) {
+        if (u[from]) {
+            u[--to] = u[from];
+        }
+        for (; iter != iters.rend() && iter->pos == from; ++iter) {
+            *iter->at = to;
+            if (!u[from]) {
+                *iter->moved_on = true;
+            }
+        }
+    }
+    for (; iter != iters.rend(); ++iter) {
+        *iter->at = to;
+        *iter->moved_on = true;
+    }
+    std::fill(u.begin() + head, u.begin() + to, static_cast<Unit *>(NULL));
+    head = to;
+    tombstones = 0;
+    shiftPositions(head, 0);
+}
+
+bool UnitCollection::remove(const Unit *unit) {
+    if (!unit) {
+        return false;
+    }
+    for (size_t i = head; i < u.size(); ++i) {
+        if (u[i] == unit) {
+            erase(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+Unit *UnitCollection::back() {
+    for (size_t i = u.size(); i-- > head;) {
+        if (u[i]) {
+            return u[i];
+        }
+    }
+    return NULL;
+}
+
+Unit *UnitCollection::front() {
+    for (size_t i = head; i < u.size(); ++i) {
+        if (u[i]) {
+            return u[i];
+        }
+    }
+    return NULL;
+}
+
+const UnitCollection &UnitCollection::operator=(const UnitCollection &uc) {
+    destr();
+    u.clear();
+    head = live = tombstones = 0;
+    for (size_t i = uc.head; i < uc.u.size(); ++i) {
+        append(uc.u[i]);
+    }
+    return *this;
+}
+
+inline void UnitCollection::reg(un_iter *iter) {
+    activeIters.push_back(iter);
+}
+
+inline void UnitCollection::unreg(un_iter *iter) {
+    for (vector<un_iter *>::iterator t = activeIters.begin(); t != activeIters.end(); ++t) {
+        if ((*t) == iter) {
+            activeIters.erase(t);
+            break;
+        }
+    }
+    compactIfWorthIt();
+}
+
+inline void UnitCollection::reg(un_kiter *iter) const {
+    activeConstIters.push_back(iter);
+}
+
+inline void UnitCollection::unreg(un_kiter *iter) const {
+    for (vector<un_kiter *>::iterator t = activeConstIters.begin(); t != activeConstIters.end(); ++t) {
+        if ((*t) == iter) {
+            activeConstIters.erase(t);
+            break;
+        }
+    }
+}
+
+//UnitCollection END:
@@ -0,0 +1,310 @@
+/*
+ * contiguous_collection.h
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef _CONTIGUOUS_COLLECTION_H_
+#define _CONTIGUOUS_COLLECTION_H_
+
+#include <cstddef>
+#include <vector>
+
+class Unit;
+
+/*
+ * UnitCollection keeping its units in one contiguous array, with the same
+ * interface and guarantees as the std::list based one in collection.h.
+ *
+ * Removing a unit leaves a NULL tombstone in its place, so that iterators
+ * keep their positions and removal while iterating stays safe. Tombstones
+ * are compacted away once enough of them have piled up, moving each held
+ * UnitIterator to the unit it would have settled on. Prepending fills a
+ * gap kept in front of the units, so both ends grow in amortized constant
+ * time; inserting in the middle, which only preinsert and postinsert do,
+ * moves the units after it.
+ *
+ * Iterators hold positions in the array rather than pointers, so every
+ * iterator, ConstIterators included, registers with its collection, which
+ * moves the positions whenever units shift.
+ */
+class UnitCollection {
+public:
+    /* Where a unit sits in the collection that tracks it, see trackUnits */
+    struct Slot {
+        UnitCollection *col;
+        size_t position;
+
+        Slot() : col(NULL), position(0) {
+        }
+    };
+
+    class UnitIterator {
+    public:
+        UnitIterator() : col(NULL), pos(0), moved_on(false) {
+        }
+
+        UnitIterator(const UnitIterator &);
+        UnitIterator(UnitCollection *);
+        virtual ~UnitIterator();
+
+        inline bool isDone() {
+            size_t at = pos;
+            return !col || col->skipTombstones(at) >= col->u.size();
+        }
+
+        /*   Request the current unit to be removed */
+        void remove();
+
+        /*  Move the current unit to the beginning of another list */
+        void moveBefore(UnitCollection &);
+
+        /* Insert unit before current unit; leaves the iterator done, like the list version */
+        void preinsert(class Unit *);
+
+        /* Insert unit after current unit */
+        void postinsert(class Unit *unit);
+
+        /* increment to next valid unit (may iterate many times) */
+        void advance();
+
+        /* same as advance, only it returns the unit at the same time */
+        Unit *next();
+
+        int size() const {
+            return (col->size());
+        }
+
+        UnitIterator &operator=(const UnitIterator &);
+
+        inline const UnitIterator operator++(int) {
+            UnitCollection::UnitIterator tmp(*this);
+            advance();
+            return tmp;
+        }
+
+        inline const UnitIterator &operator++() {
+            advance();
+            return *this;
+        }
+
+        inline Unit *operator*() {
+            size_t at = pos;
+            if (col && col->skipTombstones(at) < col->u.size()) {
+                return col->u[at];
+            }
+            return NULL;
+        }
+
+    protected:
+        friend class UnitCollection;
+        //Pointer back to the collection we were spawned from
+        UnitCollection *col;
+
+        //Current position in the array
+        size_t pos;
+
+        //Compaction moved us off a tombstone onto the unit after it, which advance must not skip
+        bool moved_on;
+
+        /* Moves on from pos to the first live unit, dropping killed ones on the way */
+        void settle();
+    };
+
+    /* For loops that don't change the list, and don't keep the iterator across physics frames */
+    class ConstIterator {
+    public:
+        ConstIterator() : col(NULL), pos(0), moved_on(false) {
+        }
+
+        ConstIterator(const ConstIterator &);
+        ConstIterator(const UnitCollection *);
+        ~ConstIterator();
+        ConstIterator &operator=(const ConstIterator &orig);
+        Unit *next();
+
+        int size() const {
+            return (col->size());
+        }
+
+        inline bool isDone() {
+            return !col || pos >= col->u.size();
+        }
+
+        void advance();
+        const ConstIterator &operator++();
+        const ConstIterator operator++(int);
+
+        inline Unit *operator*() const {
+            if (col && pos < col->u.size()) {
+                return col->u[pos];
+            }
+            return NULL;
+        }
+
+    protected:
+        friend class UnitCollection;
+        const UnitCollection *col;
+        size_t pos;
+        bool moved_on;
+
+        void settle();
+    };
+
+    /* backwards compatibility only.  Typedefs suck. dont use them. */
+    typedef ConstIterator ConstFastIterator;
+    typedef UnitIterator FastIterator;
+
+    UnitCollection();
+    UnitCollection(const UnitCollection &);
+
+    inline ~UnitCollection() {
+        destr();
+    }
+
+    /* Iterator creation functions. We use this to set the col pointer */
+    inline UnitIterator createIterator() {
+        return UnitIterator(this);
+    }
+
+    inline FastIterator fastIterator() {
+        return FastIterator(this);
+    }
+
+    inline ConstIterator constIterator() const {
+        return ConstIterator(this);
+    }
+
+    inline ConstFastIterator constFastIterator() const {
+        return ConstFastIterator(this);
+    }
+
+    /* Makes every unit in this collection keep its position in unit->physics_queue_slot,
+     * so that it can be found and moved without a search. A unit can be
+     * in only one tracking collection at a time; copies don't track. */
+    void trackUnits() {
+        tracks_units = true;
+    }
+
+    /* Moves a unit this collection tracks to the front of target, in constant time.
+     * Returns false, and does nothing, if the unit isn't in this collection */
+    bool moveToFront(Unit *unit, UnitCollection &target);
+
+    /* Same as remove, in constant time, for a unit this collection tracks */
+    bool removeTracked(Unit *unit);
+
+    /* Traverses entire list and only inserts if no matches are found
+     * Do not use in any fast-code paths */
+    void insert_unique(Unit *);
+
+    inline bool empty() const {
+        return live == 0;
+    }
+
+    // Add a unit or iterator to the front of the list. */
+    void prepend(Unit *);
+    void prepend(UnitIterator *);
+
+    /* Add a unit or iterator to the back of the list. */
+    void append(class Unit *);
+    void append(UnitIterator *);
+
+    /* Whipes out entire list only if no iterators are being held. */
+    void clear();
+
+    bool contains(const class Unit *) const;
+
+    /* traverse list and remove first (only) matching Unit.
+     * Do not use in fast-path code */
+    bool remove(const class Unit *);
+
+    /* Returns number of non-null units in list */
+    inline const int size() const {
+        return static_cast<int>(live);
+    }
+
+    /* Returns last non-null unit in list. May be Killed() */
+    Unit *back();
+
+    /* Returns first non-null unit in list. May be Killed() */
+    Unit *front();
+
+private:
+    friend class UnitIterator;
+    friend class ConstIterator;
+
+    /* Sets all the Unit pointers to null and detaches the iterators,
+     * so the collection can be destroyed safely. */
+    void destr();
+
+    const UnitCollection &operator=(const UnitCollection &);
+
+    /* An iterator "registers" with a collection when it is created, so the
+     * collection can move it when units shift */
+    void reg(UnitCollection::UnitIterator *);
+    void unreg(UnitCollection::UnitIterator *);
+    void reg(UnitCollection::ConstIterator *) const;
+    void unreg(UnitCollection::ConstIterator *) const;
+
+    /* First position at or after pos that holds a unit, or u.size() */
+    inline size_t skipTombstones(size_t &pos) const {
+        while (pos < u.size() && !u[pos]) {
+            ++pos;
+        }
+        return pos;
+    }
+
+    /* Puts unit at position, shifting the units from there on back by one */
+    void insert(size_t position, Unit *unit);
+    /* Leaves a tombstone where the unit at position was */
+    void erase(size_t position);
+    /* Makes room in front of the first unit */
+    void growFront();
+    /* Drops the tombstones when they take up enough room, moving the iterators along */
+    void compactIfWorthIt();
+    /* Moves every position at or after from by shift */
+    void shiftPositions(size_t from, ptrdiff_t shift);
+
+    void track(size_t position);
+    void untrack(size_t position);
+
+    std::vector<class UnitCollection::UnitIterator *> activeIters;
+    //a const collection can still be iterated over, and its iterators still need moving
+    mutable std::vector<class UnitCollection::ConstIterator *> activeConstIters;
+
+    /* Units from head on; NULL for tombstones, and in the gap before head */
+    std::vector<class Unit *> u;
+    size_t head = 0;
+    size_t live = 0;
+    size_t tombstones = 0;
+
+    bool tracks_units = false;
+};
+
+/* Typedefs.   We really should not use them but we're lazy */
+typedef UnitCollection::UnitIterator un_iter;
+typedef UnitCollection::ConstIterator un_kiter;
+typedef UnitCollection::UnitIterator un_fiter;
+typedef UnitCollection::ConstIterator un_fkiter;
+
+#endif // _CONTIGUOUS_COLLECTION_H_
@@ -254,9 +254,9 @@ void Drawable::Draw(const Transformation &parent, const Matrix &parentMatrix) {
                 float lod = pixradius * g_game.detaillevel;
                 if (meshdata.at(i)->getBlendDst() == ZERO) {
                     if (unit->isUnit() == Vega_UnitType::planet && pixradius > 10) {
-                        Occlusion::addOccluder(TransformedPosition, mSize, true);
+                        Occlusion::addOccluder(this, i, TransformedPosition, mSize, true);
                     } else if (pixradius >= 10.0) {
-                        Occlusion::addOccluder(TransformedPosition, mSize, false);
+                        Occlusion::addOccluder(this, i, TransformedPosition, mSize, false);
                     }
                 }
                 if (lod >= 0.5 && pixradius >= 2.5) {
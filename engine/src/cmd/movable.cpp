@@ -30,7 +30,9 @@
 #include "universe.h"
 #include "configuration/game_config.h"
 #include "vs_logging.h"
+#include "worker_pool.h"
 
+#include <cassert>
 #include <iostream>
 #include <string>
 #include <vega_cast_utils.h>
@@ -56,8 +58,6 @@ Movable::Movable() : cumulative_transformation_matrix(identity_matrix),
     const Vector default_angular_velocity(configuration()->general_config.pitch,
             configuration()->general_config.yaw,
             configuration()->general_config.roll);
-    cutsqr = configuration()->warp_config.warp_stretch_cutoff * configuration()->warp_config.warp_stretch_cutoff;
-    outcutsqr = configuration()->warp_config.warp_stretch_decel_cutoff * configuration()->warp_config.warp_stretch_decel_cutoff;
 
     Identity(cumulative_transformation_matrix);
     cumulative_transformation = identity_transformation;
@@ -133,12 +133,56 @@ void Movable::SetResolveForces(bool ys) {
     resolveforces = ys;
 }
 
+static Movable::MotionSettings motion_settings;
+static bool motion_settings_captured = false;
+
+void Movable::CaptureMotionSettings() {
+    assert(!WorkerPool::InParallelFor());
+    motion_settings.velocity_max = configuration()->physics_config.velocity_max;
+    motion_settings.max_player_rotation_rate = configuration()->physics_config.max_player_rotation_rate;
+    motion_settings.max_non_player_rotation_rate = configuration()->physics_config.max_non_player_rotation_rate;
+    motion_settings.warp_stretch_cutoff = configuration()->warp_config.warp_stretch_cutoff;
+    motion_settings.warp_stretch_decel_cutoff = configuration()->warp_config.warp_stretch_decel_cutoff;
+    motion_settings.warp_memory_effect = configuration()->warp_config.warp_memory_effect;
+    motion_settings.warp_ramp_up_time = configuration()->warp_config.warp_ramp_up_time;
+    motion_settings.computer_warp_ramp_up_time = configuration()->warp_config.computer_warp_ramp_up_time;
+    motion_settings.warp_ramp_down_time = configuration()->warp_config.warp_ramp_down_time;
+    // stephengtuggy 2020-10-17: These need to be initialized here, because they depend on having an active mission.
+    if (!active_missions.empty() && active_missions[0]) {
+        motion_settings.air_resistance = XMLSupport::parse_floatf(active_missions[0]->getVariable("air_resistance", "0"));
+        motion_settings.lateral_air_resistance =
+                XMLSupport::parse_floatf(active_missions[0]->getVariable("lateral_air_resistance", "0"));
+    }
+    motion_settings_captured = true;
+}
+
+const Movable::MotionSettings &Movable::GetMotionSettings() {
+    if (!motion_settings_captured) {
+        CaptureMotionSettings();
+    }
+    return motion_settings;
+}
+
 void Movable::UpdatePhysics(const Transformation &trans,
         const Matrix &transmat,
         const Vector &cum_vel,
         bool lastframe,
         UnitCollection *uc,
         Unit *superunit) {
+    Transformation old_physical_state = PrepareMotion(trans, transmat, lastframe, uc, superunit);
+    IntegrateMotion(trans, transmat, cum_vel);
+
+    // The 1.0 difficulty is a hack based on the hack in GetVelocityDifficultyMult
+    this->UpdatePhysics2(trans, old_physical_state, Vector(), 1.0, transmat, cum_vel, lastframe, uc);
+
+}
+
+Transformation Movable::PrepareMotion(const Transformation &trans,
+        const Matrix &transmat,
+        bool lastframe,
+        UnitCollection *uc,
+        Unit *superunit) {
+    player_ship_in_motion = isPlayerShip();
     //Save information about when this happened
     unsigned int cur_sim_frame = _Universe->activeStarSystem()->getCurrentSimFrame();
     //Well, wasn't skipped actually, but...
@@ -147,11 +191,14 @@ void Movable::UpdatePhysics(const Transformation &trans,
     Transformation old_physical_state = curr_physical_state;
 
     UpdatePhysics3(trans, transmat, lastframe, uc, superunit);
+    return old_physical_state;
+}
 
+void Movable::IntegrateMotion(const Transformation &trans, const Matrix &transmat, const Vector &cum_vel) {
     if (resolveforces) {
         //clamp velocity
         ResolveForces(trans, transmat);
-        float velocity_max = configuration()->physics_config.velocity_max;
+        float velocity_max = GetMotionSettings().velocity_max;
         if (Velocity.i > velocity_max) {
             Velocity.i = velocity_max;
         } else if (Velocity.i < -velocity_max) {
@@ -169,30 +216,45 @@ void Movable::UpdatePhysics(const Transformation &trans,
         }
     }
 
+    //Only in non-networking OR networking && is a player OR SERVER && not a player
+    if (AngularVelocity.i || AngularVelocity.j || AngularVelocity.k) {
+        Rotate(simulation_atom_var * (AngularVelocity));
+    }
     // The 1.0 difficulty is a hack based on the hack in GetVelocityDifficultyMult
-    this->UpdatePhysics2(trans, old_physical_state, Vector(), 1.0, transmat, cum_vel, lastframe, uc);
+    AddVelocity(1.0);
+
+    cumulative_transformation = curr_physical_state;
+    cumulative_transformation.Compose(trans, transmat);
+    cumulative_transformation.to_matrix(cumulative_transformation_matrix);
+    cumulative_velocity = TransformNormal(transmat, Velocity) + cum_vel;
+}
 
+bool Movable::CanIntegrateConcurrently() const {
+    const Unit *unit = static_cast<const Unit *>(this);
+    return !graphicOptions.InWarp && !graphicOptions.WarpRamping && graphicOptions.RampCounter == 0
+            && graphicOptions.WarpFieldStrength == 1.0 && unit->computer.velocity_ref.GetConstUnit() == nullptr;
 }
 
 void Movable::AddVelocity(float difficulty) {
     Unit *unit = static_cast<Unit *>(this);
     float lastWarpField = graphicOptions.WarpFieldStrength;
 
-    bool playa = isPlayerShip();
-
-    float warprampuptime = playa ? configuration()->warp_config.warp_ramp_up_time : configuration()->warp_config.computer_warp_ramp_up_time;
+    const MotionSettings &settings = GetMotionSettings();
+    const float warprampuptime =
+            player_ship_in_motion ? settings.warp_ramp_up_time : settings.computer_warp_ramp_up_time;
+    const float warprampdowntime = settings.warp_ramp_down_time;
     //Warp Turning on/off
     if (graphicOptions.WarpRamping) {
         float oldrampcounter = graphicOptions.RampCounter;
         if (graphicOptions.InWarp == 1) {             //Warp Turning on
             graphicOptions.RampCounter = warprampuptime;
         } else {                                        //Warp Turning off
-            graphicOptions.RampCounter = configuration()->warp_config.warp_ramp_down_time;
+            graphicOptions.RampCounter = warprampdowntime;
         }
         //switched mid - ramp time; we also know old mode's ramptime != 0, or there won't be ramping
         if (oldrampcounter != 0 && graphicOptions.RampCounter != 0) {
             if (graphicOptions.InWarp == 1) {             //Warp is turning on before it turned off
-                graphicOptions.RampCounter *= (1 - oldrampcounter / configuration()->warp_config.warp_ramp_down_time);
+                graphicOptions.RampCounter *= (1 - oldrampcounter / warprampdowntime);
             } else {                                        //Warp is turning off before it turned on
                 graphicOptions.RampCounter *= (1 - oldrampcounter / warprampuptime);
             }
@@ -206,8 +268,8 @@ void Movable::AddVelocity(float difficulty) {
             if (graphicOptions.RampCounter <= 0) {
                 graphicOptions.RampCounter = 0;
             }
-            if (graphicOptions.InWarp == 0 && graphicOptions.RampCounter > configuration()->warp_config.warp_ramp_down_time) {
-                graphicOptions.RampCounter = (1 - graphicOptions.RampCounter / warprampuptime) * configuration()->warp_config.warp_ramp_down_time;
+            if (graphicOptions.InWarp == 0 && graphicOptions.RampCounter > warprampdowntime) {
+                graphicOptions.RampCounter = (1 - graphicOptions.RampCounter / warprampuptime) * warprampdowntime;
             }
             if (graphicOptions.InWarp == 1 && graphicOptions.RampCounter > warprampuptime) {
                 graphicOptions.RampCounter = warprampuptime;
@@ -217,7 +279,7 @@ void Movable::AddVelocity(float difficulty) {
                             / warprampuptime)
                             * (graphicOptions.RampCounter
                                     / warprampuptime)) : (graphicOptions.RampCounter
-                    / configuration()->warp_config.warp_ramp_down_time) * (graphicOptions.RampCounter / configuration()->warp_config.warp_ramp_down_time);
+                    / warprampdowntime) * (graphicOptions.RampCounter / warprampdowntime);
         }
         graphicOptions.WarpFieldStrength = GetMaxWarpFieldStrength(rampmult);
     } else {
@@ -231,8 +293,9 @@ void Movable::AddVelocity(float difficulty) {
         v = Velocity;
     }
 
+    const float warp_memory_effect = settings.warp_memory_effect;
     graphicOptions.WarpFieldStrength =
-            lastWarpField * configuration()->warp_config.warp_memory_effect + (1.0 - configuration()->warp_config.warp_memory_effect) * graphicOptions.WarpFieldStrength;
+            lastWarpField * warp_memory_effect + (1.0 - warp_memory_effect) * graphicOptions.WarpFieldStrength;
     curr_physical_state.position = curr_physical_state.position + (v * simulation_atom_var * difficulty).Cast();
     //now we do this later in update physics
     //I guess you have to, to be robust}
@@ -246,11 +309,7 @@ void Movable::UpdatePhysics2(const Transformation &trans,
         const Vector &cum_vel,
         bool lastframe,
         UnitCollection *uc) {
-    //Only in non-networking OR networking && is a player OR SERVER && not a player
-    if (AngularVelocity.i || AngularVelocity.j || AngularVelocity.k) {
-        Rotate(simulation_atom_var * (AngularVelocity));
-    }
-
+    //The unit has already been moved by IntegrateMotion; subclasses do what has to follow that
 }
 
 void Movable::Rotate(const Vector &axis) {
@@ -296,11 +355,13 @@ Vector Movable::ResolveForces(const Transformation &trans, const Matrix &transma
     Vector temp(temp1 * simulation_atom_var);
     AngularVelocity += temp;
 
+    //runs on a worker thread for most units, so it reads nothing shared but the captured settings
+    const MotionSettings &settings = GetMotionSettings();
     float caprate;
-    if (isPlayerShip()) {         //clamp to avoid vomit-comet effects
-        caprate = configuration()->physics_config.max_player_rotation_rate;
+    if (player_ship_in_motion) {         //clamp to avoid vomit-comet effects
+        caprate = settings.max_player_rotation_rate;
     } else {
-        caprate = configuration()->physics_config.max_non_player_rotation_rate;
+        caprate = settings.max_non_player_rotation_rate;
     }
     if (AngularVelocity.MagnitudeSquared() > caprate * caprate) {
         AngularVelocity = AngularVelocity.Normalize() * caprate;
@@ -324,31 +385,33 @@ Vector Movable::ResolveForces(const Transformation &trans, const Matrix &transma
 
     float newmagsquared = Velocity.MagnitudeSquared();
 
+    const float cutsqr = settings.warp_stretch_cutoff * settings.warp_stretch_cutoff;
+    const float outcutsqr = settings.warp_stretch_decel_cutoff * settings.warp_stretch_decel_cutoff;
     bool oldbig = oldmagsquared > cutsqr;
     bool newbig = newmagsquared > cutsqr;
     bool oldoutbig = oldmagsquared > outcutsqr;
     bool newoutbig = newmagsquared > outcutsqr;
     if ((newbig && !oldbig) || (oldoutbig && !newoutbig)) {
-        static bool docache = true;
-        if (docache && !configuration()->graphics_config.in_system_jump_animation.empty()) {
-            UniverseUtil::cacheAnimation(configuration()->graphics_config.in_system_jump_animation);
-            docache = false;
-        }
         Vector v(GetVelocity());
         v.Normalize();
         Vector p, q, r;
         GetOrientation(p, q, r);
 
-        float tmpsec = oldbig ? configuration()->warp_config.warp_stretch_decel_cutoff : configuration()->warp_config.warp_stretch_cutoff;
-        UniverseUtil::playAnimationGrow(configuration()->graphics_config.in_system_jump_animation,
-                realPosition().Cast() + Velocity * tmpsec + v * radial_size,
-                radial_size * 8,
-                1);
+        float tmpsec = oldbig ? settings.warp_stretch_decel_cutoff : settings.warp_stretch_cutoff;
+        const Vector where = realPosition().Cast() + Velocity * tmpsec + v * radial_size;
+        const float size = radial_size * 8;
+        DeferredCommands::RunOrDefer([where, size]() {
+            static bool docache = true;
+            if (docache && !configuration()->graphics_config.in_system_jump_animation.empty()) {
+                UniverseUtil::cacheAnimation(configuration()->graphics_config.in_system_jump_animation);
+                docache = false;
+            }
+            UniverseUtil::playAnimationGrow(configuration()->graphics_config.in_system_jump_animation, where, size, 1);
+        });
     }
 
-    // stephengtuggy 2020-10-17: These need to be initialized here, because they depend on having an active mission.
-    air_res_coef = XMLSupport::parse_floatf(active_missions[0]->getVariable("air_resistance", "0"));
-    lateral_air_res_coef = XMLSupport::parse_floatf(active_missions[0]->getVariable("lateral_air_resistance", "0"));
+    const float air_res_coef = settings.air_resistance;
+    const float lateral_air_res_coef = settings.lateral_air_resistance;
 
     if (air_res_coef != 0.0F || lateral_air_res_coef != 0.0F) {
         float velmag = Velocity.Magnitude();
@@ -137,10 +137,8 @@ protected:
     float Momentofinertia; // Was 0 but Init says 0.01
     Vector SavedAccel;
     Vector SavedAngAccel;
-    float cutsqr{0.0F};
-    float outcutsqr{0.0F};
-    float air_res_coef{0.0F};
-    float lateral_air_res_coef{0.0F};
+    //isPlayerShip() as of PrepareMotion, for IntegrateMotion, which may run on a worker thread
+    bool player_ship_in_motion{false};
 
 // Methods
 
@@ -155,6 +153,28 @@ protected:
     virtual ~Movable() = default;
 
 public:
+    //What IntegrateMotion reads from the configuration and the mission. Captured on the simulation
+    //thread while no worker is running, so that units integrated on the worker pool read neither:
+    //the configuration may be reloaded and the mission variables change between frames
+    struct MotionSettings {
+        float velocity_max{0.0F};
+        float max_player_rotation_rate{0.0F};
+        float max_non_player_rotation_rate{0.0F};
+        float warp_stretch_cutoff{0.0F};
+        float warp_stretch_decel_cutoff{0.0F};
+        float warp_memory_effect{0.0F};
+        float warp_ramp_up_time{0.0F};
+        float computer_warp_ramp_up_time{0.0F};
+        float warp_ramp_down_time{0.0F};
+        float air_resistance{0.0F};
+        float lateral_air_resistance{0.0F};
+    };
+
+    //Takes a new snapshot of the motion settings; simulation thread only, once per physics frame
+    static void CaptureMotionSettings();
+    //The last snapshot, taken on first use if there is none yet
+    static const MotionSettings &GetMotionSettings();
+
     void AddVelocity(float difficulty);
 //Resolves forces of given unit on a physics frame
     virtual Vector ResolveForces(const Transformation &, const Matrix &);
@@ -202,6 +222,18 @@ public:
             bool ResolveLast,
             UnitCollection *uc,
             Unit *superunit);
+    //The three steps of UpdatePhysics, for callers that integrate many units at once:
+    //PrepareMotion does the AI-facing and weapon side of the frame, IntegrateMotion moves the unit
+    //and UpdatePhysics2 finishes the frame. PrepareMotion returns the state to pass to UpdatePhysics2
+    Transformation PrepareMotion(const Transformation &trans,
+            const Matrix &transmat,
+            bool ResolveLast,
+            UnitCollection *uc,
+            Unit *superunit);
+    void IntegrateMotion(const Transformation &trans, const Matrix &transmat, const Vector &CumulativeVelocity);
+    //True when IntegrateMotion reads and writes nothing but this unit; warp looks at nearby units,
+    //and a warp field or a velocity reference reads the cumulative velocity of another unit
+    bool CanIntegrateConcurrently() const;
     virtual void UpdatePhysics2(const Transformation &trans,
             const Transformation &old_physical_state,
             const Vector &accel,
@@ -240,7 +240,7 @@ Planet::Planet(QVector x,
     }
     bool wormhole = dest.size() != 0;
     if (wormhole) {
-        const std::string& wormhole_unit = configuration()->graphics_config.wormhole_unit;
+        const std::string wormhole_unit = configuration()->graphics_config.wormhole_unit;
         string stab(".stable");
         if (rand() > RAND_MAX * .99) {
             stab = ".unstable";
@@ -28,16 +28,23 @@
 #ifndef __UNIT_TEST_H_
 #define __UNIT_TEST_H_
 #include <stdio.h>
+#include "../collection.h"
+#include "gfx/vec.h"
 
 class Unit {
 public:
     bool killed;
     bool zapped;
     int ucref;
+    UnitCollection::Slot physics_queue_slot;
+    // the bounding sphere, for UnitSpatialIndex
+    QVector position;
+    float radius;
 
     Unit(bool kill) : killed(kill) {
         ucref = 0;
         zapped = false;
+        radius = 0;
     }
 
     void Kill() {
@@ -47,13 +54,21 @@ public:
         killed = true;
     }
 
-    bool Killed() {
+    bool Killed() const {
         if (zapped == true) {
             printf("segfault");
         }
         return killed;
     }
 
+    const QVector &Position() const {
+        return position;
+    }
+
+    float rSize() const {
+        return radius;
+    }
+
     void Ref() {
         if (zapped == true) {
             printf("segfault");
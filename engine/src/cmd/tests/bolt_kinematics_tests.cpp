@@ -0,0 +1,91 @@
+/*
+ * bolt_kinematics_tests.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <gtest/gtest.h>
+
+#include "bolt_kinematics.h"
+
+TEST(BoltKinematics, AdvanceMovesAlongVelocity) {
+    BoltKinematics kinematics;
+    kinematics.Add(10.0, 20.0, 30.0, 100.0f, -50.0f, 0.0f, 200.0f, 1000.0f);
+    kinematics.Advance(0, kinematics.size(), 0.5f);
+
+    EXPECT_DOUBLE_EQ(60.0, kinematics.x[0]);
+    EXPECT_DOUBLE_EQ(-5.0, kinematics.y[0]);
+    EXPECT_DOUBLE_EQ(30.0, kinematics.z[0]);
+    EXPECT_DOUBLE_EQ(10.0, kinematics.previous_x[0]);
+    EXPECT_DOUBLE_EQ(20.0, kinematics.previous_y[0]);
+    EXPECT_DOUBLE_EQ(35.0, kinematics.middle_x[0]);
+    EXPECT_DOUBLE_EQ(7.5, kinematics.middle_y[0]);
+    EXPECT_FLOAT_EQ(100.0f, kinematics.distance[0]);
+    EXPECT_FALSE(kinematics.Expired(0));
+}
+
+TEST(BoltKinematics, ExpiresPastRange) {
+    BoltKinematics kinematics;
+    kinematics.Add(0.0, 0.0, 0.0, 0.0f, 0.0f, 10.0f, 10.0f, 25.0f);
+    for (int atom = 0; atom < 2; ++atom) {
+        kinematics.Advance(0, 1, 1.0f);
+        EXPECT_FALSE(kinematics.Expired(0));
+    }
+    kinematics.Advance(0, 1, 1.0f);
+    EXPECT_TRUE(kinematics.Expired(0));
+}
+
+TEST(BoltKinematics, AdvanceOnlyTouchesRange) {
+    BoltKinematics kinematics;
+    for (int i = 0; i < 5; ++i) {
+        kinematics.Add(i, 0.0, 0.0, 1.0f, 0.0f, 0.0f, 1.0f, 100.0f);
+    }
+    kinematics.Advance(1, 4, 2.0f);
+
+    EXPECT_DOUBLE_EQ(0.0, kinematics.x[0]);
+    EXPECT_DOUBLE_EQ(3.0, kinematics.x[1]);
+    EXPECT_DOUBLE_EQ(5.0, kinematics.x[3]);
+    EXPECT_DOUBLE_EQ(4.0, kinematics.x[4]);
+    EXPECT_FLOAT_EQ(0.0f, kinematics.distance[4]);
+}
+
+TEST(BoltKinematics, RemoveMovesLastRowIntoHole) {
+    BoltKinematics kinematics;
+    for (int i = 0; i < 3; ++i) {
+        kinematics.Add(i, i, i, i, i, i, i, i);
+    }
+    kinematics.Remove(0);
+
+    ASSERT_EQ(2u, kinematics.size());
+    EXPECT_DOUBLE_EQ(2.0, kinematics.x[0]);
+    EXPECT_DOUBLE_EQ(2.0, kinematics.previous_z[0]);
+    EXPECT_FLOAT_EQ(2.0f, kinematics.velocity_y[0]);
+    EXPECT_FLOAT_EQ(2.0f, kinematics.range[0]);
+    EXPECT_DOUBLE_EQ(1.0, kinematics.x[1]);
+
+    kinematics.Remove(1);
+    ASSERT_EQ(1u, kinematics.size());
+    EXPECT_DOUBLE_EQ(2.0, kinematics.x[0]);
+    EXPECT_EQ(1u, kinematics.speed.size());
+    EXPECT_EQ(1u, kinematics.middle_y.size());
+}
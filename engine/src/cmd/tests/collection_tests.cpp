@@ -0,0 +1,211 @@
+/*
+ * collection_tests.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Built with LIST_TESTING against the mock units of testcollection/unit.h,
+ * like the collection benchmark, as the real Unit drags in the whole game.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "testcollection/unit.h"
+#include "collection.h"
+
+static std::vector<Unit *> Fill(UnitCollection &collection, size_t count) {
+    std::vector<Unit *> units;
+    for (size_t i = 0; i < count; ++i) {
+        units.push_back(new Unit(false));
+        collection.append(units.back());
+    }
+    return units;
+}
+
+static std::vector<Unit *> Walk(UnitCollection &collection) {
+    std::vector<Unit *> seen;
+    for (un_iter iter = collection.createIterator(); !iter.isDone(); ++iter) {
+        seen.push_back(*iter);
+    }
+    return seen;
+}
+
+TEST(UnitCollection, CompactsUnderALiveIterator) {
+    UnitCollection collection;
+    collection.trackUnits();
+    std::vector<Unit *> units = Fill(collection, 100);
+
+    un_iter held = collection.createIterator();
+    for (int i = 0; i < 60; ++i) {
+        ++held;
+    }
+    ASSERT_EQ(units[60], *held);
+    const size_t before = units[60]->physics_queue_slot.position;
+
+    // enough tombstones on both sides of the iterator to compact
+    for (size_t i = 11; i < 90; i += 2) {
+        EXPECT_TRUE(collection.remove(units[i]));
+    }
+    EXPECT_NE(before, units[60]->physics_queue_slot.position);
+    EXPECT_EQ(units[60], *held);
+
+    std::vector<Unit *> rest;
+    for (; !held.isDone(); ++held) {
+        rest.push_back(*held);
+    }
+    std::vector<Unit *> expected;
+    for (size_t i = 60; i < 100; ++i) {
+        if (i >= 90 || i % 2 == 0) {
+            expected.push_back(units[i]);
+        }
+    }
+    EXPECT_EQ(expected, rest);
+    EXPECT_EQ(60u, Walk(collection).size());
+}
+
+TEST(UnitCollection, IteratorOnATombstoneMovesToTheNextUnit) {
+    UnitCollection collection;
+    collection.trackUnits();
+    std::vector<Unit *> units = Fill(collection, 100);
+
+    un_iter held = collection.createIterator();
+    for (int i = 0; i < 40; ++i) {
+        ++held;
+    }
+    un_iter done = collection.createIterator();
+    while (!done.isDone()) {
+        ++done;
+    }
+    const size_t before = units[50]->physics_queue_slot.position;
+    // leave held on a tombstone, then remove enough behind it to compact
+    for (size_t i = 40; i < 50; ++i) {
+        EXPECT_TRUE(collection.remove(units[i]));
+    }
+    for (size_t i = 60; i < 100; i += 2) {
+        EXPECT_TRUE(collection.remove(units[i]));
+    }
+    EXPECT_NE(before, units[50]->physics_queue_slot.position);
+    EXPECT_EQ(units[50], *held);
+    // its own unit is gone, so stepping on stops at the next one, as it would without compaction
+    ++held;
+    EXPECT_EQ(units[50], *held);
+    ++held;
+    EXPECT_EQ(units[51], *held);
+    EXPECT_TRUE(done.isDone());
+
+    // an iterator that was done stays done as units are added in front
+    Unit *added = new Unit(false);
+    collection.prepend(added);
+    EXPECT_TRUE(done.isDone());
+    EXPECT_EQ(added, collection.front());
+    EXPECT_EQ(71u, Walk(collection).size());
+}
+
+TEST(UnitCollection, RemovingTheHeldUnitDoesNotSkipTheNextOne) {
+    UnitCollection collection;
+    collection.trackUnits();
+    std::vector<Unit *> units = Fill(collection, 100);
+
+    un_iter held = collection.createIterator();
+    for (int i = 0; i < 50; ++i) {
+        ++held;
+    }
+    ASSERT_EQ(units[50], *held);
+    for (size_t i = 1; i < 38; i += 2) {
+        EXPECT_TRUE(collection.remove(units[i]));
+    }
+    // this one makes enough tombstones to compact, with held on it
+    const size_t before = units[0]->physics_queue_slot.position;
+    EXPECT_TRUE(collection.remove(units[50]));
+    EXPECT_NE(before, units[0]->physics_queue_slot.position);
+    ++held;
+    EXPECT_EQ(units[51], *held);
+    ++held;
+    EXPECT_EQ(units[52], *held);
+}
+
+TEST(UnitCollection, RemovingWhileIteratingKeepsTheRest) {
+    UnitCollection collection;
+    collection.trackUnits();
+    std::vector<Unit *> units = Fill(collection, 200);
+
+    size_t seen = 0;
+    for (un_iter iter = collection.createIterator(); !iter.isDone();) {
+        if (seen++ % 4) {
+            iter.remove();
+        } else {
+            ++iter;
+        }
+    }
+    std::vector<Unit *> left = Walk(collection);
+    ASSERT_EQ(50u, left.size());
+    for (size_t i = 0; i < left.size(); ++i) {
+        EXPECT_EQ(units[i * 4], left[i]);
+    }
+    for (size_t i = 0; i < units.size(); ++i) {
+        EXPECT_EQ(i % 4 ? static_cast<UnitCollection *>(NULL) : &collection, units[i]->physics_queue_slot.col);
+    }
+    collection.clear();
+}
+
+TEST(UnitCollection, ConstIteratorFollowsCompactionAndPrepending) {
+    UnitCollection collection;
+    std::vector<Unit *> units = Fill(collection, 100);
+    const UnitCollection &view = collection;
+
+    un_kiter held = view.constIterator();
+    for (int i = 0; i < 30; ++i) {
+        ++held;
+    }
+    ASSERT_EQ(units[30], *held);
+
+    // enough tombstones on both sides of the iterator to compact
+    for (size_t i = 11; i < 90; i += 2) {
+        EXPECT_TRUE(collection.remove(units[i]));
+    }
+    EXPECT_EQ(units[30], *held);
+    // and more units in front than the gap there has room for
+    for (int i = 0; i < 100; ++i) {
+        collection.prepend(new Unit(false));
+    }
+    EXPECT_EQ(units[30], *held);
+
+    std::vector<Unit *> rest;
+    for (; !held.isDone(); ++held) {
+        rest.push_back(*held);
+    }
+    std::vector<Unit *> expected;
+    for (size_t i = 30; i < 100; ++i) {
+        if (i >= 90 || i % 2 == 0) {
+            expected.push_back(units[i]);
+        }
+    }
+    EXPECT_EQ(expected, rest);
+
+    un_kiter cleared = view.constIterator();
+    collection.clear();
+    EXPECT_TRUE(cleared.isDone());
+    EXPECT_EQ(NULL, *cleared);
+}
@@ -0,0 +1,148 @@
+/*
+ * collide_grid_tests.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <set>
+#include <vector>
+
+#include "collide_map.h"
+#include "collide_grid.h"
+
+static void Place(Collidable &collidable, double x, double y, double z, float radius) {
+    collidable.position.i = x;
+    collidable.position.j = y;
+    collidable.position.k = z;
+    collidable.radius = radius;
+    collidable.ref.unit = nullptr;
+}
+
+class CollectIndices {
+public:
+    std::set<uint32_t> found;
+
+    bool operator()(uint32_t index) {
+        found.insert(index);
+        return false;
+    }
+};
+
+TEST(CollideGrid, FindsEverythingInTheBox) {
+    srand(1234);
+    std::vector<Collidable> elements(503);
+    for (int i = 0; i < 500; ++i) {
+        Place(elements[i],
+                rand() % 20000 - 10000,
+                rand() % 20000 - 10000,
+                rand() % 20000 - 10000,
+                1 + rand() % 400);
+    }
+    // bolts carry negative radii, big units go in the always-visited list, deleted entries are skipped
+    Place(elements[500], 0, 0, 0, -50.0f);
+    Place(elements[501], 5000, 5000, 5000, 25000.0f);
+    Place(elements[502], 1, 1, 1, 0.0f);
+
+    CollideGrid grid;
+    grid.SetCellSize(1000.0);
+    grid.Build(&elements[0], elements.size());
+
+    for (int q = 0; q < 50; ++q) {
+        QVector center;
+        center.i = rand() % 20000 - 10000;
+        center.j = rand() % 20000 - 10000;
+        center.k = rand() % 20000 - 10000;
+        double half_x = 100 + rand() % 3000;
+        double half_yz = 100 + rand() % 3000;
+        CollectIndices visitor;
+        EXPECT_FALSE(grid.Query(center, half_x, half_yz, visitor));
+        for (uint32_t i = 0; i < elements.size(); ++i) {
+            const QVector &p = elements[i].position;
+            bool inside = fabs(p.i - center.i) <= half_x
+                    && fabs(p.j - center.j) <= half_yz
+                    && fabs(p.k - center.k) <= half_yz;
+            if (elements[i].radius == 0.0f) {
+                EXPECT_EQ(visitor.found.count(i), 0U);
+            } else if (inside || fabs(elements[i].radius) > grid.GetCellSize()) {
+                EXPECT_EQ(visitor.found.count(i), 1U);
+            }
+        }
+    }
+}
+
+TEST(CollideGrid, StopsAtFirstHit) {
+    std::vector<Collidable> elements(10);
+    for (int i = 0; i < 10; ++i) {
+        Place(elements[i], 0, i * 10, 0, 5.0f);
+    }
+    CollideGrid grid;
+    grid.Build(&elements[0], elements.size());
+
+    const QVector origin;
+    int visited = 0;
+    auto stop_at_first = [&visited](uint32_t) -> bool {
+        ++visited;
+        return true;
+    };
+    EXPECT_TRUE(grid.Query(origin, 50, 50, stop_at_first));
+    EXPECT_EQ(visited, 1);
+
+    grid.Clear();
+    EXPECT_TRUE(grid.empty());
+    EXPECT_FALSE(grid.Query(origin, 50, 50, stop_at_first));
+}
+
+TEST(CollideGrid, ClampsCellsOfWildCoordinates) {
+    const double inf = std::numeric_limits<double>::infinity();
+    const GridCellKey far(1e300, -1e300, inf, 0.001);
+    EXPECT_EQ(far.i, GridCellKey::MAX_CELL);
+    EXPECT_EQ(far.j, -GridCellKey::MAX_CELL);
+    EXPECT_EQ(far.k, GridCellKey::MAX_CELL);
+    const GridCellKey nan(std::nan(""), -inf, 2500.0, 0.001);
+    EXPECT_EQ(nan.i, 0);
+    EXPECT_EQ(nan.j, -GridCellKey::MAX_CELL);
+    EXPECT_EQ(nan.k, 2);
+
+    // far out elements are still found by a query around them, and the query does not walk the clamped span
+    std::vector<Collidable> elements(3);
+    Place(elements[0], 1e300, 0, 0, 5.0f);
+    Place(elements[1], 0, inf, 0, 5.0f);
+    Place(elements[2], 0, 0, 0, 5.0f);
+    CollideGrid grid;
+    grid.Build(&elements[0], elements.size());
+    QVector center;
+    center.i = 1e300;
+    CollectIndices visitor;
+    grid.Query(center, 50, 50, visitor);
+    EXPECT_EQ(visitor.found.count(0), 1U);
+    EXPECT_EQ(visitor.found.count(2), 0U);
+
+    CollectIndices everything;
+    const QVector origin;
+    grid.Query(origin, inf, inf, everything);
+    EXPECT_EQ(everything.found.size(), 3U);
+}
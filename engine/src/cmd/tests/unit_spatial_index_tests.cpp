@@ -0,0 +1,144 @@
+/*
+ * unit_spatial_index_tests.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Built with LIST_TESTING against the mock units of testcollection/unit.h,
+ * like the collection tests, as the real Unit drags in the whole game.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "testcollection/unit.h"
+#include "unit_spatial_index.h"
+
+static Unit *Place(std::vector<Unit *> &units, double x, double y, double z, float radius) {
+    Unit *unit = new Unit(false);
+    unit->position = QVector(x, y, z);
+    unit->radius = radius;
+    units.push_back(unit);
+    return unit;
+}
+
+static std::vector<Unit *> Query(const UnitSpatialIndex &index, double x, double y, double z, double radius) {
+    std::vector<Unit *> found;
+    index.QuerySphere(QVector(x, y, z), radius, found);
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+static std::vector<Unit *> Sorted(std::vector<Unit *> units) {
+    std::sort(units.begin(), units.end());
+    return units;
+}
+
+class UnitSpatialIndexTest : public ::testing::Test {
+protected:
+    UnitSpatialIndexTest() : index(100.0) {
+    }
+
+    ~UnitSpatialIndexTest() override {
+        index.Clear();
+        for (Unit *unit : units) {
+            delete unit;
+        }
+    }
+
+    UnitSpatialIndex index;
+    std::vector<Unit *> units;
+};
+
+TEST_F(UnitSpatialIndexTest, InsertsOnceAndHoldsAReference) {
+    Unit *ship = Place(units, 10, 10, 10, 5);
+    index.Insert(ship);
+    index.Insert(ship);
+    EXPECT_EQ(1u, index.size());
+    EXPECT_EQ(1, ship->ucref);
+    EXPECT_EQ(std::vector<Unit *>{ship}, Query(index, 10, 10, 10, 1));
+}
+
+TEST_F(UnitSpatialIndexTest, QueriesCountTheUnitsRadius) {
+    Unit *near = Place(units, 0, 0, 0, 1);
+    Unit *big = Place(units, 250, 0, 0, 60);
+    Unit *far = Place(units, 1000, 0, 0, 1);
+    // wider than a cell, so it goes in the list every query checks
+    Unit *planet = Place(units, 0, 4100, 0, 4000);
+    for (Unit *unit : units) {
+        index.Insert(unit);
+    }
+    // 200 away, which only reaches big through its radius
+    EXPECT_EQ(Sorted({near, big, planet}), Query(index, 0, 0, 0, 200));
+    EXPECT_EQ(Sorted({near, planet}), Query(index, 0, 0, 0, 180));
+    EXPECT_EQ(std::vector<Unit *>{far}, Query(index, 1000, 0, 0, 10));
+    // a query much wider than the occupied cells
+    EXPECT_EQ(Sorted(units), Query(index, 0, 0, 0, 1.0e7));
+    EXPECT_TRUE(Query(index, 0, -500, 0, 10).empty());
+}
+
+TEST_F(UnitSpatialIndexTest, FindsUnitsWhereTheyMovedOnRefresh) {
+    Unit *ship = Place(units, 0, 0, 0, 1);
+    Unit *other = Place(units, 10, 0, 0, 1);
+    index.Insert(ship);
+    index.Insert(other);
+
+    ship->position = QVector(2000, 0, 0);
+    index.Refresh();
+    EXPECT_EQ(std::vector<Unit *>{other}, Query(index, 0, 0, 0, 50));
+    EXPECT_EQ(std::vector<Unit *>{ship}, Query(index, 2000, 0, 0, 50));
+
+    // growing past a cell moves it to the oversized list, and back
+    ship->radius = 500;
+    index.Refresh();
+    EXPECT_EQ(std::vector<Unit *>{ship}, Query(index, 1460, 0, 0, 50));
+    ship->radius = 1;
+    index.Refresh();
+    EXPECT_TRUE(Query(index, 1460, 0, 0, 50).empty());
+    EXPECT_EQ(std::vector<Unit *>{ship}, Query(index, 2000, 0, 0, 50));
+    EXPECT_EQ(2u, index.size());
+}
+
+TEST_F(UnitSpatialIndexTest, RemovesUnitsAndDropsKilledOnes) {
+    Unit *ship = Place(units, 0, 0, 0, 1);
+    Unit *other = Place(units, 5, 0, 0, 1);
+    Unit *doomed = Place(units, 10, 0, 0, 1);
+    for (Unit *unit : units) {
+        index.Insert(unit);
+    }
+
+    EXPECT_TRUE(index.Remove(ship));
+    EXPECT_FALSE(index.Remove(ship));
+    EXPECT_EQ(0, ship->ucref);
+    EXPECT_EQ(Sorted({other, doomed}), Query(index, 0, 0, 0, 50));
+
+    // killed units are no longer found, and are let go at the next refresh
+    doomed->Kill();
+    EXPECT_EQ(std::vector<Unit *>{other}, Query(index, 0, 0, 0, 50));
+    EXPECT_EQ(2u, index.size());
+    index.Refresh();
+    EXPECT_EQ(1u, index.size());
+    EXPECT_EQ(0, doomed->ucref);
+    EXPECT_EQ(std::vector<Unit *>{other}, Query(index, 0, 0, 0, 50));
+}
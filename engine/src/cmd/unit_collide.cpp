@@ -198,7 +198,8 @@ bool Unit::InsideCollideTree(Unit *smaller,
     if (smaller->colTrees->usingColTree() == false || this->colTrees->usingColTree() == false) {
         return false;
     }
-    csOPCODECollider::ResetCollisionPairs();
+    csOPCODECollisionContext &context = csOPCODECollisionContext::ForThisThread();
+    context.ResetCollisionPairs();
     Unit *bigger = this;
 
     csReversibleTransform bigtransform(bigger->cumulative_transformation_matrix);
@@ -211,12 +212,12 @@ bool Unit::InsideCollideTree(Unit *smaller,
     // Check for shield collisions here prior to checking for mesh on mesh or ray collisions below.
     csOPCODECollider *tmpCol = smaller->colTrees->colTree(smaller, bigger->GetWarpVelocity());
     if (tmpCol
-            && (tmpCol->Collide(*bigger->colTrees->colTree(bigger,
-                            smaller->GetWarpVelocity()),
+            && (context.Collide(*tmpCol,
+                    *bigger->colTrees->colTree(bigger, smaller->GetWarpVelocity()),
                     &smalltransform,
                     &bigtransform))) {
-        csCollisionPair *mycollide = csOPCODECollider::GetCollisions();
-        unsigned int numHits = csOPCODECollider::GetCollisionPairCount();
+        csCollisionPair *mycollide = context.GetCollisions();
+        unsigned int numHits = context.GetCollisionPairCount();
         if (numHits) {
             smallpos.Set((mycollide[0].a1.x + mycollide[0].b1.x + mycollide[0].c1.x) / 3.0f,
                     (mycollide[0].a1.y + mycollide[0].b1.y + mycollide[0].c1.y) / 3.0f,
@@ -292,13 +293,66 @@ bool Unit::InsideCollideTree(Unit *smaller,
     return false;
 }
 
+bool Unit::SweptCollideTree(Unit *smaller,
+        const Vector &sweep,
+        QVector &bigpos,
+        Vector &bigNormal,
+        QVector &smallpos,
+        Vector &smallNormal,
+        QVector &smallcenter) {
+    if (this->colTrees == NULL || !this->colTrees->usingColTree() || Destroyed()) {
+        return false;
+    }
+    csOPCODECollider *tmpCol = this->colTrees->colTree(this, smaller->GetWarpVelocity());
+    if (tmpCol == NULL) {
+        return false;
+    }
+    const QVector start(InvTransform(cumulative_transformation_matrix, smaller->Position() - sweep.Cast()));
+    const QVector end(InvTransform(cumulative_transformation_matrix, smaller->Position()));
+    float fraction;
+    csVector3 contact, normal;
+    if (!csOPCODECollisionContext::ForThisThread().SweptSphereCollide(*tmpCol,
+            csVector3(start.i, start.j, start.k),
+            csVector3(end.i, end.j, end.k),
+            smaller->rSize(),
+            fraction,
+            contact,
+            normal)) {
+        return false;
+    }
+    bigpos = Transform(cumulative_transformation_matrix, QVector(contact.x, contact.y, contact.z));
+    bigNormal = TransformNormal(cumulative_transformation_matrix, Vector(normal.x, normal.y, normal.z));
+    smallpos = bigpos;
+    smallNormal = -bigNormal;
+    smallcenter = smaller->Position() - sweep.Cast() * (1.0 - fraction);
+    return true;
+}
+
 inline float mysqr(float a) {
     return a * a;
 }
 
+inline double DistanceSquaredToSegment(const QVector &start, const QVector &end, const QVector &point) {
+    const QVector along(end - start);
+    const double length = along.MagnitudeSquared();
+    double t = length > 0 ? (point - start).Dot(along) / length : 0;
+    t = t < 0 ? 0 : (t > 1 ? 1 : t);
+    return (start + along * t - point).MagnitudeSquared();
+}
+
 bool Unit::Collide(Unit *target) {
+    //how far this unit moved with respect to the target during the atom; when that is more than the smaller
+    //of the two is wide, they could have met anywhere along the way, not just where this unit is now
+    const Vector sweep = (GetWarpVelocity() - target->GetWarpVelocity()) * simulation_atom_var;
+    const bool swept = configuration()->physics_config.continuous_collision
+            && sweep.MagnitudeSquared() > mysqr(std::min(radial_size, target->radial_size));
     //now first OF ALL make sure they're within bubbles of each other...
-    if ((Position() - target->Position()).MagnitudeSquared() > mysqr(radial_size + target->radial_size)) {
+    if (swept) {
+        if (DistanceSquaredToSegment(Position() - sweep.Cast(), Position(), target->Position())
+                > mysqr(radial_size + target->radial_size)) {
+            return false;
+        }
+    } else if ((Position() - target->Position()).MagnitudeSquared() > mysqr(radial_size + target->radial_size)) {
         return false;
     }
     Vega_UnitType targetisUnit = target->isUnit();
@@ -342,10 +396,20 @@ bool Unit::Collide(Unit *target) {
                     && target->colTrees->colTree(this, Vector(0, 0, 0))
             : false;
     if (usecoltree) {
-        QVector bigpos, smallpos;
+        QVector bigpos, smallpos, smallcenter;
         Vector bigNormal, smallNormal;
-        if (bigger->InsideCollideTree(smaller, bigpos, bigNormal, smallpos, smallNormal)) {
+        bool hit = bigger->InsideCollideTree(smaller, bigpos, bigNormal, smallpos, smallNormal);
+        bool rewind = false;
+        if (!hit && swept) {
+            hit = rewind = bigger->SweptCollideTree(smaller, smaller == this ? sweep : -sweep,
+                    bigpos, bigNormal, smallpos, smallNormal, smallcenter);
+        }
+        if (hit) {
             if (!bigger->isDocked(smaller) && !smaller->isDocked(bigger)) {
+                if (rewind) {
+                    //back to where it reached the hull, rather than through it
+                    smaller->SetCurPosition(smallcenter);
+                }
                 //bigger->reactToCollision( smaller, bigpos, bigNormal, smallpos, smallNormal, 10 );
                 Collision::collide(bigger, bigpos, bigNormal, smaller, smallpos, smallNormal, 10);
             } else {
@@ -455,7 +519,7 @@ Unit *Unit::rayCollide(const QVector &start, const QVector &end, Vector &norm, f
 
                 return this;
             }
-            if (tmpCol->rayCollide(boltbeam, norm, distance)) {
+            if (csOPCODECollisionContext::ForThisThread().rayCollide(*tmpCol, boltbeam, norm, distance)) {
                 // compute real distance
                 distance = (end - start).Magnitude() * distance;
 
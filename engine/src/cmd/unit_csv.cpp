@@ -32,6 +32,7 @@
 #include "unit_collide.h"
 #include "collide2/Stdafx.h"
 #include "collide2/CSopcodecollider.h"
+#include "collide2/collision_tree_cache.h"
 #include "audiolib.h"
 #include "unit_xml.h"
 #include "gfx/quaternion.h"
@@ -616,10 +617,10 @@ float getFuelConversion() {
 
 const std::string EMPTY_STRING("");
 
-void YawPitchRollParser(std::string unit_key,
-        std::string main_string,
-        std::string left_string,
-        std::string right_string,
+void YawPitchRollParser(const std::string &unit_key,
+        const char *main_string,
+        const char *left_string,
+        const char *right_string,
         float &left_pointer,
         float &right_pointer) {
     float main_value = UnitCSVFactory::GetVariable(unit_key, main_string, 0.0f);
@@ -1005,8 +1006,8 @@ void Unit::LoadRow(std::string unit_identifier, string modification, bool saved_
         meshdata.back() = xml.shieldmesh;
     } else {
         const int shieldstacks = configuration()->graphics_config.shield_detail;
-        const std::string& shieldtex = configuration()->graphics_config.shield_texture;
-        const std::string& shieldtechnique = configuration()->graphics_config.shield_technique;
+        const std::string shieldtex = configuration()->graphics_config.shield_texture;
+        const std::string shieldtechnique = configuration()->graphics_config.shield_technique;
         meshdata.back() = SphereMesh::createSphereMesh(rSize(),
                                                        shieldstacks,
                                                        shieldstacks,
@@ -1031,6 +1032,8 @@ void Unit::LoadRow(std::string unit_identifier, string modification, bool saved_
         csOPCODECollider *colShield = NULL;
         string tmpname = unit_identifier;       //key
         if (!this->colTrees) {
+            // so the star system preloader can find this unit's trees next time
+            CollisionTreeCache::SourceScope tree_source(unit_identifier);
             string val;
             xml.hasColTree = 1;
             if ((val = UnitCSVFactory::GetVariable(unit_key, "Use_Rapid", std::string())).length()) {
@@ -1174,7 +1177,7 @@ string Unit::WriteUnitString() {
         return ret;
     }
 
-    std::map<std::string, std::string> unit = UnitCSVFactory::GetUnit(name);
+    std::map<std::string, std::string> unit = UnitCSVFactory::GetUnit(name.get());
     string val;
 
     //mutable things
@@ -25,15 +25,136 @@
 
 #include "unit_csv_factory.h"
 
+#include <cerrno>
+#include <cstdlib>
 #include <iostream>
+#include <limits>
 #include <vector>
 #include <string>
 
-// Required definition of static variable
-std::map<std::string, std::map<std::string, std::string>> UnitCSVFactory::units;
+UnitCSVFactory::Table::Table() {
+    // the known attributes get the first ids, in the order of keys[]
+    for (const std::string &key : keys) {
+        Intern(key);
+    }
+}
+
+UnitCSVFactory::AttributeId UnitCSVFactory::Table::Intern(boost::string_view attribute_key) {
+    auto found = attribute_ids.find(attribute_key);
+    if (found != attribute_ids.end()) {
+        return found->second;
+    }
+    const AttributeId id = static_cast<AttributeId>(attribute_names.size());
+    attribute_names.push_back(std::string(attribute_key.begin(), attribute_key.end()));
+    attribute_ids[boost::string_view(attribute_names.back())] = id;
+    columns.push_back(std::vector<Cell>(unit_keys.size()));
+    return id;
+}
+
+size_t UnitCSVFactory::Table::ResetRow(const std::string &unit_key) {
+    auto found = unit_rows.find(boost::string_view(unit_key));
+    if (found != unit_rows.end()) {
+        for (std::vector<Cell> &column : columns) {
+            column[found->second] = Cell();
+        }
+        return found->second;
+    }
+    const size_t row = unit_keys.size();
+    unit_keys.push_back(unit_key);
+    unit_rows[boost::string_view(unit_keys.back())] = row;
+    for (std::vector<Cell> &column : columns) {
+        column.push_back(Cell());
+    }
+    return row;
+}
+
+void UnitCSVFactory::Cell::Set(const std::string &value) {
+    text = value;
+    present = true;
+
+    std::string lower(value);
+    boost::algorithm::to_lower(lower);
+    bool_value = (lower == "true" || lower == "1");
+
+    // same rules as the std::sto* calls the values used to be parsed with on every lookup: leading
+    // whitespace and trailing text are fine, no number at all or one out of range is not. Most
+    // cells are text, so the strto* calls are used directly rather than throwing three times a cell.
+    const char *begin = value.c_str();
+    char *end;
+    const int saved_errno = errno;
+
+    errno = 0;
+    const float parsed_float = strtof(begin, &end);
+    has_float = (end != begin && errno != ERANGE);
+    if (has_float) {
+        float_value = parsed_float;
+    }
+
+    errno = 0;
+    const double parsed_double = strtod(begin, &end);
+    has_double = (end != begin && errno != ERANGE);
+    if (has_double) {
+        double_value = parsed_double;
+    }
+
+    errno = 0;
+    const long parsed_int = strtol(begin, &end, 10);
+    has_int = (end != begin && errno != ERANGE
+            && parsed_int >= std::numeric_limits<int>::min() && parsed_int <= std::numeric_limits<int>::max());
+    if (has_int) {
+        int_value = static_cast<int>(parsed_int);
+    }
+
+    errno = saved_errno;
+}
+
+UnitCSVFactory::Table &UnitCSVFactory::table() {
+    static Table units;
+    return units;
+}
+
+const UnitCSVFactory::Cell *UnitCSVFactory::_GetCell(boost::string_view unit_key, boost::string_view attribute_key) {
+    const Table &units = table();
+    auto row = units.unit_rows.find(unit_key);
+    if (row == units.unit_rows.end()) {
+        return nullptr;
+    }
+    auto attribute = units.attribute_ids.find(attribute_key);
+    if (attribute == units.attribute_ids.end()) {
+        return nullptr;
+    }
+    const Cell &cell = units.columns[attribute->second][row->second];
+    return cell.present ? &cell : nullptr;
+}
 
-// This is probably unique enough to ensure no collision
-std::string UnitCSVFactory::DEFAULT_ERROR_VALUE = "UnitCSVFactory::_GetVariable DEFAULT_ERROR_VALUE";
+void UnitCSVFactory::SetUnit(const std::string &unit_key, const std::map<std::string, std::string> &unit_attributes) {
+    Table &units = table();
+    const size_t row = units.ResetRow(unit_key);
+    for (const auto &attribute : unit_attributes) {
+        units.columns[units.Intern(attribute.first)][row].Set(attribute.second);
+    }
+}
+
+std::map<std::string, std::string> UnitCSVFactory::GetUnit(boost::string_view key) {
+    std::map<std::string, std::string> unit_attributes;
+    const Table &units = table();
+    auto row = units.unit_rows.find(key);
+    if (row == units.unit_rows.end()) {
+        return unit_attributes;
+    }
+    for (AttributeId id = 0; id < units.columns.size(); ++id) {
+        const Cell &cell = units.columns[id][row->second];
+        if (cell.present) {
+            unit_attributes[units.attribute_names[id]] = cell.text;
+        }
+    }
+    return unit_attributes;
+}
+
+std::vector<std::string> UnitCSVFactory::GetUnitKeys() {
+    const Table &units = table();
+    return std::vector<std::string>(units.unit_keys.begin(), units.unit_keys.end());
+}
 
 void ExtractColumns(std::string &line) {
     std::string data(line);
@@ -95,6 +216,9 @@ std::vector<std::string> ProcessLine(std::string &line) {
 
 void UnitCSVFactory::ParseCSV(VSFileSystem::VSFile &file, bool saved_game) {
     std::vector<std::string> columns;
+    std::vector<AttributeId> column_ids;
+    Table &units = table();
+    const AttributeId root_id = units.Intern("root");
     std::string data = file.ReadFull();
     std::string delimiter = "\n";
     size_t pos = 0;
@@ -112,24 +236,26 @@ void UnitCSVFactory::ParseCSV(VSFileSystem::VSFile &file, bool saved_game) {
         token = data.substr(0, pos);
         if (first_line) {
             columns = ProcessLine(token);
+            column_ids.clear();
+            for (const std::string &column : columns) {
+                column_ids.push_back(units.Intern(column));
+            }
 
             first_line = false;
         } else {
 
             std::vector<std::string> line = ProcessLine(token);
-            std::map<std::string, std::string> unit_attributes;
-
-            for (unsigned int i = 1; i < columns.size(); i++) {
-                unit_attributes[columns[i]] = line[i];
-            }
-
-            // Add root
-            unit_attributes["root"] = file.GetRoot();
 
             std::string key = (saved_game ? "player_ship" : line[0]);
 
             if(!key.empty()) {
-                UnitCSVFactory::units[key] = unit_attributes;
+                const size_t row = units.ResetRow(key);
+                for (unsigned int i = 1; i < columns.size() && i < line.size(); i++) {
+                    units.columns[column_ids[i]][row].Set(line[i]);
+                }
+
+                // Add root
+                units.columns[root_id][row].Set(file.GetRoot());
             }
         }
         data.erase(0, pos + delimiter.length());
@@ -26,12 +26,17 @@
 #ifndef UNITCSVFACTORY_H
 #define UNITCSVFACTORY_H
 
+#include <deque>
 #include <map>
 #include <string>
 #include <utility>
+#include <vector>
 #include <boost/algorithm/string.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/utility/string_view.hpp>
 #include <iostream>
 
+#include "gnuhash.h"
 #include "vsfilesystem.h"
 
 const std::string keys[] = {"Key", "Directory",	"Name",	"STATUS",	"Object_Type",
@@ -66,40 +71,48 @@ const std::string keys[] = {"Key", "Directory",	"Name",	"STATUS",	"Object_Type",
                             "FaceCamera", "Unit_Role", "Attack_Preference", "Hidden_Hold_Volume", "Equipment_Space"};
 
 
+/*
+ * Holds every unit read from units.csv/units.json (and saved games) in one table:
+ * a row per unit and a column per attribute, where the attributes are interned
+ * to small ids with the names in keys[] first. Numeric and boolean values are
+ * parsed once, when the row is stored, so looking up a value does not copy or
+ * parse anything.
+ */
 class UnitCSVFactory {
-    static std::string DEFAULT_ERROR_VALUE;
-    static std::map<std::string, std::map<std::string, std::string>> units;
-
-    static inline std::string _GetVariable(std::string unit_key, std::string const &attribute_key) {
-        if (units.count(unit_key) == 0) {
-            return DEFAULT_ERROR_VALUE;
-        }
-
-        std::map<std::string, std::string> unit_attributes = UnitCSVFactory::units[unit_key];
-
-        // TODO: Use this code to find more missing key as shown above.
-        // Note: The following code can probably be cleaner with find...
-        /*bool attribute_found = false;
-
-        for(const std::string& key : keys) {
-            if(key == attribute_key) {
-                attribute_found = true;
-                break;
-            }
-        }
-
-        if (!attribute_found)
-        {
-            std::cout << attribute_key << " attribute not found.\n";
-            assert(0);
-        }*/
-
-        if (unit_attributes.count(attribute_key) == 0) {
-            return DEFAULT_ERROR_VALUE;
-        }
-
-        return unit_attributes[attribute_key];
-    }
+    typedef unsigned int AttributeId;
+
+    struct Cell {
+        std::string text;
+        bool present = false;
+        bool has_float = false;
+        bool has_double = false;
+        bool has_int = false;
+        bool bool_value = false;
+        float float_value = 0.0f;
+        double double_value = 0.0;
+        int int_value = 0;
+
+        void Set(const std::string &value);
+    };
+
+    struct Table {
+        // the names own the characters the string_view keys point to, so they must not move
+        std::deque<std::string> attribute_names;
+        vsUMap<boost::string_view, AttributeId, boost::hash<boost::string_view>> attribute_ids;
+        std::deque<std::string> unit_keys;
+        vsUMap<boost::string_view, size_t, boost::hash<boost::string_view>> unit_rows;
+        // columns[attribute][row]
+        std::vector<std::vector<Cell>> columns;
+
+        Table();
+        AttributeId Intern(boost::string_view attribute_key);
+        // Returns the row of the unit, emptied; a new row if the unit isn't known yet
+        size_t ResetRow(const std::string &unit_key);
+    };
+
+    static Table &table();
+    static const Cell *_GetCell(boost::string_view unit_key, boost::string_view attribute_key);
+    static void SetUnit(const std::string &unit_key, const std::map<std::string, std::string> &unit_attributes);
 
     friend class UnitJSONFactory;
     friend class UnitOptimizeFactory;
@@ -107,103 +120,71 @@ public:
     static void ParseCSV(VSFileSystem::VSFile &file, bool saved_game);
 
     template<class T>
-    static inline T GetVariable(std::string unit_key, std::string const &attribute_key, T default_value) = delete;
-    static bool HasVariable(std::string unit_key, std::string const &attribute_key) {
-        if (units.count(unit_key) == 0) {
-            return false;
-        }
-
-        std::map<std::string, std::string> unit_attributes = UnitCSVFactory::units[unit_key];
-
-        return (unit_attributes.count(attribute_key) > 0);
+    static inline T GetVariable(boost::string_view unit_key, boost::string_view attribute_key, T default_value) = delete;
+    static bool HasVariable(boost::string_view unit_key, boost::string_view attribute_key) {
+        return _GetCell(unit_key, attribute_key) != nullptr;
     }
 
-    static bool HasUnit(std::string unit_key) {
-        return (units.count(unit_key) > 0);
+    static bool HasUnit(boost::string_view unit_key) {
+        return (table().unit_rows.count(unit_key) > 0);
     }
 
+    // Builds a copy of the unit's attributes, for writing it out
+    static std::map<std::string, std::string> GetUnit(boost::string_view key);
 
-    static std::map<std::string, std::string> GetUnit(std::string key) {
-        return UnitCSVFactory::units[key];
-    }
+    // The keys of all the units, in the order they were first read
+    static std::vector<std::string> GetUnitKeys();
 };
 
 // Template Specialization
 template<>
-inline std::string UnitCSVFactory::GetVariable(std::string unit_key,
-        std::string const &attribute_key,
+inline std::string UnitCSVFactory::GetVariable(boost::string_view unit_key,
+        boost::string_view attribute_key,
         std::string default_value) {
-    std::string result = _GetVariable(unit_key, attribute_key);
-    if (result == DEFAULT_ERROR_VALUE) {
+    const Cell *cell = _GetCell(unit_key, attribute_key);
+    if (cell == nullptr) {
         return default_value;
     }
 
-    return result;
+    return cell->text;
 }
 
-// Need this in because "abcd" is const char* and not std::string
-/*template <>
-inline const char* UnitCSVFactory::GetVariable(std::string unit_key, std::string const &attribute_key, const char* default_value)
-{
-    std::string result = _GetVariable(unit_key, attribute_key);
-    if(result == DEFAULT_ERROR_VALUE) {
-        return default_value;
-    }
-
-    return result.c_str();
-}*/
-
 template<>
-inline bool UnitCSVFactory::GetVariable(std::string unit_key, std::string const &attribute_key, bool default_value) {
-    std::string result = _GetVariable(unit_key, attribute_key);
-    if (result == DEFAULT_ERROR_VALUE) {
+inline bool UnitCSVFactory::GetVariable(boost::string_view unit_key, boost::string_view attribute_key, bool default_value) {
+    const Cell *cell = _GetCell(unit_key, attribute_key);
+    if (cell == nullptr) {
         return default_value;
     }
-    boost::algorithm::to_lower(result);
-    return (result == "true" || result == "1");
+    return cell->bool_value;
 }
 
 template<>
-inline float UnitCSVFactory::GetVariable(std::string unit_key, std::string const &attribute_key, float default_value) {
-    std::string result = _GetVariable(unit_key, attribute_key);
-
-    if (result == DEFAULT_ERROR_VALUE) {
-        return default_value;
-    }
-
-    try {
-        return std::stof(result);
-    } catch (std::invalid_argument &) {
+inline float UnitCSVFactory::GetVariable(boost::string_view unit_key, boost::string_view attribute_key, float default_value) {
+    const Cell *cell = _GetCell(unit_key, attribute_key);
+    if (cell == nullptr || !cell->has_float) {
         return default_value;
     }
+    return cell->float_value;
 }
 
 template<>
-inline double UnitCSVFactory::GetVariable(std::string unit_key,
-        std::string const &attribute_key,
+inline double UnitCSVFactory::GetVariable(boost::string_view unit_key,
+        boost::string_view attribute_key,
         double default_value) {
-    std::string result = _GetVariable(unit_key, attribute_key);
-    if (result == DEFAULT_ERROR_VALUE) {
-        return default_value;
-    }
-    try {
-        return std::stod(result);
-    } catch (std::invalid_argument &) {
+    const Cell *cell = _GetCell(unit_key, attribute_key);
+    if (cell == nullptr || !cell->has_double) {
         return default_value;
     }
+    return cell->double_value;
 }
 
 template<>
-inline int UnitCSVFactory::GetVariable(std::string unit_key, std::string const &attribute_key, int default_value) {
-    std::string result = _GetVariable(unit_key, attribute_key);
-    if (result == DEFAULT_ERROR_VALUE) {
-        return default_value;
-    }
-    try {
-        return std::stoi(result);
-    } catch (std::invalid_argument &) {
+inline int UnitCSVFactory::GetVariable(boost::string_view unit_key, boost::string_view attribute_key, int default_value) {
+    const Cell *cell = _GetCell(unit_key, attribute_key);
+    if (cell == nullptr || !cell->has_int) {
         return default_value;
     }
+    return cell->int_value;
 }
 
 std::string GetUnitKeyFromNameAndFaction(const std::string unit_name, const std::string unit_faction);
@@ -28,6 +28,9 @@
 #ifndef _UNIT_FIND_H_
 #define _UNIT_FIND_H_
 #include "unit_util.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
 
 template<class Locator>
 void findObjectsFromPosition(CollideMap *cm,
@@ -282,6 +285,55 @@ public:
     void init(CollideMap *cm, CollideMap::iterator parent) {
     }
 };
+//With the grid broadphase, range searches only visit cells near the finder on every axis.
+//Candidates are handed to the locator ordered by x distance, so it sees them the way the sweep would.
+template<class T>
+void findObjects(CollideMap *cm, CollideMap::iterator location, UnitWithinRangeLocator<T> *check) {
+    if (is_null(location)) {
+        return;
+    }
+    QVector thispos = (**location).GetPosition();
+    float thisrad = fabs((*location)->radius);
+    if (!cm->UsesGrid() || cm->begin() == cm->end()) {
+        findObjectsFromPosition(cm, location, check, thispos, thisrad, false);
+        return;
+    }
+    check->init(cm, location);
+    CollideMap::iterator cmbegin = cm->begin();
+    std::vector<std::pair<double, CollideMap::iterator> > candidates;
+    auto gather = [&](uint32_t index) -> bool {
+        CollideMap::iterator candidate = cmbegin + index;
+        if (candidate != location && candidate->radius > 0
+                && !check->cullless(candidate) && !check->cullmore(candidate)) {
+            candidates.push_back(std::make_pair(candidate->getKey() - check->startkey, candidate));
+        }
+        return false;
+    };
+    cm->grid.Query(thispos,
+            check->radius + check->maxUnitRadius,
+            check->radius + thisrad + cm->grid.GetCellSize(),
+            gather);
+    std::sort(candidates.begin(), candidates.end(),
+            [](const std::pair<double, CollideMap::iterator> &a, const std::pair<double, CollideMap::iterator> &b) {
+                double da = fabs(a.first);
+                double db = fabs(b.first);
+                return da != db ? da < db : a.second < b.second;
+            });
+    bool workLess = true;
+    bool workMore = true;
+    for (size_t i = 0; i < candidates.size() && (workLess || workMore); ++i) {
+        bool more = candidates[i].first >= 0;
+        if (!(more ? workMore : workLess)) {
+            continue;
+        }
+        CollideMap::iterator candidate = candidates[i].second;
+        float trad = ((*candidate)->GetPosition() - thispos).Magnitude() - fabs((*candidate)->radius) - thisrad;
+        if (!check->acquire(trad, candidate)) {
+            (more ? workMore : workLess) = false;
+        }
+    }
+}
+
 class UnitPtrLocator {
     const void *unit;
 public:
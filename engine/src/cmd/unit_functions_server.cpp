@@ -37,6 +37,11 @@ bool isVSSpriteLoaded(const VSSprite *file) {
 void deleteVSSprite(VSSprite *file) {
 }
 
+//From communication_xml.cpp
+int createSound(std::string file, bool val) {
+    return -1;
+}
+
 void abletodock(int) {
 }
 
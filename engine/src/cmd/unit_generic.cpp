@@ -76,6 +76,7 @@
 #include "base_util.h"
 #include "unit_csv_factory.h"
 #include "preferred_types.h"
+#include "worker_pool.h"
 
 #include <math.h>
 #include <list>
@@ -574,6 +575,9 @@ void Unit::SetFaction(int faction) {
     for (un_iter ui = getSubUnits(); (*ui) != NULL; ++ui) {
         (*ui)->SetFaction(faction);
     }
+    if (activeStarSystem) {
+        activeStarSystem->stats.ChangeFaction(this);
+    }
 }
 
 void Unit::SetFg(Flightgroup *fg, int fg_subnumber) {
@@ -808,6 +812,10 @@ double howFarToJump() {
 }
 
 QVector SystemLocation(std::string system) {
+    int id = _Universe->getGalaxySystem(system);
+    if (id != GalaxyGraph::NO_SYSTEM) {
+        return _Universe->getGalaxyGraph().GetLocation(id);
+    }
     string xyz = _Universe->getGalaxyProperty(system, "xyz");
     QVector pos;
     if (xyz.size() && (sscanf(xyz.c_str(), "%lf %lf %lf", &pos.i, &pos.j, &pos.k) >= 3)) {
@@ -1673,6 +1681,11 @@ void Unit::Kill(bool erasefromsave, bool quitting) {
     }
     //eraticate everything. naturally (see previous line) we won't erraticate beams erraticated above
     if (!isSubUnit()) {
+        //the dead leave draw_list with the collection's cleanup rather than StarSystem::RemoveUnit,
+        //and one docked inside has no activeStarSystem, so every system forgets it here
+        for (StarSystem *ss : _Universe->star_system) {
+            ss->stats.RemoveUnit(this);
+        }
         RemoveFromSystem();
     }
     computer.target.SetUnit(NULL);
@@ -1812,9 +1825,8 @@ const Unit *loadUnitByCache(std::string name, int faction) {
 }
 
 bool DestroySystem(float hull, float maxhull, float numhits) {
-    static float damage_chance = XMLSupport::parse_float(vs_config->getVariable("physics", "damage_chance", ".005"));
-    static float guaranteed_chance =
-            XMLSupport::parse_float(vs_config->getVariable("physics", "definite_damage_chance", ".1"));
+    static const vega_config::ConfigValue<float> damage_chance("physics.damage_chance", .005F);
+    static const vega_config::ConfigValue<float> guaranteed_chance("physics.definite_damage_chance", .1F);
     float chance = 1 - (damage_chance * (guaranteed_chance + (maxhull - hull) / maxhull));
     if (numhits > 1) {
         chance = pow(chance, numhits);
@@ -4316,8 +4328,8 @@ bool isWeapon(std::string name) {
     while (0)
 
 void Unit::Repair() {
-    static float repairtime = XMLSupport::parse_float(vs_config->getVariable("physics", "RepairDroidTime", "180"));
-    static float checktime = XMLSupport::parse_float(vs_config->getVariable("physics", "RepairDroidCheckTime", "5"));
+    static const vega_config::ConfigValue<float> repairtime("physics.RepairDroidTime", 180.0F);
+    static const vega_config::ConfigValue<float> checktime("physics.RepairDroidCheckTime", 5.0F);
     if ((repairtime <= 0) || (checktime <= 0)) {
         return;
     }
@@ -4448,7 +4460,7 @@ enum Unit::tractorHow Unit::getTractorability() const {
 void Unit::RequestPhysics() {
     //Request ASAP physics
     if (getStarSystem()) {
-        getStarSystem()->RequestPhysics(this, cur_sim_queue_slot);
+        getStarSystem()->RequestPhysics(this);
     }
 }
 
@@ -4637,8 +4649,6 @@ void Unit::UpdatePhysics2(const Transformation &trans,
         UnitCollection *uc) {
     Movable::UpdatePhysics2(trans, old_physical_state, accel, difficulty, transmat, cum_vel, lastframe, uc);
 
-    this->AddVelocity(difficulty);
-
 #ifdef DEPRECATEDPLANETSTUFF
                                                                                                                             if (planet) {
         Matrix basis;
@@ -4649,10 +4659,6 @@ void Unit::UpdatePhysics2(const Transformation &trans,
         planet->cps = Transformation::from_matrix( this->cumulative_transformation_matrix );
     }
 #endif
-    this->cumulative_transformation = this->curr_physical_state;
-    this->cumulative_transformation.Compose(trans, transmat);
-    this->cumulative_transformation.to_matrix(this->cumulative_transformation_matrix);
-    this->cumulative_velocity = TransformNormal(transmat, this->Velocity) + cum_vel;
     unsigned int i, n;
     if (lastframe) {
         char tmp = 0;
@@ -4743,7 +4749,9 @@ void Unit::Thrust(const Vector &amt1, bool afterburn) {
 Vector Unit::ResolveForces(const Transformation &trans, const Matrix &transmat) {
 #ifndef PERFRAMESOUND
     //AUDAdjustSound( this->sound->engine, this->cumulative_transformation.position, this->cumulative_velocity );
-    adjustSound(SoundType::engine);
+    DeferredCommands::RunOrDefer([this]() {
+        adjustSound(SoundType::engine);
+    });
 #endif
     return Movable::ResolveForces(trans, transmat);
 }
@@ -4799,8 +4807,7 @@ void Unit::UpdatePhysics3(const Transformation &trans,
 
     float difficulty;
     Cockpit *player_cockpit = GetVelocityDifficultyMult(difficulty);
-    static float EXTRA_CARGO_SPACE_DRAG =
-            XMLSupport::parse_float(vs_config->getVariable("physics", "extra_space_drag_for_cargo", "0.005"));
+    static const vega_config::ConfigValue<float> EXTRA_CARGO_SPACE_DRAG("physics.extra_space_drag_for_cargo", 0.005F);
     if (EXTRA_CARGO_SPACE_DRAG > 0) {
         int upgfac = FactionUtil::GetUpgradeFaction();
         if ((this->faction == upgfac) || (this->name == "eject") || (this->name == "Pilot")) {
@@ -4836,7 +4843,7 @@ void Unit::UpdatePhysics3(const Transformation &trans,
             }
         }
     }
-    static float SPACE_DRAG = XMLSupport::parse_float(vs_config->getVariable("physics", "unit_space_drag", "0.000000"));
+    static const vega_config::ConfigValue<float> SPACE_DRAG("physics.unit_space_drag", 0.0F);
 
     if (SPACE_DRAG > 0) {
         Velocity = Velocity * (1 - SPACE_DRAG);
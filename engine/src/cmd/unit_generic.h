@@ -840,6 +840,8 @@ public:
     // This used to be initialized by set_null (see collide_map)
     // Right now, there's an ifdef that assigns NULL but it could be something else.
     CollideMap::iterator location[2] = {nullptr, nullptr};
+//where the unit is in its star system's physics_buffer, kept up to date by the buffer
+    UnitCollection::Slot physics_queue_slot;
     struct collideTrees *colTrees = nullptr;
 //Sets the parent to be this unit. Unit never dereferenced for this operation
     void SetCollisionParent(Unit *name);
@@ -885,6 +887,15 @@ public:
             Vector &smallNormal,
             bool bigasteroid = false,
             bool smallasteroid = false);
+    // Continuous InsideCollideTree: sweeps the smaller unit's sphere back along sweep, its motion relative
+    // to this unit over the last atom; smallcenter is where its center was when it reached this hull
+    bool SweptCollideTree(Unit *smaller,
+            const Vector &sweep,
+            QVector &bigpos,
+            Vector &bigNormal,
+            QVector &smallpos,
+            Vector &smallNormal,
+            QVector &smallcenter);
 //    virtual void reactToCollision( Unit *smaller,
 //                                   const QVector &biglocation,
 //                                   const Vector &bignormal,
@@ -61,6 +61,6 @@ void UnitJSONFactory::ParseJSON(VSFileSystem::VSFile &file) {
         std::string unit_key = unit.get("Key");
         std::string stripped_unit_key = unit_key.substr(1, unit_key.size() - 2);
 
-        UnitCSVFactory::units[stripped_unit_key] = unit_attributes;
+        UnitCSVFactory::SetUnit(stripped_unit_key, unit_attributes);
     }
 }
@@ -64,7 +64,7 @@ void UnitOptimizeFactory::RecursiveParse(std::map<std::string, std::string> unit
 
         std::string unit_key = unit_attributes["Key"];
 
-        UnitCSVFactory::units[unit_key] = unit_attributes;
+        UnitCSVFactory::SetUnit(unit_key, unit_attributes);
     }
 }
 
@@ -0,0 +1,187 @@
+/*
+ * unit_spatial_index.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "unit_spatial_index.h"
+
+#ifndef LIST_TESTING
+#include "unit_generic.h"
+#else
+#include "testcollection/unit.h"
+#endif
+#include "vs_math.h"
+
+UnitSpatialIndex::UnitSpatialIndex(double cell_size) {
+    if (!(cell_size > 0.0)) {
+        cell_size = 1000.0;
+    }
+    this->cell_size = cell_size;
+    inverse_cell_size = 1.0 / cell_size;
+}
+
+UnitSpatialIndex::~UnitSpatialIndex() {
+    Clear();
+}
+
+UnitSpatialIndex::CellKey UnitSpatialIndex::CellOf(const QVector &position) const {
+    return CellKey(position, inverse_cell_size);
+}
+
+bool UnitSpatialIndex::IsOversized(const Unit *unit) const {
+    // NaN sizes and positions end up in the oversized list, which is always checked
+    return !(unit->rSize() <= cell_size) || ISNAN(unit->Position().i);
+}
+
+UnitSpatialIndex::Bucket &UnitSpatialIndex::BucketOf(const Location &location) {
+    return location.oversized ? oversized : cells[location.cell];
+}
+
+void UnitSpatialIndex::Link(Unit *unit, Location &location) {
+    location.oversized = IsOversized(unit);
+    if (!location.oversized) {
+        location.cell = CellOf(unit->Position());
+    }
+    Bucket &bucket = BucketOf(location);
+    location.slot = bucket.size();
+    bucket.push_back(unit);
+}
+
+void UnitSpatialIndex::Unlink(const Location &location) {
+    Bucket &bucket = BucketOf(location);
+    Unit *moved = bucket.back();
+    bucket[location.slot] = moved;
+    locations[moved].slot = location.slot;
+    bucket.pop_back();
+    if (bucket.empty() && !location.oversized) {
+        cells.erase(location.cell);
+    }
+}
+
+void UnitSpatialIndex::Insert(Unit *unit) {
+    if (!unit || locations.count(unit)) {
+        return;
+    }
+    unit->Ref();
+    Link(unit, locations[unit]);
+}
+
+bool UnitSpatialIndex::Remove(const Unit *unit) {
+    vsUMap<const Unit *, Location>::iterator it = locations.find(unit);
+    if (it == locations.end()) {
+        return false;
+    }
+    const Location location = it->second;
+    Unlink(location);
+    locations.erase(unit);
+    const_cast<Unit *>(unit)->UnRef();
+    return true;
+}
+
+void UnitSpatialIndex::Refresh() {
+    std::vector<const Unit *> dead;
+    for (vsUMap<const Unit *, Location>::iterator it = locations.begin(); it != locations.end(); ++it) {
+        Unit *unit = const_cast<Unit *>(it->first);
+        if (unit->Killed()) {
+            dead.push_back(unit);
+            continue;
+        }
+        Location &location = it->second;
+        const bool oversize = IsOversized(unit);
+        if (oversize == location.oversized && (oversize || CellOf(unit->Position()) == location.cell)) {
+            continue;
+        }
+        const Location previous = location;
+        Unlink(previous);
+        Link(unit, location);
+    }
+    for (size_t i = 0; i < dead.size(); ++i) {
+        Remove(dead[i]);
+    }
+}
+
+void UnitSpatialIndex::Clear() {
+    for (vsUMap<const Unit *, Location>::iterator it = locations.begin(); it != locations.end(); ++it) {
+        const_cast<Unit *>(it->first)->UnRef();
+    }
+    locations.clear();
+    cells.clear();
+    oversized.clear();
+}
+
+bool UnitSpatialIndex::Overlaps(const Unit *unit, const QVector &center, double radius) {
+    if (unit->Killed()) {
+        return false;
+    }
+    const double reach = radius + unit->rSize();
+    return (unit->Position() - center).MagnitudeSquared() <= reach * reach;
+}
+
+void UnitSpatialIndex::QuerySphere(const QVector &center, double radius, std::vector<Unit *> &result) const {
+    for (Bucket::const_iterator it = oversized.begin(); it != oversized.end(); ++it) {
+        if (Overlaps(*it, center, radius)) {
+            result.push_back(*it);
+        }
+    }
+    if (cells.empty()) {
+        return;
+    }
+
+    // Every binned unit is at most one cell wide, so its center lies within radius + cell_size of the query center
+    const double reach = radius + cell_size;
+    const CellKey lo = CellOf(center - QVector(reach, reach, reach));
+    const CellKey hi = CellOf(center + QVector(reach, reach, reach));
+    const double span = static_cast<double>(hi.i - lo.i + 1)
+            * static_cast<double>(hi.j - lo.j + 1)
+            * static_cast<double>(hi.k - lo.k + 1);
+
+    if (!(span <= static_cast<double>(cells.size()))) {
+        // The query covers more cells than are occupied; walking the occupied ones is cheaper
+        for (vsUMap<CellKey, Bucket, CellKeyHash>::const_iterator cell = cells.begin();
+                cell != cells.end(); ++cell) {
+            for (Bucket::const_iterator it = cell->second.begin(); it != cell->second.end(); ++it) {
+                if (Overlaps(*it, center, radius)) {
+                    result.push_back(*it);
+                }
+            }
+        }
+        return;
+    }
+
+    CellKey key;
+    for (key.i = lo.i; key.i <= hi.i; ++key.i) {
+        for (key.j = lo.j; key.j <= hi.j; ++key.j) {
+            for (key.k = lo.k; key.k <= hi.k; ++key.k) {
+                vsUMap<CellKey, Bucket, CellKeyHash>::const_iterator cell = cells.find(key);
+                if (cell == cells.end()) {
+                    continue;
+                }
+                for (Bucket::const_iterator it = cell->second.begin(); it != cell->second.end(); ++it) {
+                    if (Overlaps(*it, center, radius)) {
+                        result.push_back(*it);
+                    }
+                }
+            }
+        }
+    }
+}
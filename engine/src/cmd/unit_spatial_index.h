@@ -0,0 +1,116 @@
+/*
+ * unit_spatial_index.h
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UNIT_SPATIAL_INDEX_H
+#define UNIT_SPATIAL_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "collide_grid.h"
+#include "gfx/vec.h"
+#include "gnuhash.h"
+
+class Unit;
+
+/*
+ * UnitSpatialIndex is a loose hashed grid over the bounding spheres of the
+ * units in a star system.
+ * Unlike the CollideMap, which is sorted on a single axis and ignores the
+ * size of the unit being found, a sphere query here takes each unit's rSize()
+ * into account, so the cost of a query grows with the number of units near
+ * the query sphere rather than with the population of the system.
+ *
+ * Units are binned by the cell their center falls in. Units whose radius is
+ * larger than a cell (planets, jump points, big stations) are kept in a
+ * separate list that every query checks.
+ *
+ * The index holds a reference (Unit::Ref) on every unit it contains, the same
+ * way UnitCollection does, so a unit killed between refreshes stays valid
+ * until the next Refresh() drops it.
+ */
+class UnitSpatialIndex {
+public:
+    explicit UnitSpatialIndex(double cell_size);
+    ~UnitSpatialIndex();
+
+    /* Adds a unit. Does nothing if the unit is already indexed */
+    void Insert(Unit *unit);
+
+    /* Removes a unit. Returns false if it was not indexed */
+    bool Remove(const Unit *unit);
+
+    /* Re-bins every unit whose cell or size class changed since the last
+     * refresh, and drops units that have been killed.
+     * Call once per physics frame, after the units have moved. */
+    void Refresh();
+
+    /* Removes every unit */
+    void Clear();
+
+    /* Appends to result every live unit whose bounding sphere overlaps the
+     * sphere of the given center and radius. The result is not cleared. */
+    void QuerySphere(const QVector &center, double radius, std::vector<Unit *> &result) const;
+
+    size_t size() const {
+        return locations.size();
+    }
+
+    double GetCellSize() const {
+        return cell_size;
+    }
+
+private:
+    typedef GridCellKey CellKey;
+    typedef GridCellKeyHash CellKeyHash;
+
+    /* Where a unit currently lives: either in the oversized list or in a cell,
+     * at index slot of the corresponding vector */
+    struct Location {
+        CellKey cell;
+        size_t slot;
+        bool oversized;
+    };
+
+    typedef std::vector<Unit *> Bucket;
+
+    CellKey CellOf(const QVector &position) const;
+    bool IsOversized(const Unit *unit) const;
+    void Link(Unit *unit, Location &location);
+    void Unlink(const Location &location);
+    Bucket &BucketOf(const Location &location);
+
+    static bool Overlaps(const Unit *unit, const QVector &center, double radius);
+
+    double cell_size;
+    double inverse_cell_size;
+
+    vsUMap<const Unit *, Location> locations;
+    vsUMap<CellKey, Bucket, CellKeyHash> cells;
+    Bucket oversized;
+};
+
+#endif // UNIT_SPATIAL_INDEX_H
@@ -30,6 +30,10 @@
 #endif
 #include <math.h>
 
+#include <atomic>
+#include <mutex>
+#include <vector>
+
 using vega_config::GetGameConfig;
 
 Configuration::Configuration() {
@@ -60,9 +64,15 @@ void Configuration::OverrideDefaultsWithUserConfiguration() {
     general_config.delete_old_systems = GetGameConfig().GetBool("general.deleteoldsystems", general_config.delete_old_systems);
     // vsdebug moved to logging section -- stephengtuggy 2022-05-28
     general_config.while_loading_star_system = GetGameConfig().GetBool("general.while_loading_starsystem", general_config.while_loading_star_system);
+    general_config.preload_star_systems = GetGameConfig().GetBool("general.preload_star_systems", general_config.preload_star_systems);
+    general_config.preload_star_system_distance = GetGameConfig().GetFloat("general.preload_star_system_distance", general_config.preload_star_system_distance);
 
     data_config.master_part_list = GetGameConfig().GetString("data.master_part_list", data_config.master_part_list);
     data_config.using_templates = GetGameConfig().GetBool("data.usingtemplates", data_config.using_templates);
+    data_config.pk3_cache_megabytes = GetGameConfig().GetUInt32("data.pk3_cache_megabytes", data_config.pk3_cache_megabytes);
+    data_config.index_files = GetGameConfig().GetBool("data.index_files", data_config.index_files);
+    data_config.collision_tree_cache = GetGameConfig().GetBool("data.collision_tree_cache", data_config.collision_tree_cache);
+    data_config.collision_tree_cache_megabytes = GetGameConfig().GetUInt32("data.collision_tree_cache_megabytes", data_config.collision_tree_cache_megabytes);
 
     ai.always_obedient                                  = GetGameConfig().GetBool("AI.always_obedient", ai.always_obedient);
     ai.assist_friend_in_need                            = GetGameConfig().GetBool("AI.assist_friend_in_need", ai.assist_friend_in_need);
@@ -87,6 +97,8 @@ void Configuration::OverrideDefaultsWithUserConfiguration() {
     ai.targeting_config.turn_leader_distance            = GetGameConfig().GetFloat("AI.Targetting.TurnLeaderDist", ai.targeting_config.turn_leader_distance);
     ai.targeting_config.time_to_recommand_wing          = GetGameConfig().GetFloat("AI.Targetting.TargetCommandierTime", ai.targeting_config.time_to_recommand_wing);
     ai.targeting_config.min_time_to_switch_targets      = GetGameConfig().GetFloat("AI.Targetting.MinTimeToSwitchTargets", ai.targeting_config.min_time_to_switch_targets);
+    ai.targeting_config.search_budget_microseconds      = GetGameConfig().GetFloat("AI.Targetting.SearchBudgetMicroseconds", ai.targeting_config.search_budget_microseconds);
+    ai.targeting_config.shared_search_radius            = GetGameConfig().GetFloat("AI.Targetting.SharedSearchRadius", ai.targeting_config.shared_search_radius);
 
     audio_config.every_other_mount                     = GetGameConfig().GetBool("audio.every_other_mount", audio_config.every_other_mount);
     audio_config.shuffle_songs.clear_history_on_list_change = GetGameConfig().GetBool("audio.shuffle_songs.clear_history_on_list_change", audio_config.shuffle_songs.clear_history_on_list_change);
@@ -270,6 +282,7 @@ void Configuration::OverrideDefaultsWithUserConfiguration() {
     // logging substruct
     logging.vsdebug = GetGameConfig().GetInt8("general.verbose_output", logging.vsdebug);
     logging.verbose_debug = GetGameConfig().GetBool("data.verbose_debug", logging.verbose_debug);
+    logging.asynchronous = GetGameConfig().GetBool("logging.asynchronous", logging.asynchronous);
 
     // physics substruct
     physics_config.collision_scale_factor =
@@ -323,6 +336,7 @@ void Configuration::OverrideDefaultsWithUserConfiguration() {
     physics_config.min_asteroid_distance = GetGameConfig().GetFloat("physics.min_asteroid_distance", physics_config.min_asteroid_distance);
     physics_config.steady_itts = GetGameConfig().GetBool("physics.steady_itts", physics_config.steady_itts);
     physics_config.no_unit_collisions = GetGameConfig().GetBool("physics.no_unit_collisions", physics_config.no_unit_collisions);
+    physics_config.continuous_collision = GetGameConfig().GetBool("physics.continuous_collision", physics_config.continuous_collision);
     physics_config.difficulty_based_shield_recharge = GetGameConfig().GetBool("physics.difficulty_based_shield_recharge", physics_config.difficulty_based_shield_recharge);
     physics_config.engine_energy_takes_priority = GetGameConfig().GetBool("physics.engine_energy_priority", physics_config.engine_energy_takes_priority);
     physics_config.density_of_rock = GetGameConfig().GetFloat("physics.density_of_rock", physics_config.density_of_rock);
@@ -337,6 +351,10 @@ void Configuration::OverrideDefaultsWithUserConfiguration() {
     physics_config.speeding_discharge = GetGameConfig().GetFloat("physics.speeding_discharge", physics_config.speeding_discharge);
     physics_config.min_shield_speeding_discharge = GetGameConfig().GetFloat("physics.min_shield_speeding_discharge", physics_config.min_shield_speeding_discharge);
     physics_config.nebula_shield_recharge = GetGameConfig().GetFloat("physics.nebula_shield_recharge", physics_config.nebula_shield_recharge);
+    physics_config.unit_spatial_index_cell_size = GetGameConfig().GetDouble("physics.unit_spatial_index_cell_size", physics_config.unit_spatial_index_cell_size);
+    physics_config.collide_map_broadphase = GetGameConfig().GetString("physics.collide_map_broadphase", physics_config.collide_map_broadphase);
+    physics_config.collide_grid_cell_size = GetGameConfig().GetDouble("physics.collide_grid_cell_size", physics_config.collide_grid_cell_size);
+    physics_config.worker_threads = GetGameConfig().GetUInt32("physics.worker_threads", physics_config.worker_threads);
 
     // These calculations depend on the physics.game_speed and physics.game_accel values to be set already;
     // that's why they're down here instead of with the other graphics settings
@@ -418,7 +436,46 @@ vega_config::WeaponsConfig::WeaponsConfig() :
         can_fire_in_spec(false) {
 }
 
-std::shared_ptr<Configuration> configuration() {
-    static const std::shared_ptr<Configuration> kConfiguration = std::make_shared<Configuration>();
-    return kConfiguration;
+namespace {
+
+/* Every Configuration published since the last ReleaseRetiredConfigurations, the current one last */
+struct PublishedConfigurations {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<const Configuration>> published;
+    std::atomic<const Configuration *> current;
+
+    PublishedConfigurations() : current(nullptr) {
+        //whatever game config is loaded by now; the ones loaded later come in through the reload hook
+        std::unique_ptr<Configuration> initial(new Configuration());
+        initial->OverrideDefaultsWithUserConfiguration();
+        published.emplace_back(std::move(initial));
+        current.store(published.back().get(), std::memory_order_release);
+    }
+};
+
+PublishedConfigurations &published_configurations() {
+    static PublishedConfigurations configurations;
+    return configurations;
+}
+
+}
+
+void ReloadConfiguration() {
+    std::unique_ptr<Configuration> reloaded(new Configuration());
+    reloaded->OverrideDefaultsWithUserConfiguration();
+    PublishedConfigurations &configurations = published_configurations();
+    std::lock_guard<std::mutex> lock(configurations.mutex);
+    configurations.published.emplace_back(std::move(reloaded));
+    configurations.current.store(configurations.published.back().get(), std::memory_order_release);
+}
+
+void ReleaseRetiredConfigurations() {
+    PublishedConfigurations &configurations = published_configurations();
+    std::lock_guard<std::mutex> lock(configurations.mutex);
+    configurations.published.erase(configurations.published.begin(), configurations.published.end() - 1);
+}
+
+const Configuration *configuration() {
+    static const vega_config::ConfigReloadHook kReloadHook(ReloadConfiguration);
+    return published_configurations().current.load(std::memory_order_acquire);
 }
@@ -52,6 +52,8 @@ struct GeneralConfig {
     uint32_t num_old_systems{6U};
     bool delete_old_systems{true};
     bool while_loading_star_system{false};
+    bool preload_star_systems{true};
+    float preload_star_system_distance{100000.0F};
 };
 
 struct AIFiringConfig {
@@ -68,6 +70,8 @@ struct AITargetingConfig {
     float turn_leader_distance{5.0F};
     float time_to_recommand_wing{100.0F};
     float min_time_to_switch_targets{3.0F};
+    float search_budget_microseconds{1000.0F};
+    float shared_search_radius{1000.0F};
 };
 
 struct AIConfig {
@@ -135,6 +139,14 @@ struct ComputerConfig {
 struct DataConfig {
     std::string master_part_list{"master_part_list"};
     bool using_templates{true};
+    // Inflated PK3 members kept in memory per volume, 0 to inflate them again on every read
+    uint32_t pk3_cache_megabytes{16U};
+    // Keep a list of everything below the data and home directories instead of asking the disk on every lookup
+    bool index_files{true};
+    // Keep built collision trees in the home directory, so that each mesh's tree is only built once
+    bool collision_tree_cache{true};
+    // Most the kept collision trees may take up on disk; the least recently used go first, 0 for no limit
+    uint32_t collision_tree_cache_megabytes{64U};
 
     DataConfig() = default;
 };
@@ -334,6 +346,7 @@ struct Logging {
 
     int8_t vsdebug{0};
     bool verbose_debug{false};
+    bool asynchronous{false};   // write the log file from a background thread
 };
 
 struct PhysicsConfig {
@@ -383,6 +396,7 @@ struct PhysicsConfig {
     float min_asteroid_distance{-100.0F};
     bool steady_itts{false};
     bool no_unit_collisions{false};
+    bool continuous_collision{false};    // sweep units that move more than their radius in an atom
     bool difficulty_based_shield_recharge{true};
     bool engine_energy_takes_priority{true};
     float density_of_rock{3.0F};
@@ -397,6 +411,13 @@ struct PhysicsConfig {
     float speeding_discharge{0.25F};
     float min_shield_speeding_discharge{0.1F};
     float nebula_shield_recharge{0.5F};
+    // Cell edge length of the per-system grid used to find units caught in a blast
+    double unit_spatial_index_cell_size{1000.0};
+    // Broadphase of the collide maps: "sweep" (x-sorted sweep) or "grid" (uniform hashed grid)
+    std::string collide_map_broadphase{"sweep"};
+    double collide_grid_cell_size{1000.0};
+    // Extra threads that integrate unit motion; 0 keeps unit physics on the main thread
+    uint32_t worker_threads{0U};
 
     PhysicsConfig();
 };
@@ -461,6 +482,19 @@ public:
     vega_config::WeaponsConfig weapons;
 };
 
-extern std::shared_ptr<Configuration> configuration();
+/*
+ * The current settings, in one atomic load. A reload, automatic whenever the
+ * game config is reloaded, publishes a new Configuration rather than changing
+ * this one, so a thread holding the returned pointer keeps reading one
+ * consistent set; the old one lives until ReleaseRetiredConfigurations, so
+ * the pointer must not be kept past the end of the frame.
+ */
+extern const Configuration *configuration();
+
+/* Rebuilds the settings from the game config and publishes them */
+extern void ReloadConfiguration();
+
+/* Frees the settings replaced by reloads. Once a frame, from the main loop */
+extern void ReleaseRetiredConfigurations();
 
 #endif // CONFIGURATION_H
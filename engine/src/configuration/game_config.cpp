@@ -25,6 +25,9 @@
 
 #include "configuration/game_config.h"
 
+#include <algorithm>
+#include <mutex>
+
 std::string vega_config::GameConfig::EscapedString(const std::string &input) {
     std::string rv;
     std::string::size_type rp = 0;
@@ -65,12 +68,21 @@ std::string vega_config::GameConfig::EscapedString(const std::string &input) {
     return rv;
 }
 
-boost::shared_ptr<pt::iptree> vega_config::GameConfig::variables_() {
-    static boost::shared_ptr<pt::iptree> variables_tree = boost::make_shared<pt::iptree>();
-    return variables_tree;
+namespace {
+
+boost::shared_ptr<const pt::iptree> &variables_tree() {
+    static boost::shared_ptr<const pt::iptree> tree = boost::make_shared<const pt::iptree>();
+    return tree;
+}
+
+}
+
+boost::shared_ptr<const pt::iptree> vega_config::GameConfig::variables_() {
+    return boost::atomic_load(&variables_tree());
 }
 
 void vega_config::GameConfig::LoadGameConfig(const std::string &filename) {
+    boost::shared_ptr<pt::iptree> variables = boost::make_shared<pt::iptree>();
     pt::ptree temp_ptree;
     if (boost::filesystem::exists(filename)) {
         VS_LOG(debug, (boost::format("%1%: Found game config at '%2%'") % __func__ % filename));
@@ -95,7 +107,7 @@ void vega_config::GameConfig::LoadGameConfig(const std::string &filename) {
                     }
                     std::string variable_value = iterator2.second.get<std::string>("<xmlattr>.value", "");
 //                    VS_LOG(debug, (boost::format("%1%: putting value %2% in the tree at %3%") % __func__ % variable_value % (section_name + "." + variable_name)));
-                    variables_()->put(section_name + "." + variable_name, variable_value);
+                    variables->put(section_name + "." + variable_name, variable_value);
                 } else if (boost::iequals(iterator2.first, "section")) {
                     std::string subsection_name = iterator2.second.get<std::string>("<xmlattr>.name", "");
                     if (subsection_name.empty()) {
@@ -109,7 +121,7 @@ void vega_config::GameConfig::LoadGameConfig(const std::string &filename) {
                                 continue;
                             }
                             std::string variable_value2 = iterator3.second.get<std::string>("<xmlattr>.value", "");
-                            variables_()->put(section_name + "." + subsection_name + "." + variable_name2, variable_value2);
+                            variables->put(section_name + "." + subsection_name + "." + variable_name2, variable_value2);
                         }
                     }
                 }
@@ -117,6 +129,47 @@ void vega_config::GameConfig::LoadGameConfig(const std::string &filename) {
         }
     }
 //    pt::write_xml(filename + ".variables_.out.xml", variables_()->);
+    boost::atomic_store(&variables_tree(), boost::shared_ptr<const pt::iptree>(variables));
+    ReloadSlots();
+}
+
+namespace {
+
+struct SlotRegistry {
+    std::mutex mutex;
+    std::vector<vega_config::ConfigSlot *> slots;
+};
+
+SlotRegistry &slot_registry() {
+    static SlotRegistry registry;
+    return registry;
+}
+
+}
+
+void vega_config::GameConfig::RegisterSlot(ConfigSlot *slot) {
+    SlotRegistry &registry = slot_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.slots.push_back(slot);
+}
+
+void vega_config::GameConfig::UnregisterSlot(ConfigSlot *slot) {
+    SlotRegistry &registry = slot_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.slots.erase(std::remove(registry.slots.begin(), registry.slots.end(), slot), registry.slots.end());
+}
+
+void vega_config::GameConfig::ReloadSlots() {
+    SlotRegistry &registry = slot_registry();
+    std::vector<ConfigSlot *> slots;
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        slots = registry.slots;
+    }
+    // in registration order, so that hooks registered after the values they use see them refreshed
+    for (ConfigSlot *slot : slots) {
+        slot->Reload();
+    }
 }
 
 vega_config::GameConfig &vega_config::GetGameConfig() {
@@ -36,8 +36,12 @@
 #include <map>
 #include <exception>
 #include <iostream>
+#include <atomic>
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <type_traits>
+#include <vector>
 
 #include "vs_logging.h"
 
@@ -45,16 +49,25 @@ namespace pt = boost::property_tree;
 
 namespace vega_config {
 
+class ConfigSlot;
+
 class GameConfig {
 private:
     // This is probably unique enough to ensure no collision
 //    constexpr static const char DEFAULT_ERROR_VALUE[] {"vega_config::GetGameConfig().GetVar DEFAULT_ERROR_VALUE"};
 
     static std::string EscapedString(std::string const & input);
-    static boost::shared_ptr<pt::iptree> variables_();
+    // The variables as last loaded; a load swaps in a whole new tree, so a reader keeps the one it got
+    static boost::shared_ptr<const pt::iptree> variables_();
+
+    friend class ConfigSlot;
+    static void RegisterSlot(ConfigSlot *slot);
+    static void UnregisterSlot(ConfigSlot *slot);
+    static void ReloadSlots();
 
 public:
 
+    /* Replaces all variables with those in filename, then refreshes every ConfigSlot */
     void LoadGameConfig(const std::string &filename);
 
     template<typename T>
@@ -129,6 +142,121 @@ public:
 
 extern GameConfig& GetGameConfig();
 
+/*
+ * Something that caches values from the game config. Every slot in existence
+ * is refreshed, one after the other, each time LoadGameConfig runs, on
+ * whichever thread runs it; slots must stay readable from other threads
+ * meanwhile.
+ */
+class ConfigSlot {
+public:
+    ConfigSlot() {
+        GameConfig::RegisterSlot(this);
+    }
+
+    virtual ~ConfigSlot() {
+        GameConfig::UnregisterSlot(this);
+    }
+
+    virtual void Reload() = 0;
+
+private:
+    ConfigSlot(const ConfigSlot &) = delete;
+    ConfigSlot &operator=(const ConfigSlot &) = delete;
+};
+
+namespace detail {
+
+/* Where a ConfigValue keeps its value: an atomic for plain values, so reading one stays a single load */
+template<typename T, bool = std::is_trivially_copyable<T>::value>
+class ConfigStore {
+public:
+    explicit ConfigStore(T value) : value_(value) {
+    }
+
+    T load() const {
+        return value_.load(std::memory_order_acquire);
+    }
+
+    void store(T value) {
+        value_.store(value, std::memory_order_release);
+    }
+
+private:
+    std::atomic<T> value_;
+};
+
+/* and for anything else, such as strings, a copy that a reload replaces whole */
+template<typename T>
+class ConfigStore<T, false> {
+public:
+    explicit ConfigStore(T value) : value_(std::make_shared<const T>(std::move(value))) {
+    }
+
+    T load() const {
+        return *std::atomic_load(&value_);
+    }
+
+    void store(T value) {
+        std::atomic_store(&value_, std::make_shared<const T>(std::move(value)));
+    }
+
+private:
+    std::shared_ptr<const T> value_;
+};
+
+}
+
+/*
+ * A typed handle to one config variable. The path is resolved and the value
+ * parsed when the handle is made and again on every reload, so reading it is
+ * just a load. Meant to replace
+ *     static float x = GetGameConfig().GetFloat("section.x", 1.0F);
+ * with
+ *     static const ConfigValue<float> x("section.x", 1.0F);
+ * which also picks up a reloaded config.
+ */
+template<typename T>
+class ConfigValue : public ConfigSlot {
+public:
+    ConfigValue(std::string const & path, T default_value) :
+            path_(path),
+            default_value_(default_value),
+            value_(GetGameConfig().GetVariable(path_, default_value_)) {
+    }
+
+    T get() const {
+        return value_.load();
+    }
+
+    operator T() const {
+        return value_.load();
+    }
+
+    void Reload() override {
+        value_.store(GetGameConfig().GetVariable(path_, default_value_));
+    }
+
+private:
+    const std::string path_;
+    const T default_value_;
+    detail::ConfigStore<T> value_;
+};
+
+/* Runs a callback after every reload, for settings derived from several variables */
+class ConfigReloadHook : public ConfigSlot {
+public:
+    explicit ConfigReloadHook(std::function<void()> callback) : callback_(std::move(callback)) {
+    }
+
+    void Reload() override {
+        callback_();
+    }
+
+private:
+    std::function<void()> callback_;
+};
+
 }
 
 #endif // GAME_CONFIG_H
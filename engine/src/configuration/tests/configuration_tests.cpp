@@ -24,10 +24,13 @@
 
 
 #include <gtest/gtest.h>
+#include "configuration/configuration.h"
 #include "configuration/game_config.h"
 #include "vs_logging.h"
 
+#include <atomic>
 #include <string>
+#include <thread>
 
 TEST(LoadConfig, Sanity) {
     // Test without configuration
@@ -90,3 +93,67 @@ TEST(LoadConfig, Sanity) {
 //    VS_LOG_AND_FLUSH(fatal, "Finished GetFloat performance test");
 
 }
+
+TEST(LoadConfig, ConfigValueReload) {
+    int reloads = 0;
+    const vega_config::ConfigValue<int32_t> int_value("test.int_variable", 1);
+    const vega_config::ConfigValue<std::string> string_value("test.subsection.subsection_string_variable", "World");
+    const vega_config::ConfigValue<float> missing_value("test.no_such_variable", 2.5F);
+    const vega_config::ConfigReloadHook hook([&reloads, &int_value] {
+        // values registered before the hook are already refreshed
+        EXPECT_EQ(int_value.get(), 15);
+        ++reloads;
+    });
+
+    vega_config::GetGameConfig().LoadGameConfig("test_assets/vegastrike.config");
+    EXPECT_EQ(reloads, 1);
+    EXPECT_EQ(int_value.get(), 15);
+    EXPECT_EQ(string_value.get(), "hello");
+    EXPECT_FLOAT_EQ(missing_value, 2.5F);
+
+    vega_config::GetGameConfig().LoadGameConfig("test_assets/vegastrike.config");
+    EXPECT_EQ(reloads, 2);
+    EXPECT_EQ(int_value.get(), 15);
+}
+
+TEST(LoadConfig, ReloadPublishesANewConfiguration) {
+    const Configuration *before = configuration();
+    const float pitch = before->general_config.pitch;
+
+    vega_config::GetGameConfig().LoadGameConfig("test_assets/vegastrike.config");
+    const Configuration *after = configuration();
+    EXPECT_NE(before, after);
+    // whoever still holds the old one keeps reading it, unchanged, until the frame is over
+    EXPECT_FLOAT_EQ(before->general_config.pitch, pitch);
+    ReleaseRetiredConfigurations();
+    EXPECT_EQ(configuration(), after);
+}
+
+TEST(LoadConfig, ReadableWhileReloading) {
+    const vega_config::ConfigValue<std::string> string_value("test.subsection.subsection_string_variable", "World");
+    const vega_config::ConfigValue<int32_t> int_value("test.int_variable", 1);
+    std::atomic<bool> done(false);
+    std::atomic<int> bad_reads(0);
+    std::thread reader([&] {
+        while (!done.load()) {
+            const std::string read = string_value;
+            if (read != "hello" && read != "World") {
+                ++bad_reads;
+            }
+            if (int_value != 15 && int_value != 1) {
+                ++bad_reads;
+            }
+            const Configuration *config = configuration();
+            if (config->physics_config.max_torque_multiplier <= 0.0F) {
+                ++bad_reads;
+            }
+        }
+    });
+    for (int i = 0; i < 20; ++i) {
+        vega_config::GetGameConfig().LoadGameConfig("test_assets/vegastrike.config");
+    }
+    done = true;
+    reader.join();
+    EXPECT_EQ(bad_reads.load(), 0);
+    EXPECT_EQ(string_value.get(), "hello");
+}
@@ -169,6 +169,9 @@ void AdjustIntRelation(const int myfaction, const int theirfaction, const float
 int GetPlaylist(const int myfaction);
 const float *GetSparkColor(const int myfaction);
 unsigned int GetNumFactions();
+//Goes up every time a relationship between factions may have changed
+unsigned int GetRelationsGeneration();
+void RelationsChanged();
 //Returns a conversation that a myfaction might have with a theirfaction
 FSM *GetConversation(const int myfaction, const int theirfaction);
 vega_types::SharedPtr<Texture> getForceLogo(int faction);
@@ -121,6 +121,7 @@ void FactionUtil::AdjustIntRelation(const int Myfaction, const int TheirFaction,
                 if (strcmp(factions[TheirFaction]->factionname, "upgrades") != 0) {
                     if (isPlayerFaction(TheirFaction) || game_options()->AllowNonplayerFactionChange) {
                         if (game_options()->AllowCivilWar || Myfaction != TheirFaction) {
+                            RelationsChanged();
                             factions[Myfaction]->faction[TheirFaction].relationship += factor * rank;
                             if (factions[Myfaction]->faction[TheirFaction].relationship > 1
                                     && game_options()->CappedFactionRating) {
@@ -154,6 +155,16 @@ unsigned int FactionUtil::GetNumFactions() {
     return factions.size();
 }
 
+static unsigned int relations_generation = 0;
+
+unsigned int FactionUtil::GetRelationsGeneration() {
+    return relations_generation;
+}
+
+void FactionUtil::RelationsChanged() {
+    ++relations_generation;
+}
+
 void FactionUtil::SerializeFaction(FILE *fp) {
     for (unsigned int i = 0; i < factions.size(); i++) {
         for (unsigned int j = 0; j < factions[i]->faction.size(); j++) {
@@ -186,6 +197,7 @@ int FactionUtil::numnums(const char *str) {
 }
 
 void FactionUtil::LoadSerializedFaction(FILE *fp) {
+    RelationsChanged();
     for (unsigned int i = 0; i < factions.size(); i++) {
         char *tmp = new char[24 * factions[i]->faction.size()];
         fgets(tmp, 24 * factions[i]->faction.size() - 1, fp);
@@ -244,6 +256,7 @@ void FactionUtil::LoadSerializedFaction(char *&buf) {
         savedFactions = buf;
         return;
     }
+    RelationsChanged();
     for (unsigned int i = 0; i < factions.size(); i++) {
         if (numnums(buf) == 0) {
             return;
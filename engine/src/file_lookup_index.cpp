@@ -0,0 +1,396 @@
+/*
+ * file_lookup_index.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "file_lookup_index.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "vs_logging.h"
+
+// guards against runaway symlinked trees; the data directories are nowhere near this deep
+static const unsigned int kMaxScanDepth = 32;
+
+FileLookupIndex::FileLookupIndex() : notify_fd(-1), watch_failed(false) {
+}
+
+FileLookupIndex::~FileLookupIndex() {
+    Clear();
+}
+
+std::string FileLookupIndex::Normalize(const std::string &path) {
+    std::string normalized;
+    normalized.reserve(path.size());
+    for (std::string::const_iterator c = path.begin(); c != path.end(); ++c) {
+        char character = *c;
+#ifdef _WIN32
+        if (character == '\\') {
+            character = '/';
+        }
+        character = static_cast<char>(std::tolower(static_cast<unsigned char>(character)));
+#endif
+        if (character == '/' && !normalized.empty() && normalized.back() == '/') {
+            continue;
+        }
+        // "a/./b" is "a/b"
+        if (character == '/' && normalized.size() >= 2 && normalized.back() == '.'
+                && normalized[normalized.size() - 2] == '/') {
+            normalized.pop_back();
+            continue;
+        }
+        normalized += character;
+    }
+    if (normalized.size() >= 2 && normalized.back() == '.' && normalized[normalized.size() - 2] == '/') {
+        normalized.pop_back();
+    }
+    if (normalized.size() > 1 && normalized.back() == '/') {
+        normalized.pop_back();
+    }
+    return normalized;
+}
+
+void FileLookupIndex::Build(const std::vector<std::string> &roots, const std::vector<std::string> &volatile_roots) {
+    std::lock_guard<std::mutex> lock(mutex);
+    requested_roots = roots;
+    requested_volatile_roots = volatile_roots;
+    Reset();
+}
+
+void FileLookupIndex::Refresh() {
+    std::lock_guard<std::mutex> lock(mutex);
+    Reset();
+}
+
+void FileLookupIndex::Clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    requested_roots.clear();
+    requested_volatile_roots.clear();
+    Reset();
+}
+
+size_t FileLookupIndex::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+// Throws the index away and, if there are roots to index, scans them again. The caller holds the mutex.
+void FileLookupIndex::Reset() {
+#ifdef __linux__
+    if (notify_fd >= 0) {
+        close(notify_fd);
+    }
+#endif
+    notify_fd = -1;
+    watches.clear();
+    entries.clear();
+    scanned_links.clear();
+    unscanned.clear();
+    roots.clear();
+    if (requested_roots.empty()) {
+        return;
+    }
+
+    std::vector<std::string> volatile_keys;
+    for (std::vector<std::string>::const_iterator root = requested_volatile_roots.begin();
+            root != requested_volatile_roots.end(); ++root) {
+        volatile_keys.push_back(Normalize(*root));
+    }
+#ifdef __linux__
+    if (!volatile_keys.empty()) {
+        notify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (notify_fd < 0) {
+            VS_LOG(warning, "File index: cannot watch for changes, the home directory will not be indexed");
+        }
+    }
+#endif
+
+    for (std::vector<std::string>::const_iterator requested = requested_roots.begin();
+            requested != requested_roots.end(); ++requested) {
+        const std::string key = Normalize(*requested);
+        if (key.empty()) {
+            continue;
+        }
+        const bool is_volatile = std::find(volatile_keys.begin(), volatile_keys.end(), key) != volatile_keys.end();
+        if (is_volatile && notify_fd < 0) {
+            continue;
+        }
+        // already scanned as part of another root, unless it has to be watched and that one isn't
+        const Root *outer = CoveringRoot(key);
+        if (outer != nullptr && (outer->watched || !is_volatile)) {
+            continue;
+        }
+        boost::system::error_code error;
+        if (!boost::filesystem::is_directory(*requested, error)) {
+            continue;
+        }
+        watch_failed = false;
+        entries[key] = true;
+        Scan(key, is_volatile, 0);
+        if (watch_failed) {
+            VS_LOG(warning, (boost::format("File index: cannot watch every directory below %1%, it will not be indexed")
+                    % key));
+            Unwatch(key);
+            ForgetBelow(key);
+            entries.erase(key);
+            watch_failed = false;
+            continue;
+        }
+        Root root = {key, is_volatile};
+        roots.push_back(root);
+    }
+    VS_LOG(info, (boost::format("File index: %1% entries below %2% directories") % entries.size() % roots.size()));
+}
+
+void FileLookupIndex::Scan(const std::string &directory, bool watch, unsigned int depth) {
+    if (watch && !Watch(directory)) {
+        return;
+    }
+    boost::system::error_code error;
+    boost::filesystem::directory_iterator end;
+    for (boost::filesystem::directory_iterator it(directory, error); !error && it != end; it.increment(error)) {
+        const std::string child = Normalize(directory + "/" + it->path().filename().string());
+        boost::system::error_code status_error;
+        const boost::filesystem::file_status status = it->status(status_error);
+        if (status_error || !boost::filesystem::exists(status)) {
+            // dangling link, stat() would not find it either
+            continue;
+        }
+        if (!boost::filesystem::is_directory(status)) {
+            entries[child] = false;
+            continue;
+        }
+        entries[child] = true;
+        if (depth >= kMaxScanDepth) {
+            unscanned.insert(child);
+            continue;
+        }
+        if (boost::filesystem::is_symlink(it->symlink_status(status_error))) {
+            // a second way into a tree scanned already; what is below it is real, just not indexed
+            const boost::filesystem::path target = boost::filesystem::canonical(it->path(), status_error);
+            if (status_error || !scanned_links.insert(target.string()).second) {
+                unscanned.insert(child);
+                continue;
+            }
+        }
+        Scan(child, watch, depth + 1);
+        if (watch_failed) {
+            return;
+        }
+    }
+}
+
+void FileLookupIndex::ForgetBelow(const std::string &directory) {
+    const std::string prefix = directory + "/";
+    for (std::unordered_map<std::string, bool>::iterator entry = entries.begin(); entry != entries.end();) {
+        if (entry->first.compare(0, prefix.size(), prefix) == 0) {
+            entry = entries.erase(entry);
+        } else {
+            ++entry;
+        }
+    }
+    for (std::unordered_set<std::string>::iterator entry = unscanned.begin(); entry != unscanned.end();) {
+        if (*entry == directory || entry->compare(0, prefix.size(), prefix) == 0) {
+            entry = unscanned.erase(entry);
+        } else {
+            ++entry;
+        }
+    }
+}
+
+static bool IsAtOrBelow(const std::string &path, const std::string &directory) {
+    if (path.compare(0, directory.size(), directory) != 0) {
+        return false;
+    }
+    return path.size() == directory.size() || path[directory.size()] == '/' || directory == "/";
+}
+
+// Prefers a watched root, so that lookups below it always see its latest changes
+const FileLookupIndex::Root *FileLookupIndex::CoveringRoot(const std::string &path) const {
+    const Root *covering = nullptr;
+    for (std::vector<Root>::const_iterator root = roots.begin(); root != roots.end(); ++root) {
+        if (IsAtOrBelow(path, root->path) && (covering == nullptr || root->watched)) {
+            covering = &*root;
+        }
+    }
+    return covering;
+}
+
+// Whether the path lies below a directory that was not scanned, looking at the directories after from
+bool FileLookupIndex::IsBelowUnscanned(const std::string &path, size_t from) const {
+    if (unscanned.empty()) {
+        return false;
+    }
+    for (size_t slash = path.find('/', from + 1); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+        if (unscanned.count(path.substr(0, slash))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Whether a ".." step follows position from in the path
+static bool HasParentStep(const std::string &path, size_t from) {
+    for (size_t step = path.find("/..", from); step != std::string::npos; step = path.find("/..", step + 1)) {
+        if (step + 3 == path.size() || path[step + 3] == '/') {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FileLookupIndex::Watch(const std::string &directory) {
+#ifdef __linux__
+    const int watch = inotify_add_watch(notify_fd, directory.c_str(),
+            IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+    if (watch >= 0) {
+        watches[watch] = directory;
+        return true;
+    }
+#endif
+    watch_failed = true;
+    return false;
+}
+
+void FileLookupIndex::Unwatch(const std::string &directory) {
+    for (std::unordered_map<int, std::string>::iterator watch = watches.begin(); watch != watches.end();) {
+        if (IsAtOrBelow(watch->second, directory)) {
+#ifdef __linux__
+            inotify_rm_watch(notify_fd, watch->first);
+#endif
+            watch = watches.erase(watch);
+        } else {
+            ++watch;
+        }
+    }
+}
+
+// Applies what inotify reported since the last call. The caller holds the mutex.
+void FileLookupIndex::PollChanges() {
+#ifdef __linux__
+    if (notify_fd < 0) {
+        return;
+    }
+    bool rescan = false;
+    alignas(struct inotify_event) char buffer[16384];
+    for (;;) {
+        const ssize_t length = read(notify_fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            break;
+        }
+        for (const char *position = buffer; position < buffer + length;) {
+            const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(position);
+            position += sizeof(struct inotify_event) + event->len;
+            if (event->mask & IN_Q_OVERFLOW) {
+                rescan = true;
+                continue;
+            }
+            std::unordered_map<int, std::string>::iterator watch = watches.find(event->wd);
+            if (watch == watches.end()) {
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                watches.erase(watch);
+                continue;
+            }
+            if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+                // below a root the parent reports it; a root itself going away means starting over
+                for (std::vector<Root>::const_iterator root = roots.begin(); root != roots.end(); ++root) {
+                    if (root->path == watch->second) {
+                        rescan = true;
+                    }
+                }
+                continue;
+            }
+            if (event->len == 0) {
+                continue;
+            }
+            const std::string child = Normalize(watch->second + "/" + event->name);
+            if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                boost::system::error_code error;
+                const boost::filesystem::file_status status = boost::filesystem::status(child, error);
+                if (error || !boost::filesystem::exists(status)) {
+                    continue;
+                }
+                if (boost::filesystem::is_directory(status)) {
+                    entries[child] = true;
+                    Scan(child, true, 0);
+                } else {
+                    entries[child] = false;
+                }
+            } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                entries.erase(child);
+                if (event->mask & IN_ISDIR) {
+                    ForgetBelow(child);
+                    Unwatch(child);
+                }
+            }
+        }
+    }
+    if (rescan || watch_failed) {
+        if (watch_failed) {
+            VS_LOG(warning, "File index: lost track of a watched directory, scanning again");
+        }
+        Reset();
+    }
+#endif
+}
+
+FileLookupIndex::Result FileLookupIndex::Find(const std::string &path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (roots.empty()) {
+        return NotCovered;
+    }
+    const std::string key = Normalize(path);
+    const Root *root = CoveringRoot(key);
+    if (root == nullptr) {
+        return NotCovered;
+    }
+    if (root->watched) {
+        PollChanges();
+        root = CoveringRoot(key);
+        if (root == nullptr) {
+            return NotCovered;
+        }
+    }
+    // "root/../music" may be anywhere, and below an unscanned directory only the disk knows
+    const size_t below = root->path == "/" ? 0 : root->path.size();
+    if (HasParentStep(key, below) || IsBelowUnscanned(key, below)) {
+        return NotCovered;
+    }
+    std::unordered_map<std::string, bool>::const_iterator entry = entries.find(key);
+    if (entry == entries.end()) {
+        return Missing;
+    }
+    return entry->second ? Directory : RegularFile;
+}
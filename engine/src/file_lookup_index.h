@@ -0,0 +1,104 @@
+/*
+ * file_lookup_index.h
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef FILE_LOOKUP_INDEX_H
+#define FILE_LOOKUP_INDEX_H
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * Answers "is there a file or a directory at this path" for everything
+ * below a set of root directories without asking the disk. The roots are
+ * scanned once and every entry below them is kept in a hash set, so a path
+ * under an indexed root that is not in the set is a known miss.
+ *
+ * Roots that change while the game runs (the home directory) are only
+ * indexed where their changes can be watched (inotify on Linux); every
+ * lookup under them first applies the changes reported since the previous
+ * one. Elsewhere they are left out and lookups under them come back as
+ * NotCovered, for the caller to stat. The other roots are expected to stay
+ * put until Refresh() is called.
+ */
+class FileLookupIndex {
+public:
+    enum Result {
+        NotCovered,
+        Missing,
+        RegularFile,
+        Directory
+    };
+
+    FileLookupIndex();
+    ~FileLookupIndex();
+
+    /* Indexes every root that is a directory; volatile_roots lists the ones written to at runtime */
+    void Build(const std::vector<std::string> &roots, const std::vector<std::string> &volatile_roots);
+    /* Scans the roots given to Build() again */
+    void Refresh();
+    void Clear();
+
+    Result Find(const std::string &path);
+
+    size_t size() const;
+
+    /*
+     * Path spelling used for the keys: no repeated or trailing slashes, case folded where the file system is.
+     * ".." is left alone, as it means the parent of wherever a symlink led; Find leaves such paths to the disk.
+     */
+    static std::string Normalize(const std::string &path);
+
+private:
+    struct Root {
+        std::string path;
+        bool watched;
+    };
+
+    void Scan(const std::string &directory, bool watch, unsigned int depth);
+    void ForgetBelow(const std::string &directory);
+    void Unwatch(const std::string &directory);
+    const Root *CoveringRoot(const std::string &path) const;
+    bool IsBelowUnscanned(const std::string &path, size_t from) const;
+    bool Watch(const std::string &directory);
+    void PollChanges();
+    void Reset();
+
+    mutable std::mutex mutex;
+    std::vector<std::string> requested_roots;
+    std::vector<std::string> requested_volatile_roots;
+    std::vector<Root> roots;
+    std::unordered_map<std::string, bool> entries;     // path -> is a directory
+    std::unordered_set<std::string> scanned_links;     // canonical paths of the symlinked directories already scanned
+    std::unordered_set<std::string> unscanned;         // directories whose contents were left out, for the disk to answer
+    int notify_fd;
+    std::unordered_map<int, std::string> watches;      // inotify watch -> directory
+    bool watch_failed;
+};
+
+#endif // FILE_LOOKUP_INDEX_H
@@ -0,0 +1,162 @@
+/*
+ * file_lookup_index_tests.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "file_lookup_index.h"
+
+class FileLookupIndexTest : public ::testing::Test {
+protected:
+    boost::filesystem::path root;
+
+    void SetUp() override {
+        root = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("vs-index-%%%%-%%%%");
+        boost::filesystem::create_directories(root / "textures" / "backgrounds");
+        Touch("textures/backgrounds/stars.png");
+        Touch("readme.txt");
+    }
+
+    void TearDown() override {
+        boost::system::error_code error;
+        boost::filesystem::remove_all(root, error);
+    }
+
+    void Touch(const std::string &relative) {
+        FILE *file = fopen((root / relative).string().c_str(), "w");
+        ASSERT_NE(file, nullptr);
+        fclose(file);
+    }
+
+    std::string Path(const std::string &relative) const {
+        return root.string() + "/" + relative;
+    }
+};
+
+TEST_F(FileLookupIndexTest, Normalize) {
+    EXPECT_EQ(FileLookupIndex::Normalize("a//b/"), "a/b");
+    EXPECT_EQ(FileLookupIndex::Normalize("a/./b/."), "a/b");
+    EXPECT_EQ(FileLookupIndex::Normalize("/"), "/");
+    EXPECT_EQ(FileLookupIndex::Normalize("../data//units"), "../data/units");
+}
+
+TEST_F(FileLookupIndexTest, AnswersHitsAndMisses) {
+    FileLookupIndex index;
+    index.Build(std::vector<std::string>(1, root.string()), std::vector<std::string>());
+
+    EXPECT_EQ(index.Find(Path("readme.txt")), FileLookupIndex::RegularFile);
+    EXPECT_EQ(index.Find(Path("textures//backgrounds/stars.png")), FileLookupIndex::RegularFile);
+    EXPECT_EQ(index.Find(Path("textures/backgrounds")), FileLookupIndex::Directory);
+    EXPECT_EQ(index.Find(Path("textures/missing.png")), FileLookupIndex::Missing);
+    EXPECT_EQ(index.Find(root.string() + "-other/readme.txt"), FileLookupIndex::NotCovered);
+}
+
+TEST_F(FileLookupIndexTest, UnwatchedRootsChangeOnlyOnRefresh) {
+    FileLookupIndex index;
+    index.Build(std::vector<std::string>(1, root.string()), std::vector<std::string>());
+
+    Touch("textures/new.png");
+    EXPECT_EQ(index.Find(Path("textures/new.png")), FileLookupIndex::Missing);
+    index.Refresh();
+    EXPECT_EQ(index.Find(Path("textures/new.png")), FileLookupIndex::RegularFile);
+
+    index.Clear();
+    EXPECT_EQ(index.Find(Path("textures/new.png")), FileLookupIndex::NotCovered);
+    EXPECT_EQ(index.size(), 0U);
+}
+
+TEST_F(FileLookupIndexTest, FollowsChangesBelowVolatileRoots) {
+    const std::vector<std::string> roots(1, root.string());
+    FileLookupIndex index;
+    index.Build(roots, roots);
+    if (index.Find(Path("readme.txt")) == FileLookupIndex::NotCovered) {
+        // no way to watch for changes here, so volatile roots are left to the disk
+        EXPECT_EQ(index.size(), 0U);
+        return;
+    }
+
+    Touch("save.txt");
+    EXPECT_EQ(index.Find(Path("save.txt")), FileLookupIndex::RegularFile);
+
+    boost::filesystem::create_directories(root / "sectors" / "milky_way");
+    Touch("sectors/milky_way/sol.system");
+    EXPECT_EQ(index.Find(Path("sectors/milky_way")), FileLookupIndex::Directory);
+    EXPECT_EQ(index.Find(Path("sectors/milky_way/sol.system")), FileLookupIndex::RegularFile);
+
+    boost::filesystem::rename(root / "sectors", root / "old_sectors");
+    EXPECT_EQ(index.Find(Path("sectors/milky_way/sol.system")), FileLookupIndex::Missing);
+    EXPECT_EQ(index.Find(Path("old_sectors/milky_way/sol.system")), FileLookupIndex::RegularFile);
+
+    boost::filesystem::remove_all(root / "textures");
+    EXPECT_EQ(index.Find(Path("textures/backgrounds/stars.png")), FileLookupIndex::Missing);
+    EXPECT_EQ(index.Find(Path("textures")), FileLookupIndex::Missing);
+}
+
+TEST_F(FileLookupIndexTest, LeavesParentStepsToTheDisk) {
+    FileLookupIndex index;
+    index.Build(std::vector<std::string>(1, root.string()), std::vector<std::string>());
+
+    EXPECT_EQ(index.Find(Path("textures/../readme.txt")), FileLookupIndex::NotCovered);
+    EXPECT_EQ(index.Find(Path("textures/backgrounds/../../readme.txt")), FileLookupIndex::NotCovered);
+    EXPECT_EQ(index.Find(Path("..")), FileLookupIndex::NotCovered);
+    // only whole ".." steps count
+    Touch("..hidden");
+    index.Refresh();
+    EXPECT_EQ(index.Find(Path("..hidden")), FileLookupIndex::RegularFile);
+    EXPECT_EQ(index.Find(Path("textures/..missing")), FileLookupIndex::Missing);
+}
+
+TEST_F(FileLookupIndexTest, LeavesSecondLinksToATreeToTheDisk) {
+    boost::filesystem::create_directories(root / "music");
+    Touch("music/victory.ogg");
+    boost::system::error_code error;
+    boost::filesystem::create_directory_symlink(root / "music", root / "first", error);
+    if (error) {
+        // no symlinks here
+        return;
+    }
+    boost::filesystem::create_directory_symlink(root / "music", root / "second", error);
+    ASSERT_FALSE(error);
+
+    FileLookupIndex index;
+    index.Build(std::vector<std::string>(1, root.string()), std::vector<std::string>());
+
+    EXPECT_EQ(index.Find(Path("music/victory.ogg")), FileLookupIndex::RegularFile);
+    EXPECT_EQ(index.Find(Path("first")), FileLookupIndex::Directory);
+    EXPECT_EQ(index.Find(Path("second")), FileLookupIndex::Directory);
+    // whichever link was scanned second has its files answered by the disk, not reported missing
+    const FileLookupIndex::Result first = index.Find(Path("first/victory.ogg"));
+    const FileLookupIndex::Result second = index.Find(Path("second/victory.ogg"));
+    EXPECT_NE(first, FileLookupIndex::Missing);
+    EXPECT_NE(second, FileLookupIndex::Missing);
+    EXPECT_TRUE(first == FileLookupIndex::NotCovered || second == FileLookupIndex::NotCovered);
+    EXPECT_EQ(index.Find(Path("music/missing.ogg")), FileLookupIndex::Missing);
+}
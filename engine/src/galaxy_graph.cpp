@@ -0,0 +1,209 @@
+/*
+ * galaxy_graph.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "galaxy_graph.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+
+const int GalaxyGraph::NO_SYSTEM;
+
+// routes kept before the cache starts over
+static const size_t MAX_CACHED_ROUTES = 4096;
+
+void GalaxyGraph::Clear() {
+    ids.clear();
+    names.clear();
+    adjacent_names.clear();
+    jump_offsets.clear();
+    jumps.clear();
+    coordinates.clear();
+    has_location.clear();
+    factions.clear();
+    length_weight = 0.0;
+    longest_jump = 0.0;
+    source = nullptr;
+    source_generation = 0;
+    routes.clear();
+}
+
+int GalaxyGraph::AddSystem(const std::string &name) {
+    std::unordered_map<std::string, int>::const_iterator found = ids.find(name);
+    if (found != ids.end()) {
+        return found->second;
+    }
+    int system = static_cast<int>(names.size());
+    ids[name] = system;
+    names.push_back(name);
+    adjacent_names.push_back(std::vector<std::string>());
+    coordinates.resize(coordinates.size() + 3, 0.0);
+    has_location.push_back(0);
+    factions.push_back(std::string());
+    return system;
+}
+
+void GalaxyGraph::SetJumps(int system, const std::string &value) {
+    std::vector<std::string> destinations;
+    std::string::size_type pos = 0, sep;
+    while ((sep = value.find(' ', pos)) != std::string::npos) {
+        if (sep > pos) {
+            destinations.push_back(value.substr(pos, sep - pos));
+        }
+        pos = sep + 1;
+    }
+    if (pos < value.length()) {
+        destinations.push_back(value.substr(pos));
+    }
+    for (const std::string &destination : destinations) {
+        AddSystem(destination);
+    }
+    adjacent_names[system].swap(destinations);
+}
+
+void GalaxyGraph::SetLocation(int system, const std::string &xyz) {
+    double *pos = &coordinates[3 * system];
+    if (xyz.size() && sscanf(xyz.c_str(), "%lf %lf %lf", &pos[0], &pos[1], &pos[2]) >= 3) {
+        has_location[system] = 1;
+    } else {
+        pos[0] = pos[1] = pos[2] = 0.0;
+        has_location[system] = 0;
+    }
+}
+
+void GalaxyGraph::SetFaction(int system, const std::string &faction) {
+    factions[system] = faction;
+}
+
+void GalaxyGraph::Finish() {
+    size_t count = names.size();
+    jump_offsets.assign(1, 0);
+    jumps.clear();
+    for (size_t system = 0; system < count; ++system) {
+        for (const std::string &destination : adjacent_names[system]) {
+            jumps.push_back(ids[destination]);
+        }
+        jump_offsets.push_back(static_cast<uint32_t>(jumps.size()));
+    }
+
+    double total_length = 0.0;
+    longest_jump = 0.0;
+    bool all_located = true;
+    for (size_t system = 0; system < count; ++system) {
+        for (uint32_t i = jump_offsets[system]; i < jump_offsets[system + 1]; ++i) {
+            if (!has_location[system] || !has_location[jumps[i]]) {
+                all_located = false;
+            }
+            double length = JumpLength(static_cast<int>(system), jumps[i]);
+            total_length += length;
+            longest_jump = std::max(longest_jump, length);
+        }
+    }
+    length_weight = 1.0 / (total_length + 1.0);
+    //a jump to or through a system with no location could go anywhere, so distances say nothing then
+    if (!all_located) {
+        longest_jump = 0.0;
+    }
+    routes.clear();
+}
+
+int GalaxyGraph::Find(const std::string &name) const {
+    std::unordered_map<std::string, int>::const_iterator found = ids.find(name);
+    return found == ids.end() ? NO_SYSTEM : found->second;
+}
+
+double GalaxyGraph::Distance(int from, int to) const {
+    const double *a = &coordinates[3 * from];
+    const double *b = &coordinates[3 * to];
+    return sqrt((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]));
+}
+
+double GalaxyGraph::JumpLength(int from, int to) const {
+    if (!has_location[from] || !has_location[to]) {
+        return 0.0;
+    }
+    return Distance(from, to);
+}
+
+double GalaxyGraph::Heuristic(int system, int goal) const {
+    if (longest_jump <= 0.0) {
+        return 0.0;
+    }
+    //no jump is longer than longest_jump, and no path is shorter than the straight line
+    double distance = Distance(system, goal);
+    return distance / longest_jump + distance * length_weight;
+}
+
+const std::vector<int> &GalaxyGraph::FindJumpPath(int from, int to) const {
+    uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(from)) << 32) | static_cast<uint32_t>(to);
+    std::unordered_map<uint64_t, std::vector<int> >::const_iterator cached = routes.find(key);
+    if (cached != routes.end()) {
+        return cached->second;
+    }
+    if (routes.size() >= MAX_CACHED_ROUTES) {
+        routes.clear();
+    }
+    std::vector<int> &path = routes[key];
+
+    const double unreached = std::numeric_limits<double>::infinity();
+    std::vector<double> cost(names.size(), unreached);
+    std::vector<int> came_from(names.size(), NO_SYSTEM);
+    typedef std::pair<double, int> OpenSystem;
+    std::priority_queue<OpenSystem, std::vector<OpenSystem>, std::greater<OpenSystem> > open;
+    cost[from] = 0.0;
+    open.push(OpenSystem(Heuristic(from, to), from));
+    while (!open.empty()) {
+        OpenSystem current = open.top();
+        open.pop();
+        int system = current.second;
+        if (system == to) {
+            break;
+        }
+        if (current.first > cost[system] + Heuristic(system, to)) {
+            continue;
+        }                 //reached more cheaply since this was queued
+        for (uint32_t i = jump_offsets[system]; i < jump_offsets[system + 1]; ++i) {
+            int next = jumps[i];
+            double next_cost = cost[system] + 1.0 + JumpLength(system, next) * length_weight;
+            if (next_cost < cost[next]) {
+                cost[next] = next_cost;
+                came_from[next] = system;
+                open.push(OpenSystem(next_cost + Heuristic(next, to), next));
+            }
+        }
+    }
+    if (cost[to] != unreached) {
+        for (int system = to; system != NO_SYSTEM; system = came_from[system]) {
+            path.push_back(system);
+        }
+        std::reverse(path.begin(), path.end());
+    }
+    return path;
+}
@@ -0,0 +1,145 @@
+/*
+ * galaxy_graph.h
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#ifndef GALAXY_GRAPH_H
+#define GALAXY_GRAPH_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gfx/vec.h"
+
+/*
+ * The jump network of the galaxy, compiled for lookups.
+ *
+ * Every system gets a small integer id. The jumps out of a system are kept
+ * as one contiguous run of ids (compressed sparse rows), next to the
+ * destination names as the galaxy spells them, and the coordinates and
+ * faction of each system are parsed once.
+ *
+ * FindJumpPath runs A* for the path with the fewest jumps, and among those
+ * the shortest in space. Routes are cached until the graph is rebuilt.
+ *
+ * To build, AddSystem every system, set what is known about them, then
+ * Finish. Destinations that are not systems of their own are added by
+ * SetJumps, with no jumps, location or faction.
+ */
+class GalaxyGraph {
+public:
+    static const int NO_SYSTEM = -1;
+
+    void Clear();
+    /* Returns the id of the system, adding it if it is new */
+    int AddSystem(const std::string &name);
+    /* The space separated destinations, as in the galaxy's "jumps" */
+    void SetJumps(int system, const std::string &jumps);
+    /* "x y z"; anything else leaves the system without a location */
+    void SetLocation(int system, const std::string &xyz);
+    void SetFaction(int system, const std::string &faction);
+    void Finish();
+
+    /* NO_SYSTEM if there is no system of that exact name */
+    int Find(const std::string &name) const;
+
+    size_t GetNumSystems() const {
+        return names.size();
+    }
+
+    const std::string &GetName(int system) const {
+        return names[system];
+    }
+
+    const std::vector<std::string> &GetAdjacentNames(int system) const {
+        return adjacent_names[system];
+    }
+
+    size_t GetNumAdjacent(int system) const {
+        return jump_offsets[system + 1] - jump_offsets[system];
+    }
+
+    int GetAdjacent(int system, size_t which) const {
+        return jumps[jump_offsets[system] + which];
+    }
+
+    bool HasLocation(int system) const {
+        return has_location[system] != 0;
+    }
+
+    /* The origin when the system has no location */
+    QVector GetLocation(int system) const {
+        return QVector(coordinates[3 * system], coordinates[3 * system + 1], coordinates[3 * system + 2]);
+    }
+
+    const std::string &GetFaction(int system) const {
+        return factions[system];
+    }
+
+    /*
+     * The systems from the first to the last, both included, or nothing if
+     * there is no way through. The reference is good until the next call.
+     */
+    const std::vector<int> &FindJumpPath(int from, int to) const;
+
+    /* Which state of the galaxy the graph was built from */
+    void SetSource(const void *galaxy, unsigned int generation) {
+        source = galaxy;
+        source_generation = generation;
+    }
+
+    bool IsBuiltFrom(const void *galaxy, unsigned int generation) const {
+        return source == galaxy && source_generation == generation;
+    }
+
+private:
+    double Distance(int from, int to) const;
+    double JumpLength(int from, int to) const;
+    double Heuristic(int system, int goal) const;
+
+    std::unordered_map<std::string, int> ids;
+    std::vector<std::string> names;
+    std::vector<std::vector<std::string> > adjacent_names;
+    // the jumps out of system i are jumps[jump_offsets[i]] up to jumps[jump_offsets[i + 1]]
+    std::vector<uint32_t> jump_offsets;
+    std::vector<int> jumps;
+    // x, y and z of each system in turn
+    std::vector<double> coordinates;
+    std::vector<char> has_location;
+    std::vector<std::string> factions;
+
+    // a jump costs 1 plus its length times this, which keeps the lengths of a whole path below 1
+    double length_weight = 0.0;
+    // the longest jump, for the least number of jumps still needed; 0 when that cannot be trusted
+    double longest_jump = 0.0;
+
+    const void *source = nullptr;
+    unsigned int source_generation = 0;
+
+    mutable std::unordered_map<uint64_t, std::vector<int> > routes;
+};
+
+#endif // GALAXY_GRAPH_H
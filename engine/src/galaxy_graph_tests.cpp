@@ -0,0 +1,119 @@
+/*
+ * galaxy_graph_tests.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "galaxy_graph.h"
+
+class GalaxyGraphTest : public ::testing::Test {
+protected:
+    GalaxyGraph graph;
+
+    int System(const std::string &name, const std::string &jumps, const std::string &xyz) {
+        int id = graph.AddSystem(name);
+        graph.SetJumps(id, jumps);
+        graph.SetLocation(id, xyz);
+        return id;
+    }
+
+    std::vector<std::string> Path(const std::string &from, const std::string &to) const {
+        std::vector<std::string> names;
+        for (int system : graph.FindJumpPath(graph.Find(from), graph.Find(to))) {
+            names.push_back(graph.GetName(system));
+        }
+        return names;
+    }
+};
+
+TEST_F(GalaxyGraphTest, FewestJumpsThenShortest) {
+    // a-b-d and a-c-d both take two jumps, through c is shorter; a-e-f-d is shortest but takes three
+    System("s/a", "s/b s/c s/e", "0 0 0");
+    System("s/b", "s/d", "0 100 0");
+    System("s/c", "s/d", "50 10 0");
+    System("s/d", "", "100 0 0");
+    System("s/e", "s/f", "30 0 0");
+    System("s/f", "s/d", "60 0 0");
+    graph.Finish();
+
+    EXPECT_EQ(Path("s/a", "s/d"), std::vector<std::string>({"s/a", "s/c", "s/d"}));
+    EXPECT_EQ(Path("s/a", "s/a"), std::vector<std::string>({"s/a"}));
+    EXPECT_TRUE(Path("s/d", "s/a").empty());
+}
+
+TEST_F(GalaxyGraphTest, AddsDestinationsAndKeepsTheirSpelling) {
+    int a = System("s/a", "s/b  t/c", "1 2 3");
+    graph.SetFaction(a, "confed");
+    graph.Finish();
+
+    ASSERT_EQ(graph.GetNumSystems(), 3u);
+    EXPECT_EQ(graph.GetAdjacentNames(a), std::vector<std::string>({"s/b", "t/c"}));
+    ASSERT_EQ(graph.GetNumAdjacent(a), 2u);
+    EXPECT_EQ(graph.GetAdjacent(a, 1), graph.Find("t/c"));
+    EXPECT_EQ(graph.GetNumAdjacent(graph.Find("t/c")), 0u);
+    EXPECT_EQ(graph.Find("t/d"), GalaxyGraph::NO_SYSTEM);
+
+    EXPECT_TRUE(graph.HasLocation(a));
+    EXPECT_FALSE(graph.HasLocation(graph.Find("s/b")));
+    EXPECT_EQ(graph.GetFaction(a), "confed");
+}
+
+TEST_F(GalaxyGraphTest, UnlocatedSystemsStillRoute) {
+    // the long way round is located, the short one goes through a system with no coordinates
+    System("s/a", "s/x s/b", "0 0 0");
+    System("s/x", "s/d", "");
+    System("s/b", "s/c", "10 0 0");
+    System("s/c", "s/d", "20 0 0");
+    System("s/d", "", "30 0 0");
+    graph.Finish();
+
+    EXPECT_EQ(Path("s/a", "s/d"), std::vector<std::string>({"s/a", "s/x", "s/d"}));
+}
+
+TEST_F(GalaxyGraphTest, RebuildDropsCachedRoutes) {
+    System("s/a", "s/b", "0 0 0");
+    System("s/b", "", "10 0 0");
+    graph.Finish();
+    EXPECT_EQ(Path("s/a", "s/b").size(), 2u);
+    EXPECT_EQ(Path("s/a", "s/b").size(), 2u);
+
+    graph.Clear();
+    System("s/a", "", "0 0 0");
+    System("s/b", "", "10 0 0");
+    graph.Finish();
+    EXPECT_TRUE(Path("s/a", "s/b").empty());
+}
+
+TEST_F(GalaxyGraphTest, SourceTracking) {
+    int galaxy = 0;
+    EXPECT_FALSE(graph.IsBuiltFrom(&galaxy, 1));
+    graph.SetSource(&galaxy, 1);
+    EXPECT_TRUE(graph.IsBuiltFrom(&galaxy, 1));
+    EXPECT_FALSE(graph.IsBuiltFrom(&galaxy, 2));
+    EXPECT_FALSE(graph.IsBuiltFrom(nullptr, 1));
+}
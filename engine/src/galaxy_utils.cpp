@@ -36,8 +36,6 @@
 
 #include <vector>
 #include <string>
-#include <map>
-#include <deque>
 #include <algorithm>
 
 using namespace XMLSupport;
@@ -261,73 +259,81 @@ void MakeStarSystem(string file, Galaxy *galaxy, string origin, int forcerandom)
     generateStarSystem(si);
 }
 
-std::string Universe::getGalaxyProperty(const std::string &sys, const std::string &prop) {
-    string sector = getStarSystemSector(sys);
-    string name = RemoveDotSystem(getStarSystemName(sys).c_str());
+static string galaxyProperty(Galaxy *galaxy, const string &sector, const string &name, const string &prop) {
     return galaxy->getVariable(sector, name, prop,
             galaxy->getVariable(sector,
                     prop,
                     galaxy->getVariable("unknown_sector", "min", prop, "")));
 }
 
-std::string Universe::getGalaxyPropertyDefault(const std::string &sys, const std::string &prop, const std::string def) {
+std::string Universe::getGalaxyProperty(const std::string &sys, const std::string &prop) {
     string sector = getStarSystemSector(sys);
     string name = RemoveDotSystem(getStarSystemName(sys).c_str());
-    return galaxy->getVariable(sector, name, prop, def);
+    return galaxyProperty(galaxy.get(), sector, name, prop);
 }
 
-const vector<std::string> &Universe::getAdjacentStarSystems(const std::string &file) const {
-    string sector = getStarSystemSector(file);
-    string name = RemoveDotSystem(getStarSystemName(file).c_str());
-    return ParseDestinations(galaxy->getVariable(sector, name, "jumps", ""));
+std::string Universe::getGalaxyPropertyDefault(const std::string &sys, const std::string &prop, const std::string def) {
+    string sector = getStarSystemSector(sys);
+    string name = RemoveDotSystem(getStarSystemName(sys).c_str());
+    return galaxy->getVariable(sector, name, prop, def);
 }
 
-void Universe::getJumpPath(const std::string &from, const std::string &to, vector<std::string> &path) const {
-    map<string, unsigned int> visited;
-    vector<const string *> origin;
-    deque<const string *> open;
-
-    // seed with starting point
-    visited[from] = 0;
-    origin.push_back(NULL);
-    open.push_back(&from);
-
-    // Textbook BFS search
-    while (!open.empty()) {
-        const string *system = open.front();
-        open.pop_front();
-
-        const vector<std::string> &adjacent = getAdjacentStarSystems(*system);
-        for (vector<std::string>::const_iterator i = adjacent.begin(); i != adjacent.end(); ++i) {
-            map<string, unsigned int>::const_iterator velem = visited.find(*i);
-            if (velem == visited.end()) {
-                visited[*i] = origin.size();
-                origin.push_back(system);
-                velem = visited.find(*i);
-
-                if (*i == to) {
-                    // finished we are
-                    open.clear();
-                    break;
-                } else {
-                    open.push_back(&velem->first);
+const GalaxyGraph &Universe::getGalaxyGraph() const {
+    if (!galaxy_graph.IsBuiltFrom(galaxy.get(), GalaxyXML::GetGeneration())) {
+        galaxy_graph.Clear();
+        if (galaxy) {
+            for (SubHeirarchy::iterator sector = galaxy->getHeirarchy().begin();
+                    sector != galaxy->getHeirarchy().end(); ++sector) {
+                SubHeirarchy &systems = sector->second.getHeirarchy();
+                for (SubHeirarchy::iterator system = systems.begin(); system != systems.end(); ++system) {
+                    int id = galaxy_graph.AddSystem(sector->first + "/" + system->first);
+                    galaxy_graph.SetJumps(id, system->second["jumps"]);
                 }
             }
+            //the same lookups as getGalaxyProperty, for every system including the ones only jumped to
+            for (size_t id = 0; id < galaxy_graph.GetNumSystems(); ++id) {
+                const string &file = galaxy_graph.GetName(id);
+                string sector = getStarSystemSector(file);
+                string name = RemoveDotSystem(getStarSystemName(file).c_str());
+                galaxy_graph.SetLocation(id, galaxyProperty(galaxy.get(), sector, name, "xyz"));
+                galaxy_graph.SetFaction(id, galaxyProperty(galaxy.get(), sector, name, "faction"));
+            }
         }
+        galaxy_graph.Finish();
+        galaxy_graph.SetSource(galaxy.get(), GalaxyXML::GetGeneration());
+    }
+    return galaxy_graph;
+}
+
+int Universe::getGalaxySystem(const std::string &file) const {
+    const GalaxyGraph &graph = getGalaxyGraph();
+    int id = graph.Find(file);
+    if (id == GalaxyGraph::NO_SYSTEM) {
+        id = graph.Find(getStarSystemSector(file) + "/" + RemoveDotSystem(getStarSystemName(file).c_str()));
+    }
+    return id;
+}
+
+const vector<std::string> &Universe::getAdjacentStarSystems(const std::string &file) const {
+    static const vector<std::string> none;
+    int id = getGalaxySystem(file);
+    if (id == GalaxyGraph::NO_SYSTEM) {
+        return none;
     }
+    return galaxy_graph.GetAdjacentNames(id);
+}
 
-    // Backtrack to get a reverse path
+void Universe::getJumpPath(const std::string &from, const std::string &to, vector<std::string> &path) const {
     path.clear();
-    map<string, unsigned int>::const_iterator velem = visited.find(to);
-    while (velem != visited.end()) {
-        path.push_back(velem->first);
-        if (origin[velem->second] == NULL) {
-            velem = visited.end();
-        } else {
-            velem = visited.find(*origin[velem->second]);
+    int start = getGalaxySystem(from);
+    int finish = getGalaxySystem(to);
+    if (start == GalaxyGraph::NO_SYSTEM || finish == GalaxyGraph::NO_SYSTEM) {
+        if (from == to) {
+            path.push_back(from);
         }
+        return;
+    }
+    for (int system : galaxy_graph.FindJumpPath(start, finish)) {
+        path.push_back(galaxy_graph.GetName(system));
     }
-
-    // Reverse to get the straight path
-    reverse(path.begin(), path.end());
 }
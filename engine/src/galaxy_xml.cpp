@@ -68,6 +68,12 @@ const EnumMap::Pair attribute_names[3] = {
         EnumMap::Pair("value", VALUE)
 };
 
+static unsigned int generation = 0;
+
+unsigned int GetGeneration() {
+    return generation;
+}
+
 const EnumMap element_map(element_names, 8);
 const EnumMap attribute_map(attribute_names, 3);
 class XML {
@@ -176,10 +182,12 @@ SGalaxy &SGalaxy::operator=(const SGalaxy &g) {
         subheirarchy = nullptr;
     }
     data = g.data;
+    ++generation;
     return *this;
 }
 
 SGalaxy::SGalaxy(const SGalaxy &g) : data(g.data) {
+    ++generation;
     if (g.subheirarchy) {
         subheirarchy = new SubHeirarchy(*g.subheirarchy);
     } else {
@@ -263,6 +271,7 @@ void Galaxy::writeGalaxy(VSFile &f) const {
 SGalaxy::SGalaxy(const char *configfile) {
     using namespace VSFileSystem;
     subheirarchy = NULL;
+    ++generation;
     VSFile f;
     VSError err = f.OpenReadOnly(configfile, UniverseFile);
     if (err <= Ok) {
@@ -272,7 +281,9 @@ SGalaxy::SGalaxy(const char *configfile) {
         XML_Parser parser = XML_ParserCreate(NULL);
         XML_SetUserData(parser, &x);
         XML_SetElementHandler(parser, &GalaxyXML::beginElement, &GalaxyXML::endElement);
-        XML_Parse(parser, (f.ReadFull()).c_str(), f.Size(), 1);
+        if (const char *content = f.Map()) {
+            XML_Parse(parser, content, f.Size(), 1);
+        }
         f.Close();
 
         XML_ParserFree(parser);
@@ -315,6 +326,7 @@ SGalaxy *Galaxy::getPlanetTypes() {
 }
 
 void SGalaxy::addSection(const std::vector<string> &section) {
+    ++generation;
     SubHeirarchy *temp = &getHeirarchy();
     for (unsigned int i = 0; i < section.size(); ++i) {
         temp = &((*temp)[section[i]].getHeirarchy());
@@ -322,6 +334,7 @@ void SGalaxy::addSection(const std::vector<string> &section) {
 }
 
 void SGalaxy::setVariable(const std::vector<string> &section, const string &name, const string &value) {
+    ++generation;
     SGalaxy *g = this;
     for (unsigned int i = 0; i < section.size(); ++i) {
         g = &g->getHeirarchy()[section[i]];
@@ -332,11 +345,13 @@ void SGalaxy::setVariable(const std::vector<string> &section, const string &name
 /* *********************************************************** */
 
 bool SGalaxy::setVariable(const string &section, const string &name, const string &value) {
+    ++generation;
     getHeirarchy()[section].data[name] = value;
     return true;
 }
 
 bool SGalaxy::setVariable(const string &section, const string &subsection, const string &name, const string &value) {
+    ++generation;
     getHeirarchy()[section].getHeirarchy()[subsection].data[name] = value;
     return true;
 }
@@ -127,6 +127,9 @@ public:
 };
 
 class SubHeirarchy : public vsUMap<std::string, class SGalaxy> {};
+
+/* Goes up whenever the contents of any galaxy change, so what is compiled from one can tell it is out of date */
+unsigned int GetGeneration();
 }
 
 std::string getStarSystemFileName(const std::string &input);
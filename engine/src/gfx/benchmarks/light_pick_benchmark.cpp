@@ -0,0 +1,192 @@
+/*
+ * Compares picking the lights for each mesh by looking at every local light
+ * with picking them through the LightIndex. The old light table had cells
+ * 40000 units wide, so in a battle every light shared the cell of every ship
+ * and picking amounted to the scan. Each layout places ships and their
+ * engine lights, explosions and a few wide lights; every ship then picks its
+ * strongest lights, the way GFXPickLights does for a mesh.
+ *
+ * usage: vegastrike-light-pick-benchmark [ships [explosions [repeats]]]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gfx/light_index.h"
+
+struct Light {
+    double x, y, z;
+    double radius;
+    float intensity;
+};
+
+struct Ship {
+    double x, y, z;
+    double radius;
+};
+
+struct PickResult {
+    size_t scored;
+    size_t picked;
+    double checksum;
+    double seconds;
+};
+
+static const size_t MAX_LIGHTS = 8;
+
+// what reaches the ship of the light, falling off to nothing at the edge of its reach
+struct Score {
+    const std::vector<Light> &lights;
+    const Ship *ship;
+    size_t scored;
+
+    explicit Score(const std::vector<Light> &lights) : lights(lights), ship(nullptr), scored(0) {
+    }
+
+    float operator()(int index) {
+        ++scored;
+        const Light &light = lights[index];
+        const double dx = light.x - ship->x;
+        const double dy = light.y - ship->y;
+        const double dz = light.z - ship->z;
+        const double distance = std::sqrt(dx * dx + dy * dy + dz * dz) - ship->radius;
+        if (distance <= 0.0) {
+            return light.intensity;
+        }
+        const double left = 1.0 - distance / light.radius;
+        return left > 0.0 ? static_cast<float>(light.intensity * left * left) : 0.0f;
+    }
+};
+
+static PickResult RunScan(const std::vector<Light> &lights, const std::vector<Ship> &ships, int repeats) {
+    PickResult result = {0, 0, 0.0, 0.0};
+    Score score(lights);
+    std::vector<LightIndex::Picked> best;
+    best.reserve(MAX_LIGHTS + 1);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        score.scored = result.picked = 0;
+        result.checksum = 0.0;
+        for (const Ship &ship : ships) {
+            score.ship = &ship;
+            best.clear();
+            for (size_t i = 0; i < lights.size(); ++i) {
+                float value = score(static_cast<int>(i));
+                if (value > 0.0f && (best.size() < MAX_LIGHTS || value > best.back().score)) {
+                    LightIndex::Picked picked = {static_cast<int>(i), value};
+                    best.insert(std::upper_bound(best.begin(), best.end(), picked,
+                            [](const LightIndex::Picked &a, const LightIndex::Picked &b) {
+                                return a.score > b.score;
+                            }), picked);
+                    if (best.size() > MAX_LIGHTS) {
+                        best.pop_back();
+                    }
+                }
+            }
+            result.picked += best.size();
+            for (const LightIndex::Picked &picked : best) {
+                result.checksum += picked.score;
+            }
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repeats;
+    result.scored = score.scored;
+    return result;
+}
+
+static PickResult RunIndex(const std::vector<Light> &lights, const std::vector<Ship> &ships, int repeats) {
+    PickResult result = {0, 0, 0.0, 0.0};
+    Score score(lights);
+    LightIndex index;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        // explosions come and go every frame, so the index is rebuilt every frame too
+        index.Clear();
+        for (size_t i = 0; i < lights.size(); ++i) {
+            index.Add(static_cast<int>(i), lights[i].x, lights[i].y, lights[i].z, lights[i].radius);
+        }
+        index.Build();
+        score.scored = result.picked = 0;
+        result.checksum = 0.0;
+        for (const Ship &ship : ships) {
+            score.ship = &ship;
+            const std::vector<LightIndex::Picked> &best =
+                    index.Pick(ship.x, ship.y, ship.z, ship.radius, MAX_LIGHTS, score);
+            result.picked += best.size();
+            for (const LightIndex::Picked &picked : best) {
+                result.checksum += picked.score;
+            }
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repeats;
+    result.scored = score.scored;
+    return result;
+}
+
+static void MakeLayout(const std::string &layout, size_t ship_count, size_t explosion_count,
+        std::vector<Ship> &ships, std::vector<Light> &lights) {
+    std::mt19937 random(31337);
+    const double extent = layout == "skirmish" ? 5000.0 : 60000.0;
+    std::uniform_real_distribution<double> spread(-extent, extent);
+    std::uniform_real_distribution<double> size(10.0, 300.0);
+    std::uniform_real_distribution<double> offset(-1.0, 1.0);
+    std::uniform_real_distribution<double> blast(800.0, 4000.0);
+    std::uniform_real_distribution<float> bright(0.2f, 1.0f);
+    ships.clear();
+    lights.clear();
+    for (size_t i = 0; i < ship_count; ++i) {
+        Ship ship = {spread(random), spread(random), spread(random), size(random)};
+        ships.push_back(ship);
+        // two engines each, reaching a few ship lengths
+        for (int engine = 0; engine < 2; ++engine) {
+            Light light = {ship.x + offset(random) * ship.radius, ship.y + offset(random) * ship.radius,
+                    ship.z - ship.radius, ship.radius * 4.0, bright(random)};
+            lights.push_back(light);
+        }
+    }
+    for (size_t i = 0; i < explosion_count; ++i) {
+        Light light = {spread(random), spread(random), spread(random), blast(random), bright(random)};
+        lights.push_back(light);
+    }
+    // capital ship floodlights that reach across the field
+    for (int i = 0; i < 4; ++i) {
+        Light light = {spread(random), spread(random), spread(random), extent, bright(random)};
+        lights.push_back(light);
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t ship_count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000;
+    size_t explosion_count = argc > 2 ? strtoul(argv[2], nullptr, 10) : 200;
+    int repeats = argc > 3 ? atoi(argv[3]) : 10;
+    if (ship_count == 0 || repeats <= 0) {
+        fprintf(stderr, "usage: %s [ships [explosions [repeats]]]\n", argv[0]);
+        return 1;
+    }
+
+    const char *layouts[] = {"skirmish", "fleet"};
+    printf("%-9s %-6s %7s %10s %8s %10s %14s\n", "layout", "picker", "lights", "scored", "picked", "ms/frame",
+            "picks/second");
+    for (size_t l = 0; l < sizeof(layouts) / sizeof(*layouts); ++l) {
+        std::vector<Ship> ships;
+        std::vector<Light> lights;
+        MakeLayout(layouts[l], ship_count, explosion_count, ships, lights);
+        PickResult scan = RunScan(lights, ships, repeats);
+        PickResult index = RunIndex(lights, ships, repeats);
+        printf("%-9s %-6s %7zu %10zu %8zu %10.3f %14.0f\n", layouts[l], "scan", lights.size(), scan.scored,
+                scan.picked, scan.seconds * 1000.0, ships.size() / scan.seconds);
+        printf("%-9s %-6s %7zu %10zu %8zu %10.3f %14.0f\n", layouts[l], "index", lights.size(), index.scored,
+                index.picked, index.seconds * 1000.0, ships.size() / index.seconds);
+        if (scan.picked != index.picked || std::fabs(scan.checksum - index.checksum) > 1e-3 * scan.checksum) {
+            fprintf(stderr, "%s: the pickers disagree on the lights picked\n", layouts[l]);
+            return 2;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,251 @@
+/*
+ * Compares testing planet and ship shadows the way Occlusion did before the
+ * OccluderSet, rebuilding the occluders every frame and checking each light
+ * and object pair against all of them, with the OccluderSet, which keeps the
+ * occluders, finds those near an object once for all of its lights, and runs
+ * the shadow test over arrays. Every frame the planets and the capital ships
+ * are added as occluders (the smaller ships are too small on screen to be),
+ * then every ship is tested against every light.
+ *
+ * usage: vegastrike-occlusion-benchmark [ships [lights [planets [frames]]]]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "gfx/occluder_set.h"
+
+struct Body {
+    double x, y, z;
+    float radius;
+};
+
+struct FrameResult {
+    double seconds;
+    double checksum;
+    size_t shadowed;
+};
+
+// capital ships, the occluders that are not significant
+static const size_t CAPITALS = 12;
+
+static double Distance(double ax, double ay, double az, double bx, double by, double bz) {
+    return std::sqrt((ax - bx) * (ax - bx) + (ay - by) * (ay - by) + (az - bz) * (az - bz));
+}
+
+// the occluder Occlusion used to build every frame, with plain doubles for QVector
+struct OldOccluder {
+    Body body;
+    float maxOcclusionDistance;
+    float occlusionRating;
+
+    OldOccluder(const Body &body, const OccluderSet::Light &light, const double camera[3]) : body(body) {
+        double distance = Distance(body.x, body.y, body.z, light.x, light.y, light.z) - body.radius - light.size;
+        float inner = body.radius - light.size;
+        float outer = body.radius + light.size;
+        if (inner >= 0) {
+            maxOcclusionDistance = std::numeric_limits<float>::infinity();
+        } else {
+            maxOcclusionDistance = outer >= 0 ? -(distance / inner) * 4.0 : -(distance / outer);
+            maxOcclusionDistance += light.size + body.radius;
+        }
+        double distanceSq = std::pow(Distance(body.x, body.y, body.z, light.x, light.y, light.z), 2);
+        if (distanceSq >= double(maxOcclusionDistance) * maxOcclusionDistance) {
+            occlusionRating = 0.f;
+        } else if (distance <= 0.0) {
+            occlusionRating = 1.0;
+        } else {
+            double camDistance = Distance(body.x, body.y, body.z, camera[0], camera[1], camera[2]);
+            occlusionRating = body.radius / (body.radius + distance + camDistance * 0.2);
+        }
+    }
+
+    bool operator<(const OldOccluder &other) const {
+        return occlusionRating > other.occlusionRating;
+    }
+
+    bool affects(const Body &object, float threshSize) const {
+        return body.radius >= threshSize
+                && Distance(body.x, body.y, body.z, object.x, object.y, object.z) - object.radius
+                        <= maxOcclusionDistance;
+    }
+
+    float test(const OccluderSet::Light &light, const Body &object) const {
+        double ox = body.x - light.x, oy = body.y - light.y, oz = body.z - light.z;
+        double px = object.x - light.x, py = object.y - light.y, pz = object.z - light.z;
+        double D = std::sqrt(ox * ox + oy * oy + oz * oz);
+        double lightSize = light.size;
+        double rSize = object.radius;
+        if (D <= lightSize + rSize) {
+            return 1.f;
+        }
+        if (std::pow(Distance(object.x, object.y, object.z, body.x, body.y, body.z), 2) <= rSize * rSize) {
+            return 1.f;
+        }
+        double Dinv = 1.0 / D;
+        double Tinv = 1.0 / body.radius;
+        ox *= Dinv;
+        oy *= Dinv;
+        oz *= Dinv;
+        double objD = px * ox + py * oy + pz * oz;
+        double objT = Distance(px, py, pz, ox * objD, oy * objD, oz * objD);
+        if (objD <= D) {
+            return 1.0;
+        }
+        objD *= Dinv;
+        objT *= Tinv;
+        lightSize *= Tinv;
+        rSize *= Tinv;
+        if (objD <= 1.0) {
+            return 1.0;
+        }
+        double occInner = 1.0 - lightSize - rSize;
+        double occOuter = 1.0 + lightSize + rSize;
+        double objTan = (objT - 1.0) / (objD - 1.0);
+        if (objTan > occOuter) {
+            return 1.f;
+        } else if (objTan < occInner) {
+            return 0.f;
+        } else if (occOuter != occInner) {
+            return float((objTan - occInner) / (occOuter - occInner));
+        } else {
+            return 1.f;
+        }
+    }
+};
+
+static void Tally(FrameResult &result, float occlusion) {
+    result.checksum += occlusion;
+    if (occlusion < 1.0f) {
+        ++result.shadowed;
+    }
+}
+
+static FrameResult RunOld(const std::vector<Body> &bodies, size_t planets, const std::vector<OccluderSet::Light> &lights,
+        const double camera[3], int frames) {
+    FrameResult result = {0.0, 0.0, 0};
+    std::vector<OldOccluder> forced;
+    std::priority_queue<OldOccluder> dynamic;
+    std::vector<OldOccluder> dynamic_list;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        result.checksum = 0.0;
+        result.shadowed = 0;
+        forced.clear();
+        dynamic = std::priority_queue<OldOccluder>();
+        for (size_t i = 0; i < planets + CAPITALS; ++i) {
+            OldOccluder occluder(bodies[i], lights[0], camera);
+            if (i < planets) {
+                forced.push_back(occluder);
+            } else {
+                dynamic.push(occluder);
+                while (dynamic.size() > OccluderSet::MAX_DYNAMIC) {
+                    dynamic.pop();
+                }
+            }
+        }
+        dynamic_list.clear();
+        for (; !dynamic.empty(); dynamic.pop()) {
+            dynamic_list.push_back(dynamic.top());
+        }
+        for (size_t i = planets; i < bodies.size(); ++i) {
+            for (const OccluderSet::Light &light : lights) {
+                float rv = 1.0f;
+                for (const std::vector<OldOccluder> *list : {&forced, &dynamic_list}) {
+                    for (const OldOccluder &occluder : *list) {
+                        if (rv > 0.0f && occluder.affects(bodies[i], bodies[i].radius * 4.f)) {
+                            rv *= occluder.test(light, bodies[i]);
+                        }
+                    }
+                }
+                Tally(result, rv);
+            }
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / frames;
+    return result;
+}
+
+static FrameResult RunSet(const std::vector<Body> &bodies, size_t planets, const std::vector<OccluderSet::Light> &lights,
+        const double camera[3], int frames) {
+    FrameResult result = {0.0, 0.0, 0};
+    OccluderSet set;
+    std::vector<float> occlusion(lights.size());
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        result.checksum = 0.0;
+        result.shadowed = 0;
+        set.Begin(camera[0], camera[1], camera[2], lights[0]);
+        for (size_t i = 0; i < planets + CAPITALS; ++i) {
+            set.Add(&bodies[i], 0, bodies[i].x, bodies[i].y, bodies[i].z, bodies[i].radius, i < planets);
+        }
+        for (size_t i = planets; i < bodies.size(); ++i) {
+            const OccluderSet::Receiver receiver = {bodies[i].x, bodies[i].y, bodies[i].z, bodies[i].radius};
+            set.Test(&lights[0], lights.size(), receiver, &occlusion[0]);
+            for (float value : occlusion) {
+                Tally(result, value);
+            }
+        }
+        set.End();
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / frames;
+    return result;
+}
+
+int main(int argc, char **argv) {
+    size_t ship_count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 2000;
+    size_t light_count = argc > 2 ? strtoul(argv[2], nullptr, 10) : 4;
+    size_t planets = argc > 3 ? strtoul(argv[3], nullptr, 10) : 8;
+    int frames = argc > 4 ? atoi(argv[4]) : 20;
+    if (ship_count == 0 || light_count == 0 || planets == 0 || frames <= 0) {
+        fprintf(stderr, "usage: %s [ships [lights [planets [frames]]]]\n", argv[0]);
+        return 1;
+    }
+
+    // a sun and a few other stars, planets around the sun, and ships crowding around the planets
+    std::mt19937 random(31337);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    std::vector<OccluderSet::Light> lights;
+    OccluderSet::Light sun = {0, 0, 0, 200000};
+    lights.push_back(sun);
+    for (size_t i = 1; i < light_count; ++i) {
+        OccluderSet::Light star = {unit(random) * 1e8, unit(random) * 1e8, unit(random) * 1e8, 100000};
+        lights.push_back(star);
+    }
+    std::vector<Body> bodies;
+    for (size_t i = 0; i < planets; ++i) {
+        Body planet = {unit(random) * 5e6, unit(random) * 5e6, unit(random) * 5e5, 20000.0f + 10000.0f * float(i % 8)};
+        bodies.push_back(planet);
+    }
+    for (size_t i = 0; i < CAPITALS + ship_count; ++i) {
+        const Body &planet = bodies[i % planets];
+        const float size = i < CAPITALS ? 500.0f + 100.0f * float(i)
+                : float(5.0 + 50.0 * std::pow(unit(random) * 0.5 + 0.5, 4));
+        Body ship = {planet.x + unit(random) * 1e5, planet.y + unit(random) * 1e5, planet.z + unit(random) * 1e5, size};
+        bodies.push_back(ship);
+    }
+    const double camera[3] = {bodies[planets].x, bodies[planets].y, bodies[planets].z};
+
+    printf("%-8s %7s %7s %7s %10s %10s %14s\n", "tester", "planets", "ships", "lights", "shadowed", "ms/frame",
+            "tests/second");
+    FrameResult old = RunOld(bodies, planets, lights, camera, frames);
+    FrameResult set = RunSet(bodies, planets, lights, camera, frames);
+    const size_t ships = bodies.size() - planets;
+    const double tests = double(ships) * light_count;
+    printf("%-8s %7zu %7zu %7zu %10zu %10.3f %14.0f\n", "rebuild", planets, ships, light_count, old.shadowed,
+            old.seconds * 1000.0, tests / old.seconds);
+    printf("%-8s %7zu %7zu %7zu %10zu %10.3f %14.0f\n", "set", planets, ships, light_count, set.shadowed,
+            set.seconds * 1000.0, tests / set.seconds);
+    if (old.shadowed != set.shadowed || std::fabs(old.checksum - set.checksum) > 1e-3 * tests) {
+        fprintf(stderr, "the testers disagree on the shadows\n");
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,183 @@
+/*
+ * Times one frame of a particle trail: writing the quad vertices and the
+ * update (move, fade, drop the dead). The "struct" rows do both the way
+ * ParticleTrail did before ParticleBuffer, over an array of particle structs,
+ * appending vertex floats one at a time and compacting with
+ * std::stable_partition; the "soa" rows run ParticleBuffer. One particle in
+ * twenty is spawned about to fade out, so every frame drops some, and the
+ * dead are replaced before the next frame.
+ *
+ * usage: vegastrike-particle-benchmark [frames]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "gfx/particle_buffer.h"
+
+// the layout of the particle struct ParticleTrail used to keep
+struct StructParticle {
+    float velocity[3];
+    double location[3];
+    float color[4];
+    float size;
+};
+
+struct FrameResult {
+    double update_seconds;
+    double vertex_seconds;
+    size_t alive;
+};
+
+static const double kElapsed = 1.0 / 60.0;
+static const float kFade = 0.1f;
+static const float kMinAlpha = 0.1f;
+
+static const float kCorners[12][5] = {
+        {1, 1, 0, 0, 0}, {1, -1, 0, 0, 1}, {-1, -1, 0, 1, 1}, {-1, 1, 0, 1, 0},
+        {0, 1, 1, 0, 0}, {0, -1, 1, 0, 1}, {0, -1, -1, 1, 1}, {0, 1, -1, 1, 0},
+        {1, 0, 1, 0, 0}, {1, 0, -1, 0, 1}, {-1, 0, -1, 1, 1}, {-1, 0, 1, 1, 0},
+};
+
+struct Spawn {
+    std::mt19937 random;
+    std::uniform_real_distribution<float> unit;
+
+    Spawn() : random(31337), unit(-1.0f, 1.0f) {
+    }
+
+    // one in twenty particles starts about to fade out
+    void Next(double location[3], float velocity[3], float color[4], float &size) {
+        for (int i = 0; i < 3; ++i) {
+            location[i] = unit(random) * 5000.0;
+            velocity[i] = unit(random) * 100.0f;
+            color[i] = 0.5f + 0.5f * unit(random);
+        }
+        color[3] = (random() % 20 == 0) ? kMinAlpha + 0.001f : 0.6f + 0.4f * unit(random);
+        size = 2.0f + unit(random);
+    }
+};
+
+static FrameResult RunStruct(size_t count, int frames) {
+    FrameResult result = {0.0, 0.0, 0};
+    Spawn spawn;
+    std::vector<StructParticle> particles;
+    std::vector<float> vertices;
+    for (int frame = 0; frame < frames; ++frame) {
+        while (particles.size() < count) {
+            StructParticle particle;
+            spawn.Next(particle.location, particle.velocity, particle.color, particle.size);
+            particles.push_back(particle);
+        }
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        vertices.clear();
+        vertices.reserve(particles.size() * ParticleBuffer::QUAD_FLOATS);
+        std::back_insert_iterator<std::vector<float> > v(vertices);
+        for (const StructParticle &particle : particles) {
+            float size = particle.size * (50.0f * (1.0f - particle.color[3]) + particle.color[3]);
+            float scale = particle.color[3] * 2.5f * std::min(size, particle.size) / std::max(size, particle.size);
+            for (const float *corner : kCorners) {
+                *v++ = static_cast<float>(particle.location[0]) + corner[0] * size;
+                *v++ = static_cast<float>(particle.location[1]) + corner[1] * size;
+                *v++ = static_cast<float>(particle.location[2]) + corner[2] * size;
+                for (int i = 0; i < 4; ++i) {
+                    *v++ = particle.color[i] * scale;
+                }
+                *v++ = corner[3];
+                *v++ = corner[4];
+            }
+        }
+        std::chrono::steady_clock::time_point written = std::chrono::steady_clock::now();
+        const float faded = static_cast<float>(kFade * kElapsed);
+        for (StructParticle &particle : particles) {
+            for (int i = 0; i < 3; ++i) {
+                particle.location[i] += particle.velocity[i] * kElapsed;
+            }
+            particle.color[3] = std::max(0.0f, particle.color[3] - faded);
+        }
+        particles.erase(std::stable_partition(particles.begin(), particles.end(), [](const StructParticle &item) {
+            return item.color[3] > kMinAlpha;
+        }), particles.end());
+        result.vertex_seconds += std::chrono::duration<double>(written - start).count();
+        result.update_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - written).count();
+        result.alive += particles.size();
+    }
+    result.update_seconds /= frames;
+    result.vertex_seconds /= frames;
+    result.alive /= frames;
+    return result;
+}
+
+static FrameResult RunBuffer(size_t count, int frames) {
+    FrameResult result = {0.0, 0.0, 0};
+    Spawn spawn;
+    ParticleBuffer particles;
+    std::vector<float> vertices;
+    QVector camera;
+    camera.i = camera.j = camera.k = 0.0;
+    for (int frame = 0; frame < frames; ++frame) {
+        while (particles.size() < count) {
+            double location[3];
+            float velocity[3];
+            GFXColor color;
+            float size;
+            float rgba[4];
+            spawn.Next(location, velocity, rgba, size);
+            QVector at;
+            at.i = location[0];
+            at.j = location[1];
+            at.k = location[2];
+            Vector speed;
+            speed.i = velocity[0];
+            speed.j = velocity[1];
+            speed.k = velocity[2];
+            color.r = rgba[0];
+            color.g = rgba[1];
+            color.b = rgba[2];
+            color.a = rgba[3];
+            particles.Add(at, speed, color, size);
+        }
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        vertices.resize(particles.size() * ParticleBuffer::QUAD_FLOATS);
+        particles.WriteQuads(camera, 50.0f, 2.5f, nullptr, 0, particles.size(), &vertices[0]);
+        std::chrono::steady_clock::time_point written = std::chrono::steady_clock::now();
+        particles.Advance(kElapsed, kFade, false, kMinAlpha);
+        result.vertex_seconds += std::chrono::duration<double>(written - start).count();
+        result.update_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - written).count();
+        result.alive += particles.size();
+    }
+    result.update_seconds /= frames;
+    result.vertex_seconds /= frames;
+    result.alive /= frames;
+    return result;
+}
+
+int main(int argc, char **argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 100;
+    if (frames <= 0) {
+        fprintf(stderr, "usage: %s [frames]\n", argv[0]);
+        return 1;
+    }
+
+    const size_t counts[] = {10000, 30000, 100000};
+    printf("%9s %-7s %9s %12s %12s %16s\n", "particles", "layout", "alive", "update ms", "vertex ms",
+            "updates/second");
+    for (size_t count : counts) {
+        FrameResult structs = RunStruct(count, frames);
+        FrameResult buffer = RunBuffer(count, frames);
+        printf("%9zu %-7s %9zu %12.3f %12.3f %16.0f\n", count, "struct", structs.alive,
+                structs.update_seconds * 1000.0, structs.vertex_seconds * 1000.0, count / structs.update_seconds);
+        printf("%9zu %-7s %9zu %12.3f %12.3f %16.0f\n", count, "soa", buffer.alive,
+                buffer.update_seconds * 1000.0, buffer.vertex_seconds * 1000.0, count / buffer.update_seconds);
+        if (structs.alive != buffer.alive) {
+            fprintf(stderr, "%zu: the updates disagree on the particles left alive\n", count);
+            return 2;
+        }
+    }
+    return 0;
+}
@@ -63,15 +63,11 @@ BoltDrawManager::~BoltDrawManager() {
     animations.clear();
 
     for (auto & ball : balls) {
-        for (int j = ball.size() - 1; j >= 0; j--) {
-            ball[j].Destroy(j);
-        }
+        ball.Clear();
     }
 
     for (auto & bolt : bolts) {
-        for (int j = bolt.size() - 1; j >= 0; j--) {
-            bolt[j].Destroy(j);
-        }
+        bolt.Clear();
     }
 }
 
@@ -118,7 +114,5 @@ CollideMap::iterator BoltDrawManager::AddBall(const WeaponInfo *typ,
         const Vector &shipspeed,
         void *owner,
         CollideMap::iterator hint) {
-    Bolt ball = Bolt(typ, orientationpos, shipspeed, owner, hint);             //FIXME turrets won't work! Velocity
-    _balls.push_back(ball);
-    return _balls[_balls.size() - 1].location;
+    return Bolt(typ, orientationpos, shipspeed, owner, hint).location;             //FIXME turrets won't work! Velocity
 }
@@ -44,10 +44,8 @@ public:
 
     vector<std::string> animationname;
     vector<vega_types::SharedPtr<Animation>> animations; // Balls are animated
-    vector<vector<Bolt> > bolts; // The inner vector is all of the same type.
-    vector<vector<Bolt> > balls;
-
-    vector<Bolt> _balls;
+    vector<BoltPool> bolts; // Each pool is all of the same type.
+    vector<BoltPool> balls;
 
     BoltDrawManager();
     ~BoltDrawManager();
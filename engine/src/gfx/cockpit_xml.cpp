@@ -718,7 +718,9 @@ void GameCockpit::LoadXML(VSFileSystem::VSFile &f) {
     XML_SetUserData(parser, this);
     XML_SetElementHandler(parser, &Cockpit::beginElement, &Cockpit::endElement);
 
-    XML_Parse(parser, (f.ReadFull()).c_str(), f.Size(), 1);
+    if (const char *content = f.Map()) {
+        XML_Parse(parser, content, f.Size(), 1);
+    }
     /*
      *  do {
      * #ifdef BIDBG
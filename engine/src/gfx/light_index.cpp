@@ -0,0 +1,112 @@
+/*
+ * light_index.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "light_index.h"
+
+#include <algorithm>
+#include <cmath>
+
+// the share of lights, by reach, that get cells of their own; the rest are checked by every pick
+static const double BINNED_LIGHTS = 0.9;
+
+void LightIndex::Clear() {
+    entries.clear();
+    indices.clear();
+    scratch.clear();
+    cells.clear();
+    oversized.clear();
+}
+
+void LightIndex::Add(int light, double x, double y, double z, double radius) {
+    if (!(radius >= 0.0)) {
+        return;
+    }
+    Entry entry = {light, x, y, z, radius};
+    entries.push_back(entry);
+}
+
+void LightIndex::Build() {
+    indices.clear();
+    scratch.clear();
+    cells.clear();
+    oversized.clear();
+    visited.assign(entries.size(), 0);
+    stamp = 0;
+    if (entries.empty()) {
+        return;
+    }
+
+    // cells twice as wide as the reach of all but the furthest reaching lights, so each of those touches 8 cells at most
+    radii.clear();
+    for (const Entry &entry : entries) {
+        radii.push_back(entry.radius);
+    }
+    std::vector<double>::iterator cut = radii.begin() + static_cast<size_t>((radii.size() - 1) * BINNED_LIGHTS);
+    std::nth_element(radii.begin(), cut, radii.end());
+    cell_size = *cut > 0.0 ? 2.0 * *cut : 1.0;
+    inverse_cell_size = 1.0 / cell_size;
+
+    for (uint32_t index = 0; index < entries.size(); ++index) {
+        const Entry &entry = entries[index];
+        // NaN and infinite positions never pass the cell test below, so they land in the always-visited list
+        if (!(2.0 * entry.radius <= cell_size
+                && std::isfinite(entry.x) && std::isfinite(entry.y) && std::isfinite(entry.z))) {
+            oversized.push_back(index);
+            continue;
+        }
+        const GridCellKey lo(entry.x - entry.radius, entry.y - entry.radius, entry.z - entry.radius,
+                inverse_cell_size);
+        const GridCellKey hi(entry.x + entry.radius, entry.y + entry.radius, entry.z + entry.radius,
+                inverse_cell_size);
+        // a light that fits in a cell touches two cells per axis at most; anything wider went wrong
+        // in the arithmetic (overflow to infinity, cells clamped far out), so it is checked by every pick
+        if (hi.i - lo.i > 1 || hi.j - lo.j > 1 || hi.k - lo.k > 1) {
+            oversized.push_back(index);
+            continue;
+        }
+        GridCellKey key;
+        for (key.i = lo.i; key.i <= hi.i; ++key.i) {
+            for (key.j = lo.j; key.j <= hi.j; ++key.j) {
+                for (key.k = lo.k; key.k <= hi.k; ++key.k) {
+                    scratch.push_back(std::make_pair(key, index));
+                }
+            }
+        }
+    }
+    std::sort(scratch.begin(), scratch.end());
+    cells.reserve(scratch.size());
+
+    indices.resize(scratch.size());
+    Range *range = nullptr;
+    for (size_t i = 0; i < scratch.size(); ++i) {
+        indices[i] = scratch[i].second;
+        if (i == 0 || !(scratch[i].first == scratch[i - 1].first)) {
+            // map nodes never move, so the pointer stays valid as the map grows
+            range = &cells[scratch[i].first];
+            *range = Range(static_cast<uint32_t>(i), static_cast<uint32_t>(i));
+        }
+        ++range->second;
+    }
+}
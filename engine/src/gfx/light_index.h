@@ -0,0 +1,186 @@
+/*
+ * light_index.h
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LIGHT_INDEX_H
+#define LIGHT_INDEX_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "cmd/collide_grid.h"
+
+/*
+ * LightIndex bins local lights into a uniform hashed grid by the sphere each
+ * of them reaches, so picking the lights for a mesh only looks at the lights
+ * whose sphere overlaps the mesh's.
+ *
+ * Lights are added, then Build sizes the cells after the lights themselves
+ * (most lights fit in a cell) and files every light under each cell its
+ * sphere touches. Lights that reach further than a cell are kept in a list
+ * every pick looks at. The index knows nothing of light colours: Pick asks
+ * the caller to score each candidate and keeps the best few, strongest
+ * first, in a buffer that is reused from pick to pick.
+ */
+class LightIndex {
+public:
+    struct Picked {
+        int light;
+        float score;
+    };
+
+    LightIndex() : cell_size(1.0), inverse_cell_size(1.0), stamp(0) {
+    }
+
+    void Clear();
+    /* A light reaching radius around x, y, z; lights with a NaN or negative reach are dropped */
+    void Add(int light, double x, double y, double z, double radius);
+    void Build();
+
+    size_t size() const {
+        return entries.size();
+    }
+
+    double GetCellSize() const {
+        return cell_size;
+    }
+
+    /*
+     * Calls score(light) for every light whose sphere overlaps the sphere of
+     * the given center and radius, and keeps the max_count lights that
+     * scored highest, leaving out those that scored 0 or less. Returns them
+     * strongest first; the reference is good until the next Pick.
+     */
+    template<class Scorer>
+    const std::vector<Picked> &Pick(double x, double y, double z, double radius, size_t max_count, Scorer &score) {
+        picked.clear();
+        if (max_count == 0 || entries.empty()) {
+            return picked;
+        }
+        if (++stamp == 0) {
+            // wrapped around; nothing may look visited by a pick long gone
+            std::fill(visited.begin(), visited.end(), 0);
+            stamp = 1;
+        }
+        for (std::vector<uint32_t>::const_iterator it = oversized.begin(); it != oversized.end(); ++it) {
+            Consider(*it, x, y, z, radius, max_count, score);
+        }
+        if (cells.empty()) {
+            return picked;
+        }
+        const GridCellKey lo(x - radius, y - radius, z - radius, inverse_cell_size);
+        const GridCellKey hi(x + radius, y + radius, z + radius, inverse_cell_size);
+        const double span = static_cast<double>(hi.i - lo.i + 1)
+                * static_cast<double>(hi.j - lo.j + 1)
+                * static_cast<double>(hi.k - lo.k + 1);
+        if (!(span <= static_cast<double>(cells.size()))) {
+            // a mesh wider than the lit space; every light is a candidate
+            for (uint32_t entry = 0; entry < entries.size(); ++entry) {
+                Consider(entry, x, y, z, radius, max_count, score);
+            }
+            return picked;
+        }
+        GridCellKey key;
+        for (key.i = lo.i; key.i <= hi.i; ++key.i) {
+            for (key.j = lo.j; key.j <= hi.j; ++key.j) {
+                for (key.k = lo.k; key.k <= hi.k; ++key.k) {
+                    CellMap::const_iterator cell = cells.find(key);
+                    if (cell == cells.end()) {
+                        continue;
+                    }
+                    for (uint32_t i = cell->second.first; i != cell->second.second; ++i) {
+                        Consider(indices[i], x, y, z, radius, max_count, score);
+                    }
+                }
+            }
+        }
+        return picked;
+    }
+
+private:
+    struct Entry {
+        int light;
+        double x, y, z;
+        double radius;
+    };
+
+    typedef std::pair<uint32_t, uint32_t> Range;
+    typedef vsUMap<GridCellKey, Range, GridCellKeyHash> CellMap;
+
+    template<class Scorer>
+    void Consider(uint32_t index, double x, double y, double z, double radius, size_t max_count, Scorer &score) {
+        if (visited[index] == stamp) {
+            return;
+        }
+        visited[index] = stamp;
+        const Entry &entry = entries[index];
+        const double dx = entry.x - x;
+        const double dy = entry.y - y;
+        const double dz = entry.z - z;
+        const double reach = entry.radius + radius;
+        // written so that NaN positions never overlap anything
+        if (!(dx * dx + dy * dy + dz * dz <= reach * reach)) {
+            return;
+        }
+        const float value = score(entry.light);
+        if (!(value > 0.0f)) {
+            return;
+        }
+        if (picked.size() == max_count) {
+            if (!(value > picked.back().score)) {
+                return;
+            }
+            picked.pop_back();
+        }
+        // max_count is a handful of lights, so an insertion beats any heap
+        Picked candidate = {entry.light, value};
+        std::vector<Picked>::iterator place = picked.end();
+        while (place != picked.begin() && (place - 1)->score < value) {
+            --place;
+        }
+        picked.insert(place, candidate);
+    }
+
+    double cell_size;
+    double inverse_cell_size;
+
+    std::vector<Entry> entries;
+    // entry indices grouped by cell; cells maps each occupied cell to its slice
+    std::vector<uint32_t> indices;
+    std::vector<std::pair<GridCellKey, uint32_t> > scratch;
+    std::vector<double> radii;
+    CellMap cells;
+    std::vector<uint32_t> oversized;
+
+    // the pick that last looked at each entry, as lights touching several cells turn up more than once
+    std::vector<uint32_t> visited;
+    uint32_t stamp;
+    std::vector<Picked> picked;
+};
+
+#endif // LIGHT_INDEX_H
@@ -35,7 +35,11 @@
 #include "animation.h"
 #include "faction_generic.h"
 #endif
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
 
 #include "vegastrike.h"
 #include "vs_logging.h"
@@ -214,10 +218,9 @@ struct OrigMeshLoader {
 
 #define READSTRING(inmemfile, word32index, stringlen, stringvar)                                 \
     do {     /* By Klauss - Much more efficient than the preceding code, and yet still portable */ \
-        uchar8bit *inmemstring = (uchar8bit*) (inmemfile+word32index);                               \
-        uchar8bit  oc = inmemstring[stringlen]; inmemstring[stringlen] = 0;                         \
-        stringvar    = (const char*) inmemstring;                                                  \
-        inmemstring[stringlen] = oc;                                                               \
+        const char *inmemstring = (const char*) (inmemfile+word32index);                            \
+        /* the file may be a read only mapping, so don't terminate the string in place */          \
+        stringvar.assign(inmemstring, std::find(inmemstring, inmemstring+stringlen, '\0'));       \
         word32index += (stringlen+3)/4;                                                            \
     }                                                                                              \
     while (0)
@@ -298,8 +301,8 @@ SequenceContainer<SharedPtr<Mesh>> Mesh::LoadMeshes(VSFileSystem::VSFile &Inputf
         uint32bit i32val;
         float32bit f32val;
         uchar8bit c8val[4];
-    }
-            *inmemfile;
+    };
+    const chunk32 *inmemfile;
 #ifdef STANDALONE
     // stephengtuggy 2020-10-30: Leaving this here, since this is for when running in STANDALONE mode
     printf( "Loading Mesh File: %s\n", Inputfile.GetFilename().c_str() );
@@ -311,28 +314,37 @@ SequenceContainer<SharedPtr<Mesh>> Mesh::LoadMeshes(VSFileSystem::VSFile &Inputf
         fprintf( stderr, "Corrupt file %s, aborting\n", Inputfile.GetFilename().c_str() );
         exit( -1 );
     }
-    inmemfile = (chunk32*) malloc( Inputlength+1 );
-    if (!inmemfile) {
+    chunk32 *filebuffer = (chunk32*) malloc( Inputlength+1 );
+    if (!filebuffer) {
         // stephengtuggy 2020-10-30: Leaving this here, since this is for when running in STANDALONE mode
         fprintf( stderr, "Buffer allocation failed, Aborting" );
         exit( -1 );
     }
     rewind( Inputfile );
-    fread( inmemfile, 1, Inputlength, Inputfile );
+    fread( filebuffer, 1, Inputlength, Inputfile );
     fcloseInput( Inputfile );
+    inmemfile = filebuffer;
 #else
     uint32bit Inputlength = Inputfile.Size();
     if (Inputlength < sizeof(uint32bit) * 13 || Inputlength > (1 << 30)) {
         VS_LOG_AND_FLUSH(fatal, (boost::format("Corrupt file %1%, aborting") % Inputfile.GetFilename()));
         abort();
     }
-    inmemfile = (chunk32 *) malloc(Inputlength);
-    if (!inmemfile) {
-        VS_LOG_AND_FLUSH(fatal, "Buffer allocation failed, Aborting");
+    //Parsed in place, straight from the mapped file; it stays open until we are done
+    const char *mapped = Inputfile.Map();
+    if (!mapped) {
+        VS_LOG_AND_FLUSH(fatal, (boost::format("Could not read %1%, aborting") % Inputfile.GetFilename()));
         exit(-2);
     }
-    Inputfile.Read(inmemfile, Inputlength);
-    Inputfile.Close();
+    //A member stored in a PK3 may start anywhere, and the words can't be read from there in place
+    std::vector<chunk32> aligned_copy;
+    if (reinterpret_cast<uintptr_t>(mapped) % alignof(chunk32) != 0) {
+        aligned_copy.resize((Inputlength + sizeof(chunk32) - 1) / sizeof(chunk32));
+        memcpy(aligned_copy.data(), mapped, Inputlength);
+        inmemfile = aligned_copy.data();
+    } else {
+        inmemfile = reinterpret_cast<const chunk32 *>(mapped);
+    }
 #endif
     //Extract superheader fields
     word32index += 3;
@@ -1081,7 +1093,11 @@ SequenceContainer<SharedPtr<Mesh>> Mesh::LoadMeshes(VSFileSystem::VSFile &Inputf
         }
         output.back()->numlods = output.back()->orig->front()->numlods = back_mesh.num;
     }
-    free(inmemfile);
+#ifdef STANDALONE
+    free(filebuffer);
+#else
+    Inputfile.Close();
+#endif
     inmemfile = NULL;
 #ifndef STANDALONE
     return output;
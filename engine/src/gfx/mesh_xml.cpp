@@ -1448,7 +1448,9 @@ void Mesh::LoadXML(VSFileSystem::VSFile &f,
     XML_Parser parser = XML_ParserCreate(NULL);
     XML_SetUserData(parser, xml.get());
     XML_SetElementHandler(parser, &Mesh::beginElement, &Mesh::endElement);
-    XML_Parse(parser, (f.ReadFull()).c_str(), f.Size(), 1);
+    if (const char *content = f.Map()) {
+        XML_Parse(parser, content, f.Size(), 1);
+    }
     XML_ParserFree(parser);
     //Now, copy everything into the mesh data structures
     if (xml->load_stage != 5) {
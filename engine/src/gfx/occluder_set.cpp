@@ -0,0 +1,449 @@
+/*
+ * occluder_set.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "occluder_set.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// occluders per leaf of the tree
+static const uint32_t LEAF_SIZE = 4;
+
+const size_t OccluderSet::MAX_DYNAMIC;
+
+OccluderSet::OccluderSet()
+        : frame(0), open(false), dirty(false), forced_count(0), gathered(false) {
+    camera[0] = camera[1] = camera[2] = 0.0;
+    rating_light.x = rating_light.y = rating_light.z = 0.0;
+    rating_light.size = 1.0f;
+    last_receiver.x = last_receiver.y = last_receiver.z = 0.0;
+    last_receiver.radius = 0.0f;
+}
+
+void OccluderSet::Begin(double camera_x, double camera_y, double camera_z, const Light &rating_light) {
+    camera[0] = camera_x;
+    camera[1] = camera_y;
+    camera[2] = camera_z;
+    this->rating_light = rating_light;
+    forced_positions.clear();
+    ++frame;
+    open = true;
+    dirty = true;
+}
+
+void OccluderSet::End() {
+    open = false;
+}
+
+void OccluderSet::Add(const void *owner, unsigned int part, double x, double y, double z, float radius,
+        bool significant) {
+    if (significant) {
+        // a significant occluder drawn twice in the same place only counts once
+        unsigned long hash = (unsigned long) (long) (x * 17)
+                ^ (unsigned long) (long) (y * 19)
+                ^ (unsigned long) (long) (z * 5);
+        if (!forced_positions.insert(hash).second) {
+            return;
+        }
+    }
+    const Key key(owner, part);
+    std::map<Key, uint32_t>::iterator found = slots.find(key);
+    if (found == slots.end()) {
+        found = slots.insert(std::make_pair(key, static_cast<uint32_t>(occluders.size()))).first;
+        occluders.push_back(Occluder());
+        occluders.back().key = key;
+    }
+    Occluder &occluder = occluders[found->second];
+    occluder.x = x;
+    occluder.y = y;
+    occluder.z = z;
+    occluder.radius = radius;
+    occluder.significant = significant;
+    occluder.seen = frame;
+    dirty = true;
+}
+
+void OccluderSet::ComputeInfluence(Occluder &occluder) const {
+    const double dx = occluder.x - rating_light.x;
+    const double dy = occluder.y - rating_light.y;
+    const double dz = occluder.z - rating_light.z;
+    const double light_distance_sq = dx * dx + dy * dy + dz * dz;
+    const double light_distance = std::sqrt(light_distance_sq);
+    const float size = rating_light.size;
+
+    // Inner cone tangent is (rSize - lSize) / distance
+    // Outer cone tangent is (rSize + lSize) / distance
+    // Factor out the /distance thing, for performance and
+    // precision sake, though.
+    const double distance = light_distance - occluder.radius - size;
+    const float inner = occluder.radius - size;
+    const float outer = occluder.radius + size;
+    float reach;
+    if (inner >= 0) {
+        // Positive inner tangent means infinite shadow cone
+        reach = std::numeric_limits<float>::infinity();
+    } else {
+        if (outer >= 0) {
+            // Positive outer cone means decreasing shadow intensity
+            // over distance, so max distance will be a multiple
+            // of maximum inner cone distance that will result in
+            // minimal shadowing (4x distance = 16x less shadow)
+            reach = -(distance / inner) * 4.0;
+        } else {
+            // All negative, quite impossible, but if it was possible,
+            // max distance would be the length of the outer cone
+            reach = -(distance / outer);
+        }
+        // Add some margin
+        reach += size + occluder.radius;
+    }
+    occluder.reach = reach;
+
+    if (light_distance_sq >= occluder.reach * occluder.reach) {
+        occluder.rating = 0.0f;
+    } else if (distance <= 0.0) {
+        occluder.rating = 1.0f;
+    } else {
+        const double cx = occluder.x - camera[0];
+        const double cy = occluder.y - camera[1];
+        const double cz = occluder.z - camera[2];
+        const double camera_distance = std::sqrt(cx * cx + cy * cy + cz * cz);
+        occluder.rating = occluder.radius / (occluder.radius + distance + camera_distance * 0.2);
+    }
+}
+
+void OccluderSet::Settle() {
+    if (!dirty) {
+        return;
+    }
+    dirty = false;
+    gathered = false;
+
+    // drop the occluders nobody drew this frame, and rate the rest
+    for (uint32_t slot = 0; slot < occluders.size();) {
+        if (occluders[slot].seen == frame) {
+            ComputeInfluence(occluders[slot]);
+            ++slot;
+            continue;
+        }
+        slots.erase(occluders[slot].key);
+        if (slot + 1 != occluders.size()) {
+            occluders[slot] = occluders.back();
+            slots[occluders[slot].key] = slot;
+        }
+        occluders.pop_back();
+    }
+
+    used.clear();
+    dynamic.clear();
+    for (uint32_t slot = 0; slot < occluders.size(); ++slot) {
+        const Occluder &occluder = occluders[slot];
+        if (occluder.reach != occluder.reach) {
+            continue;
+        }
+        if (occluder.significant) {
+            used.push_back(slot);
+        } else {
+            dynamic.push_back(slot);
+        }
+    }
+    forced_count = used.size();
+    if (dynamic.size() > MAX_DYNAMIC) {
+        std::nth_element(dynamic.begin(), dynamic.begin() + MAX_DYNAMIC, dynamic.end(),
+                [this](uint32_t a, uint32_t b) {
+                    return occluders[a].rating > occluders[b].rating;
+                });
+        dynamic.resize(MAX_DYNAMIC);
+        std::sort(dynamic.begin(), dynamic.end());
+    }
+    used.insert(used.end(), dynamic.begin(), dynamic.end());
+
+    unbounded.clear();
+    dynamic.clear();
+    for (uint32_t slot : used) {
+        if (occluders[slot].reach == std::numeric_limits<double>::infinity()) {
+            unbounded.push_back(slot);
+        } else {
+            dynamic.push_back(slot);
+        }
+    }
+    std::sort(dynamic.begin(), dynamic.end());
+    // the same occluders as last frame, most likely a little moved: keep the tree, only fix its bounds
+    if (dynamic == tree_members) {
+        Refit();
+    } else {
+        tree_members.swap(dynamic);
+        Rebuild();
+    }
+}
+
+void OccluderSet::ItemBounds(uint32_t slot, double lo[3], double hi[3]) const {
+    const Occluder &occluder = occluders[slot];
+    lo[0] = occluder.x - occluder.reach;
+    lo[1] = occluder.y - occluder.reach;
+    lo[2] = occluder.z - occluder.reach;
+    hi[0] = occluder.x + occluder.reach;
+    hi[1] = occluder.y + occluder.reach;
+    hi[2] = occluder.z + occluder.reach;
+}
+
+static inline void Include(double lo[3], double hi[3], const double item_lo[3], const double item_hi[3]) {
+    for (int axis = 0; axis < 3; ++axis) {
+        lo[axis] = std::min(lo[axis], item_lo[axis]);
+        hi[axis] = std::max(hi[axis], item_hi[axis]);
+    }
+}
+
+void OccluderSet::Rebuild() {
+    nodes.clear();
+    tree_items = tree_members;
+    if (!tree_items.empty()) {
+        BuildNode(0, static_cast<uint32_t>(tree_items.size()));
+    }
+}
+
+uint32_t OccluderSet::BuildNode(uint32_t first, uint32_t count) {
+    const uint32_t index = static_cast<uint32_t>(nodes.size());
+    Node node;
+    ItemBounds(tree_items[first], node.lo, node.hi);
+    for (uint32_t i = first + 1; i < first + count; ++i) {
+        double lo[3], hi[3];
+        ItemBounds(tree_items[i], lo, hi);
+        Include(node.lo, node.hi, lo, hi);
+    }
+    node.first = first;
+    node.count = count;
+    node.right = 0;
+    nodes.push_back(node);
+    if (count <= LEAF_SIZE) {
+        return index;
+    }
+
+    // split at the median along the longest side
+    int axis = 0;
+    for (int other = 1; other < 3; ++other) {
+        if (node.hi[other] - node.lo[other] > node.hi[axis] - node.lo[axis]) {
+            axis = other;
+        }
+    }
+    const uint32_t half = count / 2;
+    std::vector<uint32_t>::iterator begin = tree_items.begin() + first;
+    std::nth_element(begin, begin + half, begin + count, [this, axis](uint32_t a, uint32_t b) {
+        const double *at = &occluders[a].x;
+        const double *bt = &occluders[b].x;
+        return at[axis] < bt[axis];
+    });
+    nodes[index].count = 0;
+    BuildNode(first, half);
+    const uint32_t right = BuildNode(first + half, count - half);
+    nodes[index].right = right;
+    return index;
+}
+
+void OccluderSet::Refit() {
+    // children always come after their parent
+    for (size_t i = nodes.size(); i-- > 0;) {
+        Node &node = nodes[i];
+        if (node.count) {
+            ItemBounds(tree_items[node.first], node.lo, node.hi);
+            for (uint32_t item = node.first + 1; item < node.first + node.count; ++item) {
+                double lo[3], hi[3];
+                ItemBounds(tree_items[item], lo, hi);
+                Include(node.lo, node.hi, lo, hi);
+            }
+        } else {
+            const Node &left = nodes[i + 1];
+            const Node &right = nodes[node.right];
+            for (int axis = 0; axis < 3; ++axis) {
+                node.lo[axis] = std::min(left.lo[axis], right.lo[axis]);
+                node.hi[axis] = std::max(left.hi[axis], right.hi[axis]);
+            }
+        }
+    }
+}
+
+bool OccluderSet::Affects(const Occluder &occluder, const Receiver &receiver) const {
+    if (occluder.radius < receiver.radius * 4.0f) {
+        return false;
+    }
+    // within reach of the shadow, counting from the receiver's edge
+    const double dx = occluder.x - receiver.x;
+    const double dy = occluder.y - receiver.y;
+    const double dz = occluder.z - receiver.z;
+    const double reach = occluder.reach + receiver.radius;
+    return reach >= 0.0 && dx * dx + dy * dy + dz * dz <= reach * reach;
+}
+
+void OccluderSet::Gather(const Receiver &receiver) {
+    if (gathered && receiver.x == last_receiver.x && receiver.y == last_receiver.y && receiver.z == last_receiver.z
+            && receiver.radius == last_receiver.radius) {
+        return;
+    }
+    gathered = true;
+    last_receiver = receiver;
+    cx.clear();
+    cy.clear();
+    cz.clear();
+    cr.clear();
+
+    auto consider = [this, &receiver](uint32_t slot) {
+        const Occluder &occluder = occluders[slot];
+        if (Affects(occluder, receiver)) {
+            cx.push_back(occluder.x);
+            cy.push_back(occluder.y);
+            cz.push_back(occluder.z);
+            cr.push_back(occluder.radius);
+        }
+    };
+    for (uint32_t slot : unbounded) {
+        consider(slot);
+    }
+    if (nodes.empty()) {
+        return;
+    }
+    const double point[3] = {receiver.x, receiver.y, receiver.z};
+    const double radius_sq = static_cast<double>(receiver.radius) * receiver.radius;
+    stack.clear();
+    stack.push_back(0);
+    while (!stack.empty()) {
+        const Node &node = nodes[stack.back()];
+        const uint32_t index = stack.back();
+        stack.pop_back();
+        double distance_sq = 0.0;
+        for (int axis = 0; axis < 3; ++axis) {
+            const double outside = std::max(std::max(node.lo[axis] - point[axis], point[axis] - node.hi[axis]), 0.0);
+            distance_sq += outside * outside;
+        }
+        if (!(distance_sq <= radius_sq)) {
+            continue;
+        }
+        if (node.count) {
+            for (uint32_t item = node.first; item < node.first + node.count; ++item) {
+                consider(tree_items[item]);
+            }
+        } else {
+            stack.push_back(node.right);
+            stack.push_back(index + 1);
+        }
+    }
+}
+
+float OccluderSet::Shadow(const Light &light, const Receiver &receiver) {
+    const size_t count = cx.size();
+    factors.resize(count);
+    const double *ox = __alpr(cx.data());
+    const double *oy = __alpr(cy.data());
+    const double *oz = __alpr(cz.data());
+    const double *oradius = __alpr(cr.data());
+    float *factor = __alpr(factors.data());
+    const double light_size = light.size;
+    const double radius = receiver.radius;
+
+    // One ray, light to receiver, against every occluder's sphere, with no branches so it vectorises.
+    // To maintain precision, the receiver is placed relative to the light-occluder segment, and the
+    // tangent direction is scaled by the occluder's size.
+    for (size_t i = 0; i < count; ++i) {
+        const double occluder_x = ox[i] - light.x;
+        const double occluder_y = oy[i] - light.y;
+        const double occluder_z = oz[i] - light.z;
+        const double object_x = receiver.x - light.x;
+        const double object_y = receiver.y - light.y;
+        const double object_z = receiver.z - light.z;
+        const double self_x = receiver.x - ox[i];
+        const double self_y = receiver.y - oy[i];
+        const double self_z = receiver.z - oz[i];
+        const double D = std::sqrt(occluder_x * occluder_x + occluder_y * occluder_y + occluder_z * occluder_z);
+        const double Dinv = 1.0 / D;
+        const double Tinv = 1.0 / oradius[i];
+
+        // Here, occD = 1.0, occT = 0.0
+        const double dir_x = occluder_x * Dinv;
+        const double dir_y = occluder_y * Dinv;
+        const double dir_z = occluder_z * Dinv;
+        const double objD = object_x * dir_x + object_y * dir_y + object_z * dir_z;
+        const double across_x = object_x - dir_x * objD;
+        const double across_y = object_y - dir_y * objD;
+        const double across_z = object_z - dir_z * objD;
+        const double objT = std::sqrt(across_x * across_x + across_y * across_y + across_z * across_z);
+
+        // pSize = 1.0 due to T scaling; scale rSize and lightSize accordingly
+        const double scaledD = objD * Dinv;
+        const double scaledT = objT * Tinv;
+        const double scaledLight = light_size * Tinv;
+        const double scaledRadius = radius * Tinv;
+
+        // Occluder cone spans between tangents (pSize - lSize) / occD and (pSize + lSize) / occD,
+        // counting from the light's edges; add rSize to lSize to somewhat account for target size.
+        // We don't bother with the object's cone, just the direction to its center from the occluder's edge.
+        const double occInner = 1.0 - scaledLight - scaledRadius;
+        const double occOuter = 1.0 + scaledLight + scaledRadius;
+        const double objTan = (scaledT - 1.0) / (scaledD - 1.0);
+        // clear above the outer tangent, fully occluded below the inner, and a ramp between them
+        const double ramp = (objTan - occInner) / (occOuter - occInner);
+        const double shade = std::min(1.0, std::max(0.0, ramp));
+
+        // Clear when the occluder is the emitter itself, the object is the occluder,
+        // or the object is before the occluder (scaledD <= 1 can also come of rounding)
+        const bool clear = (D <= light_size + radius)
+                | (self_x * self_x + self_y * self_y + self_z * self_z <= radius * radius)
+                | (objD <= D) | (scaledD <= 1.0);
+        factor[i] = clear ? 1.0f : static_cast<float>(shade);
+    }
+
+    float rv = 1.0f;
+    for (size_t i = 0; i < count && rv > 0.0f; ++i) {
+        rv *= factor[i];
+    }
+    return rv;
+}
+
+float OccluderSet::Test(const Light &light, const Receiver &receiver) {
+    if (!open) {
+        return 1.0f;
+    }
+    Settle();
+    Gather(receiver);
+    return Shadow(light, receiver);
+}
+
+void OccluderSet::Test(const Light *lights, size_t light_count, const Receiver &receiver, float *out) {
+    if (!open) {
+        std::fill(out, out + light_count, 1.0f);
+        return;
+    }
+    Settle();
+    Gather(receiver);
+    for (size_t i = 0; i < light_count; ++i) {
+        out[i] = Shadow(lights[i], receiver);
+    }
+}
+
+void OccluderSet::Test(const Light *lights, size_t light_count, const Receiver *receivers, size_t receiver_count,
+        float *out) {
+    for (size_t i = 0; i < receiver_count; ++i) {
+        Test(lights, light_count, receivers[i], out + i * light_count);
+    }
+}
@@ -0,0 +1,156 @@
+/*
+ * occluder_set.h
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OCCLUDER_SET_H
+#define OCCLUDER_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "aligned.h"
+
+/*
+ * OccluderSet keeps the objects that may shadow others from a light from one
+ * frame to the next, and answers how much of a light reaches an object.
+ *
+ * Each frame starts with Begin, which names the camera and the light the
+ * occluders are rated against. Add then files or moves the occluder drawn
+ * for a part of an owner; those not added again by the next test are
+ * dropped. Significant occluders (planets) are always used; of the others
+ * only the MAX_DYNAMIC most important are. The occluders in use are kept
+ * in a bounding volume tree over the reach of their shadows, which is
+ * refitted in place while the same occluders stay in use and rebuilt when
+ * they change. A test looks up the occluders whose shadow reaches the
+ * object once, then runs the shadow test of each light against all of them
+ * at once over plain arrays the compiler can vectorise. Testing the same
+ * object again, for another light, reuses the lookup.
+ */
+class OccluderSet {
+public:
+    struct Light {
+        double x, y, z;
+        float size;
+    };
+
+    struct Receiver {
+        double x, y, z;
+        float radius;
+    };
+
+    // how many of the occluders that are not significant are used
+    static const size_t MAX_DYNAMIC = 16;
+
+    OccluderSet();
+
+    void Begin(double camera_x, double camera_y, double camera_z, const Light &rating_light);
+    void Add(const void *owner, unsigned int part, double x, double y, double z, float radius, bool significant);
+
+    /* Stops answering tests, with every light clear, until the next Begin; the occluders are kept */
+    void End();
+
+    /* The occluders in use, once a test has settled the frame's additions */
+    size_t size() const {
+        return used.size();
+    }
+
+    size_t forced() const {
+        return forced_count;
+    }
+
+    /* How much of the light reaches the receiver, from 0 (fully occluded) to 1 (clear) */
+    float Test(const Light &light, const Receiver &receiver);
+    /* Test for each of several lights, one result per light */
+    void Test(const Light *lights, size_t light_count, const Receiver &receiver, float *out);
+    /* Test for every light and receiver pair, the results of a receiver's lights in a row */
+    void Test(const Light *lights, size_t light_count, const Receiver *receivers, size_t receiver_count,
+            float *out);
+
+private:
+    typedef std::pair<const void *, unsigned int> Key;
+
+    struct Occluder {
+        Key key;
+        double x, y, z;
+        float radius;
+        bool significant;
+        uint32_t seen;
+        // how far from its center the shadow matters, and how much
+        double reach;
+        float rating;
+    };
+
+    struct Node {
+        double lo[3], hi[3];
+        // leaves hold tree_items[first, first + count); inner nodes have their left child next
+        uint32_t first, count;
+        uint32_t right;
+    };
+
+    template<typename T>
+    using Array = std::vector<T, aligned_allocator<T> >;
+
+    void Settle();
+    void ComputeInfluence(Occluder &occluder) const;
+    void Rebuild();
+    uint32_t BuildNode(uint32_t first, uint32_t count);
+    void Refit();
+    void ItemBounds(uint32_t slot, double lo[3], double hi[3]) const;
+    bool Affects(const Occluder &occluder, const Receiver &receiver) const;
+    void Gather(const Receiver &receiver);
+    float Shadow(const Light &light, const Receiver &receiver);
+
+    std::vector<Occluder> occluders;
+    std::map<Key, uint32_t> slots;
+    std::set<unsigned long> forced_positions;
+
+    double camera[3];
+    Light rating_light;
+    uint32_t frame;
+    bool open;
+    bool dirty;
+
+    // the slots in use; significant ones first
+    std::vector<uint32_t> used;
+    std::vector<uint32_t> dynamic;
+    size_t forced_count;
+    // occluders in use whose shadows never end, checked by every test
+    std::vector<uint32_t> unbounded;
+    std::vector<uint32_t> tree_members;
+    std::vector<uint32_t> tree_items;
+    std::vector<Node> nodes;
+    std::vector<uint32_t> stack;
+
+    // the occluders found for the last receiver, one array per component
+    bool gathered;
+    Receiver last_receiver;
+    Array<double> cx, cy, cz, cr;
+    Array<float> factors;
+};
+
+#endif // OCCLUDER_SET_H
@@ -32,6 +32,7 @@
 
 #include "gfxlib.h"
 #include "vec.h"
+#include "occluder_set.h"
 
 namespace Occlusion {
 
@@ -44,6 +45,9 @@ void /*GFXDRVAPI*/ end();
 /**
  * Register an occluder
  *
+ * @param owner The object drawing the occluder, which
+ *          together with part names it from frame to frame
+ * @param part Which of the owner's occluders this is
  * @param pos The occluder object's center
  * @param rSize The occluder's radius
  * @param significant If false, the occluder may be ignored
@@ -51,7 +55,7 @@ void /*GFXDRVAPI*/ end();
  *          If true, it will be forcibly considered when
  *          rendering all objects. Ie: for planets.
  */
-void /*GFXDRVAPI*/ addOccluder(const QVector &pos, float rSize, bool significant);
+void /*GFXDRVAPI*/ addOccluder(const void *owner, unsigned int part, const QVector &pos, float rSize, bool significant);
 
 /**
  * Test occlusion between a light and an object
@@ -66,6 +70,18 @@ void /*GFXDRVAPI*/ addOccluder(const QVector &pos, float rSize, bool significant
  */
 float /*GFXDRVAPI*/ testOcclusion(const QVector &lightPos, float lightSize, const QVector &pos, float rSize);
 
+/**
+ * Test occlusion between several lights and an object
+ *
+ * @param lights The lights' centers and radii
+ * @param count How many lights there are
+ * @param pos The object's center
+ * @param rSize The object's radius
+ * @param occlusion Receives the occlusion factor of each light
+ */
+void /*GFXDRVAPI*/ testOcclusion(const OccluderSet::Light *lights, size_t count, const QVector &pos, float rSize,
+        float *occlusion);
+
 }
 
 #endif//_VS_OCCLUSION_H_
\ No newline at end of file
@@ -34,6 +34,7 @@
 #include "aligned.h"
 #include "vec.h"
 #include "gfxlib_struct.h"
+#include "particle_buffer.h"
 
 class Texture;
 
@@ -43,25 +44,21 @@ struct ParticlePoint {
     float size;
 };
 
-struct Particle {
-    Vector velocity{};
-    QVector location{};
-    GFXColor color{};
-    float size{};
-};
-
 /**
  * Particle system class, contains regularly updated geometry for all active
  * particles of the same kind.
  *
+ * The particles are simulated in a ParticleBuffer; drawing first writes
+ * all their vertices, on the worker threads when there are many, and only
+ * then hands the finished buffer to GL.
+ *
  * Can be instantiated statically.
  */
 class ParticleTrail {
-    std::vector<Particle, aligned_allocator<Particle>> particles;
+    ParticleBuffer particles;
     std::vector<float> particleVert;
     std::vector<float> distances;
-    std::vector<unsigned short> pointIndices;
-    std::vector<unsigned short> indices;
+    std::vector<uint32_t> drawOrder;
     unsigned int max_particles{};
     BLENDFUNC blendsrc, blenddst;
     float alphaMask;
@@ -108,6 +105,10 @@ public:
     void DrawAndUpdate();
     void AddParticle(const ParticlePoint &, const Vector &, float size);
     void ChangeMax(unsigned int max);
+
+private:
+    // fills particleVert with floats_per_particle floats for every particle, in drawOrder if sorted
+    void WriteVertices(const QVector &camera, size_t floats_per_particle, bool sorted);
 };
 
 /**
@@ -0,0 +1,210 @@
+/*
+ * particle_buffer.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "particle_buffer.h"
+
+#include <algorithm>
+
+const size_t ParticleBuffer::POINT_FLOATS;
+const size_t ParticleBuffer::QUAD_FLOATS;
+
+// the three crossed quads of a particle: corner offsets in units of its size, and texture coordinates
+static const float kQuadCorners[12][5] = {
+        {1, 1, 0, 0, 0}, {1, -1, 0, 0, 1}, {-1, -1, 0, 1, 1}, {-1, 1, 0, 1, 0},
+        {0, 1, 1, 0, 0}, {0, -1, 1, 0, 1}, {0, -1, -1, 1, 1}, {0, 1, -1, 1, 0},
+        {1, 0, 1, 0, 0}, {1, 0, -1, 0, 1}, {-1, 0, -1, 1, 1}, {-1, 0, 1, 1, 0},
+};
+
+void ParticleBuffer::Clear() {
+    x.clear();
+    y.clear();
+    z.clear();
+    vx.clear();
+    vy.clear();
+    vz.clear();
+    r.clear();
+    g.clear();
+    b.clear();
+    a.clear();
+    sizes.clear();
+}
+
+void ParticleBuffer::Add(const QVector &location, const Vector &velocity, const GFXColor &color, float size) {
+    x.push_back(location.i);
+    y.push_back(location.j);
+    z.push_back(location.k);
+    vx.push_back(velocity.i);
+    vy.push_back(velocity.j);
+    vz.push_back(velocity.k);
+    r.push_back(color.r);
+    g.push_back(color.g);
+    b.push_back(color.b);
+    a.push_back(color.a);
+    sizes.push_back(size);
+}
+
+void ParticleBuffer::Set(size_t index, const QVector &location, const Vector &velocity, const GFXColor &color,
+        float size) {
+    x[index] = location.i;
+    y[index] = location.j;
+    z[index] = location.k;
+    vx[index] = velocity.i;
+    vy[index] = velocity.j;
+    vz[index] = velocity.k;
+    r[index] = color.r;
+    g[index] = color.g;
+    b[index] = color.b;
+    a[index] = color.a;
+    sizes[index] = size;
+}
+
+void ParticleBuffer::Advance(double elapsed, float fade, bool fade_color, float min_alpha) {
+    const size_t count = size();
+    double *px = __alpr(x.data());
+    double *py = __alpr(y.data());
+    double *pz = __alpr(z.data());
+    const float *pvx = __alpr(vx.data());
+    const float *pvy = __alpr(vy.data());
+    const float *pvz = __alpr(vz.data());
+    for (size_t i = 0; i < count; ++i) {
+        px[i] += pvx[i] * elapsed;
+        py[i] += pvy[i] * elapsed;
+        pz[i] += pvz[i] * elapsed;
+    }
+
+    const float faded = static_cast<float>(fade * elapsed);
+    float *pa = __alpr(a.data());
+    if (fade_color) {
+        float *pr = __alpr(r.data());
+        float *pg = __alpr(g.data());
+        float *pb = __alpr(b.data());
+        for (size_t i = 0; i < count; ++i) {
+            pr[i] = std::max(0.0f, pr[i] - faded);
+            pg[i] = std::max(0.0f, pg[i] - faded);
+            pb[i] = std::max(0.0f, pb[i] - faded);
+        }
+    }
+    for (size_t i = 0; i < count; ++i) {
+        pa[i] = std::max(0.0f, pa[i] - faded);
+    }
+
+    // compact the survivors in place; most frames nothing has died until the first dead particle
+    size_t kept = 0;
+    while (kept < count && a[kept] > min_alpha) {
+        ++kept;
+    }
+    for (size_t i = kept; i < count; ++i) {
+        if (a[i] > min_alpha) {
+            x[kept] = x[i];
+            y[kept] = y[i];
+            z[kept] = z[i];
+            vx[kept] = vx[i];
+            vy[kept] = vy[i];
+            vz[kept] = vz[i];
+            r[kept] = r[i];
+            g[kept] = g[i];
+            b[kept] = b[i];
+            a[kept] = a[i];
+            sizes[kept] = sizes[i];
+            ++kept;
+        }
+    }
+    if (kept != count) {
+        x.resize(kept);
+        y.resize(kept);
+        z.resize(kept);
+        vx.resize(kept);
+        vy.resize(kept);
+        vz.resize(kept);
+        r.resize(kept);
+        g.resize(kept);
+        b.resize(kept);
+        a.resize(kept);
+        sizes.resize(kept);
+    }
+}
+
+void ParticleBuffer::WriteDistances(const QVector &camera, float *out) const {
+    const size_t count = size();
+    for (size_t i = 0; i < count; ++i) {
+        const double dx = x[i] - camera.i;
+        const double dy = y[i] - camera.j;
+        const double dz = z[i] - camera.k;
+        out[i] = static_cast<float>(dx * dx + dy * dy + dz * dz);
+    }
+}
+
+//Squared, surface-linked decay - looks nicer, more real for emissive gasses
+//NOTE: maxsize/minsize allows for inverted growth (shrinkage) while still fading correctly. Cheers!
+static inline float FadedSize(float psize, float alpha, float grow, float trans, float &scale) {
+    const float size = psize * (grow * (1.0f - alpha) + alpha);
+    const float maxsize = (psize > size) ? psize : size;
+    const float minsize = (psize <= size) ? psize : size;
+    scale = alpha * trans * (minsize / ((maxsize > 0) ? maxsize : 1.0f));
+    return size;
+}
+
+void ParticleBuffer::WritePoints(const QVector &camera, float grow, float trans, const uint32_t *order,
+        size_t begin, size_t end, float *out) const {
+    for (size_t place = begin; place < end; ++place) {
+        const size_t i = order ? order[place] : place;
+        float scale;
+        FadedSize(sizes[i], a[i], grow, trans, scale);
+        *out++ = static_cast<float>(x[i] - camera.i);
+        *out++ = static_cast<float>(y[i] - camera.j);
+        *out++ = static_cast<float>(z[i] - camera.k);
+        *out++ = r[i] * scale;
+        *out++ = g[i] * scale;
+        *out++ = b[i] * scale;
+        *out++ = a[i] * scale;
+    }
+}
+
+void ParticleBuffer::WriteQuads(const QVector &camera, float grow, float trans, const uint32_t *order,
+        size_t begin, size_t end, float *out) const {
+    for (size_t place = begin; place < end; ++place) {
+        const size_t i = order ? order[place] : place;
+        float scale;
+        const float size = FadedSize(sizes[i], a[i], grow, trans, scale);
+        const float lx = static_cast<float>(x[i] - camera.i);
+        const float ly = static_cast<float>(y[i] - camera.j);
+        const float lz = static_cast<float>(z[i] - camera.k);
+        const float cr = r[i] * scale;
+        const float cg = g[i] * scale;
+        const float cb = b[i] * scale;
+        const float ca = a[i] * scale;
+        for (const float *corner : kQuadCorners) {
+            *out++ = lx + corner[0] * size;
+            *out++ = ly + corner[1] * size;
+            *out++ = lz + corner[2] * size;
+            *out++ = cr;
+            *out++ = cg;
+            *out++ = cb;
+            *out++ = ca;
+            *out++ = corner[3];
+            *out++ = corner[4];
+        }
+    }
+}
@@ -0,0 +1,95 @@
+/*
+ * particle_buffer.h
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PARTICLE_BUFFER_H
+#define PARTICLE_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "aligned.h"
+#include "vec.h"
+#include "gfxlib_struct.h"
+
+/*
+ * The particles of a ParticleTrail, one array per component, so the
+ * simulation runs down plain float and double arrays the compiler can
+ * vectorise. It knows nothing of GL: Advance moves and fades the particles,
+ * and the Write functions turn any range of them into vertices for a
+ * finished buffer, so ranges can be written by several threads at once.
+ */
+class ParticleBuffer {
+public:
+    // floats written per particle: position, color
+    static const size_t POINT_FLOATS = 3 + 4;
+    // floats written per particle: 12 vertices of position, color, texture coordinates
+    static const size_t QUAD_FLOATS = 12 * (3 + 4 + 2);
+
+    size_t size() const {
+        return a.size();
+    }
+
+    bool empty() const {
+        return a.empty();
+    }
+
+    void Clear();
+    void Add(const QVector &location, const Vector &velocity, const GFXColor &color, float size);
+    void Set(size_t index, const QVector &location, const Vector &velocity, const GFXColor &color, float size);
+
+    /*
+     * Moves every particle by its velocity over elapsed seconds and fades it
+     * by fade per second, every channel if fade_color is set, else alpha
+     * only, never below 0. Then drops the particles whose alpha is at or
+     * below min_alpha, keeping the order of the rest.
+     */
+    void Advance(double elapsed, float fade, bool fade_color, float min_alpha);
+
+    /* Squared distances from the camera, one per particle */
+    void WriteDistances(const QVector &camera, float *out) const;
+
+    /*
+     * Writes particles [begin, end) relative to the camera, POINT_FLOATS or
+     * QUAD_FLOATS floats each, starting at out. With an order, the particle
+     * written in place i is order[i] rather than i. A particle grows towards
+     * grow times its size as it fades, and its color is scaled by trans.
+     */
+    void WritePoints(const QVector &camera, float grow, float trans, const uint32_t *order,
+            size_t begin, size_t end, float *out) const;
+    void WriteQuads(const QVector &camera, float grow, float trans, const uint32_t *order,
+            size_t begin, size_t end, float *out) const;
+
+private:
+    template<typename T>
+    using Array = std::vector<T, aligned_allocator<T> >;
+
+    Array<double> x, y, z;
+    Array<float> vx, vy, vz;
+    Array<float> r, g, b, a;
+    Array<float> sizes;
+};
+
+#endif // PARTICLE_BUFFER_H
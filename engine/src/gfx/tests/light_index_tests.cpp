@@ -0,0 +1,164 @@
+/*
+ * light_index_tests.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <vector>
+
+#include "gfx/light_index.h"
+
+// scores every light it is asked about by a fixed strength, and counts the asks
+class FixedScores {
+public:
+    std::map<int, float> strength;
+    std::map<int, int> asked;
+
+    float operator()(int light) {
+        ++asked[light];
+        std::map<int, float>::const_iterator found = strength.find(light);
+        return found == strength.end() ? 1.0f : found->second;
+    }
+};
+
+TEST(LightIndex, PicksTheOverlappingLightsStrongestFirst) {
+    LightIndex index;
+    index.Add(10, 0, 0, 0, 100);
+    index.Add(11, 150, 0, 0, 100);
+    index.Add(12, 0, 500, 0, 100);
+    index.Add(13, 0, 0, -90, 100);
+    index.Build();
+
+    FixedScores score;
+    score.strength[10] = 0.5f;
+    score.strength[11] = 0.9f;
+    score.strength[13] = 0.0f;
+    const std::vector<LightIndex::Picked> &picked = index.Pick(60, 0, 0, 30, 8, score);
+    ASSERT_EQ(picked.size(), 2u);
+    EXPECT_EQ(picked[0].light, 11);
+    EXPECT_EQ(picked[1].light, 10);
+    // too far to be asked about
+    EXPECT_EQ(score.asked.count(12), 0u);
+    // overlapping but scored 0, so left out
+    EXPECT_EQ(score.asked.count(13), 1u);
+}
+
+TEST(LightIndex, KeepsTheBestFewAndAsksOnce) {
+    LightIndex index;
+    for (int i = 0; i < 20; ++i) {
+        index.Add(i, i * 10.0, 0, 0, 150);
+    }
+    // a light reaching much further than the rest is checked by every pick
+    index.Add(100, 100000, 0, 0, 200000);
+    index.Build();
+
+    FixedScores score;
+    for (int i = 0; i < 20; ++i) {
+        score.strength[i] = 1.0f + i;
+    }
+    score.strength[100] = 5.5f;
+    const std::vector<LightIndex::Picked> &picked = index.Pick(95, 0, 0, 10, 4, score);
+    ASSERT_EQ(picked.size(), 4u);
+    EXPECT_EQ(picked[0].light, 19);
+    EXPECT_EQ(picked[1].light, 18);
+    EXPECT_EQ(picked[2].light, 17);
+    EXPECT_EQ(picked[3].light, 16);
+    EXPECT_EQ(score.asked.size(), 21u);
+    for (std::map<int, int>::const_iterator it = score.asked.begin(); it != score.asked.end(); ++it) {
+        EXPECT_EQ(it->second, 1) << "light " << it->first;
+    }
+}
+
+TEST(LightIndex, MatchesAScanOverEveryLight) {
+    srand(1234);
+    LightIndex index;
+    std::vector<double> lights;
+    for (int i = 0; i < 300; ++i) {
+        double x = rand() % 20000 - 10000;
+        double y = rand() % 20000 - 10000;
+        double z = rand() % 20000 - 10000;
+        double radius = 50 + rand() % 2000;
+        index.Add(i, x, y, z, radius);
+        lights.insert(lights.end(), {x, y, z, radius});
+    }
+    index.Build();
+
+    for (int query = 0; query < 100; ++query) {
+        double x = rand() % 20000 - 10000;
+        double y = rand() % 20000 - 10000;
+        double z = rand() % 20000 - 10000;
+        double radius = 10 + rand() % 500;
+        FixedScores score;
+        index.Pick(x, y, z, radius, 1000, score);
+        std::map<int, int> expected;
+        for (int i = 0; i < 300; ++i) {
+            const double *light = &lights[4 * i];
+            double reach = light[3] + radius;
+            double dx = light[0] - x, dy = light[1] - y, dz = light[2] - z;
+            if (dx * dx + dy * dy + dz * dz <= reach * reach) {
+                expected[i] = 1;
+            }
+        }
+        EXPECT_EQ(score.asked, expected);
+    }
+}
+
+TEST(LightIndex, EmptyAndCleared) {
+    LightIndex index;
+    index.Build();
+    FixedScores score;
+    EXPECT_TRUE(index.Pick(0, 0, 0, 100, 8, score).empty());
+
+    index.Add(1, 0, 0, 0, 100);
+    index.Build();
+    EXPECT_EQ(index.Pick(0, 0, 0, 100, 8, score).size(), 1u);
+    EXPECT_TRUE(index.Pick(0, 0, 0, 100, 0, score).empty());
+
+    index.Clear();
+    index.Build();
+    EXPECT_TRUE(index.Pick(0, 0, 0, 100, 8, score).empty());
+}
+
+TEST(LightIndex, WildPositionsAreCheckedButNeverPicked) {
+    const double inf = std::numeric_limits<double>::infinity();
+    LightIndex index;
+    index.Add(1, 0, 0, 0, 100);
+    index.Add(2, inf, 0, 0, 100);
+    index.Add(3, 0, std::nan(""), 0, 100);
+    index.Add(4, 1e300, 0, 0, 100);
+    index.Build();
+
+    FixedScores score;
+    const std::vector<LightIndex::Picked> &picked = index.Pick(0, 0, 0, 10, 8, score);
+    ASSERT_EQ(picked.size(), 1u);
+    EXPECT_EQ(picked[0].light, 1);
+
+    FixedScores far_score;
+    const std::vector<LightIndex::Picked> &far = index.Pick(1e300, 0, 0, 10, 8, far_score);
+    ASSERT_EQ(far.size(), 1u);
+    EXPECT_EQ(far[0].light, 4);
+}
@@ -0,0 +1,149 @@
+/*
+ * occluder_set_tests.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "gfx/occluder_set.h"
+
+static const OccluderSet::Light kSun = {0, 0, 0, 10};
+
+static OccluderSet::Receiver At(double x, double y, double z, float radius = 1) {
+    OccluderSet::Receiver receiver = {x, y, z, radius};
+    return receiver;
+}
+
+// owners only name occluders, so any distinct addresses do
+static const char kOwners[32] = {};
+
+TEST(OccluderSet, ShadowsWhatIsBehindAPlanet) {
+    OccluderSet set;
+    set.Begin(0, 0, 0, kSun);
+    set.Add(&kOwners[0], 0, 1000, 0, 0, 100, true);
+
+    EXPECT_FLOAT_EQ(0.0f, set.Test(kSun, At(2000, 0, 0)));
+    EXPECT_FLOAT_EQ(1.0f, set.Test(kSun, At(2000, 500, 0)));
+    // in front of the planet, and the planet itself
+    EXPECT_FLOAT_EQ(1.0f, set.Test(kSun, At(500, 0, 0)));
+    EXPECT_FLOAT_EQ(1.0f, set.Test(kSun, At(1000, 0, 0, 10)));
+    // nothing shadows an object at least a quarter of the occluder's size
+    EXPECT_FLOAT_EQ(1.0f, set.Test(kSun, At(2000, 0, 0, 30)));
+    EXPECT_EQ(1, set.size());
+    EXPECT_EQ(1, set.forced());
+}
+
+TEST(OccluderSet, ShadesThePenumbraPartly) {
+    OccluderSet set;
+    set.Begin(0, 0, 0, kSun);
+    set.Add(&kOwners[0], 0, 1000, 0, 0, 100, true);
+
+    float last = 0.0f;
+    for (double y = 150; y <= 250; y += 10) {
+        float occlusion = set.Test(kSun, At(2000, y, 0));
+        EXPECT_GE(occlusion, last) << y;
+        last = occlusion;
+    }
+    EXPECT_FLOAT_EQ(1.0f, last);
+    EXPECT_GT(set.Test(kSun, At(2000, 200, 0)), 0.0f);
+    EXPECT_LT(set.Test(kSun, At(2000, 200, 0)), 1.0f);
+}
+
+TEST(OccluderSet, ForgetsOccludersThatAreNotDrawnAgain) {
+    OccluderSet set;
+    set.Begin(0, 0, 0, kSun);
+    set.Add(&kOwners[0], 0, 1000, 0, 0, 100, true);
+    set.Add(&kOwners[1], 0, 0, 1000, 0, 100, true);
+    EXPECT_FLOAT_EQ(0.0f, set.Test(kSun, At(2000, 0, 0)));
+    EXPECT_FLOAT_EQ(0.0f, set.Test(kSun, At(0, 2000, 0)));
+
+    set.Begin(0, 0, 0, kSun);
+    set.Add(&kOwners[1], 0, 0, 0, 1000, 100, true);
+    EXPECT_FLOAT_EQ(1.0f, set.Test(kSun, At(2000, 0, 0)));
+    EXPECT_FLOAT_EQ(1.0f, set.Test(kSun, At(0, 2000, 0)));
+    EXPECT_FLOAT_EQ(0.0f, set.Test(kSun, At(0, 0, 2000)));
+    EXPECT_EQ(1, set.size());
+
+    // between frames every light is clear
+    set.End();
+    EXPECT_FLOAT_EQ(1.0f, set.Test(kSun, At(0, 0, 2000)));
+}
+
+TEST(OccluderSet, FollowsMovingOccludersThroughTheTree) {
+    // a light much bigger than the occluders, so their shadows end and they go into the tree
+    OccluderSet set;
+    for (int frame = 0; frame < 3; ++frame) {
+        const double shift = frame * 100000.0;
+        const OccluderSet::Light giant = {shift, 0, 0, 1000};
+        set.Begin(shift, 0, 0, giant);
+        for (int i = 0; i < 10; ++i) {
+            set.Add(&kOwners[i], 0, shift + 5000, i * 3000.0, 0, 50, false);
+        }
+        // just behind the fourth occluder, and between the fourth and fifth
+        EXPECT_FLOAT_EQ(0.0f, set.Test(giant, At(shift + 5200, 9360, 0))) << frame;
+        EXPECT_FLOAT_EQ(1.0f, set.Test(giant, At(shift + 5200, 10920, 0))) << frame;
+        // beyond the end of the shadow
+        EXPECT_FLOAT_EQ(1.0f, set.Test(giant, At(shift + 40000, 0, 0))) << frame;
+        if (frame > 0) {
+            EXPECT_FLOAT_EQ(1.0f, set.Test(giant, At(shift - 100000 + 5200, 9360, 0))) << frame;
+        }
+    }
+}
+
+TEST(OccluderSet, UsesOnlyTheMostImportantDynamicOccluders) {
+    OccluderSet set;
+    set.Begin(0, 0, 0, kSun);
+    // the further from the light and camera, the less important
+    for (int i = 0; i < 20; ++i) {
+        set.Add(&kOwners[i], 0, 1000.0 * (i + 1), 0, 1000, 50, false);
+    }
+    set.Add(&kOwners[20], 0, 0, 0, 1000000, 50, true);
+    EXPECT_FLOAT_EQ(1.0f, set.Test(kSun, At(0, 0, -1)));
+    EXPECT_EQ(OccluderSet::MAX_DYNAMIC + 1, set.size());
+    EXPECT_EQ(1, set.forced());
+
+    // the nearest ones still shadow, the furthest are gone
+    EXPECT_FLOAT_EQ(0.0f, set.Test(kSun, At(2000, 0, 2000)));
+    EXPECT_FLOAT_EQ(1.0f, set.Test(kSun, At(40000, 0, 2000)));
+}
+
+TEST(OccluderSet, TestsLightsAndReceiversInBatches) {
+    OccluderSet set;
+    set.Begin(0, 0, 0, kSun);
+    set.Add(&kOwners[0], 0, 1000, 0, 0, 100, true);
+    set.Add(&kOwners[1], 0, 0, 1000, 0, 100, true);
+
+    const OccluderSet::Light lights[] = {kSun, {0, 3000, 0, 10}, {3000, 0, 0, 10}};
+    const OccluderSet::Receiver receivers[] = {At(2000, 0, 0), At(0, 2000, 0), At(0, 0, 2000), At(2000, 105, 0)};
+    float batch[4 * 3];
+    set.Test(lights, 3, receivers, 4, batch);
+    for (int r = 0; r < 4; ++r) {
+        for (int l = 0; l < 3; ++l) {
+            EXPECT_FLOAT_EQ(set.Test(lights[l], receivers[r]), batch[r * 3 + l]) << r << " " << l;
+        }
+    }
+    EXPECT_FLOAT_EQ(0.0f, batch[0]);
+    EXPECT_FLOAT_EQ(1.0f, batch[1]);
+    EXPECT_FLOAT_EQ(1.0f, batch[2]);
+    EXPECT_FLOAT_EQ(0.0f, batch[3]);
+    EXPECT_FLOAT_EQ(1.0f, batch[4]);
+}
@@ -0,0 +1,127 @@
+/*
+ * particle_buffer_tests.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "gfx/particle_buffer.h"
+
+static void AddParticle(ParticleBuffer &particles, double x, float vx, float alpha, float size) {
+    QVector location;
+    location.i = x;
+    location.j = 2.0 * x;
+    location.k = 3.0 * x;
+    Vector velocity;
+    velocity.i = vx;
+    velocity.j = 0.0f;
+    velocity.k = 0.0f;
+    GFXColor color;
+    color.r = 0.5f;
+    color.g = 0.05f;
+    color.b = 1.0f;
+    color.a = alpha;
+    particles.Add(location, velocity, color, size);
+}
+
+static QVector Origin() {
+    QVector origin;
+    origin.i = origin.j = origin.k = 0.0;
+    return origin;
+}
+
+TEST(ParticleBuffer, AdvanceMovesFadesAndDropsTheFadedInOrder) {
+    ParticleBuffer particles;
+    AddParticle(particles, 1, 10, 0.9f, 1);
+    AddParticle(particles, 2, 10, 0.14f, 1);
+    AddParticle(particles, 3, 10, 0.9f, 1);
+    AddParticle(particles, 4, 10, 0.12f, 1);
+    AddParticle(particles, 5, 10, 0.9f, 1);
+
+    particles.Advance(0.5, 0.1f, false, 0.1f);
+    ASSERT_EQ(3, particles.size());
+
+    std::vector<float> points(particles.size() * ParticleBuffer::POINT_FLOATS);
+    particles.WritePoints(Origin(), 1.0f, 1.0f, nullptr, 0, particles.size(), &points[0]);
+    const double expected_x[] = {6, 8, 10};
+    for (size_t i = 0; i < 3; ++i) {
+        const float *point = &points[i * ParticleBuffer::POINT_FLOATS];
+        EXPECT_FLOAT_EQ(expected_x[i], point[0]);
+        // only x moves, and y and z stay where they were put
+        EXPECT_FLOAT_EQ(2.0 * (expected_x[i] - 5), point[1]);
+        EXPECT_FLOAT_EQ(3.0 * (expected_x[i] - 5), point[2]);
+        // alpha is scaled by itself
+        EXPECT_FLOAT_EQ(0.85f * 0.85f, point[6]);
+    }
+}
+
+TEST(ParticleBuffer, FadingColorStopsAtZero) {
+    ParticleBuffer particles;
+    AddParticle(particles, 0, 0, 1.0f, 1);
+    particles.Advance(1.0, 0.1f, true, 0.0f);
+
+    std::vector<float> points(ParticleBuffer::POINT_FLOATS);
+    particles.WritePoints(Origin(), 1.0f, 1.0f, nullptr, 0, 1, &points[0]);
+    // colors are written scaled by the alpha
+    EXPECT_FLOAT_EQ(0.4f * 0.9f, points[3]);
+    EXPECT_FLOAT_EQ(0.0f, points[4]);
+    EXPECT_FLOAT_EQ(0.9f * 0.9f, points[5]);
+    EXPECT_FLOAT_EQ(0.9f * 0.9f, points[6]);
+}
+
+TEST(ParticleBuffer, WritesQuadsInTheGivenOrder) {
+    ParticleBuffer particles;
+    AddParticle(particles, 10, 0, 1.0f, 2);
+    AddParticle(particles, 20, 0, 1.0f, 3);
+    AddParticle(particles, 30, 0, 1.0f, 4);
+
+    std::vector<float> distances(particles.size());
+    particles.WriteDistances(Origin(), &distances[0]);
+    EXPECT_FLOAT_EQ(14 * 100, distances[0]);
+    EXPECT_FLOAT_EQ(14 * 900, distances[2]);
+
+    const uint32_t order[] = {2, 0, 1};
+    QVector camera = Origin();
+    camera.i = 5.0;
+    // write only places 1 and 2, as one of several jobs would
+    std::vector<float> quads(2 * ParticleBuffer::QUAD_FLOATS);
+    particles.WriteQuads(camera, 1.0f, 1.0f, order, 1, 3, &quads[0]);
+
+    // the first vertex of each particle is offset by its size along +x and +y
+    const float *first = &quads[0];
+    EXPECT_FLOAT_EQ(10 - 5 + 2, first[0]);
+    EXPECT_FLOAT_EQ(20 + 2, first[1]);
+    EXPECT_FLOAT_EQ(30, first[2]);
+    EXPECT_FLOAT_EQ(0.0f, first[7]);
+    EXPECT_FLOAT_EQ(0.0f, first[8]);
+    const float *second = &quads[ParticleBuffer::QUAD_FLOATS];
+    EXPECT_FLOAT_EQ(20 - 5 + 3, second[0]);
+    EXPECT_FLOAT_EQ(40 + 3, second[1]);
+    // the last vertex of a particle is offset along -x and +z
+    const float *last = &quads[ParticleBuffer::QUAD_FLOATS - 9];
+    EXPECT_FLOAT_EQ(10 - 5 - 2, last[0]);
+    EXPECT_FLOAT_EQ(30 + 2, last[2]);
+    EXPECT_FLOAT_EQ(1.0f, last[7]);
+}
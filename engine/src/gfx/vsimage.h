@@ -138,7 +138,7 @@ typedef struct {
 //End DDS header
 
 typedef struct {
-    char *Buffer;
+    const char *Buffer;
     int Pos;
 } TPngFileBuffer;
 
@@ -0,0 +1,482 @@
+/*
+ * gfxlib_headless.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * A graphics driver that draws nothing, for running the simulation without
+ * a window. It stands in for the parts of gldrv that talk to GL, alongside
+ * gfxlib_struct_server.cpp and gl_sphere_list_server.cpp; the frustum and
+ * vertex list code that does not need GL is used as is.
+ */
+
+#include <cstdlib>
+#include <vector>
+
+#include "gfxlib.h"
+#include "gfxlib_struct.h"
+#include "gfx/matrix.h"
+#include "gldrv/winsys.h"
+
+static std::vector<GFXLight> lights;
+static GFXMaterial default_material;
+static int next_texture = 1;
+static int next_light_context = 0;
+
+void GFXInit(int, char **) {
+}
+
+void GFXLoop(void main_loop()) {
+}
+
+void GFXShutdown() {
+}
+
+void GFXBeginScene() {
+}
+
+void GFXEndScene() {
+}
+
+void GFXClear(const GFXBOOL colorbuffer, const GFXBOOL depthbuffer, const GFXBOOL stencilbuffer) {
+}
+
+//Lights
+
+void GFXCreateLightContext(int &con_number) {
+    con_number = next_light_context++;
+}
+
+void GFXSetLightContext(const int con_number) {
+}
+
+GFXBOOL GFXLightContextAmbient(const vega_types::SharedPtr<GFXColor> amb) {
+    return GFXTRUE;
+}
+
+GFXBOOL GFXGetLightContextAmbient(vega_types::SharedPtr<GFXColor> amb) {
+    if (amb) {
+        *amb = GFXColor(0, 0, 0, 1);
+    }
+    return GFXTRUE;
+}
+
+void GFXPickLights(const Vector &center, const float radius) {
+}
+
+void GFXPickLights(const Vector &center,
+        const float radius,
+        vega_types::SequenceContainer<int> &lights,
+        const int maxlights,
+        const bool pickglobals) {
+}
+
+void GFXGlobalLights(vega_types::SequenceContainer<int> &lights) {
+}
+
+void GFXSetLightOffset(const QVector &offset) {
+}
+
+GFXBOOL GFXSetSeparateSpecularColor(const GFXBOOL spec) {
+    return GFXTRUE;
+}
+
+GFXBOOL GFXCreateLight(int &light, const GFXLight &templatecopy, const bool global) {
+    light = lights.size();
+    lights.push_back(templatecopy);
+    return GFXTRUE;
+}
+
+void GFXDeleteLight(const int light) {
+}
+
+GFXBOOL GFXEnableLight(const int light) {
+    return GFXTRUE;
+}
+
+GFXBOOL GFXDisableLight(const int light) {
+    return GFXTRUE;
+}
+
+GFXBOOL GFXSetLight(const int light, const enum LIGHT_TARGET lt, const GFXColor &color) {
+    lights[light].SetProperties(lt, color);
+    return GFXTRUE;
+}
+
+const GFXLight &GFXGetLight(const int light) {
+    return lights[light];
+}
+
+void GFXUploadLightState(int max_light_location,
+        int active_light_array,
+        int apparent_light_size_array,
+        bool shader,
+        vega_types::SequenceContainer<int>::const_iterator begin,
+        vega_types::SequenceContainer<int>::const_iterator end) {
+}
+
+void GFXPushGlobalEffects() {
+}
+
+GFXBOOL GFXPopGlobalEffects() {
+    return GFXTRUE;
+}
+
+bool GFXLight::attenuated() const {
+    return false;
+}
+
+void GFXLight::apply_attenuate(bool attenuated) {
+}
+
+void GFXLight::SetProperties(enum LIGHT_TARGET lighttarg, const GFXColor &color) {
+}
+
+GFXColor GFXLight::GetProperties(enum LIGHT_TARGET lighttarg) const {
+    return GFXColor(0, 0, 0, 1);
+}
+
+//Materials
+
+const GFXMaterial &GFXGetMaterial(const unsigned int number) {
+    return default_material;
+}
+
+void GFXSelectMaterialHighlights(const unsigned int number,
+        const GFXColor &ambient,
+        const GFXColor &diffuse,
+        const GFXColor &specular,
+        const GFXColor &emmissive) {
+}
+
+void GFXSelectMaterial(const unsigned int number) {
+}
+
+//Matrices
+
+void GFXHudMode(const bool Enter) {
+}
+
+void GFXRestoreHudMode() {
+}
+
+void GFXCenterCamera(const bool Enter) {
+}
+
+void GFXGetMatrixView(Matrix &m) {
+    Identity(m);
+}
+
+void GFXTranslateModel(const QVector &r) {
+}
+
+void GFXLoadMatrixModel(const Matrix &matrix) {
+}
+
+void GFXLoadIdentity(const MATRIXMODE mode) {
+}
+
+void GFXPerspective(float fov, float aspect, float znear, float zfar, float cockpit_offset) {
+}
+
+void GFXParallel(float left, float right, float bottom, float top, float znear, float zfar) {
+}
+
+void GFXViewPort(int minx, int miny, int maxx, int maxy) {
+}
+
+void GFXLookAt(Vector eye, QVector center, Vector up) {
+}
+
+void GFXFrustum(float *mat,
+        float *inv,
+        float left,
+        float right,
+        float bottom,
+        float top,
+        float nearval,
+        float farval) {
+}
+
+void GFXSubwindow(float x, float y, float xsize, float ysize) {
+}
+
+Vector GFXDeviceToEye(int x, int y) {
+    return Vector(0, 0, 0);
+}
+
+//Textures
+
+GFXBOOL GFXCreateTexture(int width,
+        int height,
+        TEXTUREFORMAT externaltextureformat,
+        int *handle,
+        char *palette,
+        int texturestage,
+        enum FILTER mipmap,
+        enum TEXTURE_TARGET texture_target,
+        enum ADDRESSMODE address_mode) {
+    *handle = next_texture++;
+    return GFXTRUE;
+}
+
+void GFXPrioritizeTexture(unsigned int handle, float priority) {
+}
+
+GFXBOOL GFXTransferTexture(unsigned char *buffer,
+        int handle,
+        int inWidth,
+        int inHeight,
+        enum TEXTUREFORMAT internalformat,
+        enum TEXTURE_IMAGE_TARGET image2D,
+        int max_texture_dimension,
+        GFXBOOL detailtexture,
+        unsigned int pageIndex) {
+    return GFXTRUE;
+}
+
+void GFXDeleteTexture(int handle) {
+}
+
+void GFXSelectTexture(int handle, int stage) {
+}
+
+void GFXActiveTexture(const int stage) {
+}
+
+void GFXToggleTexture(bool enable, int whichstage, enum TEXTURE_TARGET target) {
+}
+
+void GFXTextureAddressMode(const ADDRESSMODE mode, enum TEXTURE_TARGET target) {
+}
+
+void GFXTextureEnv(int stage, GFXTEXTUREENVMODES mode, float arg2) {
+}
+
+void GFXTextureCoordGenMode(int stage, GFXTEXTURECOORDMODE tex, const float params[4], const float paramt[4]) {
+}
+
+//State
+
+void GFXEnable(const enum STATE) {
+}
+
+void GFXDisable(const enum STATE) {
+}
+
+void GFXBlendMode(const enum BLENDFUNC src, const enum BLENDFUNC dst) {
+}
+
+void GFXGetBlendMode(enum BLENDFUNC &src, enum BLENDFUNC &dst) {
+    src = ONE;
+    dst = ZERO;
+}
+
+void GFXPushBlendMode() {
+}
+
+void GFXPopBlendMode() {
+}
+
+void GFXColorMaterial(int LIGHTTARG) {
+}
+
+void GFXPointSize(const float size) {
+}
+
+void GFXLineWidth(const float size) {
+}
+
+void GFXDepthFunc(const enum DEPTHFUNC) {
+}
+
+void GFXAlphaTest(const enum DEPTHFUNC, const float ref) {
+}
+
+void GFXPolygonOffset(float factor, float units) {
+}
+
+void GFXGetPolygonOffset(float *factor, float *units) {
+    *factor = 0;
+    *units = 0;
+}
+
+void GFXPolygonMode(const enum POLYMODE) {
+}
+
+void GFXCullFace(const enum POLYFACE) {
+}
+
+void GFXFogMode(const FOGMODE fog) {
+}
+
+void GFXFogDensity(const float fogdensity) {
+}
+
+void GFXFogLimits(const float fognear, const float fogfar) {
+}
+
+void GFXFogColor(GFXColor c) {
+}
+
+void GFXFogIndex(const int index) {
+}
+
+//Drawing
+
+void GFXColorf(const GFXColor &col) {
+}
+
+void GFXColor4f(const float r, const float g, const float b, const float a) {
+}
+
+GFXColor GFXColorf() {
+    return GFXColor(1, 1, 1, 1);
+}
+
+void GFXCircle(float x, float y, float r1, float r2) {
+}
+
+void GFXDraw(POLYTYPE type, const float data[], int vnum, int vsize, int csize, int tsize0, int tsize1) {
+}
+
+void GFXDrawElements(POLYTYPE type,
+        const float data[],
+        int vnum,
+        const unsigned char indices[],
+        int nelem,
+        int vsize,
+        int csize,
+        int tsize0,
+        int tsize1) {
+}
+
+void GFXDrawElements(POLYTYPE type,
+        const float data[],
+        int vnum,
+        const unsigned short indices[],
+        int nelem,
+        int vsize,
+        int csize,
+        int tsize0,
+        int tsize1) {
+}
+
+void GFXCallList(int list) {
+}
+
+GFXQuadList::GFXQuadList(GFXBOOL color) : numVertices(0), numQuads(0) {
+    data.vertices = NULL;
+    Dirty = GFXFALSE;
+    isColor = color;
+}
+
+GFXQuadList::~GFXQuadList() {
+}
+
+void GFXQuadList::Draw() {
+}
+
+int GFXQuadList::AddQuad(const GFXVertex *vertices, const GFXColorVertex *color) {
+    return -1;
+}
+
+void GFXQuadList::DelQuad(int which) {
+}
+
+void GFXQuadList::ModQuad(int which, const GFXVertex *vertices, float alpha) {
+}
+
+void GFXQuadList::ModQuad(int which, const GFXColorVertex *vertices) {
+}
+
+//Shaders; each program compiles, so meshes keep their techniques
+
+int GFXCreateProgram(const char *vertex, const char *fragment, const char *extra_defines) {
+    return 1;
+}
+
+void GFXDestroyProgram(int program) {
+}
+
+int GFXActivateShader(int program) {
+    return program;
+}
+
+void GFXDeactivateShader() {
+}
+
+void GFXReloadDefaultShader() {
+}
+
+int GFXGetProgramVersion() {
+    return 0;
+}
+
+int GFXNamedShaderConstant(int progID, const char *name) {
+    return 0;
+}
+
+int GFXShaderConstant(int name, Vector value) {
+    return 1;
+}
+
+int GFXShaderConstant(int name, const float *value) {
+    return 1;
+}
+
+int GFXShaderConstant(int name, float v1) {
+    return 1;
+}
+
+int GFXShaderConstant(int name, float v1, float v2, float v3, float v4) {
+    return 1;
+}
+
+int GFXShaderConstanti(int name, int value) {
+    return 1;
+}
+
+//Window system
+
+void winsys_set_keyboard_func(winsys_keyboard_func_t func) {
+}
+
+void winsys_set_mouse_func(winsys_mouse_func_t func) {
+}
+
+void winsys_set_motion_func(winsys_motion_func_t func) {
+}
+
+void winsys_set_passive_motion_func(winsys_motion_func_t func) {
+}
+
+void winsys_warp_pointer(int x, int y) {
+}
+
+void winsys_show_cursor(bool visible) {
+}
+
+void winsys_exit(int code) {
+    exit(code);
+}
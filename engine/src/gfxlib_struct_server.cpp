@@ -64,6 +64,10 @@ GFXVertexList::VDAT *GFXVertexList::Map(bool read, bool write) {
 void GFXVertexList::UnMap() {
 }
 
+int GFXVertexList::GetNumLists() const {
+    return numlists;
+}
+
 //private, only for inheriters
 GFXVertexList::GFXVertexList() :
         numVertices(0),
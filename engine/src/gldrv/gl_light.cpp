@@ -331,7 +331,7 @@ void /*GFXDRVAPI*/ GFXDeleteLightContext(int con_number) {
 void /*GFXDRVAPI*/ GFXSetLightContext(const int con_number) {
     unpickLights();
     int GLLindex = 0;
-    lighttable.Clear();
+    localLightsChanged();
     _currentContext = con_number;
     staticLightsDataManager()->l_lights = staticLightsDataManager()->local_lights_dat->at(con_number);
     SharedPtr<GFXColor> ambient_light_tmp = staticLightsDataManager()->ambient_light->at(con_number);
@@ -343,14 +343,10 @@ void /*GFXDRVAPI*/ GFXSetLightContext(const int con_number) {
     }
     for (size_t i = 0; i < staticLightsDataManager()->l_lights->size() && GLLindex < GFX_MAX_LIGHTS; ++i) {
         SharedPtr<gfx_light> const & light = staticLightsDataManager()->l_lights->at(i);
-        if (light->enabled()) {
-            if (light->LocalLight()) {
-                light->AddToTable();
-            } else {
-                staticLightsDataManager()->gl_lights->at(GLLindex)->index = -1;                 //make it clobber completely! no trace of old light.
-                light->ClobberGLLight(GLLindex);
-                ++GLLindex;
-            }
+        if (light->enabled() && !light->LocalLight()) {
+            staticLightsDataManager()->gl_lights->at(GLLindex)->index = -1;                 //make it clobber completely! no trace of old light.
+            light->ClobberGLLight(GLLindex);
+            ++GLLindex;
         }
     }
     for (; GLLindex < GFX_MAX_LIGHTS; ++GLLindex) {
@@ -361,7 +357,7 @@ void /*GFXDRVAPI*/ GFXSetLightContext(const int con_number) {
 }
 
 void GFXDestroyAllLights() {
-    lighttable.Clear();
+    localLightsChanged();
     staticLightsDataManager()->gl_lights.reset();
 }
 
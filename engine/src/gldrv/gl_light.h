@@ -27,7 +27,6 @@
 
 #include <options.h>
 #include "gfxlib.h"
-#include "hashtable_3d.h"
 #include "gl_globals.h"
 
 extern GLint GFX_MAX_LIGHTS;
@@ -41,7 +40,6 @@ extern GFXBOOL GFXLIGHTING;
 //#define GFX_LIGHT_POS 16
 #define GFX_LIGHT_ENABLED 32
 #define GFX_LOCAL_LIGHT 64
-const unsigned int lighthuge = 20 * 20 * 20;
 constexpr size_t kGfxMaxContexts = 64;
 
 /**
@@ -102,36 +100,30 @@ public:
 
     /**
      * for global lights, clobbers SOMETHING for sure, calls GLenable
-     * for local lights, puts it into the light table
+     * for local lights, has the local light index take it in
      */
     void Enable();
 
     /**
      * for global lights, GLdisables it.
-     * for local lights, removes it from the table. and trashes it form GLlights.
+     * for local lights, has the local light index drop it. and trashes it form GLlights.
      */
     void Disable();
 
     /** sets properties, making minimum GL state changes for global,
-     *  for local lights, removes it from table, trashes it from GLlights,
-     *  if enabled, puts it bakc in table.
+     *  for local lights, trashes it from GLlights,
+     *  if enabled, has the local light index take in the change.
      */
     void ResetProperties(const enum LIGHT_TARGET, const GFXColor &color);
 
-    ///Adds this light to table (assume local)
-    void AddToTable();
-
-    ///Removes this light from light table
-    bool RemoveFromTable(bool shouldremove = true, const GFXLight &t = GFXLight());
-
     ///Trash this light from active GLLights
     void TrashFromGLLights();
 
     ///Do all enables from picking
     static void dopickenables();
 
-    ///calculates bounds for the table given cutoffs!
-    LineCollide CalculateBounds(bool &err);
+    ///calculates how far the light reaches before it fades under the cutoff!
+    double InfluenceRadius(bool &err) const;
 };
 
 namespace OpenGLL {
@@ -156,6 +148,8 @@ void light_rekey_frame();
 ///picks doubtless changed position
 void unpickLights();
 void removeLightFromNewPick(int whichlight);
+///local lights were enabled, disabled, moved or changed; the local light index is rebuilt at the next pick
+void localLightsChanged();
 
 class ManagerOfStaticLightsData {
 public:
@@ -242,32 +236,9 @@ public:
 
 extern vega_types::SharedPtr<ManagerOfStaticLightsData> staticLightsDataManager();
 
-///A sortable line collide object that will sort by object addr for dup elim
-struct LineCollideStar {
-    LineCollide *lc;
-
-    LineCollideStar() : lc(nullptr) {
-    }
-
-    bool operator==(const LineCollideStar &b) const {
-        return lc->object.i == b.lc->object.i;
-    }
-
-    bool operator<(const LineCollideStar &b) const {
-        return *((int *) &(lc->object.i)) < *((int *) &(b.lc->object.i));
-    }
-
-    inline int GetIndex() {
-        return *((int *) (&lc->object.i));
-    }
-};
 ///Finds the local lights that are clobberable for new lights (permanent perhaps)
 int findLocalClobberable();
 
-#define CTACC 40000
-///table to store local lights, numerical pointers to _llights (eg indices)
-extern Hashtable3d<LineCollideStar, 20, CTACC, lighthuge> lighttable;
-
 ///something that would normally round down
 extern float intensity_cutoff;
 ///optimization globals
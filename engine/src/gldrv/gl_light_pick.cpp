@@ -25,17 +25,13 @@
 
 #include "gl_light.h"
 #include "options.h"
-#include <queue>
-#include <list>
 #include "vs_logging.h"
 #include "gfx/occlusion.h"
+#include "gfx/light_index.h"
 
 #include <vector>
 #include <algorithm>
 #include "preferred_types.h"
-using std::priority_queue;
-#include "hashtable_3d.h"
-//using std::list;
 using std::vector;
 using namespace vega_types;
 
@@ -47,42 +43,42 @@ float optintense = kDefaultOptIntense;
 static const constexpr float kDefaultOptSat = 0.95F;
 float optsat = kDefaultOptSat;
 
-struct light_key {
-    int number;
-    float intensity_key;
+//the enabled local lights of the current light context, by where they reach
+static LightIndex local_light_index;
+static bool local_light_index_stale = true;
 
-    light_key() : number(0), intensity_key(0.0F) {
-    }
-
-    light_key(int num, float inte) : number(num), intensity_key(inte) {
-    }
-};
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-function"  // Disable the unused warning for this function only
-
-static bool operator<(light_key tmp1, light_key tmp2) {
-    return tmp1.intensity_key < tmp2.intensity_key;
+void localLightsChanged() {
+    local_light_index_stale = true;
 }
 
-#pragma GCC diagnostic pop
-
-static SharedPtr<priority_queue<light_key>> lightQ() {
-    static const SharedPtr<priority_queue<light_key>> kLightQ = MakeShared<priority_queue<light_key>>();
-    return kLightQ;
+static void updateLocalLightIndex() {
+    if (!local_light_index_stale) {
+        return;
+    }
+    local_light_index_stale = false;
+    local_light_index.Clear();
+    SharedPtr<ContiguousSequenceContainer<SharedPtr<gfx_light>>> const &lights = staticLightsDataManager()->l_lights;
+    for (size_t i = 0; i < lights->size(); ++i) {
+        const gfx_light &light = *lights->at(i);
+        if (!light.LocalLight() || !light.enabled()) {
+            continue;
+        }
+        bool err;
+        double const radius = light.InfluenceRadius(err);
+        if (!err) {
+            local_light_index.Add(static_cast<int>(i), light.vect[0], light.vect[1], light.vect[2], radius);
+        }
+    }
+    local_light_index.Build();
 }
 
 void removeLightFromNewPick(int index) {
     for (int i = 0; i < 2; ++i) {
         SharedPtr<SequenceContainer<int>> const &p_collection = staticLightsDataManager()->picked_lights->at(i);
-        auto first_to_remove = std::stable_partition(p_collection->begin(), p_collection->end(), [index](int elem) { return elem != index; });
-        p_collection->erase(first_to_remove, p_collection->end());
+        p_collection->erase(std::remove(p_collection->begin(), p_collection->end(), index), p_collection->end());
     }
 }
 
-inline int getIndex(const LineCollide &t) {
-    return t.object.i;
-}
-
 void unpickLights() {
     for (int & i : *staticLightsDataManager()->new_picked) {
         if (i >= staticLightsDataManager()->l_lights->size()) {
@@ -115,6 +111,7 @@ static float occludedIntensity(const gfx_light &light, const Vector &center, con
     return Occlusion::testOcclusion(light.getPosition().Cast(), light.getSize(), center.Cast(), rad);
 }
 
+//the share of the light's intensity that reaches the sphere, 1 inside the light
 static float attenuatedIntensity(const gfx_light &light, const Vector &center, const float rad) {
     float const intensity = (1.0F / 3.0F) * (
             light.diffuse[0] + light.specular[0]
@@ -128,49 +125,56 @@ static float attenuatedIntensity(const gfx_light &light, const Vector &center, c
     if ((distance <= 0.0F) || (att <= 0.0F)) {
         return 1.0F;
     } else {
-        return (intensity / att) >= light.cutoff;
+        return std::min(1.0F, intensity / att);
     }
 }
 
-static bool picklight(const LineCollide &lightcollide,
-        const Vector &center,
-        const float rad,
-        const int lightsenabled,
-        const int lightindex,
-        float &attenuated,
-        float &occlusion) {
-    const gfx_light &light = *(staticLightsDataManager()->localLightAtIndex(lightindex));
-    return (
-            !light.attenuated()
-                    || ((attenuated = attenuatedIntensity(light, center, rad)) >= light.cutoff)
-    ) && ((occlusion = occludedIntensity(light, center, rad)) * attenuated >= light.cutoff);
-}
-
-struct lightsort {
+//scores a local light for a mesh by how much of it gets there; 0 if too little, else records its occlusion
+struct lightscore {
     Vector center;
     float rad;
 
-    lightsort(const Vector &_center, const float _rad) : center(_center), rad(_rad) {
+    lightscore(const Vector &_center, const float _rad) : center(_center), rad(_rad) {
     }
 
-    bool operator()(const int a, const int b) const {
-        const gfx_light &lighta = *(staticLightsDataManager()->localLightAtIndex(a));
-        const gfx_light &lightb = *(staticLightsDataManager()->localLightAtIndex(b));
-        return attenuatedIntensity(lighta, center, rad) > attenuatedIntensity(lightb, center, rad);
+    float operator()(const int lightindex) const {
+        gfx_light &light = *(staticLightsDataManager()->localLightAtIndex(lightindex));
+        float attenuated = 1.0F;
+        if (light.attenuated() && (attenuated = attenuatedIntensity(light, center, rad)) < light.cutoff) {
+            return 0.0F;
+        }
+        float const occlusion = occludedIntensity(light, center, rad);
+        if (occlusion < light.cutoff) {
+            return 0.0F;
+        }
+        light.occlusion = occlusion;
+        return attenuated * occlusion;
     }
 };
 
-typedef vector<LineCollideStar> veclinecol;
-
 void GFXGlobalLights(SequenceContainer<int> &lights, const Vector &center, const float radius) {
+    // the global lights are tested for occlusion together, so the occluders near the mesh are only found once
+    static std::vector<OccluderSet::Light> occluded;
+    static std::vector<float> occlusion;
+    occluded.clear();
+    size_t const first = lights.size();
     for (int i = 0; i < GFX_MAX_LIGHTS; ++i) {
         if ((staticLightsDataManager()->gl_lights->at(i)->options & (OpenGLL::GL_ENABLED | OpenGLL::GLL_LOCAL)) == OpenGLL::GL_ENABLED) {
             // It's global and enabled
-            gfx_light &light = *(staticLightsDataManager()->localLightAtIndex(staticLightsDataManager()->gl_lights->at(i)->index));
-            light.occlusion = occludedIntensity(light, center, radius);
+            gfx_light const &light = *(staticLightsDataManager()->localLightAtIndex(staticLightsDataManager()->gl_lights->at(i)->index));
+            OccluderSet::Light const tested = {light.vect[0], light.vect[1], light.vect[2], light.getSize()};
+            occluded.push_back(tested);
             lights.push_back(staticLightsDataManager()->gl_lights->at(i)->index);
         }
     }
+    if (occluded.empty()) {
+        return;
+    }
+    occlusion.resize(occluded.size());
+    Occlusion::testOcclusion(&occluded[0], occluded.size(), center.Cast(), radius, &occlusion[0]);
+    for (size_t i = 0; i < occluded.size(); ++i) {
+        staticLightsDataManager()->localLightAtIndex(lights[first + i])->occlusion = occlusion[i];
+    }
 }
 
 void GFXGlobalLights(SequenceContainer<int> &lights) {
@@ -187,34 +191,21 @@ void GFXPickLights(const Vector &center,
                    SequenceContainer<int> &lights,
                    const int maxlights,
                    const bool pickglobals) {
-    QVector tmp;
-    //Beware if re-using rndvar !! Because rand returns an int and on 64 bits archs sizeof( void*) != sizeof( int) !!!
-    //void * rndvar = (void *)rand();
-    int lights_enabled = staticLightsDataManager()->gl_lights_enabled;
-    tmp = QVector(radius, radius, radius);
-
-    if (lights_enabled && pickglobals) {
+    if (staticLightsDataManager()->gl_lights_enabled && pickglobals) {
         GFXGlobalLights(lights, center, radius);
     }
 
-    veclinecol *tmppickt[2];
-    lighttable.Get(center.Cast(), static_cast<veclinecol **>(tmppickt));
-
-    for (auto & j : tmppickt) {
-        veclinecol::iterator i;
-        float attenuated = 0, occlusion = 0;
-
-        for (i = j->begin(); i != j->end(); i++) {
-            if (picklight(*i->lc, center, radius, lights_enabled, i->GetIndex(), attenuated, occlusion)) {
-                int const ix = i->GetIndex();
-                gfx_light &l = *(staticLightsDataManager()->localLightAtIndex(ix));
-                l.occlusion = occlusion;
-                lights.push_back(ix);
-                lights_enabled++;
-            }
-        }
+    //no more local lights than can be drawn, be it in one pass or over several
+    size_t const most = std::max(maxlights, static_cast<int>(GFX_MAX_LIGHTS));
+    if (lights.size() >= most) {
+        return;
+    }
+    updateLocalLightIndex();
+    lightscore score(center, radius);
+    for (const LightIndex::Picked &picked : local_light_index.Pick(center.i, center.j, center.k, radius,
+            most - lights.size(), score)) {
+        lights.push_back(picked.light);
     }
-    std::sort(lights.begin(), lights.end(), lightsort(center, radius));
 }
 
 void GFXPickLights(const Vector &center, const float radius) {
@@ -28,7 +28,6 @@
 #include <boost/smart_ptr.hpp>
 //#include <vegastrike.h>
 #include "gl_globals.h"
-#include "hashtable_3d.h"
 #include "gl_light.h"
 
 #include <math.h>
@@ -183,11 +182,9 @@ void GFXUploadLightState(int max_light_location,
 }
 
 #define GFX_HARDWARE_LIGHTING
-//table to store local lights, numerical pointers to _llights (eg indices)
 const float atten0scale = 1;
 const float atten1scale = 1. / GFX_SCALE;
 const float atten2scale = 1. / (GFX_SCALE * GFX_SCALE);
-Hashtable3d<LineCollideStar, 20, CTACC, lighthuge> lighttable;
 
 gfx_light & gfx_light::operator=(const GFXLight &tmp) {   // Let's see if I can write a better copy operator
 //    memcpy( this, &tmp, sizeof (GFXLight) );
@@ -393,15 +390,13 @@ void gfx_light::ClobberGLLight(const int target) {
 }
 
 void gfx_light::ResetProperties(const enum LIGHT_TARGET light_targ, const GFXColor &color) {
-    bool changed = false;
     if (LocalLight()) {
         GFXLight t;
         t = *this;
         t.SetProperties(light_targ, color);
-        changed = RemoveFromTable(false, t);
         *this = t;
-        if (changed) {
-            AddToTable();
+        if (enabled()) {
+            localLightsChanged();
         }
         if (target >= 0) {
             TrashFromGLLights();
@@ -477,53 +472,11 @@ void gfx_light::TrashFromGLLights() {
     target = -1;
 }
 
-void gfx_light::AddToTable() {
-    LineCollideStar tmp;
-    bool err;
-    LineCollide *coltarg = new LineCollide(CalculateBounds(err));     //leak??
-    if (err) {
-        return;
-    }
-    tmp.lc = coltarg;
-    lighttable.Put(coltarg, tmp);
-}
-
-bool gfx_light::RemoveFromTable(bool shouldremove, const GFXLight &t) {
-    LineCollideStar tmp;
-    bool err;
-    LineCollide coltarg(CalculateBounds(err));
-    if (!shouldremove) {
-        bool err2;
-        LineCollide coltarg2(CalculateBounds(err2));
-        if (lighttable.hash_int(coltarg2.Mini.i) == lighttable.hash_int(coltarg.Mini.i)
-                && lighttable.hash_int(coltarg2.Mini.j) == lighttable.hash_int(coltarg.Mini.j)
-                && lighttable.hash_int(coltarg2.Mini.k) == lighttable.hash_int(coltarg.Mini.k)
-                && lighttable.hash_int(coltarg2.Maxi.i) == lighttable.hash_int(coltarg.Maxi.i)
-                && lighttable.hash_int(coltarg2.Maxi.j) == lighttable.hash_int(coltarg.Maxi.j)
-                && lighttable.hash_int(coltarg2.Maxi.k) == lighttable.hash_int(coltarg.Maxi.k)) {
-            return false;
-        }
-    }
-    if (err) {
-        return false;
-    }
-    tmp.lc = &coltarg;
-    if (lighttable.Remove(&coltarg, tmp)) {
-        if (tmp.lc != nullptr) {
-            delete tmp.lc;
-            tmp.lc = nullptr;
-        } else {
-            assert(tmp.lc);
-        }
-    }
-    return true;
-}
-
 //unimplemented -- O RLY? Looks implemented to me -- Stephen G. Tuggy 2022-12-21
 void gfx_light::Enable() {
     if (!enabled()) {
         if (LocalLight()) {
-            AddToTable();
+            localLightsChanged();
         } else {
             if (target == -1) {
                 int const newtarg = findGlobalClobberable();
@@ -551,8 +504,10 @@ void gfx_light::Disable() {
             }
             staticLightsDataManager()->gl_lights->at(this->target)->options &= (~(OpenGLL::GL_ENABLED | OpenGLL::GLL_ON));
         }
+        if (LocalLight()) {
+            localLightsChanged();
+        }
         if (LocalLight() && enabled()) {
-            RemoveFromTable();
             if (target >= 0) {
                 TrashFromGLLights();
             }
@@ -564,7 +519,7 @@ void gfx_light::Disable() {
 //d= (-Bi + sqrtf (B*i*B*i - 4*Ci*(Ai-tot)))/ (2Ci)
 //d= (-B + sqrtf (B*B + 4*C*(tot/i-A)))/ (2C)
 
-LineCollide gfx_light::CalculateBounds(bool &error) {
+double gfx_light::InfluenceRadius(bool &error) const {
     error = false;
     float tot_intensity = ((specular[0] + specular[1] + specular[2]) * specular[3]
             + (diffuse[0] + diffuse[1] + diffuse[2]) * diffuse[3]
@@ -580,13 +535,7 @@ LineCollide gfx_light::CalculateBounds(bool &error) {
     if (ffastmathreallysucksq == 0 || ffastmathreallysucksd <= 0) {
         error = true;
     }
-    ffastmathreallysucksd /= ffastmathreallysucksq;
-
-    QVector st(vect[0] - ffastmathreallysucksd, vect[1] - ffastmathreallysucksd, vect[2] - ffastmathreallysucksd);
-    QVector end(vect[0] + ffastmathreallysucksd, vect[1] + ffastmathreallysucksd, vect[2] + ffastmathreallysucksd);
-    LineCollide retval(NULL, LineCollide::UNIT, st, end);
-    *((int *) (&retval.object)) = lightNum();       //put in a lightNum
-    return retval;
+    return ffastmathreallysucksd / ffastmathreallysucksq;
 }
 
 void light_rekey_frame() {
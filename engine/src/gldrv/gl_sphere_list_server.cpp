@@ -34,16 +34,19 @@ void GFXSphereVertexList::Draw(enum POLYTYPE *poly, const INDEX index, const int
 void GFXSphereVertexList::BeginDrawState(GFXBOOL lock) {
 }
 
-void GFXSphereVertexList::GetPolys(GFXVertex **vert, int *numPolys, int *numTris) {
-    sphere->GetPolys(vert, numPolys, numTris);
-    int numt = *numTris;
-    int numq = *numPolys - numt;
-    int verts = numt * 3 + numq * 4;
-    for (int i = 0; i < verts; ++i) {
-        (*vert)[i].x *= radius;
-        (*vert)[i].y *= radius;
-        (*vert)[i].z *= radius;
+vega_types::SharedPtr<vega_types::ContiguousSequenceContainer<GFXVertex>> GFXSphereVertexList::GetPolys(size_t &num_tris,
+                                                                                                        size_t &num_quads,
+                                                                                                        size_t &total_num_polys) {
+    vega_types::SharedPtr<vega_types::ContiguousSequenceContainer<GFXVertex>> return_value =
+            sphere->GetPolys(num_tris,
+                             num_quads,
+                             total_num_polys);
+    for (auto& elem: *return_value) {
+        elem.x *= radius;
+        elem.y *= radius;
+        elem.z *= radius;
     }
+    return return_value;
 }
 
 void GFXSphereVertexList::EndDrawState(GFXBOOL lock) {
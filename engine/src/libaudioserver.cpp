@@ -22,6 +22,7 @@
 
 #include <string>
 #include "audiolib.h"
+#include "aldrv/al_globals.h"
 #include "gfx/cockpit_generic.h"
 
 void AUDAdjustSound(int i, QVector const &qv, Vector const &vv) {
@@ -72,10 +73,36 @@ QVector AUDListenerLocation() {
     return QVector(0, 0, 0);
 }
 
-//From communication_xml.cpp
-int createSound(std::string file, bool val) {
+void AUDListenerSize(const float size) {
+}
+
+void AUDListener(const QVector &pos, const Vector &vel) {
+}
+
+void AUDListenerOrientation(const Vector &i, const Vector &j, const Vector &k) {
+}
+
+void AUDListenerGain(const float gain) {
+}
+
+float AUDGetListenerGain() {
+    return 0;
+}
+
+void AUDStopAllSounds(int except_this_one) {
+}
+
+int AUDHighestSoundPlaying() {
     return -1;
 }
 
+void AUDStreamingSound(const int sound) {
+}
+
+bool AUDLoadSoundFile(const char *s, struct AUDSoundProperties *info, bool use_fileptr) {
+    info->success = false;
+    return false;
+}
+
 //soundContainer::~soundContainer () {}
 
@@ -51,6 +51,7 @@ static double lasttime;
 #endif
 static double elapsedtime = .1;
 static double timecompression = 1;
+static double fixedtimestep = 0;
 
 double getNewTime() {
 #ifdef _WIN32
@@ -280,11 +281,18 @@ void UpdateTime() {
 #else
 # error "We have no way to determine the time on this system."
 #endif
+    if (fixedtimestep > 0) {
+        elapsedtime = fixedtimestep;
+    }
     elapsedtime *= timecompression;
     // VS_LOG(trace, (boost::format("lin_time.cpp: UpdateTime():                                  elapsedtime after  time compression is %1%") % elapsedtime));
     first = false;
 }
 
+void setFixedTimeStep(double step) {
+    fixedtimestep = step;
+}
+
 void setNewTime(double newnewtime) {
     firsttime -= newnewtime - queryTime();
     UpdateTime();
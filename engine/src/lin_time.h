@@ -32,6 +32,8 @@ void UpdateTime();
 void micro_sleep(unsigned int n);
 double getNewTime();
 void setNewTime(double newnewtime);
+//When positive, every UpdateTime() advances the game clock by exactly step seconds (before time compression)
+void setFixedTimeStep(double step);
 
 //Essentially calling UpdateTime();getNewTime() without modifying any state.
 //Always use this except at the beginning of a frame.
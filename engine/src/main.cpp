@@ -58,6 +58,7 @@
 #include "save_util.h"
 #include "gfx/masks.h"
 #include "cmd/music.h"
+#include "cmd/collide2/collision_tree_cache.h"
 #include "ship_commands.h"
 #include "gamemenu.h"
 #include "audio/SceneManager.h"
@@ -311,7 +312,7 @@ int main(int argc, char *argv[]) {
     }
 
     // now that the user config file has been loaded from disk, update the global configuration struct values
-    configuration()->OverrideDefaultsWithUserConfiguration();
+    ReloadConfiguration();
 
     // If no debug argument is supplied, set to what the config file has.
     if (g_game.vsdebug == '0') {
@@ -328,7 +329,14 @@ int main(int argc, char *argv[]) {
         home_subdir_path = home_path;
     }
 
-    VegaStrikeLogging::vega_logger()->InitLoggingPart2(g_game.vsdebug, home_subdir_path);
+    VegaStrikeLogging::vega_logger()->InitLoggingPart2(g_game.vsdebug, home_subdir_path,
+            configuration()->logging.asynchronous);
+
+    if (configuration()->data_config.collision_tree_cache) {
+        VSFileSystem::CreateDirectoryHome("collision_trees");
+        CollisionTreeCache::SetDirectory(VSFileSystem::homedir + "/collision_trees",
+                uint64_t(configuration()->data_config.collision_tree_cache_megabytes) << 20);
+    }
 
     // can use the vegastrike config variable to read in the default mission
     if (game_options()->force_client_connect) {
@@ -1042,6 +1042,9 @@ void main_loop() {
     }
     loop_count++;
 
+    //nothing holds on to the settings of the last frame
+    ReleaseRetiredConfigurations();
+
     //Execute DJ script
     Music::MuzakCycle();
 
@@ -55,6 +55,10 @@
 #include "pk3.h"
 #include <cstdlib>
 #include <iostream>
+#if !defined (_WIN32) || defined (__CYGWIN__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 #include "posh.h"
 #include "vs_globals.h"
 #include "vsfilesystem.h"
@@ -182,14 +186,26 @@ struct CPK3::TZipDirFileHeader {
 
 #pragma pack()
 
-CPK3::CPK3(FILE *n_f) {
+CPK3::CPK3(FILE *n_f) : m_nEntries(0), m_pMapped(NULL), m_nMappedSize(0), m_nCacheBytes(0), m_nCacheLimit(0) {
     CheckPK3(n_f);
 }
 
-CPK3::CPK3(const char *filename) {
+CPK3::CPK3(const char *filename) :
+        m_nEntries(0), m_pMapped(NULL), m_nMappedSize(0), m_nCacheBytes(0), m_nCacheLimit(0) {
     Open(filename);
 }
 
+//Directory names use '\\', so lookups do too
+static std::string IndexKey(const char *name, size_t length) {
+    std::string key(name, length);
+    for (size_t i = 0; i < key.size(); ++i) {
+        if (key[i] == '/') {
+            key[i] = '\\';
+        }
+    }
+    return key;
+}
+
 static size_t bogus_sizet; //added by chuck_starchaser to squash some warnings
 
 bool CPK3::CheckPK3(FILE *f) {
@@ -257,14 +273,38 @@ bool CPK3::CheckPK3(FILE *f) {
     } else {
         m_nEntries = dh.nDirEntries;
         this->f = f;
+        //the first entry of a name wins, as it did when FileExists scanned the directory
+        m_index.clear();
+        m_index.reserve(m_nEntries);
+        for (int i = 0; i < m_nEntries; i++) {
+            m_index.insert(std::make_pair(IndexKey(m_papDir[i]->GetName(), m_papDir[i]->fnameLen), i));
+        }
+        MapArchive();
     }
     return ret;
 }
 
+void CPK3::MapArchive() {
+#if !defined (_WIN32) || defined (__CYGWIN__)
+    struct stat st{};
+    if (fstat(fileno(this->f), &st) != 0 || st.st_size <= 0) {
+        return;
+    }
+    void *mapped = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno(this->f), 0);
+    if (mapped == MAP_FAILED) {
+        VS_LOG(info, (boost::format("PK3 -- could not map %1%, reading it through stdio") % pk3filename));
+        return;
+    }
+    m_pMapped = static_cast<const char *>(mapped);
+    m_nMappedSize = st.st_size;
+#endif
+}
+
 bool CPK3::Open(const char *filename) {
     f = fopen(filename, "rb");
     if (f) {
-        strcpy(pk3filename, filename);
+        strncpy(pk3filename, filename, PK3LENGTH - 1);
+        pk3filename[PK3LENGTH - 1] = '\0';
         return CheckPK3(f);
     } else {
         return false;
@@ -286,101 +326,141 @@ bool CPK3::ExtractFile(const char *lp_name, const char *new_filename) {
             new_f = fopen(new_filename, "wb");
             fwrite(data_content, 1, size, new_f);
             fclose(new_f);
-            delete data_content;
+            delete[] data_content;
             return true;
         }
     }
     return false;     //probably file not found
 }
 
-//Compares 2 c-strings but do not take into account '/' or '\'
-int vsstrcmp(const char *lp, const char *str) {
-    unsigned int i, ok = 1;
-    unsigned int len = strlen(lp);
-    for (i = 0; ok && i < len; i++) {
-        if (lp[i] != '/' && lp[i] != '\\' && lp[i] != str[i]) {
-            ok = 0;
-        }
-    }
-    return !ok;
-}
-
 int CPK3::FileExists(const char *lpname) {
-    char str[PK3LENGTH];
-    int idx = -1;
-
-    memset(&str, 0, sizeof(str));
-    for (int i = 0; idx == -1 && i < m_nEntries; i++) {
-        GetFilename(i, str);
-        int result = vsstrcmp(lpname, str);
-        if (result == 0) {
-            VS_LOG(info, (boost::format("FOUND IN PK3 FILE : %1% with index=%2%") % lpname % i));
-            idx = i;
-        }
+    std::unordered_map<std::string, int>::const_iterator found = m_index.find(IndexKey(lpname, strlen(lpname)));
+    if (found == m_index.end()) {
+        //if the file isn't in the archive idx=-1
+        return -1;
     }
-    //if the file isn't in the archive idx=-1
-    return idx;
+    VS_LOG(trace, (boost::format("FOUND IN PK3 FILE : %1% with index=%2%") % lpname % found->second));
+    return found->second;
 }
 
 char *CPK3::ExtractFile(int index, int *file_size) {
-    char *buffer;
-    int flength = GetFileLen(index);
-
-    buffer = new char[flength];
-    if (!buffer) {
-        VS_LOG(error, "Unable to allocate memory, probably memory too low !!!");
+    const int size = GetFileLen(index);
+    if (size < 0) {
         return NULL;
-    } else {
-        if (true == ReadFile(index, buffer)) {
-            //everything went well !!!
-        } else {
-            VS_LOG(error,
-                    "\nThe file was found in the archive, but I was unable to extract it. Maybe the archive is broken.\n");
-        }
     }
-    *file_size = flength;
+    //callers read it as a C string
+    char *buffer = new char[size + 1]();
+    //the caller owns the copy, so inflate straight into it rather than through the member cache
+    std::shared_ptr<const std::vector<char> > cached = FindCachedMember(index);
+    if (cached) {
+        memcpy(buffer, cached->data(), size);
+    } else if (size > 0 && !ReadFile(index, buffer)) {
+        VS_LOG(error,
+                "\nThe file was found in the archive, but I was unable to extract it. Maybe the archive is broken.\n");
+        //still hand out a buffer of the right size, as callers expect one for every index FileExists returned
+        memset(buffer, 0, size);
+    }
+    *file_size = size;
     return buffer;
 }
 
 char *CPK3::ExtractFile(const char *lpname, int *file_size) {
-    char str[PK3LENGTH];
-    int index = -1;
-    char *buffer;
-
-    memset(&str, 0, sizeof(str));
-    for (int i = 0; index == -1 && i < m_nEntries; i++) {
-        GetFilename(i, str);
-        int result = vsstrcmp(lpname, str);
-        if (result == 0) {
-            index = i;
-        }
-    }
+    int index = FileExists(lpname);
     //if the file isn't in the archive
     if (index == -1) {
         return (NULL);
     }
-    int flength = GetFileLen(index);
+    return ExtractFile(index, file_size);
+}
 
-    buffer = new char[flength];
-    if (!buffer) {
-        VS_LOG(error, "Unable to allocate memory, probably memory too low !!!");
-        return NULL;
-    } else {
-        if (true == ReadFile(index, buffer)) {
-            //everything went well !!!
-        } else {
-            VS_LOG(error,
-                    "\nThe file was found in the archive, but I was unable to extract it. Maybe the archive is broken.\n");
+CPK3::FileView CPK3::ViewFile(int index) {
+    FileView view;
+    if (index < 0 || index >= m_nEntries) {
+        return view;
+    }
+    unsigned short compression = 0;
+    const char *mapped = MappedData(index, &compression);
+    if (mapped && compression == TZipLocalHeader::COMP_STORE) {
+        view.data = mapped;
+        view.size = m_papDir[index]->ucSize;
+        return view;
+    }
+    if (GetFileLen(index) == 0) {
+        view.data = "";
+        view.size = 0;
+        return view;
+    }
+    view.inflated = FindCachedMember(index);
+    if (!view.inflated) {
+        std::shared_ptr<std::vector<char> > buffer = std::make_shared<std::vector<char> >(GetFileLen(index));
+        if (!ReadFile(index, buffer->data())) {
+            return view;
         }
+        view.inflated = buffer;
+        CacheMember(index, view.inflated);
     }
-    *file_size = flength;
-    return buffer;
+    view.data = view.inflated->data();
+    view.size = static_cast<int>(view.inflated->size());
+    return view;
+}
+
+void CPK3::SetInflatedCacheSize(size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    m_nCacheLimit = bytes;
+    EvictMembers(m_nCacheLimit);
+}
+
+//Drops the least recently used members until they take up at most bytes; m_cacheMutex must be held
+void CPK3::EvictMembers(size_t bytes) {
+    while (m_nCacheBytes > bytes) {
+        std::unordered_map<int, CachedMember>::iterator oldest = m_cache.find(m_cacheOrder.back());
+        m_nCacheBytes -= oldest->second.data->size();
+        m_cache.erase(oldest);
+        m_cacheOrder.pop_back();
+    }
+}
+
+std::shared_ptr<const std::vector<char> > CPK3::FindCachedMember(int i) {
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    std::unordered_map<int, CachedMember>::iterator cached = m_cache.find(i);
+    if (cached == m_cache.end()) {
+        return std::shared_ptr<const std::vector<char> >();
+    }
+    m_cacheOrder.splice(m_cacheOrder.begin(), m_cacheOrder, cached->second.order);
+    return cached->second.data;
+}
+
+void CPK3::CacheMember(int i, const std::shared_ptr<const std::vector<char> > &data) {
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    if (data->size() > m_nCacheLimit || m_cache.find(i) != m_cache.end()) {
+        return;
+    }
+    EvictMembers(m_nCacheLimit - data->size());
+    m_cacheOrder.push_front(i);
+    CachedMember &member = m_cache[i];
+    member.data = data;
+    member.order = m_cacheOrder.begin();
+    m_nCacheBytes += data->size();
 }
 
 bool CPK3::Close() {
+#if !defined (_WIN32) || defined (__CYGWIN__)
+    if (m_pMapped) {
+        munmap(const_cast<char *>(m_pMapped), m_nMappedSize);
+    }
+#endif
+    m_pMapped = NULL;
+    m_nMappedSize = 0;
     fclose(f);
     delete[] m_pDirData;
     m_nEntries = 0;
+    m_index.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+        m_cache.clear();
+        m_cacheOrder.clear();
+        m_nCacheBytes = 0;
+    }
 
     return true;
 }
@@ -411,6 +491,76 @@ int CPK3::GetFileLen(int i) const {
     }
 }
 
+//Finds member i in the mapped archive and returns its first byte, or NULL
+const char *CPK3::MappedData(int i, unsigned short *compression) const {
+    if (!m_pMapped) {
+        return NULL;
+    }
+    size_t offset = m_papDir[i]->hdrOffset;
+    if (offset + sizeof(TZipLocalHeader) > m_nMappedSize) {
+        return NULL;
+    }
+    TZipLocalHeader h;
+    memcpy(&h, m_pMapped + offset, sizeof(h));
+    h.correctByteOrder();
+    if (h.sig != TZipLocalHeader::SIGNATURE) {
+        VS_LOG(error, "PK3ERROR - BAD LOCAL HEADER SIGNATURE !!!");
+        return NULL;
+    }
+    offset += sizeof(h) + h.fnameLen + h.xtraLen;
+    //the directory has the sizes even when the local header leaves them to a data descriptor
+    if (offset + m_papDir[i]->cSize > m_nMappedSize) {
+        return NULL;
+    }
+    //a stored member is read as ucSize bytes, and only cSize of them were checked
+    if (h.compression == TZipLocalHeader::COMP_STORE && m_papDir[i]->ucSize != m_papDir[i]->cSize) {
+        VS_LOG(error, "PK3ERROR - STORED MEMBER SIZES DO NOT MATCH !!!");
+        return NULL;
+    }
+    *compression = h.compression;
+    return m_pMapped + offset;
+}
+
+static bool Inflate(const char *pcData, unsigned int cSize, void *pBuf, unsigned int ucSize) {
+    //Setup the inflate stream.
+    z_stream stream;
+    int err, err2;
+
+    stream.next_in = (Bytef *) pcData;
+    stream.avail_in = (uInt) cSize;
+    stream.next_out = (Bytef *) pBuf;
+    stream.avail_out = ucSize;
+    stream.zalloc = (alloc_func) 0;
+    stream.zfree = (free_func) 0;
+
+    //Perform inflation. wbits < 0 indicates no zlib header inside the data.
+    err = inflateInit2(&stream, -MAX_WBITS);
+    if (err == Z_OK) {
+        err = inflate(&stream, Z_FINISH);
+        if (err == Z_STREAM_END) {
+            err = Z_OK;
+        } else if (err == Z_NEED_DICT)
+            VS_LOG(error, "PK3ERROR : Needed a dictionary");
+        else if (err == Z_DATA_ERROR)
+            VS_LOG(error, "PK3ERROR : Bad data buffer");
+        else if (err == Z_STREAM_ERROR)
+            VS_LOG(error, "PK3ERROR : Bad parameter, stream error");
+        err2 = inflateEnd(&stream);
+        if (err2 == Z_STREAM_ERROR)
+            VS_LOG(error, "PK3ERROR : Bad parameter, stream error");
+    } else {
+        if (err == Z_STREAM_ERROR)
+            VS_LOG(error, "PK3ERROR : Bad parameter, stream error");
+        else if (err == Z_MEM_ERROR)
+            VS_LOG(error, "PK3ERROR : Memory error");
+    }
+    if (err != Z_OK) {
+        VS_LOG(error, "PK3ERROR : Bad decompression return code");
+        return false;
+    }
+    return true;
+}
+
 bool CPK3::ReadFile(int i, void *pBuf) {
     if (pBuf == nullptr) {
         VS_LOG(error, "PK3ERROR :  pBuf is NULL !!!");
@@ -423,6 +573,21 @@ bool CPK3::ReadFile(int i, void *pBuf) {
         return false;
     }
 
+    unsigned short compression = 0;
+    const char *mapped = MappedData(i, &compression);
+    if (mapped) {
+        if (compression == TZipLocalHeader::COMP_STORE) {
+            memcpy(pBuf, mapped, m_papDir[i]->ucSize);
+            return true;
+        } else if (compression != TZipLocalHeader::COMP_DEFLAT) {
+            VS_LOG(error,
+                    (boost::format("BAD Compression level, found=%1% - expected=%2%") % compression
+                            % TZipLocalHeader::COMP_DEFLAT));
+            return false;
+        }
+        return Inflate(mapped, m_papDir[i]->cSize, pBuf, m_papDir[i]->ucSize);
+    }
+
     //Quick'n dirty read, the whole file at once.
     //Ungood if the ZIP has huge files inside
 
@@ -439,9 +604,16 @@ bool CPK3::ReadFile(int i, void *pBuf) {
     }
     //Skip extra fields
     fseek(this->f, h.fnameLen + h.xtraLen, SEEK_CUR);
+    //pBuf holds the directory's ucSize bytes, so the directory's sizes are the ones to go by
+    const unsigned int cSize = m_papDir[i]->cSize;
+    const unsigned int ucSize = m_papDir[i]->ucSize;
     if (h.compression == TZipLocalHeader::COMP_STORE) {
+        if (cSize != ucSize) {
+            VS_LOG(error, "PK3ERROR - STORED MEMBER SIZES DO NOT MATCH !!!");
+            return false;
+        }
         //Simply read in raw stored data.
-        bogus_sizet = fread(pBuf, h.cSize, 1, this->f);
+        bogus_sizet = fread(pBuf, ucSize, 1, this->f);
         return true;
     } else if (h.compression != TZipLocalHeader::COMP_DEFLAT) {
         VS_LOG(error,
@@ -450,56 +622,15 @@ bool CPK3::ReadFile(int i, void *pBuf) {
         return false;
     }
     //Alloc compressed data buffer and read the whole stream
-    char *pcData = new char[h.cSize];
+    char *pcData = new char[cSize];
     if (!pcData) {
         VS_LOG(error, "PK3ERROR : Could not allocate memory buffer for decompression");
         return false;
     }
-    memset(pcData, 0, h.cSize);
-    bogus_sizet = fread(pcData, h.cSize, 1, this->f);
-
-    bool ret = true;
-
-    //Setup the inflate stream.
-    z_stream stream;
-    int err, err2;
+    memset(pcData, 0, cSize);
+    bogus_sizet = fread(pcData, cSize, 1, this->f);
 
-    stream.next_in = (Bytef *) pcData;
-    stream.avail_in = (uInt) h.cSize;
-    stream.next_out = (Bytef *) pBuf;
-    stream.avail_out = h.ucSize;
-    stream.zalloc = (alloc_func) 0;
-    stream.zfree = (free_func) 0;
-
-    //Perform inflation. wbits < 0 indicates no zlib header inside the data.
-    err = inflateInit2(&stream, -MAX_WBITS);
-    if (err == Z_OK) {
-        err = inflate(&stream, Z_FINISH);
-        if (err == Z_STREAM_END) {
-            err = Z_OK;
-        } else if (err == Z_NEED_DICT)
-            VS_LOG(error, "PK3ERROR : Needed a dictionary");
-        else if (err == Z_DATA_ERROR)
-            VS_LOG(error, "PK3ERROR : Bad data buffer");
-        else if (err == Z_STREAM_ERROR)
-            VS_LOG(error, "PK3ERROR : Bad parameter, stream error");
-        err2 = inflateEnd(&stream);
-        if (err2 == Z_STREAM_ERROR)
-            VS_LOG(error, "PK3ERROR : Bad parameter, stream error");
-        err2 = inflateEnd(&stream);
-        if (err2 == Z_STREAM_ERROR)
-            VS_LOG(error, "PK3ERROR : Bad parameter, stream error");
-    } else {
-        if (err == Z_STREAM_ERROR)
-            VS_LOG(error, "PK3ERROR : Bad parameter, stream error");
-        else if (err == Z_MEM_ERROR)
-            VS_LOG(error, "PK3ERROR : Memory error");
-    }
-    if (err != Z_OK) {
-        VS_LOG(error, "PK3ERROR : Bad decompression return code");
-        ret = false;
-    }
+    bool ret = Inflate(pcData, cSize, pBuf, ucSize);
     delete[] pcData;
     return ret;
 }
-
@@ -41,10 +41,29 @@
 #include <stdio.h>
 #include <string.h>
 #include <zlib.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #define PK3LENGTH 512
 
 class CPK3 {
+public:
+    //The bytes of one member. A stored member points straight into the mapped
+    //archive and stays valid until Close(); an inflated one is kept alive by
+    //the view (and by the member cache, while it is in there).
+    struct FileView {
+        const char *data;
+        int size;
+        std::shared_ptr<const std::vector<char> > inflated;
+
+        FileView() : data(NULL), size(-1) {
+        }
+    };
+
 private:
     struct TZipDirHeader;
     struct TZipDirFileHeader;
@@ -57,12 +76,34 @@ private:
 
 //Pointers to the dir entries in pDirData.
     const TZipDirFileHeader **m_papDir;
+//Entry index by name, with '\\' as the only separator.
+    std::unordered_map<std::string, int> m_index;
+//The whole archive mapped read only, or NULL when it could not be mapped.
+    const char *m_pMapped;
+    size_t m_nMappedSize;
+
+//Recently inflated members, most recently used first, up to m_nCacheLimit bytes.
+    struct CachedMember {
+        std::shared_ptr<const std::vector<char> > data;
+        std::list<int>::iterator order;
+    };
+    std::unordered_map<int, CachedMember> m_cache;
+    std::list<int> m_cacheOrder;
+    size_t m_nCacheBytes;
+    size_t m_nCacheLimit;
+    std::mutex m_cacheMutex;
+
     void GetFilename(int i, char *pszDest) const;
     int GetFileLen(int i) const;
     bool ReadFile(int i, void *pBuf);
+    const char *MappedData(int i, unsigned short *compression) const;
+    void MapArchive();
+    std::shared_ptr<const std::vector<char> > FindCachedMember(int i);
+    void CacheMember(int i, const std::shared_ptr<const std::vector<char> > &data);
+    void EvictMembers(size_t bytes);
 
 public:
-    CPK3() : m_nEntries(0) {
+    CPK3() : m_nEntries(0), m_pMapped(NULL), m_nMappedSize(0), m_nCacheBytes(0), m_nCacheLimit(0) {
     }
 
     CPK3(FILE *n_f);
@@ -75,13 +116,14 @@ public:
     bool Open(const char *filename);
     bool ExtractFile(const char *lp_name);
     bool ExtractFile(const char *lp_name, const char *new_filename);
-    char *ExtractFile(int index, int *file_size);
+    char *ExtractFile(int index, int *file_size);                             //NUL terminated copy, free with delete[]; leaves the cache alone
     char *ExtractFile(const char *lpname, int *file_size);
+    FileView ViewFile(int index);                                             //size is -1 when the member can't be read
     int FileExists(const char *lpname);                                       //Checks if a file exists and returns index or -1 if not found
+    void SetInflatedCacheSize(size_t bytes);                                  //0, the default, keeps no inflated members
     bool Close(void);
 
     void PrintFileContent();
 };
 
 #endif
-
@@ -0,0 +1,283 @@
+/*
+ * pk3_tests.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <zlib.h>
+
+#include "pk3.h"
+
+// Writes a zip archive member by member, the way zip tools lay one out
+class ZipWriter {
+public:
+    // a wrong_size replaces the uncompressed size in both headers, to make broken archives
+    void Add(const std::string &name, const std::string &content, bool deflate, unsigned int wrong_size = 0) {
+        std::string data = content;
+        if (deflate) {
+            data = Deflate(content);
+        }
+        const unsigned int crc = crc32(0L, reinterpret_cast<const Bytef *>(content.data()), content.size());
+        const unsigned int offset = archive.size();
+        const unsigned short compression = deflate ? 8 : 0;
+        const unsigned int size = wrong_size ? wrong_size : content.size();
+
+        U32(archive, 0x04034b50);
+        U16(archive, 20);
+        U16(archive, 0);
+        U16(archive, compression);
+        U16(archive, 0);
+        U16(archive, 0);
+        U32(archive, crc);
+        U32(archive, data.size());
+        U32(archive, size);
+        U16(archive, name.size());
+        U16(archive, 0);
+        archive += name;
+        archive += data;
+
+        U32(directory, 0x02014b50);
+        U16(directory, 20);
+        U16(directory, 20);
+        U16(directory, 0);
+        U16(directory, compression);
+        U16(directory, 0);
+        U16(directory, 0);
+        U32(directory, crc);
+        U32(directory, data.size());
+        U32(directory, size);
+        U16(directory, name.size());
+        U16(directory, 0);
+        U16(directory, 0);
+        U16(directory, 0);
+        U16(directory, 0);
+        U32(directory, 0);
+        U32(directory, offset);
+        directory += name;
+        ++entries;
+    }
+
+    void Write(const std::string &path) {
+        std::string end;
+        U32(end, 0x06054b50);
+        U16(end, 0);
+        U16(end, 0);
+        U16(end, entries);
+        U16(end, entries);
+        U32(end, directory.size());
+        U32(end, archive.size());
+        U16(end, 0);
+        FILE *file = fopen(path.c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        const std::string whole = archive + directory + end;
+        fwrite(whole.data(), 1, whole.size(), file);
+        fclose(file);
+    }
+
+private:
+    std::string archive;
+    std::string directory;
+    unsigned short entries = 0;
+
+    static void U16(std::string &out, unsigned int value) {
+        out += static_cast<char>(value & 0xff);
+        out += static_cast<char>((value >> 8) & 0xff);
+    }
+
+    static void U32(std::string &out, unsigned int value) {
+        U16(out, value & 0xffff);
+        U16(out, value >> 16);
+    }
+
+    // raw deflate, no zlib header, as zip members are
+    static std::string Deflate(const std::string &content) {
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+        std::vector<char> out(deflateBound(&stream, content.size()));
+        stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(content.data()));
+        stream.avail_in = content.size();
+        stream.next_out = reinterpret_cast<Bytef *>(out.data());
+        stream.avail_out = out.size();
+        deflate(&stream, Z_FINISH);
+        deflateEnd(&stream);
+        return std::string(out.data(), stream.total_out);
+    }
+};
+
+class PK3Test : public ::testing::Test {
+protected:
+    boost::filesystem::path path;
+    CPK3 archive;
+
+    void SetUp() override {
+        path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("vs-pk3-%%%%-%%%%.pk3");
+    }
+
+    void TearDown() override {
+        boost::system::error_code error;
+        boost::filesystem::remove(path, error);
+    }
+
+    void Open(ZipWriter &zip) {
+        zip.Write(path.string());
+        ASSERT_TRUE(archive.Open(path.string().c_str()));
+    }
+
+    static std::string Repeated(const std::string &line, int count) {
+        std::string text;
+        for (int i = 0; i < count; ++i) {
+            text += line;
+        }
+        return text;
+    }
+
+    std::string View(int index) {
+        CPK3::FileView view = archive.ViewFile(index);
+        EXPECT_GE(view.size, 0);
+        return view.size < 0 ? std::string() : std::string(view.data, view.size);
+    }
+};
+
+TEST_F(PK3Test, FindsMembersByEitherSeparatorAndExactNameOnly) {
+    ZipWriter zip;
+    zip.Add("textures/Stars.png", "stars", false);
+    zip.Add("units/llama/llama.csv", "llama", false);
+    zip.Add("textures/Stars.png", "shadowed", false);
+    Open(zip);
+
+    EXPECT_EQ(archive.FileExists("textures/Stars.png"), 0);
+    EXPECT_EQ(archive.FileExists("textures\\Stars.png"), 0);
+    EXPECT_EQ(archive.FileExists("units\\llama/llama.csv"), 1);
+    // the first of two members with one name wins
+    EXPECT_EQ(View(archive.FileExists("textures/Stars.png")), "stars");
+
+    EXPECT_EQ(archive.FileExists("textures/stars.png"), -1);
+    EXPECT_EQ(archive.FileExists("textures/Stars.png/"), -1);
+    EXPECT_EQ(archive.FileExists("textures"), -1);
+    EXPECT_EQ(archive.FileExists("Stars.png"), -1);
+    EXPECT_EQ(archive.FileExists("/textures/Stars.png"), -1);
+    archive.Close();
+}
+
+TEST_F(PK3Test, ViewsStoredAndDeflatedMembers) {
+    const std::string text = Repeated("Vega Strike units are described by units.json\n", 200);
+    ZipWriter zip;
+    zip.Add("stored.txt", text, false);
+    zip.Add("deflated.txt", text, true);
+    zip.Add("empty.txt", "", false);
+    Open(zip);
+
+    CPK3::FileView stored = archive.ViewFile(0);
+    ASSERT_EQ(stored.size, static_cast<int>(text.size()));
+    // a stored member is read from the mapping, with nothing inflated
+    EXPECT_FALSE(stored.inflated);
+    EXPECT_EQ(std::string(stored.data, stored.size), text);
+
+    CPK3::FileView deflated = archive.ViewFile(1);
+    ASSERT_EQ(deflated.size, static_cast<int>(text.size()));
+    EXPECT_TRUE(deflated.inflated);
+    EXPECT_EQ(std::string(deflated.data, deflated.size), text);
+
+    EXPECT_EQ(archive.ViewFile(2).size, 0);
+    EXPECT_EQ(archive.ViewFile(3).size, -1);
+    EXPECT_EQ(archive.ViewFile(-1).size, -1);
+
+    int size = -1;
+    char *copy = archive.ExtractFile("deflated.txt", &size);
+    ASSERT_NE(copy, nullptr);
+    EXPECT_EQ(size, static_cast<int>(text.size()));
+    EXPECT_EQ(std::string(copy, size), text);
+    EXPECT_EQ(copy[size], '\0');
+    delete[] copy;
+    archive.Close();
+}
+
+TEST_F(PK3Test, RefusesStoredMembersLongerThanTheirData) {
+    ZipWriter zip;
+    zip.Add("short.txt", "only a few bytes", false, 1 << 20);
+    zip.Add("fine.txt", "fine", false);
+    Open(zip);
+
+    EXPECT_EQ(archive.ViewFile(0).size, -1);
+    EXPECT_EQ(View(1), "fine");
+    archive.Close();
+}
+
+TEST_F(PK3Test, KeepsTheMostRecentlyUsedInflatedMembers) {
+    ZipWriter zip;
+    zip.Add("a.txt", Repeated("a", 1000), true);
+    zip.Add("b.txt", Repeated("b", 1000), true);
+    zip.Add("c.txt", Repeated("c", 1000), true);
+    Open(zip);
+
+    // nothing is kept by default
+    EXPECT_NE(archive.ViewFile(0).inflated, archive.ViewFile(0).inflated);
+
+    archive.SetInflatedCacheSize(2000);
+    std::shared_ptr<const std::vector<char> > a = archive.ViewFile(0).inflated;
+    std::shared_ptr<const std::vector<char> > b = archive.ViewFile(1).inflated;
+    EXPECT_EQ(archive.ViewFile(0).inflated, a);
+    // a was used last, so c pushes b out
+    archive.ViewFile(2);
+    EXPECT_EQ(archive.ViewFile(0).inflated, a);
+    EXPECT_NE(archive.ViewFile(1).inflated, b);
+
+    // members bigger than the whole cache are never kept
+    archive.SetInflatedCacheSize(500);
+    std::shared_ptr<const std::vector<char> > again = archive.ViewFile(0).inflated;
+    EXPECT_NE(archive.ViewFile(0).inflated, again);
+    EXPECT_EQ(std::string(again->begin(), again->end()), Repeated("a", 1000));
+    archive.Close();
+}
+
+TEST_F(PK3Test, ExtractingLeavesTheCacheAlone) {
+    ZipWriter zip;
+    zip.Add("a.txt", Repeated("a", 1000), true);
+    zip.Add("b.txt", Repeated("b", 1000), true);
+    Open(zip);
+    archive.SetInflatedCacheSize(1000);
+
+    std::shared_ptr<const std::vector<char> > a = archive.ViewFile(0).inflated;
+    int size = -1;
+    char *copy = archive.ExtractFile(1, &size);
+    ASSERT_NE(copy, nullptr);
+    EXPECT_EQ(std::string(copy, size), Repeated("b", 1000));
+    delete[] copy;
+    // b went straight into the copy, so a is still the member kept
+    EXPECT_EQ(archive.ViewFile(0).inflated, a);
+
+    // and a copy of a cached member comes from the cache
+    copy = archive.ExtractFile(0, &size);
+    EXPECT_EQ(std::string(copy, size), Repeated("a", 1000));
+    EXPECT_EQ(copy[size], '\0');
+    delete[] copy;
+    archive.Close();
+}
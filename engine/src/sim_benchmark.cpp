@@ -0,0 +1,231 @@
+/*
+ * sim_benchmark.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "sim_benchmark.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "cmd/ai/targeting_service.h"
+#include "cmd/unit_csv_factory.h"
+#include "cmd/unit_generic.h"
+#include "faction_generic.h"
+#include "lin_time.h"
+#include "star_system.h"
+#include "universe.h"
+#include "universe_util.h"
+#include "vegastrike.h"
+#include "version.h"
+#include "vs_logging.h"
+#include "vs_random.h"
+
+static const char *const phase_names[] = {
+        "update_units_physics",
+        "bolt_physics",
+        "collide_all",
+        "update_missiles",
+        "collide_table_update",
+};
+
+SimulationBenchmark &SimulationBenchmark::Instance() {
+    static SimulationBenchmark instance;
+    return instance;
+}
+
+std::vector<std::string> SimulationBenchmark::ShipTypes() {
+    std::vector<std::string> types;
+    for (const std::string &key : UnitCSVFactory::GetUnitKeys()) {
+        // Llama.civvie and the like are loadouts, Llama__confed the ship as one faction has it
+        if (key.find('.') == std::string::npos && key.find("__") == std::string::npos
+                && UnitCSVFactory::GetVariable(key, "Object_Type", std::string()) == "Vessel") {
+            types.push_back(key);
+        }
+    }
+    return types;
+}
+
+/* The first faction with an enemy, and that enemy */
+static void HostileFactions(int &faction, int &enemy) {
+    for (unsigned int mine = 0; mine < FactionUtil::GetNumFactions(); ++mine) {
+        for (unsigned int other = 0; other < FactionUtil::GetNumFactions(); ++other) {
+            if (other != mine && FactionUtil::GetIntRelation(mine, other) < 0) {
+                faction = mine;
+                enemy = other;
+                return;
+            }
+        }
+    }
+    faction = enemy = 0;
+}
+
+void SimulationBenchmark::SpawnShips(StarSystem *system,
+        const std::vector<std::string> &ship_types,
+        const QVector &center) {
+    if (ships == 0 || ship_types.empty()) {
+        return;
+    }
+    int faction, enemy;
+    HostileFactions(faction, enemy);
+    _Universe->pushActiveStarSystem(system);
+    for (unsigned int n = 0; n < ships; ++n) {
+        Unit *ship = new Unit(ship_types[n % ship_types.size()].c_str(), false, n % 2 == 0 ? faction : enemy);
+        system->AddUnit(ship);
+        // the spread createObjects gives ships placed without a position
+        const QVector position = center + QVector(vsrandom.uniformInc(-5000, 5000),
+                vsrandom.uniformInc(-5000, 5000),
+                vsrandom.uniformInc(-5000, 5000));
+        ship->SetPosAndCumPos(UniverseUtil::SafeEntrancePoint(position, ship->rSize()));
+        ship->LoadAIScript("default");
+        ship->SetTurretAI();
+    }
+    _Universe->popActiveStarSystem();
+    VS_LOG(info, (boost::format("Benchmark: launched %1% ships of %2% types, %3% against %4%") % ships
+            % std::min<size_t>(ships, ship_types.size()) % FactionUtil::GetFactionName(faction)
+            % FactionUtil::GetFactionName(enemy)));
+}
+
+void SimulationBenchmark::Start() {
+    setFixedTimeStep(SIMULATION_ATOM);
+    TargetingService::SetFixedBudget(searches_per_frame);
+    for (size_t i = 0; i < static_cast<size_t>(SimulationPhase::NUM_PHASES); ++i) {
+        phases[i] = PhaseTotals();
+    }
+    atoms_run = 0;
+    frames = 0;
+    physics_requests = FrameCounter();
+    physics_reschedules = FrameCounter();
+    started = std::chrono::steady_clock::now();
+    timing = true;
+}
+
+void SimulationBenchmark::AddTime(SimulationPhase phase, double seconds) {
+    PhaseTotals &totals = phases[static_cast<size_t>(phase)];
+    ++totals.calls;
+    totals.total += seconds;
+    if (seconds > totals.max) {
+        totals.max = seconds;
+    }
+}
+
+void SimulationBenchmark::CountSimAtom() {
+    if (timing) {
+        ++atoms_run;
+    }
+}
+
+void SimulationBenchmark::CountPhysicsRequests(unsigned int requests, unsigned int reschedules) {
+    if (timing) {
+        ++frames;
+        physics_requests.Add(requests);
+        physics_reschedules.Add(reschedules);
+    }
+}
+
+static std::string JsonString(const std::string &text) {
+    std::string quoted("\"");
+    for (std::string::const_iterator c = text.begin(); c != text.end(); ++c) {
+        if (*c == '"' || *c == '\\') {
+            quoted += '\\';
+            quoted += *c;
+        } else if (static_cast<unsigned char>(*c) < 0x20) {
+            quoted += (boost::format("\\u%04x") % static_cast<int>(*c)).str();
+        } else {
+            quoted += *c;
+        }
+    }
+    return quoted + "\"";
+}
+
+void SimulationBenchmark::WriteReport(std::ostream &out, StarSystem *system) const {
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    out << std::fixed << std::setprecision(4);
+    out << "{\n";
+    out << "  \"engine_version\": " << JsonString(VEGASTRIKE_VERSION_STR) << ",\n";
+    out << "  \"system\": " << JsonString(system ? system->getFileName() : std::string()) << ",\n";
+    out << "  \"seed\": " << seed << ",\n";
+    out << "  \"extra_ships\": " << ships << ",\n";
+    out << "  \"searches_per_frame\": " << searches_per_frame << ",\n";
+    out << "  \"units\": " << (system ? system->getUnitList().size() : 0) << ",\n";
+    out << "  \"sim_atoms\": " << atoms_run << ",\n";
+    out << "  \"sim_atom_seconds\": " << SIMULATION_ATOM << ",\n";
+    out << "  \"wall_seconds\": " << wall << ",\n";
+    out << "  \"frames\": " << frames << ",\n";
+    // no player, so no cockpit for the director to run against
+    out << "  \"not_measured\": [\"execute_director\"],\n";
+    const FrameCounter *counters[] = {&physics_requests, &physics_reschedules};
+    const char *counter_names[] = {"physics_requests", "physics_reschedules"};
+    for (size_t i = 0; i < 2; ++i) {
+        out << "  " << JsonString(counter_names[i]) << ": {"
+                << "\"total\": " << counters[i]->total
+                << ", \"mean_per_frame\": " << (frames ? static_cast<double>(counters[i]->total) / frames : 0.0)
+                << ", \"max_per_frame\": " << counters[i]->max
+                << "},\n";
+    }
+    out << "  \"phases\": {\n";
+    for (size_t i = 0; i < static_cast<size_t>(SimulationPhase::NUM_PHASES); ++i) {
+        const PhaseTotals &totals = phases[i];
+        out << "    " << JsonString(phase_names[i]) << ": {"
+                << "\"calls\": " << totals.calls
+                << ", \"total_ms\": " << totals.total * 1000.0
+                << ", \"mean_ms\": " << (totals.calls ? totals.total * 1000.0 / totals.calls : 0.0)
+                << ", \"max_ms\": " << totals.max * 1000.0
+                << "}" << (i + 1 < static_cast<size_t>(SimulationPhase::NUM_PHASES) ? ",\n" : "\n");
+    }
+    out << "  }\n";
+    out << "}\n";
+}
+
+void SimulationBenchmark::WriteReport(StarSystem *system) const {
+    if (report_path.empty()) {
+        WriteReport(std::cout, system);
+        std::cout.flush();
+        return;
+    }
+    std::ofstream out(report_path.c_str());
+    if (!out) {
+        VS_LOG(error, (boost::format("Benchmark: cannot write report to %1%") % report_path));
+        WriteReport(std::cout, system);
+        return;
+    }
+    WriteReport(out, system);
+    VS_LOG(info, (boost::format("Benchmark: report written to %1%") % report_path));
+}
+
+SimulationBenchmark::Timer::Timer(SimulationPhase phase) :
+        phase(phase),
+        active(SimulationBenchmark::Instance().IsTiming()) {
+    if (active) {
+        start = std::chrono::steady_clock::now();
+    }
+}
+
+SimulationBenchmark::Timer::~Timer() {
+    if (active) {
+        SimulationBenchmark::Instance().AddTime(phase,
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+}
@@ -0,0 +1,149 @@
+/*
+ * sim_benchmark.h
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SIM_BENCHMARK_H
+#define SIM_BENCHMARK_H
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "gfx/vec.h"
+
+class StarSystem;
+
+/*
+ * The parts of StarSystem::Update that the benchmark times. ExecuteDirector
+ * is not among them: it needs a player's cockpit, and the benchmark has no
+ * player, so it never runs there.
+ */
+enum class SimulationPhase {
+    UPDATE_UNITS_PHYSICS,   // includes BOLT_PHYSICS and COLLIDE_ALL
+    BOLT_PHYSICS,
+    COLLIDE_ALL,
+    UPDATE_MISSILES,
+    COLLIDE_TABLE_UPDATE,
+    NUM_PHASES
+};
+
+/*
+ * Reproducible simulation benchmark, run by vegastrike-sim-benchmark:
+ *
+ *   --system <sector/system>    the star system to simulate (default Sol/Sol)
+ *   --atoms <M>                 stop after M simulation atoms
+ *   --ships <N>                 add N AI ships, taken in turn from the vessels of units.json
+ *   --seed <S>                  seed for rand() and vsrandom (default 171070)
+ *   --searches-per-frame <K>    target searches each system runs a frame (default 32)
+ *   --report <file>             write the JSON report there instead of stdout
+ *
+ * The report leaves out ExecuteDirector, which the benchmark does not run,
+ * and says so under "not_measured".
+ *
+ * Both random generators are seeded with the fixed seed, every frame
+ * advances the game clock by exactly one simulation atom and the target
+ * searches get a fixed number a frame rather than a slice of wall-clock
+ * time, so two runs of the same build simulate the same thing however fast
+ * the machine is.
+ */
+class SimulationBenchmark {
+public:
+    static SimulationBenchmark &Instance();
+
+    std::string star_system = "Sol/Sol";
+    uint64_t atoms = 1000;
+    unsigned int ships = 0;
+    unsigned int seed = 171070;
+    unsigned int searches_per_frame = 32;
+    std::string report_path;
+
+    /* The vessels of units.json, in the order they were read, without their faction and loadout variants */
+    static std::vector<std::string> ShipTypes();
+
+    /* Adds the extra ships around center, their types taken in turn; every other one goes to a hostile faction */
+    void SpawnShips(StarSystem *system, const std::vector<std::string> &ship_types, const QVector &center);
+
+    /* Fixes the frame time and the target search budget, and starts the clocks */
+    void Start();
+
+    bool IsTiming() const {
+        return timing;
+    }
+
+    void AddTime(SimulationPhase phase, double seconds);
+    void CountSimAtom();
+    /* Adds one frame's worth of StarSystem::RequestPhysics calls, and how many of them moved a unit */
+    void CountPhysicsRequests(unsigned int requests, unsigned int reschedules);
+
+    bool IsFinished() const {
+        return timing && atoms > 0 && atoms_run >= atoms;
+    }
+
+    void WriteReport(std::ostream &out, StarSystem *system) const;
+    /* Writes the report to report_path, or to stdout when no path was given */
+    void WriteReport(StarSystem *system) const;
+
+    /* Adds the time from construction to destruction to the phase, when timing */
+    class Timer {
+    public:
+        explicit Timer(SimulationPhase phase);
+        ~Timer();
+
+    private:
+        SimulationPhase phase;
+        bool active;
+        std::chrono::steady_clock::time_point start;
+    };
+
+private:
+    struct PhaseTotals {
+        uint64_t calls = 0;
+        double total = 0.0;
+        double max = 0.0;
+    };
+
+    struct FrameCounter {
+        uint64_t total = 0;
+        unsigned int max = 0;
+
+        void Add(unsigned int count) {
+            total += count;
+            if (count > max) {
+                max = count;
+            }
+        }
+    };
+
+    bool timing = false;
+    uint64_t atoms_run = 0;
+    std::chrono::steady_clock::time_point started;
+    PhaseTotals phases[static_cast<size_t>(SimulationPhase::NUM_PHASES)];
+    uint64_t frames = 0;
+    FrameCounter physics_requests;
+    FrameCounter physics_reschedules;
+};
+
+#endif // SIM_BENCHMARK_H
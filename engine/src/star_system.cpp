@@ -24,6 +24,7 @@
 
 
 #include <assert.h>
+#include <functional>
 #include "star_system.h"
 
 #include "damageable.h"
@@ -46,6 +47,9 @@
 #include "savegame.h"
 #include "in_kb_data.h"
 #include "universe_util.h" //get galaxy faction, dude
+#include "configuration/configuration.h"
+#include "worker_pool.h"
+#include "sim_benchmark.h"
 
 #include "cmd/planet.h"
 #include "cmd/unit_collide.h"
@@ -66,6 +70,7 @@
 #include "cmd/nebula.h"
 #include "cmd/unit_util.h"
 #include "cmd/missile.h"
+#include "cmd/ai/targeting_service.h"
 
 #include "gfx/boltdrawmanager.h"
 #include "gfx/sphere.h"
@@ -93,9 +98,13 @@ double calc_blend_factor(double frac,
         unsigned int when_it_will_be_simulated,
         unsigned int cur_simulation_frame);
 
-StarSystem::StarSystem(const string filename, const Vector &centr, const float timeofyear) {
+StarSystem::StarSystem(const string filename, const Vector &centr, const float timeofyear) :
+        unit_index(configuration()->physics_config.unit_spatial_index_cell_size) {
     collide_map[Unit::UNIT_ONLY] = new CollideMap(Unit::UNIT_ONLY);
     collide_map[Unit::UNIT_BOLT] = new CollideMap(Unit::UNIT_BOLT);
+    for (unsigned int i = 0; i <= SIM_QUEUE_SIZE; ++i) {
+        physics_buffer[i].trackUnits();
+    }
 
     // no_collision_time = (int)(1+2.000/SIMULATION_ATOM);
 
@@ -171,6 +180,7 @@ StarSystem::~StarSystem() {
         _Universe->activeStarSystem()->SwapIn();
     }
     RemoveStarsystemFromUniverse();
+    Bolt::DestroyAll(this);
     delete collide_map[Unit::UNIT_ONLY];
     delete collide_map[Unit::UNIT_BOLT];
 
@@ -640,6 +650,7 @@ void StarSystem::AddUnit(Unit *unit) {
     //and relative to this function, when the bucket is processed...
     unsigned int tmp = 1 + ((unsigned int) vsrandom.genrand_int32()) % priority;
     this->physics_buffer[(this->current_sim_location + tmp) % SIM_QUEUE_SIZE].prepend(unit);
+    unit_index.Insert(unit);
     stats.AddUnit(unit);
 }
 
@@ -650,13 +661,13 @@ bool StarSystem::RemoveUnit(Unit *un) {
             set_null(un->location[locind]);
         }
     }
+    unit_index.Remove(un);
 
     if (draw_list.remove(un)) {
         // regardless of being drawn, it should be in physics list
-        for (unsigned int i = 0; i <= SIM_QUEUE_SIZE; ++i) {
-            if (physics_buffer[i].remove(un)) {
-                i = SIM_QUEUE_SIZE + 1;
-            }
+        UnitCollection *queue = PhysicsQueueOf(un);
+        if (queue) {
+            queue->removeTracked(un);
         }
         stats.RemoveUnit(un);
         return (true);
@@ -716,152 +727,190 @@ void CarSimUpdate(Unit *un, float height) {
 
 Statistics::Statistics() {
     system_faction = FactionUtil::GetNeutralFaction();
-    newfriendlycount = 0;
-    newenemycount = 0;
-    newcitizencount = 0;
-    newneutralcount = 0;
     friendlycount = 0;
     enemycount = 0;
     neutralcount = 0;
     citizencount = 0;
-    checkIter = 0;
     navCheckIter = 0;
+    for (int &count : standing_counts) {
+        count = 0;
+    }
+    relations_generation = FactionUtil::GetRelationsGeneration();
 }
 
-void Statistics::CheckVitals(StarSystem *ss) {
-    int faction = FactionUtil::GetFactionIndex(UniverseUtil::GetGalaxyFaction(ss->getFileName()));
-    if (faction != system_faction) {
-        *this = Statistics();                    //invoke copy constructor to clear it
-        this->system_faction = faction;
-        for (un_iter ui = ss->getUnitList().createIterator(); !ui.isDone(); ++ui) {
-            this->AddUnit(*ui);                 //siege will take some time
-        }
-        return;                                          //no need to check vitals now, they're all set
+Statistics::Standing Statistics::StandingOf(int faction, float relation) {
+    if (FactionUtil::isCitizenInt(faction)) {
+        return CITIZEN;
+    }
+    if (relation > 0.05) {
+        return FRIENDLY;
+    } else if (relation < 0.) {
+        return ENEMY;
     }
-    size_t iter = navCheckIter;
+    return NEUTRAL;
+}
+
+//which nav list a significant unit goes in, given how the system faction sees it
+static int NavListOf(const Unit *un, float relation) {
     int k = 0;
-    if (iter >= navs[0].size()) {
-        iter -= navs[0].size();
+    if (relation > 0) {
         k = 1;
-    }
-    if (iter >= navs[1].size()) {
-        iter -= navs[1].size();
+    }                      //base
+    if (un->isPlanet() && !un->isJumppoint()) {
+        k = 1;
+    }                                       //friendly planet
+    //asteroid field/debris field
+    if (UnitUtil::isAsteroid(un)) {
         k = 2;
     }
-    size_t totalnavchecking = 25;
-    size_t totalsyschecking = 25;
-    while (iter < totalnavchecking && iter < navs[k].size()) {
-        if (navs[k][iter].GetUnit() == nullptr) {
-            navs[k].erase(navs[k].begin() + iter);
-            break;
-        } else {
-            ++iter;
-            ++navCheckIter;
-        }
+    return k;
+}
+
+void Statistics::Reclassify() {
+    size_t num_factions = FactionUtil::GetNumFactions();
+    faction_units.resize(num_factions, 0);
+    faction_standing.resize(num_factions);
+    for (int &count : standing_counts) {
+        count = 0;
     }
-    if (k == 2 && iter >= navs[k].size()) {
-        navCheckIter = 0;
-    }                        //start over next time
-    size_t sortedsize = ss->collide_map[Unit::UNIT_ONLY]->sorted.size();
-    int sysfac = system_faction;
-    size_t counter = checkIter + totalsyschecking;
-    for (; checkIter < counter && checkIter < sortedsize; ++checkIter) {
-        Collidable *collide = &ss->collide_map[Unit::UNIT_ONLY]->sorted[checkIter];
-        if (collide->radius > 0) {
-            Unit *un = collide->ref.unit;
-            float rel = UnitUtil::getRelationFromFaction(un, sysfac);
-            if (FactionUtil::isCitizenInt(un->faction)) {
-                ++newcitizencount;
-            } else {
-                if (rel > 0.05) {
-                    ++newfriendlycount;
-                } else if (rel < 0.) {
-                    ++newenemycount;
-                } else {
-                    ++newneutralcount;
+    for (size_t i = 0; i < num_factions; ++i) {
+        faction_standing[i] = StandingOf(i, FactionUtil::GetIntRelation(system_faction, i));
+        standing_counts[faction_standing[i]] += faction_units[i];
+    }
+    relations_generation = FactionUtil::GetRelationsGeneration();
+}
+
+void Statistics::CountFaction(int faction, int delta) {
+    if (faction_standing.size() != FactionUtil::GetNumFactions()
+            || relations_generation != FactionUtil::GetRelationsGeneration()) {
+        Reclassify();
+    }
+    if (faction < 0 || static_cast<size_t>(faction) >= faction_units.size()) {
+        return;
+    }
+    faction_units[faction] += delta;
+    standing_counts[faction_standing[faction]] += delta;
+}
+
+void Statistics::AddNav(Unit *un) {
+    roster.AddNav(un, NavListOf(un, UnitUtil::getRelationFromFaction(un, system_faction)), UnitContainer(un));
+}
+
+void Statistics::Forget(const Unit *un) {
+    int faction = -1;
+    if (roster.Remove(un, faction)) {
+        //the unit may have changed since it came in, so go by what was recorded then
+        CountFaction(faction, -1);
+        UpdateCounts();
+    }
+}
+
+void Statistics::UpdateCounts() {
+    int counts[NUM_STANDINGS];
+    for (int i = 0; i < NUM_STANDINGS; ++i) {
+        counts[i] = standing_counts[i];
+    }
+    //players carry their own modifier on top of the faction relation
+    unsigned int numplayers = _Universe->numPlayers();
+    for (unsigned int i = 0; i < numplayers; ++i) {
+        const Unit *player = _Universe->AccessCockpit(i)->GetParent();
+        if (player == nullptr || !roster.Contains(player)) {
+            continue;
+        }
+        int faction = roster.FactionOf(player);
+        if (faction < 0 || static_cast<size_t>(faction) >= faction_standing.size()) {
+            continue;
+        }
+        float rel = FactionUtil::GetIntRelation(system_faction, faction)
+                + UniverseUtil::getRelationModifierInt(i, system_faction);
+        --counts[faction_standing[faction]];
+        ++counts[StandingOf(faction, rel)];
+    }
+    neutralcount = counts[NEUTRAL];
+    friendlycount = counts[FRIENDLY];
+    enemycount = counts[ENEMY];
+    citizencount = counts[CITIZEN];
+}
+
+void Statistics::CheckVitals(StarSystem *ss) {
+    int faction = FactionUtil::GetFactionIndex(UniverseUtil::GetGalaxyFaction(ss->getFileName()));
+    if (faction != system_faction) {
+        system_faction = faction;
+        Reclassify();
+        //bases are filed by how the system faction sees them, so move the ones that changed sides
+        std::vector<Unit *> moving;
+        for (int k = 0; k < 2; ++k) {
+            for (size_t i = 0; i < roster.NavCount(k); ++i) {
+                Unit *un = roster.Nav(k, i).GetUnit();
+                if (un && NavListOf(un, UnitUtil::getRelationFromFaction(un, system_faction)) != k) {
+                    moving.push_back(un);
                 }
             }
         }
+        for (Unit *un : moving) {
+            AddNav(un);
+        }
+    } else if (faction_standing.size() != FactionUtil::GetNumFactions()
+            || relations_generation != FactionUtil::GetRelationsGeneration()) {
+        Reclassify();
     }
-    if (checkIter >= sortedsize && sortedsize
-            > (unsigned int) (enemycount + neutralcount + friendlycount
-                    + citizencount) / 4 /*suppose at least 1/4 survive a given frame*/) {
-        citizencount = newcitizencount;
-        newcitizencount = 0;
-        enemycount = newenemycount;
-        newenemycount = 0;
-        neutralcount = newneutralcount;
-        newneutralcount = 0;
-        friendlycount = newfriendlycount;
-        newfriendlycount = 0;
-        checkIter = 0;                           //start over with list
+    //drop the navs that died since the last look, a few at a time
+    size_t totalnavchecking = 25;
+    for (size_t checked = 0; checked < totalnavchecking; ++checked) {
+        size_t iter = navCheckIter;
+        int k = 0;
+        while (k < 3 && iter >= roster.NavCount(k)) {
+            iter -= roster.NavCount(k);
+            ++k;
+        }
+        if (k == 3) {
+            navCheckIter = 0;                    //start over next time
+            break;
+        }
+        if (roster.Nav(k, iter).GetUnit() == nullptr) {
+            //the slot has forgotten its unit, but the roster still knows which one it was
+            Forget(roster.NavUnit(k, iter));
+        } else {
+            ++navCheckIter;
+        }
     }
+    UpdateCounts();
 }
 
 void Statistics::AddUnit(Unit *un) {
-    float rel = UnitUtil::getRelationFromFaction(un, system_faction);
-    if (FactionUtil::isCitizenInt(un->faction)) {
-        ++citizencount;
-    } else {
-        if (rel > 0.05) {
-            ++friendlycount;
-        } else if (rel < 0.) {
-            ++enemycount;
-        } else {
-            ++neutralcount;
-        }
-    }
     if (un->GetDestinations().size()) {
         jumpPoints[un->GetDestinations()[0]].SetUnit(un);
     }
+    if (!roster.Add(un, un->faction)) {
+        return;
+    }
+    CountFaction(un->faction, 1);
     if (UnitUtil::isSignificant(un)) {
-        int k = 0;
-        if (rel > 0) {
-            k = 1;
-        }                      //base
-        if (un->isPlanet() && !un->isJumppoint()) {
-            k = 1;
-        }                                       //friendly planet
-        //asteroid field/debris field
-        if (UnitUtil::isAsteroid(un)) {
-            k = 2;
-        }
-        navs[k].push_back(UnitContainer(un));
+        AddNav(un);
     }
+    UpdateCounts();
 }
 
 void Statistics::RemoveUnit(Unit *un) {
-    float rel = UnitUtil::getRelationFromFaction(un, system_faction);
-    if (FactionUtil::isCitizenInt(un->faction)) {
-        --citizencount;
-    } else {
-        if (rel > 0.05) {
-            --friendlycount;
-        } else if (rel < 0.) {
-            --enemycount;
-        } else {
-            --neutralcount;
-        }
-    }
     if (un->GetDestinations().size()) {
-        //make sure it is there
-        jumpPoints[(un->GetDestinations()[0])].SetUnit(nullptr);
-        //kill it--stupid I know--but hardly time critical
-        jumpPoints.erase(jumpPoints.find(un->GetDestinations()[0]));
-    }
-    bool temp_erased = false;
-    if (UnitUtil::isSignificant(un)) {
-        for (int k = 0; k < 3 && !temp_erased; ++k) {
-            for (size_t i = 0; i < navs[k].size(); ++i) {
-                if (navs[k][i].GetUnit() == un) {
-                    //slow but who cares
-                    navs[k].erase(navs[k].begin() + i);
-                    temp_erased = true;
-                    break; // would we exist in this array more than once?
-                }
-            }
+        //another jump point may lead to the same place, so only forget this one
+        vsUMap<std::string, UnitContainer>::iterator jump = jumpPoints.find(un->GetDestinations()[0]);
+        if (jump != jumpPoints.end() && jump->second.GetConstUnit() == un) {
+            jump->second.SetUnit(nullptr);
+            jumpPoints.erase(jump);
         }
     }
+    Forget(un);
+}
+
+void Statistics::ChangeFaction(Unit *un) {
+    if (!roster.Contains(un) || roster.FactionOf(un) == un->faction) {
+        return;
+    }
+    CountFaction(roster.FactionOf(un), -1);
+    roster.SetFaction(un, un->faction);
+    CountFaction(un->faction, 1);
+    UpdateCounts();
 }
 
 //Variables for debugging purposes only - eliminate later
@@ -874,17 +923,25 @@ double aggfire = 0;
 int numprocessed = 0;
 double targetpick = 0;
 
-void StarSystem::RequestPhysics(Unit *un, unsigned int queue) {
-    Unit *unit = nullptr;
-    un_iter iter = this->physics_buffer[queue].createIterator();
-    while ((unit = *iter) && *iter != un) {
-        ++iter;
+UnitCollection *StarSystem::PhysicsQueueOf(Unit *un) {
+    UnitCollection *queue = un->physics_queue_slot.col;
+    //std::less, as the slot may point into another system's buffer or some other collection altogether
+    const std::less<const UnitCollection *> before;
+    if (before(queue, &physics_buffer[0]) || before(&physics_buffer[SIM_QUEUE_SIZE], queue)) {
+        return nullptr;
     }
-    if (unit == un) {
+    return queue;
+}
+
+void StarSystem::RequestPhysics(Unit *un) {
+    ++physics_requests;
+    UnitCollection *queue = PhysicsQueueOf(un);
+    if (queue) {
         un->predicted_priority = 0;
         unsigned int newloc = (current_sim_location + 1) % SIM_QUEUE_SIZE;
-        if (newloc != queue) {
-            iter.moveBefore(this->physics_buffer[newloc]);
+        if (queue != &physics_buffer[newloc]) {
+            queue->moveToFront(un, physics_buffer[newloc]);
+            ++physics_reschedules;
         }
     }
 }
@@ -899,6 +956,7 @@ void StarSystem::RequestPhysics(Unit *un, unsigned int queue) {
 //will wreak havoc with subunit interpolation. Luckily again, we only need
 //randomization on priority changes, so we're fine.
 void StarSystem::UpdateUnitsPhysics(bool firstframe) {
+    SimulationBenchmark::Timer timer(SimulationPhase::UPDATE_UNITS_PHYSICS);
     static int batchcount = SIM_QUEUE_SIZE - 1;
 //    double collidetime = 0.0;
 //    double bolttime = 0.0;
@@ -906,14 +964,27 @@ void StarSystem::UpdateUnitsPhysics(bool firstframe) {
     aggfire = 0.0;
     numprocessed = 0;
     stats.CheckVitals(this);
+    //what the motion of the units integrated on the worker pool may read, as of this frame
+    Movable::CaptureMotionSettings();
 
     for (++batchcount; batchcount > 0; --batchcount) {
         try {
             UnitCollection col = physics_buffer[current_sim_location];
             un_iter iter = physics_buffer[current_sim_location].createIterator();
             Unit *unit = nullptr;
+            // With worker threads, every unit first runs its AI and weapons here, and the motion of
+            // all of them is integrated in parallel afterwards, while col keeps them alive
+            WorkerPool *workers = WorkerPool::GetPhysicsPool();
             for (; (unit = *iter); ++iter) {
-                UpdateUnitPhysics(firstframe, unit);
+                UpdateUnitPhysics(firstframe, unit, workers != nullptr);
+            }
+            if (workers) {
+                IntegrateDeferredMotion(*workers);
+            }
+            if (batchcount == 1) {
+                //once the last batch has run its AI, the target searches the AIs of this system asked for,
+                //as many as fit in the frame's budget
+                targeting.RunFrame();
             }
         } catch (const boost::python::error_already_set &) {
             if (PyErr_Occurred()) {
@@ -926,8 +997,12 @@ void StarSystem::UpdateUnitsPhysics(bool firstframe) {
             throw;
         }
 //        double c0 = queryTime();
-        Bolt::UpdatePhysics(this);
+        {
+            SimulationBenchmark::Timer bolt_timer(SimulationPhase::BOLT_PHYSICS);
+            Bolt::UpdatePhysics(this);
+        }
 //        double cc = queryTime();
+        SimulationBenchmark::Timer collide_timer(SimulationPhase::COLLIDE_ALL);
         last_collisions.clear();
         collide_map[Unit::UNIT_BOLT]->flatten();
         if (Unit::NUM_COLLIDE_MAPS > 1) {
@@ -958,9 +1033,10 @@ void StarSystem::UpdateUnitsPhysics(bool firstframe) {
         totalprocessed += theunitcounter;
         theunitcounter = 0;
     }
+    unit_index.Refresh();
 }
 
-void StarSystem::UpdateUnitPhysics(bool firstframe, Unit *unit) {
+void StarSystem::UpdateUnitPhysics(bool firstframe, Unit *unit, bool defer_motion) {
     int priority = UnitUtil::getPhysicsPriority(unit);
     //Doing spreading here and only on priority changes, so as to make AI easier
     int predprior = unit->predicted_priority;
@@ -988,15 +1064,35 @@ void StarSystem::UpdateUnitPhysics(bool firstframe, Unit *unit) {
         unit->ExecuteAI();
         unit->ResetThreatLevel();
         //FIXME "firstframe"-- assume no more than 2 physics updates per frame.
-        unit->UpdatePhysics(identity_transformation,
-                identity_matrix,
-                Vector(0,
-                        0,
-                        0),
-                priority
-                        == 1 ? firstframe : true,
-                &this->gravitationalUnits(),
-                unit);
+        const bool lastframe = priority == 1 ? firstframe : true;
+        if (!defer_motion) {
+            unit->UpdatePhysics(identity_transformation,
+                    identity_matrix,
+                    Vector(0,
+                            0,
+                            0),
+                    lastframe,
+                    &this->gravitationalUnits(),
+                    unit);
+        } else {
+            Transformation old_physical_state = unit->PrepareMotion(identity_transformation,
+                    identity_matrix,
+                    lastframe,
+                    &this->gravitationalUnits(),
+                    unit);
+            if (unit->CanIntegrateConcurrently()) {
+                deferred_motion.push_back(DeferredMotion());
+                DeferredMotion &motion = deferred_motion.back();
+                motion.unit = unit;
+                motion.old_physical_state = old_physical_state;
+                motion.simulation_atom = simulation_atom_var;
+                motion.lastframe = lastframe;
+            } else {
+                unit->IntegrateMotion(identity_transformation, identity_matrix, Vector(0, 0, 0));
+                unit->UpdatePhysics2(identity_transformation, old_physical_state, Vector(), 1.0,
+                        identity_matrix, Vector(0, 0, 0), lastframe, &this->gravitationalUnits());
+            }
+        }
         simulation_atom_var = backup;
     } catch (...) {
         simulation_atom_var = backup;
@@ -1006,6 +1102,30 @@ void StarSystem::UpdateUnitPhysics(bool firstframe, Unit *unit) {
     unit->predicted_priority = predprior;
 }
 
+void StarSystem::IntegrateDeferredMotion(WorkerPool &workers) {
+    workers.ParallelFor(deferred_motion.size(), [this](size_t i) {
+        DeferredMotion &motion = deferred_motion[i];
+        DeferredCommands deferral(&motion.commands);
+        float backup = simulation_atom_var;
+        simulation_atom_var = motion.simulation_atom;
+        motion.unit->IntegrateMotion(identity_transformation, identity_matrix, Vector(0, 0, 0));
+        simulation_atom_var = backup;
+    });
+    //Back on the main thread: replay the side effects and finish the frame in scheduling order
+    for (size_t i = 0; i < deferred_motion.size(); ++i) {
+        DeferredMotion &motion = deferred_motion[i];
+        float backup = simulation_atom_var;
+        simulation_atom_var = motion.simulation_atom;
+        for (size_t c = 0; c < motion.commands.size(); ++c) {
+            motion.commands[c]();
+        }
+        motion.unit->UpdatePhysics2(identity_transformation, motion.old_physical_state, Vector(), 1.0,
+                identity_matrix, Vector(0, 0, 0), motion.lastframe, &this->gravitationalUnits());
+        simulation_atom_var = backup;
+    }
+    deferred_motion.clear();
+}
+
 extern void TerrainCollide();
 extern void UpdateAnimatedTexture();
 extern void UpdateCameraSnds();
@@ -1102,6 +1222,13 @@ void StarSystem::Update(float priority, bool executeDirector) {
             priority = 1;
         }
     }
+    last_frame_physics_requests = physics_requests;
+    last_frame_physics_reschedules = physics_reschedules;
+    physics_requests = physics_reschedules = 0;
+    if (this == _Universe->getActiveStarSystem(0)) {
+        SimulationBenchmark::Instance().CountPhysicsRequests(last_frame_physics_requests,
+                last_frame_physics_reschedules);
+    }
     float normal_simulation_atom = simulation_atom_var;
     //VS_LOG(trace, (boost::format("void StarSystem::Update( float priority, bool executeDirector ): Msg A: simulation_atom_var as backed up  = %1%") % simulation_atom_var));
     simulation_atom_var /= (priority / getTimeCompression());
@@ -1160,14 +1287,21 @@ void StarSystem::Update(float priority, bool executeDirector) {
                 UpdateUnitsPhysics(firstframe);
 //                double updateUnitsPhysicsDoneTime = realTime();
 //                updateUnitsPhysicsTimeSubtotal += (updateUnitsPhysicsDoneTime - processUnitStageStartTime);
-                UpdateMissiles(); //do explosions
+                {
+                    SimulationBenchmark::Timer timer(SimulationPhase::UPDATE_MISSILES);
+                    UpdateMissiles(); //do explosions
+                }
 //                double updateMissilesDoneTime = realTime();
 //                updateMissilesTimeSubtotal += (updateMissilesDoneTime - updateUnitsPhysicsDoneTime);
-                collide_table->Update();
+                {
+                    SimulationBenchmark::Timer timer(SimulationPhase::COLLIDE_TABLE_UPDATE);
+                    collide_table->Update();
+                }
 //                double collideTableUpdateDoneTime = realTime();
 //                collideTableUpdateTimeSubtotal += (collideTableUpdateDoneTime - updateMissilesDoneTime);
                 if (this == _Universe->getActiveStarSystem(0)) {
                     UpdateCameraSnds();
+                    SimulationBenchmark::Instance().CountSimAtom();
                 }
 //                bolttime = queryTime();
 //                bolttime = queryTime() - bolttime;
@@ -1460,18 +1594,16 @@ void StarSystem::UpdateMissiles() {
     static bool collideroids =
             XMLSupport::parse_bool(vs_config->getVariable("physics", "AsteroidWeaponCollision", "false"));
 
-    //WARNING: This is a big performance problem...
-    //...responsible for many hiccups.
-    //TODO: Make it use the collide_map to only iterate through potential hits...
-    //PROBLEM: The current collide_map does not allow this efficiently (no way of
-    //taking the other unit's rSize() into account).
+    //The unit index accounts for each unit's rSize(), so only units near the blast are visited
     if (!discharged_missiles.empty()) {
         if (discharged_missiles.back()->GetRadius()
                 > 0) {           //we can avoid this iterated check for kinetic projectiles even if they "discharge" on hit
-            Unit *un;
-            for (un_iter ui = getUnitList().createIterator();
-                    NULL != (un = (*ui));
-                    ++ui) {
+            std::vector<Unit *> blast_candidates;
+            unit_index.QuerySphere(discharged_missiles.back()->GetCenter(),
+                    discharged_missiles.back()->GetRadius(),
+                    blast_candidates);
+            for (std::vector<Unit *>::iterator ui = blast_candidates.begin(); ui != blast_candidates.end(); ++ui) {
+                Unit *un = *ui;
                 enum Vega_UnitType type = un->isUnit();
                 if (collideroids || type
                         != Vega_UnitType::asteroid) {           // could check for more, unless someone wants planet-killer missiles, but what it would change?
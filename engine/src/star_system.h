@@ -28,13 +28,18 @@
 
 #include "cmd/collection.h"
 #include "cmd/container.h"
+#include "cmd/unit_spatial_index.h"
+#include "cmd/ai/targeting_service.h"
 
 #include "gfx/vec.h"
+#include "gfx/quaternion.h"
 #include "gfxlib.h"
 #include "gfxlib_struct.h"
 
 #include "star_xml.h"
+#include "unit_roster.h"
 
+#include <functional>
 #include <string>
 #include <vector>
 #include <map>
@@ -59,29 +64,54 @@ class Texture;
 class Unit;
 class Universe;
 class StarSystem;
+class WorkerPool;
 
 const unsigned int SIM_QUEUE_SIZE = 128;
 bool PendingJumpsEmpty();
 
+/* Who is in the system and how they stand towards its faction.   The
+ * counts are kept up to date as units come, go and change faction; the
+ * standing of each faction is cached and only redone when the system
+ * faction or a faction relation changes.   Every unit knows its slot in the
+ * nav lists, so removing it is a swap with the last entry, see UnitRoster. */
 struct Statistics {
-    //neutral, friendly, enemy
-    std::vector<UnitContainer> navs[3];
     vsUMap<std::string, UnitContainer> jumpPoints;
     int system_faction;
-    int newfriendlycount;
-    int newenemycount;
-    int newcitizencount;
-    int newneutralcount;
     int friendlycount;
     int enemycount;
     int neutralcount;
     int citizencount;
-    size_t checkIter;
     size_t navCheckIter;
     Statistics();
     void AddUnit(Unit *un);
+    //also called for every unit that is killed, as the dead never pass through StarSystem::RemoveUnit
     void RemoveUnit(Unit *un);
+    //the unit is already in the system and its faction has just been set
+    void ChangeFaction(Unit *un);
     void CheckVitals(StarSystem *ss);
+
+    //neutral, friendly, enemy
+    std::vector<UnitContainer> *Navs() {
+        return roster.Navs();
+    }
+
+private:
+    enum Standing {
+        NEUTRAL, FRIENDLY, ENEMY, CITIZEN, NUM_STANDINGS
+    };
+    UnitRoster<UnitContainer> roster;
+    std::vector<int> faction_units;
+    std::vector<Standing> faction_standing;
+    int standing_counts[NUM_STANDINGS];
+    unsigned int relations_generation;
+
+    static Standing StandingOf(int faction, float relation);
+    void Reclassify();
+    void CountFaction(int faction, int delta);
+    void AddNav(Unit *un);
+    //drops what is recorded of the unit without looking at it, as it may be gone
+    void Forget(const Unit *un);
+    void UpdateCounts();
 };
 
 /**
@@ -119,6 +149,30 @@ protected:
     UnitCollection gravitational_units;
     UnitCollection physics_buffer[SIM_QUEUE_SIZE + 1];
     unsigned int current_sim_location = 0;
+    /// RequestPhysics calls since the start of this frame, and how many of them moved a unit
+    unsigned int physics_requests = 0;
+    unsigned int physics_reschedules = 0;
+    /// the same, for the whole of the previous frame
+    unsigned int last_frame_physics_requests = 0;
+    unsigned int last_frame_physics_reschedules = 0;
+    /// Bounding spheres of the units in draw_list, refreshed every physics frame
+    UnitSpatialIndex unit_index;
+    /// The target searches the AIs of this system asked for, run within a budget every physics frame
+    TargetingService targeting;
+
+    /// A unit whose motion is integrated on the worker pool once the whole batch has run its AI
+    struct DeferredMotion {
+        Unit *unit;
+        Transformation old_physical_state;
+        float simulation_atom;
+        bool lastframe;
+        /// side effects of the integration, replayed on the main thread
+        std::vector<std::function<void()> > commands;
+    };
+    vector<DeferredMotion> deferred_motion;
+    void IntegrateDeferredMotion(WorkerPool &workers);
+    /// The physics_buffer entry the unit is queued in, if it is in one of ours
+    UnitCollection *PhysicsQueueOf(Unit *un);
 
     ///The moving, fading stars
     Stars *stars = nullptr;
@@ -162,10 +216,11 @@ public:
     virtual void AddMissileToQueue(class MissileEffect *);
     virtual void UpdateMissiles();
     void UpdateUnitsPhysics(bool firstframe);
-    void UpdateUnitPhysics(bool firstframe, Unit *unit);
+    ///With defer_motion, the motion of the unit is left to IntegrateDeferredMotion when possible
+    void UpdateUnitPhysics(bool firstframe, Unit *unit, bool defer_motion = false);
 
     ///Requeues the unit so that it is simulated ASAP.
-    void RequestPhysics(Unit *un, unsigned int queue);
+    void RequestPhysics(Unit *un);
 
     /// update a simulation atom ExecuteDirector must be false if star system is just loaded before mission is loaded
     void Update(float priority, bool executeDirector);
@@ -177,6 +232,15 @@ public:
         return current_sim_location;
     }
 
+    ///How often RequestPhysics was called in the previous frame, and how many units it moved
+    unsigned int getPhysicsRequests() const {
+        return last_frame_physics_requests;
+    }
+
+    unsigned int getPhysicsReschedules() const {
+        return last_frame_physics_reschedules;
+    }
+
     void ExecuteUnitAI();
 
     static void beginElement(void *userData, const XML_Char *name, const XML_Char **atts);
@@ -193,6 +257,15 @@ public:
         return gravitational_units;
     }
 
+    ///Finds the units whose bounding spheres overlap the given sphere
+    const UnitSpatialIndex &getUnitIndex() const {
+        return unit_index;
+    }
+
+    TargetingService &getTargetingService() {
+        return targeting;
+    }
+
     Unit *nextSignificantUnit();
     /// returns xy sorted bounding spheres of all units in current view
     ///Adds to draw list
@@ -0,0 +1,186 @@
+/*
+ * star_system_prefetcher.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "star_system_prefetcher.h"
+
+#include <chrono>
+#include <fstream>
+
+#include <boost/property_tree/xml_parser.hpp>
+#include <boost/format.hpp>
+
+#include "vs_logging.h"
+
+StarSystemPrefetcher::StarSystemPrefetcher(size_t max_systems) : max_systems(max_systems) {
+}
+
+StarSystemPrefetcher::~StarSystemPrefetcher() {
+    while (!entries.empty()) {
+        Retire(entries.begin(), true);
+    }
+    for (Entry &entry : retired) {
+        entry.progress->cancelled = true;
+    }
+}
+
+bool StarSystemPrefetcher::Ready(const std::shared_future<std::shared_ptr<Tree>> &parsed) {
+    return parsed.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void StarSystemPrefetcher::ReadThrough(const std::vector<std::string> &paths,
+        const std::shared_ptr<Progress> &progress) {
+    std::vector<char> buffer(64 * 1024);
+    for (const std::string &path : paths) {
+        if (progress->cancelled) {
+            return;
+        }
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            continue;
+        }
+        while (file.read(buffer.data(), buffer.size()) && !progress->cancelled) {
+        }
+        ++progress->files_read;
+    }
+}
+
+void StarSystemPrefetcher::Retire(std::vector<Entry>::iterator entry, bool cancel) {
+    if (cancel) {
+        entry->progress->cancelled = true;
+    }
+    retired.push_back(std::move(*entry));
+    entries.erase(entry);
+}
+
+bool StarSystemPrefetcher::Has(const std::string &system) const {
+    for (const Entry &entry : entries) {
+        if (entry.system == system) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool StarSystemPrefetcher::Start(const std::string &system, const std::string &path) {
+    if (entries.size() >= max_systems) {
+        std::vector<Entry>::iterator done = entries.begin();
+        while (done != entries.end() && !Ready(done->parsed)) {
+            ++done;
+        }
+        if (done == entries.end()) {
+            return false;
+        }
+        Retire(done, true);
+    }
+    Entry entry;
+    entry.system = system;
+    entry.path = path;
+    entry.progress = std::make_shared<Progress>();
+    entry.parsed = std::async(std::launch::async, [path]() {
+        std::shared_ptr<Tree> tree = std::make_shared<Tree>();
+        boost::property_tree::read_xml(path, *tree);
+        return tree;
+    }).share();
+    entries.push_back(std::move(entry));
+    return true;
+}
+
+void StarSystemPrefetcher::Poll(const FileLister &list_files) {
+    for (Entry &entry : entries) {
+        if (entry.listed || !Ready(entry.parsed)) {
+            continue;
+        }
+        entry.listed = true;
+        std::vector<std::string> paths;
+        try {
+            paths = list_files(*entry.parsed.get());
+        } catch (const boost::property_tree::ptree_error &) {
+            // TakeParsed reports it
+            continue;
+        }
+        std::shared_ptr<Progress> progress = entry.progress;
+        entry.reads = std::async(std::launch::async, [paths, progress]() {
+            ReadThrough(paths, progress);
+        });
+    }
+    std::vector<Entry>::iterator entry = retired.begin();
+    while (entry != retired.end()) {
+        if (Ready(entry->parsed)
+                && (!entry->reads.valid()
+                        || entry->reads.wait_for(std::chrono::seconds(0)) == std::future_status::ready)) {
+            entry = retired.erase(entry);
+        } else {
+            ++entry;
+        }
+    }
+}
+
+void StarSystemPrefetcher::Cancel(const std::string &system) {
+    for (std::vector<Entry>::iterator entry = entries.begin(); entry != entries.end(); ++entry) {
+        if (entry->system == system) {
+            VS_LOG(info, (boost::format("No longer preloading star system %1%") % system));
+            Retire(entry, true);
+            return;
+        }
+    }
+}
+
+std::vector<std::string> StarSystemPrefetcher::Systems() const {
+    std::vector<std::string> systems;
+    for (const Entry &entry : entries) {
+        systems.push_back(entry.system);
+    }
+    return systems;
+}
+
+bool StarSystemPrefetcher::TakeParsed(const std::string &path, Tree &tree) {
+    for (std::vector<Entry>::iterator entry = entries.begin(); entry != entries.end(); ++entry) {
+        if (entry->path != path) {
+            continue;
+        }
+        bool taken = false;
+        try {
+            tree.swap(*entry->parsed.get());
+            taken = true;
+        } catch (const boost::property_tree::ptree_error &e) {
+            VS_LOG(warning, (boost::format("Preloading %1% failed: %2%") % path % e.what()));
+        }
+        // the files may still be being read; that goes on while the system is built
+        Retire(entry, !taken);
+        return taken;
+    }
+    return false;
+}
+
+size_t StarSystemPrefetcher::FilesRead(const std::string &system) const {
+    for (const std::vector<Entry> *list : {&entries, &retired}) {
+        for (const Entry &entry : *list) {
+            if (entry.system == system) {
+                return entry.progress->files_read;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,127 @@
+/*
+ * star_system_prefetcher.h
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef STAR_SYSTEM_PREFETCHER_H
+#define STAR_SYSTEM_PREFETCHER_H
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+/*
+ * The threads behind StarSystemPreloader, kept apart from the game so they
+ * can be tested on their own.
+ *
+ * Start parses a system file on a thread of its own. Once it is parsed,
+ * Poll asks the caller which files building the system will read (which
+ * needs the file lookup, so it happens on the polling thread) and reads
+ * them through on another thread, so that when the system is built they
+ * come from the OS's cache rather than the disk. TakeParsed hands the
+ * parsed tree over; the reads go on meanwhile if they aren't done.
+ *
+ * Cancel stops the reads after the file at hand and drops the tree. A parse
+ * cannot be stopped, so cancelled work is only let go of once it ends.
+ * Everything here is called from one thread.
+ */
+class StarSystemPrefetcher {
+public:
+    typedef boost::property_tree::ptree Tree;
+    /* Names the files building a parsed system reads, as paths the disk knows */
+    typedef std::function<std::vector<std::string>(const Tree &)> FileLister;
+
+    /* At most max_systems systems are kept, parsed or being parsed, at a time */
+    explicit StarSystemPrefetcher(size_t max_systems);
+    /* Cancels everything and waits for the threads */
+    ~StarSystemPrefetcher();
+
+    /* Whether system is being prefetched or waits to be taken */
+    bool Has(const std::string &system) const;
+
+    /*
+     * Starts parsing the file at path for system. When max_systems are
+     * already kept, the oldest parsed one is cancelled to make room; false
+     * if they are all still being parsed.
+     */
+    bool Start(const std::string &system, const std::string &path);
+
+    /* Starts reading the files of the systems parsed since the last call, and lets go of work that has ended */
+    void Poll(const FileLister &list_files);
+
+    /* Stops prefetching system; taking it afterwards is a miss */
+    void Cancel(const std::string &system);
+
+    /* The systems kept, in the order they were started */
+    std::vector<std::string> Systems() const;
+
+    /*
+     * Hands over the parsed contents of the file at path, waiting for the
+     * parse if it is still going. Returns false if that file was not
+     * prefetched or could not be parsed, in which case the caller reads it
+     * itself.
+     */
+    bool TakeParsed(const std::string &path, Tree &tree);
+
+    /* How many of the files listed for system have been read through so far */
+    size_t FilesRead(const std::string &system) const;
+
+private:
+    StarSystemPrefetcher(const StarSystemPrefetcher &) = delete;
+    StarSystemPrefetcher &operator=(const StarSystemPrefetcher &) = delete;
+
+    struct Progress {
+        std::atomic<bool> cancelled;
+        std::atomic<size_t> files_read;
+
+        Progress() : cancelled(false), files_read(0) {
+        }
+    };
+
+    struct Entry {
+        std::string system;
+        std::string path;
+        std::shared_future<std::shared_ptr<Tree>> parsed;
+        // whether the files have been listed, and the reads started if there were any
+        bool listed = false;
+        std::future<void> reads;
+        std::shared_ptr<Progress> progress;
+    };
+
+    static bool Ready(const std::shared_future<std::shared_ptr<Tree>> &parsed);
+    static void ReadThrough(const std::vector<std::string> &paths, const std::shared_ptr<Progress> &progress);
+    /* Moves the entry to retired, where its threads are left to finish, cancelling it first if asked */
+    void Retire(std::vector<Entry>::iterator entry, bool cancel);
+
+    const size_t max_systems;
+    std::vector<Entry> entries;
+    // entries cancelled or taken whose threads may still run; a std::async future waits for its thread when destroyed
+    std::vector<Entry> retired;
+};
+
+#endif // STAR_SYSTEM_PREFETCHER_H
@@ -0,0 +1,168 @@
+/*
+ * star_system_prefetcher_tests.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "star_system_prefetcher.h"
+
+class StarSystemPrefetcherTest : public ::testing::Test {
+protected:
+    boost::filesystem::path root;
+    int listed = 0;
+
+    void SetUp() override {
+        root = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("vs-prefetch-%%%%-%%%%");
+        boost::filesystem::create_directories(root);
+        Write("sol.system", "<system name=\"Sol\"><planet name=\"Earth\" file=\"earth.png\"/></system>");
+        Write("broken.system", "<system name=\"Broken\"><planet>");
+        Write("earth.png", std::string(100000, 'e'));
+        Write("station.bfxm", std::string(1000, 's'));
+    }
+
+    void TearDown() override {
+        boost::system::error_code error;
+        boost::filesystem::remove_all(root, error);
+    }
+
+    void Write(const std::string &relative, const std::string &contents) {
+        FILE *file = fopen(Path(relative).c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        fwrite(contents.data(), 1, contents.size(), file);
+        fclose(file);
+    }
+
+    std::string Path(const std::string &relative) const {
+        return (root / relative).string();
+    }
+
+    /* Lists the planet textures, the station mesh and a file that isn't there */
+    std::vector<std::string> ListFiles(const StarSystemPrefetcher::Tree &tree) {
+        ++listed;
+        std::vector<std::string> paths;
+        for (const auto &child : tree.get_child("system")) {
+            if (child.first == "planet") {
+                paths.push_back(Path(child.second.get<std::string>("<xmlattr>.file")));
+            }
+        }
+        paths.push_back(Path("station.bfxm"));
+        paths.push_back(Path("missing.bfxm"));
+        return paths;
+    }
+
+    /* Polls until condition holds, for at most a few seconds */
+    template<typename Condition>
+    bool PollUntil(StarSystemPrefetcher &prefetcher, Condition condition) {
+        const std::chrono::steady_clock::time_point give_up = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!condition()) {
+            if (std::chrono::steady_clock::now() > give_up) {
+                return false;
+            }
+            prefetcher.Poll([this](const StarSystemPrefetcher::Tree &tree) {
+                return ListFiles(tree);
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+};
+
+TEST_F(StarSystemPrefetcherTest, HandsOverTheParsedSystem) {
+    StarSystemPrefetcher prefetcher(4);
+    ASSERT_TRUE(prefetcher.Start("Sol", Path("sol.system")));
+    EXPECT_TRUE(prefetcher.Has("Sol"));
+
+    StarSystemPrefetcher::Tree tree;
+    ASSERT_TRUE(prefetcher.TakeParsed(Path("sol.system"), tree));
+    EXPECT_EQ(tree.get<std::string>("system.<xmlattr>.name"), "Sol");
+    EXPECT_FALSE(prefetcher.Has("Sol"));
+    // taken once only
+    EXPECT_FALSE(prefetcher.TakeParsed(Path("sol.system"), tree));
+}
+
+TEST_F(StarSystemPrefetcherTest, MissesWhatWasNotPrefetchedOrDidNotParse) {
+    StarSystemPrefetcher prefetcher(4);
+    StarSystemPrefetcher::Tree tree;
+    EXPECT_FALSE(prefetcher.TakeParsed(Path("sol.system"), tree));
+
+    ASSERT_TRUE(prefetcher.Start("Broken", Path("broken.system")));
+    EXPECT_FALSE(prefetcher.TakeParsed(Path("broken.system"), tree));
+    EXPECT_FALSE(prefetcher.Has("Broken"));
+}
+
+TEST_F(StarSystemPrefetcherTest, ReadsTheFilesTheSystemUses) {
+    StarSystemPrefetcher prefetcher(4);
+    ASSERT_TRUE(prefetcher.Start("Sol", Path("sol.system")));
+    // the texture and the mesh; the missing file is skipped
+    EXPECT_TRUE(PollUntil(prefetcher, [&prefetcher] {
+        return prefetcher.FilesRead("Sol") == 2;
+    }));
+    EXPECT_EQ(listed, 1);
+
+    StarSystemPrefetcher::Tree tree;
+    EXPECT_TRUE(prefetcher.TakeParsed(Path("sol.system"), tree));
+}
+
+TEST_F(StarSystemPrefetcherTest, CancelledSystemsAreMissedAndNotRead) {
+    StarSystemPrefetcher prefetcher(4);
+    ASSERT_TRUE(prefetcher.Start("Sol", Path("sol.system")));
+    prefetcher.Cancel("Sol");
+    EXPECT_FALSE(prefetcher.Has("Sol"));
+    EXPECT_TRUE(prefetcher.Systems().empty());
+
+    StarSystemPrefetcher::Tree tree;
+    EXPECT_FALSE(prefetcher.TakeParsed(Path("sol.system"), tree));
+    for (int i = 0; i < 20; ++i) {
+        prefetcher.Poll([this](const StarSystemPrefetcher::Tree &tree) {
+            return ListFiles(tree);
+        });
+    }
+    EXPECT_EQ(listed, 0);
+    EXPECT_EQ(prefetcher.FilesRead("Sol"), 0);
+
+    // and it can be asked for again
+    ASSERT_TRUE(prefetcher.Start("Sol", Path("sol.system")));
+    EXPECT_TRUE(prefetcher.TakeParsed(Path("sol.system"), tree));
+}
+
+TEST_F(StarSystemPrefetcherTest, MakesRoomByCancellingAParsedSystem) {
+    StarSystemPrefetcher prefetcher(1);
+    ASSERT_TRUE(prefetcher.Start("Sol", Path("sol.system")));
+    ASSERT_TRUE(PollUntil(prefetcher, [this] {
+        return listed == 1;
+    }));
+    ASSERT_TRUE(prefetcher.Start("Broken", Path("broken.system")));
+    EXPECT_EQ(prefetcher.Systems(), std::vector<std::string>(1, "Broken"));
+
+    StarSystemPrefetcher::Tree tree;
+    EXPECT_FALSE(prefetcher.TakeParsed(Path("sol.system"), tree));
+}
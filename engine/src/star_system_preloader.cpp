@@ -0,0 +1,218 @@
+/*
+ * star_system_preloader.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "star_system_preloader.h"
+
+#include <algorithm>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/format.hpp>
+
+#include "cmd/collide2/collision_tree_cache.h"
+#include "cmd/unit_csv_factory.h"
+#include "cmd/unit_generic.h"
+#include "cmd/unit_util.h"
+#include "configuration/configuration.h"
+#include "gfx/cockpit_generic.h"
+#include "star_system.h"
+#include "universe.h"
+#include "vsfilesystem.h"
+#include "vs_logging.h"
+
+extern void MakeStarSystem(std::string file, GalaxyXML::Galaxy *galaxy, std::string origin, int forcerandom);
+extern std::string RemoveDotSystem(const char *input);
+extern StarSystem *GetLoadedStarSystem(const char *system);
+
+// how many parsed systems may wait to be jumped to
+static const size_t MAX_PRELOADED_SYSTEMS = 8;
+
+StarSystemPreloader &StarSystemPreloader::Instance() {
+    static StarSystemPreloader preloader;
+    return preloader;
+}
+
+StarSystemPreloader::StarSystemPreloader() : prefetcher(MAX_PRELOADED_SYSTEMS) {
+}
+
+void StarSystemPreloader::WatchPlayers() {
+    if (!configuration()->general_config.preload_star_systems) {
+        return;
+    }
+    std::vector<std::string> wanted;
+    for (unsigned int i = 0; i < _Universe->numPlayers(); ++i) {
+        Cockpit *cockpit = _Universe->AccessCockpit(i);
+        Unit *player = cockpit->GetParent();
+        Unit *jumppoint = player ? player->Target() : nullptr;
+        if (jumppoint == nullptr || !jumppoint->isJumppoint() || cockpit->activeStarSystem == nullptr) {
+            continue;
+        }
+        if (player->jump.drive >= 0
+                || UnitUtil::getDistance(player, jumppoint)
+                        < configuration()->general_config.preload_star_system_distance) {
+            for (const std::string &destination : jumppoint->GetDestinations()) {
+                wanted.push_back(destination);
+                Request(destination, cockpit->activeStarSystem->getFileName());
+            }
+        }
+    }
+    //the jump takes its system when it starts, so whatever is left is not going to be needed
+    for (const std::string &system : prefetcher.Systems()) {
+        if (std::find(wanted.begin(), wanted.end(), system) == wanted.end()) {
+            prefetcher.Cancel(system);
+        }
+    }
+    prefetcher.Poll(ListFiles);
+}
+
+void StarSystemPreloader::Request(const std::string &system, const std::string &origin) {
+    if (prefetcher.Has(system)) {
+        return;
+    }
+    std::string ssys = system + ".system";
+    if (GetLoadedStarSystem(system.c_str())) {
+        return;
+    }
+    //same as Universe::Generate1, so the jump finds the file there
+    VSFileSystem::VSFile f;
+    VSFileSystem::VSError err = f.OpenReadOnly(ssys, VSFileSystem::SystemFile);
+    if (err > VSFileSystem::Ok) {
+        MakeStarSystem(ssys, _Universe->getGalaxy(), RemoveDotSystem(origin.c_str()), 0);
+    } else {
+        f.Close();
+    }
+    //and the same lookup StarSystem::LoadXML does
+    bool autogenerated = false;
+    std::string file = VSFileSystem::GetCorrectStarSysPath(ssys, autogenerated);
+    if (file.empty()) {
+        file = ssys;
+    }
+    VSFileSystem::VSFile other_file;
+    std::string path = other_file.GetSystemDirectoryPath(file);
+
+    if (prefetcher.Start(system, path)) {
+        VS_LOG(info, (boost::format("Preloading star system %1% from %2%") % system % path));
+    }
+}
+
+bool StarSystemPreloader::TakeParsed(const std::string &path, Tree &tree) {
+    return prefetcher.TakeParsed(path, tree);
+}
+
+namespace {
+
+/* The attribute, whatever its case, as SystemFactory reads them */
+std::string Attribute(const StarSystemPreloader::Tree &element, const char *name) {
+    const boost::optional<const StarSystemPreloader::Tree &> attributes = element.get_child_optional("<xmlattr>");
+    if (attributes) {
+        for (const auto &attribute : *attributes) {
+            if (boost::iequals(attribute.first, name)) {
+                return attribute.second.data();
+            }
+        }
+    }
+    return std::string();
+}
+
+void AddPath(const std::string &path, std::vector<std::string> &paths) {
+    if (std::find(paths.begin(), paths.end(), path) == paths.end()) {
+        paths.push_back(path);
+    }
+}
+
+/* Adds where the file would be read from, unless it is missing or inside a volume */
+void AddFile(const std::string &name, VSFileSystem::VSFileType type, std::vector<std::string> &paths) {
+    if (name.empty()) {
+        return;
+    }
+    VSFileSystem::VSFile file;
+    file.SetFilename(name);
+    if (VSFileSystem::LookForFile(file, type) > VSFileSystem::Ok || file.UseVolume()) {
+        return;
+    }
+    AddPath(file.GetFullPath(), paths);
+}
+
+/* The meshes of the unit, looked for from its directory as Unit::Init does, and its stored collision trees */
+void AddUnitFiles(const std::string &name, const std::string &faction, std::vector<std::string> &paths) {
+    const std::string unit_key = GetUnitKeyFromNameAndFaction(name, faction);
+    if (unit_key.empty()) {
+        return;
+    }
+    VSFileSystem::current_path.push_back(UnitCSVFactory::GetVariable(unit_key, "root", std::string()));
+    VSFileSystem::current_subdirectory.push_back(
+            "/" + UnitCSVFactory::GetVariable(unit_key, "Directory", std::string()));
+    VSFileSystem::current_type.push_back(VSFileSystem::UnitFile);
+    //the {mesh;frame;time} list AddMeshes reads
+    const std::string meshes = UnitCSVFactory::GetVariable(unit_key, "Mesh", std::string());
+    std::string::size_type where = meshes.find('{');
+    while (where != std::string::npos) {
+        const std::string::size_type end = meshes.find_first_of(";}", where + 1);
+        AddFile(meshes.substr(where + 1, end == std::string::npos ? std::string::npos : end - where - 1),
+                VSFileSystem::MeshFile, paths);
+        where = meshes.find('{', where + 1);
+    }
+    VSFileSystem::current_type.pop_back();
+    VSFileSystem::current_subdirectory.pop_back();
+    VSFileSystem::current_path.pop_back();
+    for (const std::string &tree : CollisionTreeCache::Files(unit_key)) {
+        AddPath(tree, paths);
+    }
+}
+
+void AddElementFiles(const std::string &type, const StarSystemPreloader::Tree &element,
+        std::vector<std::string> &paths) {
+    if (boost::iequals(type, "planet") || boost::iequals(type, "jump")) {
+        std::vector<std::string> textures;
+        const std::string file = Attribute(element, "file");
+        boost::split(textures, file, boost::is_any_of("|"));
+        for (const std::string &texture : textures) {
+            AddFile(texture, VSFileSystem::TextureFile, paths);
+        }
+        AddFile(Attribute(element, "citylights"), VSFileSystem::TextureFile, paths);
+    } else if (boost::iequals(type, "ring") || boost::iequals(type, "atmosphere")) {
+        AddFile(Attribute(element, "file"), VSFileSystem::TextureFile, paths);
+    } else if (boost::iequals(type, "fog")) {
+        AddFile(Attribute(element, "file"), VSFileSystem::MeshFile, paths);
+    } else if (boost::iequals(type, "unit") || boost::iequals(type, "asteroid")
+            || boost::iequals(type, "enhancement") || boost::iequals(type, "vehicle")
+            || boost::iequals(type, "building")) {
+        AddUnitFiles(Attribute(element, "file"), Attribute(element, "faction"), paths);
+    }
+    for (const auto &child : element) {
+        if (child.first != "<xmlattr>") {
+            AddElementFiles(child.first, child.second, paths);
+        }
+    }
+}
+
+}
+
+std::vector<std::string> StarSystemPreloader::ListFiles(const Tree &tree) {
+    std::vector<std::string> paths;
+    for (const auto &child : tree) {
+        AddElementFiles(child.first, child.second, paths);
+    }
+    return paths;
+}
@@ -0,0 +1,83 @@
+/*
+ * star_system_preloader.h
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef STAR_SYSTEM_PRELOADER_H
+#define STAR_SYSTEM_PRELOADER_H
+
+#include <string>
+#include <vector>
+
+#include "star_system_prefetcher.h"
+
+/*
+ * Gets the star systems a player is about to jump to ready ahead of time.
+ *
+ * Once a player targets a jump point and either engages the jump drive or
+ * comes within general.preload_star_system_distance of it, the system file
+ * of every destination is generated if need be, and then read and parsed
+ * on a thread of its own. Once parsed, the files building the system will
+ * read (the textures of its planets, the meshes of its units and their
+ * stored collision trees) are looked up and read through on another
+ * thread, so the jump finds them in the OS's cache. When the jump comes,
+ * SystemFactory takes the parsed tree instead of reading the file on the
+ * sim thread. Systems no player is headed for anymore are cancelled.
+ *
+ * Building the system (units, meshes, textures, the collide trees and the
+ * first physics frames) still happens on the sim thread, since it goes
+ * through the GL, Python and the shared caches. Neither are the textures
+ * named inside the meshes prefetched, since finding them means loading
+ * the mesh.
+ */
+class StarSystemPreloader {
+public:
+    typedef StarSystemPrefetcher::Tree Tree;
+
+    static StarSystemPreloader &Instance();
+
+    /* Looks at where the players are headed, starts and cancels preloading; called once per frame */
+    void WatchPlayers();
+
+    /* Starts preloading the system (as named by a jump point destination), unless it is loaded or on its way */
+    void Request(const std::string &system, const std::string &origin);
+
+    /*
+     * Hands over the parsed contents of the system file at path, waiting for
+     * the parse if it is still going. Returns false if that file was not
+     * preloaded or could not be parsed, in which case the caller reads it itself.
+     */
+    bool TakeParsed(const std::string &path, Tree &tree);
+
+    /* The files building the system in tree will read, that are on disk rather than in a volume */
+    static std::vector<std::string> ListFiles(const Tree &tree);
+
+private:
+    StarSystemPreloader();
+    StarSystemPreloader(const StarSystemPreloader &) = delete;
+    StarSystemPreloader &operator=(const StarSystemPreloader &) = delete;
+
+    StarSystemPrefetcher prefetcher;
+};
+
+#endif // STAR_SYSTEM_PRELOADER_H
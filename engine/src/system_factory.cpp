@@ -23,6 +23,7 @@
  */
 
 #include "system_factory.h"
+#include "star_system_preloader.h"
 
 #include "star_xml.h"
 #include "planet.h"
@@ -117,7 +118,9 @@ SystemFactory::SystemFactory(string const &relative_filename, string &system_fil
     this->fullname = truncateFilename(relative_filename);
 
     pt::ptree tree;
-    pt::read_xml(system_file, tree);
+    if (!StarSystemPreloader::Instance().TakeParsed(system_file, tree)) {
+        pt::read_xml(system_file, tree);
+    }
     recursiveParse(tree, root);
     recursiveProcess(xml, root, nullptr);
 }
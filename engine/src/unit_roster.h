@@ -0,0 +1,163 @@
+/*
+ * unit_roster.h
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UNIT_ROSTER_H
+#define UNIT_ROSTER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "gnuhash.h"
+
+class Unit;
+
+/*
+ * UnitRoster is the bookkeeping behind the Statistics of a star system: the
+ * faction every unit came in with, and the nav list slot of the significant
+ * ones, so removing a unit is a swap with the last slot of its list.
+ *
+ * Units are known by their address alone and never looked at, as a unit
+ * may be gone by the time it is dropped. Each nav slot holds a Slot, a
+ * UnitContainer in the game, which forgets its unit once it is killed; the
+ * roster keeps the address every slot was filed for on the side, so a
+ * removal still finds the unit that moved into the freed slot.
+ */
+template<class Slot>
+class UnitRoster {
+public:
+    enum { NUM_NAV_LISTS = 3 };
+
+    /* Records a unit coming in with faction; false if it is recorded already */
+    bool Add(const Unit *unit, int faction) {
+        if (entries.find(unit) != entries.end()) {
+            return false;
+        }
+        Entry &entry = entries[unit];
+        entry.faction = faction;
+        entry.nav_list = -1;
+        entry.nav_index = 0;
+        return true;
+    }
+
+    /* Forgets a unit and its nav slot, giving the faction it was recorded with; false if it wasn't */
+    bool Remove(const Unit *unit, int &faction) {
+        typename Entries::iterator found = entries.find(unit);
+        if (found == entries.end()) {
+            return false;
+        }
+        faction = found->second.faction;
+        RemoveNav(unit);
+        entries.erase(found);
+        return true;
+    }
+
+    bool Contains(const Unit *unit) const {
+        return entries.find(unit) != entries.end();
+    }
+
+    /* The faction the unit was recorded with, or -1 if it isn't */
+    int FactionOf(const Unit *unit) const {
+        typename Entries::const_iterator found = entries.find(unit);
+        return found == entries.end() ? -1 : found->second.faction;
+    }
+
+    void SetFaction(const Unit *unit, int faction) {
+        typename Entries::iterator found = entries.find(unit);
+        if (found != entries.end()) {
+            found->second.faction = faction;
+        }
+    }
+
+    /* Files a recorded unit at the back of nav list k, leaving the list it was on */
+    void AddNav(const Unit *unit, int k, const Slot &slot) {
+        typename Entries::iterator found = entries.find(unit);
+        if (found == entries.end() || k < 0 || k >= NUM_NAV_LISTS) {
+            return;
+        }
+        RemoveNav(unit);
+        found->second.nav_list = k;
+        found->second.nav_index = navs[k].size();
+        navs[k].push_back(slot);
+        nav_units[k].push_back(unit);
+    }
+
+    void RemoveNav(const Unit *unit) {
+        typename Entries::iterator removed = entries.find(unit);
+        if (removed == entries.end() || removed->second.nav_list < 0) {
+            return;
+        }
+        const int k = removed->second.nav_list;
+        const size_t i = removed->second.nav_index;
+        removed->second.nav_list = -1;
+        if (i + 1 != navs[k].size()) {
+            navs[k][i] = navs[k].back();
+            nav_units[k][i] = nav_units[k].back();
+            typename Entries::iterator moved = entries.find(nav_units[k][i]);
+            if (moved != entries.end()) {
+                moved->second.nav_index = i;
+            }
+        }
+        navs[k].pop_back();
+        nav_units[k].pop_back();
+    }
+
+    /* The nav list the unit is filed under, or -1 */
+    int NavListOf(const Unit *unit) const {
+        typename Entries::const_iterator found = entries.find(unit);
+        return found == entries.end() ? -1 : found->second.nav_list;
+    }
+
+    size_t NavCount(int k) const {
+        return navs[k].size();
+    }
+
+    Slot &Nav(int k, size_t i) {
+        return navs[k][i];
+    }
+
+    /* All NUM_NAV_LISTS lists; slots may be looked at, but not added or removed */
+    std::vector<Slot> *Navs() {
+        return navs;
+    }
+
+    /* The unit slot i of nav list k was filed for, even once the slot has forgotten it */
+    const Unit *NavUnit(int k, size_t i) const {
+        return nav_units[k][i];
+    }
+
+private:
+    struct Entry {
+        int faction;
+        int nav_list;                            //-1 if not a nav
+        size_t nav_index;
+    };
+    typedef vsUMap<const Unit *, Entry> Entries;
+
+    Entries entries;
+    std::vector<Slot> navs[NUM_NAV_LISTS];
+    std::vector<const Unit *> nav_units[NUM_NAV_LISTS];
+};
+
+#endif // UNIT_ROSTER_H
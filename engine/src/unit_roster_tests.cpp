@@ -0,0 +1,146 @@
+/*
+ * unit_roster_tests.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <set>
+
+#include "unit_roster.h"
+
+// the roster never looks at a unit, so any distinct addresses will do
+static char unit_storage[8];
+
+static const Unit *FakeUnit(int n) {
+    return reinterpret_cast<const Unit *>(&unit_storage[n]);
+}
+
+static std::set<const Unit *> killed;
+
+// forgets a killed unit once copied or looked at, the way UnitContainer does
+class ForgetfulSlot {
+public:
+    explicit ForgetfulSlot(const Unit *unit) : unit(Alive(unit)) {
+    }
+
+    ForgetfulSlot(const ForgetfulSlot &other) : unit(Alive(other.unit)) {
+    }
+
+    ForgetfulSlot &operator=(const ForgetfulSlot &other) {
+        unit = Alive(other.unit);
+        return *this;
+    }
+
+    const Unit *Get() {
+        unit = Alive(unit);
+        return unit;
+    }
+
+private:
+    static const Unit *Alive(const Unit *unit) {
+        return killed.count(unit) ? nullptr : unit;
+    }
+
+    const Unit *unit;
+};
+
+class UnitRosterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        killed.clear();
+    }
+
+    void AddNav(const Unit *unit, int faction, int k) {
+        ASSERT_TRUE(roster.Add(unit, faction));
+        roster.AddNav(unit, k, ForgetfulSlot(unit));
+    }
+
+    UnitRoster<ForgetfulSlot> roster;
+};
+
+TEST_F(UnitRosterTest, ForgetsAKilledNavAndTakesItsAddressAgain) {
+    AddNav(FakeUnit(0), 3, 1);
+    AddNav(FakeUnit(1), 4, 1);
+    EXPECT_FALSE(roster.Add(FakeUnit(0), 5));
+
+    killed.insert(FakeUnit(0));
+    EXPECT_EQ(nullptr, roster.Nav(1, 0).Get());
+    // the slot has forgotten the unit, the roster hasn't
+    ASSERT_EQ(FakeUnit(0), roster.NavUnit(1, 0));
+    int faction = -1;
+    EXPECT_TRUE(roster.Remove(roster.NavUnit(1, 0), faction));
+    EXPECT_EQ(3, faction);
+    EXPECT_FALSE(roster.Contains(FakeUnit(0)));
+    ASSERT_EQ(1u, roster.NavCount(1));
+    EXPECT_EQ(FakeUnit(1), roster.NavUnit(1, 0));
+    EXPECT_EQ(FakeUnit(1), roster.Nav(1, 0).Get());
+
+    // a new unit allocated where the dead one was is a unit of its own
+    killed.clear();
+    AddNav(FakeUnit(0), 6, 2);
+    EXPECT_EQ(6, roster.FactionOf(FakeUnit(0)));
+    EXPECT_EQ(2, roster.NavListOf(FakeUnit(0)));
+    EXPECT_EQ(1u, roster.NavCount(2));
+    EXPECT_FALSE(roster.Remove(FakeUnit(2), faction));
+}
+
+TEST_F(UnitRosterTest, KeepsTheSlotOfAKilledNavMovedIntoAFreedOne) {
+    AddNav(FakeUnit(0), 1, 0);
+    AddNav(FakeUnit(1), 1, 0);
+    AddNav(FakeUnit(2), 1, 0);
+
+    // removing the first moves the last, killed, into its slot, which forgets it on the way
+    killed.insert(FakeUnit(2));
+    int faction = -1;
+    EXPECT_TRUE(roster.Remove(FakeUnit(0), faction));
+    ASSERT_EQ(2u, roster.NavCount(0));
+    EXPECT_EQ(nullptr, roster.Nav(0, 0).Get());
+    EXPECT_EQ(FakeUnit(2), roster.NavUnit(0, 0));
+
+    EXPECT_TRUE(roster.Remove(FakeUnit(2), faction));
+    ASSERT_EQ(1u, roster.NavCount(0));
+    EXPECT_EQ(FakeUnit(1), roster.NavUnit(0, 0));
+    EXPECT_EQ(FakeUnit(1), roster.Nav(0, 0).Get());
+    EXPECT_TRUE(roster.Remove(FakeUnit(1), faction));
+    EXPECT_EQ(0u, roster.NavCount(0));
+}
+
+TEST_F(UnitRosterTest, MovesNavsBetweenLists) {
+    AddNav(FakeUnit(0), 1, 0);
+    AddNav(FakeUnit(1), 1, 0);
+    ASSERT_TRUE(roster.Add(FakeUnit(2), 1));
+    EXPECT_EQ(-1, roster.NavListOf(FakeUnit(2)));
+
+    roster.AddNav(FakeUnit(0), 1, ForgetfulSlot(FakeUnit(0)));
+    EXPECT_EQ(1u, roster.NavCount(0));
+    EXPECT_EQ(1u, roster.NavCount(1));
+    EXPECT_EQ(FakeUnit(1), roster.NavUnit(0, 0));
+    EXPECT_EQ(1, roster.NavListOf(FakeUnit(0)));
+
+    roster.SetFaction(FakeUnit(2), 7);
+    EXPECT_EQ(7, roster.FactionOf(FakeUnit(2)));
+    roster.RemoveNav(FakeUnit(1));
+    EXPECT_EQ(0u, roster.NavCount(0));
+    EXPECT_TRUE(roster.Contains(FakeUnit(1)));
+}
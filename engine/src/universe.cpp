@@ -49,6 +49,7 @@
 #include "gfx/screenshot.h"
 #include "universe_util.h"
 #include "star_system.h"
+#include "star_system_preloader.h"
 #include "save_util.h"
 #include "cmd/csv.h"
 #include "cmd/role_bitmask.h"
@@ -349,6 +350,8 @@ Universe::Universe(int argc, char **argv, const char *galaxy_str) {
     WeaponFactory wf = WeaponFactory(VSFileSystem::weapon_list);
 
     galaxy.reset(new GalaxyXML::Galaxy(galaxy_str));
+    //compile the jump network now rather than on the first route asked for in flight
+    getGalaxyGraph();
     static bool firsttime = false;
     if (!firsttime) {
         LoadFactionXML("factions.xml");
@@ -446,6 +449,7 @@ void Universe::StartDraw() {
     for (i = 0; i < star_system.size() && i < game_options()->NumRunningSystems; ++i) {
         star_system[i]->Update((i == 0) ? 1 : game_options()->InactiveSystemTime / i, true);
     }
+    StarSystemPreloader::Instance().WatchPlayers();
     StarSystem::ProcessPendingJumps();
     for (i = 0; i < _cockpits.size(); ++i) {
         SetActiveCockpit(i);
@@ -27,6 +27,7 @@
 #include "gfx/cockpit.h"
 #include "faction_generic.h"
 #include "galaxy_xml.h"
+#include "galaxy_graph.h"
 #include "stardate.h"
 
 /**
@@ -46,6 +47,8 @@ public:
 
 protected:
     std::unique_ptr<GalaxyXML::Galaxy> galaxy;
+    // compiled from galaxy, and again whenever that changes
+    mutable GalaxyGraph galaxy_graph;
     Camera hud_camera; // a generic camera facing the HUD
 
     // Constructors
@@ -97,6 +100,9 @@ public:
     string getGalaxyProperty(const string &sys, const string &prop);
     string getGalaxyPropertyDefault(const string &sys, const string &prop, const string def = "");
     GalaxyXML::Galaxy *getGalaxy();
+    const GalaxyGraph &getGalaxyGraph() const;
+    // the system's id in getGalaxyGraph, GalaxyGraph::NO_SYSTEM if it is not in the galaxy
+    int getGalaxySystem(const string &sys) const;
 
 // Light Map
     void activateLightMap(int stage = 1);
@@ -490,7 +490,7 @@ Unit *getUnitByName(std::string name) {
 }
 
 int getNumUnits() {
-#ifdef USE_STL_COLLECTION
+#ifndef USE_OLD_COLLECTION
     return activeSys->getUnitList().size();
 
 #else
@@ -528,7 +528,9 @@ string GetGalaxyPropertyDefault(string sys, string prop, string def) {
 #define DEFAULT_FACTION_SAVENAME "FactionTookOver_"
 
 string GetGalaxyFaction(string sys) {
-    string fac = _Universe->getGalaxyProperty(sys, "faction");
+    int id = _Universe->getGalaxySystem(sys);
+    string fac = id != GalaxyGraph::NO_SYSTEM ? _Universe->getGalaxyGraph().GetFaction(id)
+            : _Universe->getGalaxyProperty(sys, "faction");
     vector<std::string> *ans =
             &(_Universe->AccessCockpit(0)->savegame->getMissionStringData(string(DEFAULT_FACTION_SAVENAME) + sys));
     if (ans->size()) {
@@ -30,7 +30,8 @@
 #ifndef _VEGASTRIKE_H_
 #define _VEGASTRIKE_H_
 
-extern float simulation_atom_var;
+// per thread, so that worker threads can scale it for the unit they are simulating
+extern thread_local float simulation_atom_var;
 extern float audio_atom_var;
 //#define SIMULATION_ATOM (simulation_atom_var)
 //#define AUDIO_ATOM (audio_atom_var)
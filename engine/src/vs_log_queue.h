@@ -0,0 +1,220 @@
+/*
+ * vs_log_queue.h
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef VEGASTRIKE_VS_LOG_QUEUE_H
+#define VEGASTRIKE_VS_LOG_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include <boost/log/core/record_view.hpp>
+
+namespace VegaStrikeLogging {
+
+/*
+ * Fixed size lock-free ring buffer for any number of producers and
+ * consumers (Dmitry Vyukov's bounded MPMC queue).
+ */
+template<typename T, std::size_t CapacityV>
+class LockFreeRingBuffer {
+    static_assert(CapacityV >= 2 && (CapacityV & (CapacityV - 1)) == 0, "capacity must be a power of two");
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    // keep the two ends on different cache lines, they are written by different threads
+    char padding0_[64];
+    std::atomic<std::size_t> enqueue_position_;
+    char padding1_[64];
+    std::atomic<std::size_t> dequeue_position_;
+    char padding2_[64];
+
+public:
+    LockFreeRingBuffer() :
+            slots_(new Slot[CapacityV]),
+            enqueue_position_(0),
+            dequeue_position_(0) {
+        for (std::size_t i = 0; i < CapacityV; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Returns false when the buffer is full
+    bool TryPush(T const &value) {
+        std::size_t position = enqueue_position_.load(std::memory_order_relaxed);
+        Slot *slot;
+        for (;;) {
+            slot = &slots_[position & (CapacityV - 1)];
+            const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const std::intptr_t difference =
+                    static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (difference == 0) {
+                if (enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = enqueue_position_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = value;
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false when the buffer is empty
+    bool TryPop(T &value) {
+        std::size_t position = dequeue_position_.load(std::memory_order_relaxed);
+        Slot *slot;
+        for (;;) {
+            slot = &slots_[position & (CapacityV - 1)];
+            const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const std::intptr_t difference =
+                    static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+            if (difference == 0) {
+                if (dequeue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = dequeue_position_.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(slot->value);
+        // don't keep whatever the value owns alive until the slot is reused
+        slot->value = T();
+        slot->sequence.store(position + CapacityV, std::memory_order_release);
+        return true;
+    }
+};
+
+/*
+ * Log record queueing strategy for boost::log::sinks::asynchronous_sink,
+ * in the same shape as boost's bounded_fifo_queue, but backed by a
+ * LockFreeRingBuffer, so that the threads that log never take a lock. A
+ * thread that finds the ring full yields until the writer thread has made
+ * room; records are never dropped.
+ *
+ * The mutex is only used to put the writer thread to sleep while the ring
+ * is empty; producers touch it only when the writer is actually asleep.
+ */
+template<std::size_t CapacityV>
+class LockFreeRecordQueue {
+private:
+    LockFreeRingBuffer<boost::log::record_view, CapacityV> ring_;
+    std::mutex wait_mutex_;
+    std::condition_variable wait_condition_;
+    std::atomic<bool> consumer_waiting_;
+    bool interruption_requested_;
+
+    void WakeConsumer() {
+        // pairs with the fence in dequeue_ready: either we see the flag or the consumer sees our record
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumer_waiting_.load()) {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            wait_condition_.notify_one();
+        }
+    }
+
+protected:
+    LockFreeRecordQueue() :
+            consumer_waiting_(false),
+            interruption_requested_(false) {
+    }
+
+    template<typename ArgsT>
+    explicit LockFreeRecordQueue(ArgsT const &) : LockFreeRecordQueue() {
+    }
+
+    void enqueue(boost::log::record_view const &rec) {
+        while (!ring_.TryPush(rec)) {
+            WakeConsumer();
+            std::this_thread::yield();
+        }
+        WakeConsumer();
+    }
+
+    bool try_enqueue(boost::log::record_view const &rec) {
+        if (!ring_.TryPush(rec)) {
+            return false;
+        }
+        WakeConsumer();
+        return true;
+    }
+
+    bool try_dequeue_ready(boost::log::record_view &rec) {
+        return ring_.TryPop(rec);
+    }
+
+    bool try_dequeue(boost::log::record_view &rec) {
+        return ring_.TryPop(rec);
+    }
+
+    // Blocks until there is a record or interrupt_dequeue is called
+    bool dequeue_ready(boost::log::record_view &rec) {
+        for (;;) {
+            if (ring_.TryPop(rec)) {
+                return true;
+            }
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            if (interruption_requested_) {
+                interruption_requested_ = false;
+                return false;
+            }
+            consumer_waiting_.store(true);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            // a producer that pushed before seeing the flag didn't wake us, so look once more
+            if (ring_.TryPop(rec)) {
+                consumer_waiting_.store(false);
+                return true;
+            }
+            wait_condition_.wait_for(lock, std::chrono::milliseconds(100));
+            consumer_waiting_.store(false);
+        }
+    }
+
+    void interrupt_dequeue() {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        interruption_requested_ = true;
+        wait_condition_.notify_one();
+    }
+};
+
+} // namespace VegaStrikeLogging
+
+#endif // VEGASTRIKE_VS_LOG_QUEUE_H
@@ -38,10 +38,13 @@
 #include <boost/log/utility/setup/console.hpp>
 #include <boost/log/utility/setup/file.hpp>
 #include <boost/log/utility/setup/common_attributes.hpp>
+#include <boost/log/utility/setup/formatter_parser.hpp>
 #include <boost/filesystem.hpp>
 
 namespace VegaStrikeLogging {
 
+std::atomic<vega_log_level> minimum_enabled_level{trace};
+
 // void exitProgram(int code)
 // {
 //     Music::CleanupMuzak();
@@ -50,43 +53,67 @@ namespace VegaStrikeLogging {
 // }
 
 void VegaStrikeLogger::InitLoggingPart2(const uint8_t debug_level,
-        const boost::filesystem::path &vega_strike_home_dir) {
+        const boost::filesystem::path &vega_strike_home_dir,
+        const bool asynchronous) {
 
     const boost::filesystem::path &logging_dir = boost::filesystem::absolute("logs",
             vega_strike_home_dir);         /*< $HOME/.vegastrike/logs, typically >*/
     const std::string &logging_dir_name = logging_dir.string();
     VS_LOG(info, (boost::format("log directory : '%1%'") % logging_dir_name));
 
+    vega_log_level minimum_level;
     switch (debug_level) {
         case 1:
-            logging_core_->set_filter(severity >= info);
+            minimum_level = info;
             break;
         case 2:
-            logging_core_->set_filter(severity >= debug);
+            minimum_level = debug;
             break;
         case 3:
-            logging_core_->set_filter(severity >= trace);
+            minimum_level = trace;
             break;
         default:
-            logging_core_->set_filter(severity >= important_info);
+            minimum_level = important_info;
             break;
     }
-
-    file_log_sink_ = boost::log::add_file_log
-            (
-                    boost::log::keywords::file_name =
-                            logging_dir_name + "/" + "vegastrike_%Y-%m-%d_%H_%M_%S.%f.log", /*< file name pattern >*/
-                    boost::log::keywords::rotation_size = 10 * 1024
-                            * 1024,                                               /*< rotate files every 10 MiB... >*/
-                    boost::log::keywords::time_based_rotation =
-                            boost::log::sinks::file::rotation_at_time_point(0, 0, 0),     /*< ...or at midnight >*/
-                    boost::log::keywords::format =
-                            "[%TimeStamp%]: %Message%",                                     /*< log record format >*/
-                    boost::log::keywords::auto_flush =
-                            true, /*false,*/                                                /*< whether to auto flush to the file after every line >*/
-                    boost::log::keywords::min_free_space = 2UL * 1024UL * 1024UL
-                            * 1024UL                                      /*< stop boost::log when there's only 2 GiB free space left >*/
-            );
+    logging_core_->set_filter(severity >= minimum_level);
+    minimum_enabled_level.store(minimum_level);
+
+    if (asynchronous) {
+        // same settings as the synchronous file log below
+        boost::shared_ptr<boost::log::sinks::text_file_backend> backend =
+                boost::make_shared<boost::log::sinks::text_file_backend>(
+                        boost::log::keywords::file_name =
+                                logging_dir_name + "/" + "vegastrike_%Y-%m-%d_%H_%M_%S.%f.log",
+                        boost::log::keywords::rotation_size = 10 * 1024 * 1024,
+                        boost::log::keywords::time_based_rotation =
+                                boost::log::sinks::file::rotation_at_time_point(0, 0, 0),
+                        boost::log::keywords::auto_flush = true);
+        backend->set_file_collector(boost::log::sinks::file::make_collector(
+                boost::log::keywords::target = logging_dir_name,
+                boost::log::keywords::min_free_space = 2UL * 1024UL * 1024UL * 1024UL));
+        async_file_log_sink_ = boost::make_shared<AsyncFileLogSink>(backend);
+        async_file_log_sink_->set_formatter(boost::log::parse_formatter("[%TimeStamp%]: %Message%"));
+        logging_core_->add_sink(async_file_log_sink_);
+    } else {
+        file_log_sink_ = boost::log::add_file_log
+                (
+                        boost::log::keywords::file_name =
+                                logging_dir_name + "/" + "vegastrike_%Y-%m-%d_%H_%M_%S.%f.log", /*< file name pattern >*/
+                        boost::log::keywords::rotation_size = 10 * 1024
+                                * 1024,                                               /*< rotate files every 10 MiB... >*/
+                        boost::log::keywords::time_based_rotation =
+                                boost::log::sinks::file::rotation_at_time_point(0, 0, 0),     /*< ...or at midnight >*/
+                        boost::log::keywords::format =
+                                "[%TimeStamp%]: %Message%",                                     /*< log record format >*/
+                        boost::log::keywords::auto_flush =
+                                true, /*false,*/                                                /*< whether to auto flush to the file after every line >*/
+                        boost::log::keywords::target =
+                                logging_dir_name,                                               /*< the file collector only runs with a target >*/
+                        boost::log::keywords::min_free_space = 2UL * 1024UL * 1024UL
+                                * 1024UL                                      /*< stop boost::log when there's only 2 GiB free space left >*/
+                );
+    }
 
     console_log_sink_->set_filter(severity >= fatal);
 }
@@ -98,6 +125,10 @@ void VegaStrikeLogger::FlushLogs() {
     if (file_log_sink_) {
         file_log_sink_->flush();
     }
+    if (async_file_log_sink_) {
+        // writes out everything still queued, on this thread
+        async_file_log_sink_->flush();
+    }
     fflush(stdout);
     fflush(stderr);
 }
@@ -120,6 +151,11 @@ VegaStrikeLogger::VegaStrikeLogger() {
 
 VegaStrikeLogger::~VegaStrikeLogger() {
     FlushLogs();
+    if (async_file_log_sink_) {
+        logging_core_->remove_sink(async_file_log_sink_);
+        async_file_log_sink_->stop();
+        async_file_log_sink_->flush();
+    }
 }
 
 void VegaStrikeLogger::Log(const vega_log_level level, const std::string &message) {
@@ -24,6 +24,7 @@
 #ifndef VEGASTRIKE_VS_LOGGING_H
 #define VEGASTRIKE_VS_LOGGING_H
 
+#include <atomic>
 #include <cstdint>
 
 #include <boost/move/utility_core.hpp>
@@ -33,10 +34,13 @@
 #include <boost/log/sources/severity_logger.hpp>
 #include <boost/log/sources/record_ostream.hpp>
 #include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/async_frontend.hpp>
 #include <boost/log/sinks/text_file_backend.hpp>
 #include <boost/log/sinks/text_ostream_backend.hpp>
 #include <boost/filesystem.hpp>
 
+#include "vs_log_queue.h"
+
 namespace VegaStrikeLogging {
 
 enum vega_log_level {
@@ -54,14 +58,32 @@ BOOST_LOG_ATTRIBUTE_KEYWORD(severity, "Severity", vega_log_level)
 
 typedef boost::log::sinks::synchronous_sink<boost::log::sinks::text_ostream_backend> ConsoleLogSink;
 typedef boost::log::sinks::synchronous_sink<boost::log::sinks::text_file_backend> FileLogSink;
+// Records are formatted and written by a background thread
+typedef boost::log::sinks::asynchronous_sink<boost::log::sinks::text_file_backend,
+        LockFreeRecordQueue<8192>> AsyncFileLogSink;
+
+// The lowest severity that any sink currently accepts
+extern std::atomic<vega_log_level> minimum_enabled_level;
+
+inline bool IsLogEnabled(const vega_log_level level) {
+    return level >= minimum_enabled_level.load(std::memory_order_relaxed);
+}
 
+// log_message is only evaluated when log_level is enabled
 #define VS_LOG(log_level, log_message)                                                                              \
     do {                                                                                                            \
-        VegaStrikeLogging::vega_logger()->Log(VegaStrikeLogging::vega_log_level::log_level, (log_message));         \
+        if (VegaStrikeLogging::IsLogEnabled(VegaStrikeLogging::vega_log_level::log_level)) {                        \
+            VegaStrikeLogging::vega_logger()->Log(VegaStrikeLogging::vega_log_level::log_level, (log_message));     \
+        }                                                                                                           \
     } while (false)
+// Flushes even when log_level is disabled, so whatever was logged before reaches the disk
 #define VS_LOG_AND_FLUSH(log_level, log_message)                                                                    \
     do {                                                                                                            \
-        VegaStrikeLogging::vega_logger()->LogAndFlush(VegaStrikeLogging::vega_log_level::log_level, (log_message)); \
+        if (VegaStrikeLogging::IsLogEnabled(VegaStrikeLogging::vega_log_level::log_level)) {                        \
+            VegaStrikeLogging::vega_logger()->LogAndFlush(VegaStrikeLogging::vega_log_level::log_level, (log_message)); \
+        } else {                                                                                                    \
+            VegaStrikeLogging::vega_logger()->FlushLogs();                                                          \
+        }                                                                                                           \
     } while (false)
 
 class VegaStrikeLogger {
@@ -70,11 +92,15 @@ private:
     boost::shared_ptr<boost::log::sources::severity_logger_mt<vega_log_level>> slg_;
     boost::shared_ptr<ConsoleLogSink> console_log_sink_;
     boost::shared_ptr<FileLogSink> file_log_sink_;
+    boost::shared_ptr<AsyncFileLogSink> async_file_log_sink_;
 
 public:
     VegaStrikeLogger();
     ~VegaStrikeLogger();
-    void InitLoggingPart2(const uint8_t debug_level, const boost::filesystem::path &vega_strike_home_dir);
+    // With asynchronous set, the log file is written by a background thread
+    void InitLoggingPart2(const uint8_t debug_level,
+            const boost::filesystem::path &vega_strike_home_dir,
+            const bool asynchronous = false);
     void FlushLogs();
     void Log(const vega_log_level level, const std::string& message);
     void Log(const vega_log_level level, const char * message);
@@ -0,0 +1,102 @@
+/*
+ * vs_logging_tests.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "vs_logging.h"
+#include "vs_log_queue.h"
+
+using VegaStrikeLogging::LockFreeRingBuffer;
+
+static int evaluations = 0;
+
+static const char *CountedMessage() {
+    ++evaluations;
+    return "counted message";
+}
+
+TEST(Logging, DisabledLevelIsNotEvaluated) {
+    const VegaStrikeLogging::vega_log_level saved = VegaStrikeLogging::minimum_enabled_level.load();
+    VegaStrikeLogging::minimum_enabled_level.store(VegaStrikeLogging::fatal);
+    evaluations = 0;
+    VS_LOG(trace, CountedMessage());
+    VS_LOG(error, CountedMessage());
+    EXPECT_EQ(evaluations, 0);
+    VegaStrikeLogging::minimum_enabled_level.store(saved);
+}
+
+TEST(LockFreeRingBuffer, FullAndEmpty) {
+    LockFreeRingBuffer<int, 4> ring;
+    int value = 0;
+    EXPECT_FALSE(ring.TryPop(value));
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.TryPush(i));
+    }
+    EXPECT_FALSE(ring.TryPush(4));
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(ring.TryPop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(ring.TryPop(value));
+}
+
+TEST(LockFreeRingBuffer, ManyProducers) {
+    const int kProducers = 4;
+    const int kPerProducer = 20000;
+    LockFreeRingBuffer<int, 64> ring;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.push_back(std::thread([&ring, p] {
+            for (int i = 0; i < kPerProducer; ++i) {
+                while (!ring.TryPush(p * kPerProducer + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        }));
+    }
+
+    // every value arrives exactly once, and each producer's values in order
+    std::vector<int> last_seen(kProducers, -1);
+    int received = 0;
+    while (received < kProducers * kPerProducer) {
+        int value;
+        if (!ring.TryPop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        const int producer = value / kPerProducer;
+        EXPECT_GT(value % kPerProducer, last_seen[producer]);
+        last_seen[producer] = value % kPerProducer;
+        ++received;
+    }
+    for (std::thread &producer : producers) {
+        producer.join();
+    }
+    for (int p = 0; p < kProducers; ++p) {
+        EXPECT_EQ(last_seen[p], kPerProducer - 1);
+    }
+}
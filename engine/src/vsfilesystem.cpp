@@ -46,6 +46,7 @@ struct dirent
 #include <unistd.h>
 #include <pwd.h>
 #include <sys/types.h>
+#include <sys/mman.h>
 #include <dirent.h>
 #endif
 #include <sys/stat.h>
@@ -55,6 +56,7 @@ struct dirent
 #include "common/common.h"
 #include "galaxy_gen.h"
 #include "pk3.h"
+#include "file_lookup_index.h"
 
 #include "gnuhash.h"
 
@@ -64,6 +66,7 @@ struct dirent
 
 #include <boost/filesystem.hpp>
 
+#include "configuration/configuration.h"
 #include "configuration/game_config.h"
 #include "vs_exit.h"
 
@@ -277,6 +280,22 @@ std::string failed;
 // FIXME: Clang-Tidy: Initialization of 'pk3_opened_files' with static storage duration may throw an exception that cannot be caught
 vsUMap<std::string, CPK3 *> pk3_opened_files;
 
+static size_t VolumeCacheSize() {
+    return static_cast<size_t>(configuration()->data_config.pk3_cache_megabytes) << 20;
+}
+
+//What is below Rootdir, so that FileExists doesn't have to stat every candidate path
+static FileLookupIndex file_index;
+
+void RefreshFileIndex() {
+    if (!configuration()->data_config.index_files) {
+        file_index.Clear();
+        return;
+    }
+    //homedir is where the game writes, the other roots only change when the player edits them
+    file_index.Build(Rootdir, vector<string>(1, homedir));
+}
+
 /*
  ***********************************************************************************************
  **** vs_path functions                                                                      ***
@@ -967,6 +986,7 @@ void InitPaths(string conf, string subdir) {
     Rootdir.push_back(homedir);
     InitMods();
     Rootdir.push_back(datadir);
+    RefreshFileIndex();
 
     //NOTE : UniverseFiles cannot use volumes since some are needed by python
     //Also : Have to try with systems, not sure it would work well
@@ -1103,23 +1123,28 @@ int FileExists(const string &root, const char *filename, VSFileType type, bool l
         file = filename;
     }
     const char *rootsep = (root.empty() || root == "/") ? "" : "/";
+    //failed is only ever printed when debugging the file system, don't pay for building it otherwise
+    const bool describe = VSFS_DEBUG() != 0;
     if (!UseVolumes[type] || !lookinvolume) {
         if (type == UnknownFile) {
             fullpath = root + rootsep + file;
         } else {
             fullpath = root + rootsep + Directories[type] + "/" + file;
         }
-        struct stat s{};
-        if (stat(fullpath.c_str(), &s) >= 0) {
-            if (s.st_mode & S_IFDIR) {
-                VS_LOG(error, " File is a directory ! ");
-                found = -1;
-            } else {
-                isin_bigvolumes = VSFSNone;
-                found = 1;
+        FileLookupIndex::Result entry = file_index.Find(fullpath);
+        if (entry == FileLookupIndex::NotCovered) {
+            struct stat s{};
+            if (stat(fullpath.c_str(), &s) >= 0) {
+                entry = (s.st_mode & S_IFDIR) ? FileLookupIndex::Directory : FileLookupIndex::RegularFile;
             }
         }
-        //}
+        if (entry == FileLookupIndex::Directory) {
+            VS_LOG(error, " File is a directory ! ");
+            found = -1;
+        } else if (entry == FileLookupIndex::RegularFile) {
+            isin_bigvolumes = VSFSNone;
+            found = 1;
+        }
     } else {
         if (q_volume_format == vfmtVSR) {
         } else if (q_volume_format == vfmtPK3) {
@@ -1131,20 +1156,27 @@ int FileExists(const string &root, const char *filename, VSFileType type, bool l
             fullpath = root + rootsep + "data." + volume_format;
             vsUMap<string, CPK3 *>::iterator it;
             it = pk3_opened_files.find(fullpath);
-            failed += "Looking for file in VOLUME : " + fullpath + "... ";
+            if (describe) {
+                failed += "Looking for file in VOLUME : " + fullpath + "... ";
+            }
             if (it == pk3_opened_files.end()) {
                 //File is not opened so we open it and add it in the pk3 file map
                 vol = new CPK3;
                 if ((volok = vol->Open(fullpath.c_str()))) {
-                    failed += " VOLUME OPENED\n";
+                    if (describe) {
+                        failed += " VOLUME OPENED\n";
+                    }
+                    vol->SetInflatedCacheSize(VolumeCacheSize());
                     //We add the resource file to the map only if we could have opened it
                     std::pair<std::string, CPK3 *> pk3_pair(fullpath, vol);
                     pk3_opened_files.insert(pk3_pair);
-                } else {
+                } else if (describe) {
                     failed += " COULD NOT OPEN VOLUME\n";
                 }
             } else {
-                failed += " VOLUME FOUND\n";
+                if (describe) {
+                    failed += " VOLUME FOUND\n";
+                }
                 vol = it->second;
                 volok = true;
             }
@@ -1162,20 +1194,27 @@ int FileExists(const string &root, const char *filename, VSFileType type, bool l
                 filestr = string(file);
                 fullpath = root + rootsep + Directories[type] + "." + volume_format;
                 it = pk3_opened_files.find(fullpath);
-                failed += "Looking for file in VOLUME : " + fullpath + "... ";
+                if (describe) {
+                    failed += "Looking for file in VOLUME : " + fullpath + "... ";
+                }
                 if (it == pk3_opened_files.end()) {
                     //File is not opened so we open it and add it in the pk3 file map
                     vol = new CPK3;
                     if ((volok = vol->Open(fullpath.c_str()))) {
-                        failed += " VOLUME OPENED\n";
+                        if (describe) {
+                            failed += " VOLUME OPENED\n";
+                        }
+                        vol->SetInflatedCacheSize(VolumeCacheSize());
                         //We add the resource file to the map only if we could have opened it
                         std::pair<std::string, CPK3 *> pk3_pair(fullpath, vol);
                         pk3_opened_files.insert(pk3_pair);
-                    } else {
+                    } else if (describe) {
                         failed += " COULD NOT OPEN VOLUME\n";
                     }
                 } else {
-                    failed += " VOLUME FOUND\n";
+                    if (describe) {
+                        failed += " VOLUME FOUND\n";
+                    }
                     vol = it->second;
                     volok = true;
                 }
@@ -1191,19 +1230,21 @@ int FileExists(const string &root, const char *filename, VSFileType type, bool l
             }
         }
     }
-    if (found < 0) {
-        if (!UseVolumes[type]) {
-            failed += "\tTRY LOADING : " + nameof(type) + " " + fullpath + "... NOT FOUND\n";
-        } else if (VSFS_DEBUG() > 1) {
-            failed += "\tTRY LOADING in " + nameof(type) + " " + fullpath + " : " + file + "... NOT FOUND\n";
-        }
-    } else {
-        if (!UseVolumes[type]) {
-            failed = "\tTRY LOADING : " + nameof(type) + " " + fullpath + "... SUCCESS";
-        } else if (VSFS_DEBUG() > 1) {
-            failed = "\tTRY LOADING in " + nameof(type) + " " + fullpath + " : " + file + "... SUCCESS";
+    if (describe) {
+        if (found < 0) {
+            if (!UseVolumes[type]) {
+                failed += "\tTRY LOADING : " + nameof(type) + " " + fullpath + "... NOT FOUND\n";
+            } else if (VSFS_DEBUG() > 1) {
+                failed += "\tTRY LOADING in " + nameof(type) + " " + fullpath + " : " + file + "... NOT FOUND\n";
+            }
         } else {
-            failed.erase();
+            if (!UseVolumes[type]) {
+                failed = "\tTRY LOADING : " + nameof(type) + " " + fullpath + "... SUCCESS";
+            } else if (VSFS_DEBUG() > 1) {
+                failed = "\tTRY LOADING in " + nameof(type) + " " + fullpath + " : " + file + "... SUCCESS";
+            } else {
+                failed.erase();
+            }
         }
     }
     return found;
@@ -1508,6 +1549,7 @@ VSFile::VSFile(const char *filename, VSFileType type, VSFileMode mode) {
 }
 
 VSFile::~VSFile() {
+    Unmap();
     if (fp != nullptr) {
         fclose(fp);
         this->fp = nullptr;
@@ -1518,31 +1560,69 @@ VSFile::~VSFile() {
     }
 }
 
+const char *VSFile::viewVolumeFile() {
+    if (pk3_extracted_file) {
+        return pk3_extracted_file;
+    }
+    if (q_volume_format != vfmtPK3) {
+        return nullptr;
+    }
+    if (pk3_view.size < 0) {
+        string full_vol_path;
+        if (this->volume_type == VSFSBig) {
+            full_vol_path = this->rootname + "/data." + volume_format;
+        } else {
+            full_vol_path = this->rootname + "/" + Directories[this->alt_type] + "." + volume_format;
+        }
+        vsUMap<string, CPK3 *>::iterator it;
+        it = pk3_opened_files.find(full_vol_path);
+        if (it == pk3_opened_files.end()) {
+            //File is not opened so we open it and add it in the pk3 file map
+            CPK3 *pk3newfile = new CPK3;
+            if (!pk3newfile->Open(full_vol_path.c_str())) {
+                VS_LOG_AND_FLUSH(fatal, (boost::format("!!! ERROR : opening volume : %1%") % full_vol_path));
+                VSExit(1);
+            }
+            pk3newfile->SetInflatedCacheSize(VolumeCacheSize());
+            std::pair<std::string, CPK3 *> pk3_pair(full_vol_path, pk3newfile);
+            pk3_opened_files.insert(pk3_pair);
+
+            this->pk3_file = pk3newfile;
+        } else {
+            this->pk3_file = it->second;
+        }
+        if (this->file_index != -1) {
+            pk3_view = pk3_file->ViewFile(this->file_index);
+        } else {
+            const string member = this->subdirectoryname + "/" + this->filename;
+            pk3_view = pk3_file->ViewFile(pk3_file->FileExists(member.c_str()));
+        }
+        if (pk3_view.size < 0) {
+            return nullptr;
+        }
+        this->size = pk3_view.size;
+        VS_LOG(info,
+                (boost::format("VIEWING %1% WITH INDEX=%2% SIZE=%3%")
+                        % (this->subdirectoryname + "/" + this->filename)
+                        % this->file_index
+                        % pk3_view.size));
+    }
+    return pk3_view.data;
+}
+
 void VSFile::checkExtracted() {
     if (q_volume_format == vfmtPK3) {
         if (!pk3_extracted_file) {
-            string full_vol_path;
-            if (this->volume_type == VSFSBig) {
-                full_vol_path = this->rootname + "/data." + volume_format;
-            } else {
-                full_vol_path = this->rootname + "/" + Directories[this->alt_type] + "." + volume_format;
+            if (const char *data = viewVolumeFile()) {
+                pk3_extracted_file = new char[this->size + 1];
+                memcpy(pk3_extracted_file, data, this->size);
+                pk3_extracted_file[this->size] = 0;
+                return;
             }
-            vsUMap<string, CPK3 *>::iterator it;
-            it = pk3_opened_files.find(full_vol_path);
-            if (it == pk3_opened_files.end()) {
-                //File is not opened so we open it and add it in the pk3 file map
-                CPK3 *pk3newfile = new CPK3;
-                if (!pk3newfile->Open(full_vol_path.c_str())) {
-                    VS_LOG_AND_FLUSH(fatal, (boost::format("!!! ERROR : opening volume : %1%") % full_vol_path));
-                    VSExit(1);
-                }
-                std::pair<std::string, CPK3 *> pk3_pair(full_vol_path, pk3newfile);
-                pk3_opened_files.insert(pk3_pair);
-
-                this->pk3_file = pk3newfile;
-            } else {
-                this->pk3_file = it->second;
+            if (!pk3_file) {
+                return;
             }
+            //the member can't be read; this hands out a zeroed buffer of its size, if it is there at all
             int pk3size = 0;
             if (this->file_index != -1) {
                 pk3_extracted_file = (char *) pk3_file->ExtractFile(this->file_index, &pk3size);
@@ -1551,11 +1631,6 @@ void VSFile::checkExtracted() {
                         (this->subdirectoryname + "/" + this->filename).c_str(), &pk3size);
             }
             this->size = pk3size;
-            VS_LOG(info,
-                    (boost::format("EXTRACTING %1% WITH INDEX=%2% SIZE=%3%")
-                            % (this->subdirectoryname + "/" + this->filename)
-                            % this->file_index
-                            % pk3size));
         }
     }
 }
@@ -1594,7 +1669,7 @@ VSError VSFile::OpenReadOnly(const char *file, VSFileType type) {
                     string filestr1 = current_directory.back()
                             + "/" + current_subdirectory.back() + "/" + string(file);
                     filestr = current_path.back() + "/" + filestr1;
-                    if ((found = FileExists(current_path.back(), filestr1)) < 0) {
+                    if ((found = FileExists(current_path.back(), filestr1)) < 0 && VSFS_DEBUG()) {
                         failed += "\t" + filestr + " NOT FOUND !\n";
                     }
                 }
@@ -1602,14 +1677,14 @@ VSError VSFile::OpenReadOnly(const char *file, VSFileType type) {
                     for (unsigned int ij = 0; ij < Rootdir.size() && found < 0; ij++) {
                         filestr = Rootdir[ij] + "/" + file;
                         found = FileExists(Rootdir[ij], file);
-                        if (found < 0) {
+                        if (found < 0 && VSFS_DEBUG()) {
                             failed += "\tRootdir : " + filestr + " NOT FOUND !\n";
                         }
                     }
                     //Look for relative (to datadir) or absolute named file
                     if (found < 0) {
                         filestr = file;
-                        if ((found = FileExists("", filestr)) < 0) {
+                        if ((found = FileExists("", filestr)) < 0 && VSFS_DEBUG()) {
                             failed += "\tAbs or rel : " + filestr + " NOT FOUND !\n";
                         }
                     }
@@ -1777,13 +1852,19 @@ size_t VSFile::Read(void *ptr, size_t length) {
     } else {
         if (q_volume_format == vfmtVSR) {
         } else if (q_volume_format == vfmtPK3) {
-            checkExtracted();
-            if (length > this->size - this->offset) {
-                length = this->size - this->offset;
+            const char *data = viewVolumeFile();
+            if (!data) {
+                checkExtracted();
+                data = pk3_extracted_file;
+            }
+            if (data) {
+                if (length > this->size - this->offset) {
+                    length = this->size - this->offset;
+                }
+                memcpy(ptr, (data + offset), length);
+                offset += length;
+                nbread = length;
             }
-            memcpy(ptr, (pk3_extracted_file + offset), length);
-            offset += length;
-            nbread = length;
         }
     }
     return nbread;
@@ -1879,6 +1960,62 @@ std::string VSFile::ReadFull() {
     return string("");
 }
 
+const char *VSFile::Map() {
+    if (mapped_data != nullptr) {
+        return mapped_data;
+    }
+    if (file_mode != ReadOnly) {
+        return nullptr;
+    }
+    if (pk3_extracted_file != nullptr) {
+        return pk3_extracted_file;
+    }
+    if (UseVolumes[alt_type] && this->volume_type != VSFSNone && q_volume_format == vfmtPK3) {
+        return viewVolumeFile();
+    }
+    const long length = this->Size();
+    if (fp == nullptr || length < 0) {
+        return nullptr;
+    }
+    if (length == 0) {
+        return "";
+    }
+#if !defined (_WIN32) || defined (__CYGWIN__)
+    void *view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+    if (view != MAP_FAILED) {
+        mapped_data = static_cast<const char *>(view);
+        mapped_length = length;
+        return mapped_data;
+    }
+    VS_LOG(info, (boost::format("Could not map %1%, reading it instead") % this->filename));
+#endif
+    //No mapping to be had: read it into a buffer of our own, leaving the file pointer where it was
+    mapped_copy.resize(length);
+    const long position = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    const size_t readsize = fread(mapped_copy.data(), 1, length, fp);
+    fseek(fp, position, SEEK_SET);
+    if (readsize != static_cast<size_t>(length)) {
+        VS_LOG(error, (boost::format("Only read %1% out of %2% bytes of %3%") % readsize % length % this->filename));
+        GetError("Map");
+        vector<char>().swap(mapped_copy);
+        return nullptr;
+    }
+    mapped_data = mapped_copy.data();
+    return mapped_data;
+}
+
+void VSFile::Unmap() {
+#if !defined (_WIN32) || defined (__CYGWIN__)
+    if (mapped_length != 0) {
+        munmap(const_cast<char *>(mapped_data), mapped_length);
+    }
+#endif
+    mapped_data = nullptr;
+    mapped_length = 0;
+    vector<char>().swap(mapped_copy);
+}
+
 size_t VSFile::Write(const void *ptr, size_t length) {
     if (!UseVolumes[this->alt_type] || this->volume_type == VSFSNone) {
         size_t nbwritten = fwrite(ptr, 1, length, this->fp);
@@ -2062,8 +2199,10 @@ bool VSFile::Valid() {
 }
 
 void VSFile::Close() {
+    Unmap();
+    pk3_view = CPK3::FileView();
     if (this->file_type >= ZoneBuffer && this->file_type != UnknownFile && this->pk3_extracted_file) {
-        delete this->pk3_extracted_file;
+        delete[] this->pk3_extracted_file;
         this->pk3_extracted_file = nullptr;
         return;
     }
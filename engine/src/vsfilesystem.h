@@ -281,6 +281,8 @@ void InitDataDirectory();
 void InitHomeDirectory();
 void LoadConfig(std::string subdir = "");
 void InitMods();
+//Index the files below Rootdir again, for changes made behind the game's back
+void RefreshFileIndex();
 
 //Create a directory
 void CreateDirectoryAbs(const char *filename);
@@ -332,11 +334,22 @@ private:
 //PK3 stuff
     CPK3 *pk3_file{};
     char *pk3_extracted_file{};
+    CPK3::FileView pk3_view;
     int file_index{};
     unsigned int offset{};
 
+    //The file's bytes in the volume, without copying them when they can be had in place, or nullptr
+    const char *viewVolumeFile();
+    //Makes the NUL terminated copy in pk3_extracted_file that the text functions read
     void checkExtracted();
 
+//Read only view of the whole file, see Map()
+    const char *mapped_data{};
+    size_t mapped_length{};
+    std::vector<char> mapped_copy;
+
+    void Unmap();
+
 //VSFile internals
     VSFileType file_type{};
     VSFileType alt_type{};
@@ -352,8 +365,8 @@ private:
     bool valid{};
 
 public:
-    char *get_pk3_data() {
-        return pk3_extracted_file;
+    const char *get_pk3_data() {
+        return viewVolumeFile();
     }
 
 public:
@@ -401,6 +414,11 @@ public:
             size_t length);                                            //Read length in ptr (store read bytes number in length)
     VSError ReadLine(void *ptr, size_t length);                               //Read a line of maximum length
     std::string ReadFull();                                                                                          //Read the entire file and returns the content in a string
+    //Read only view of the entire file, Size() bytes long and not NUL terminated, or nullptr on failure.
+    //Plain files are mapped, volume files are already in memory. The view lives until the file is closed
+    //and does not move the file pointer. A member stored in a PK3 may start at any address, so the view
+    //has no particular alignment.
+    const char *Map();
     size_t Write(const void *ptr,
             size_t length);                             //Write length from ptr (store written bytes number in length)
     size_t Write(const std::string &content);                                              //Write a string
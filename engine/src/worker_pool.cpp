@@ -0,0 +1,192 @@
+/*
+ * worker_pool.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "configuration/configuration.h"
+#include "vegastrike.h"
+#include "vs_logging.h"
+
+std::atomic<unsigned int> WorkerPool::parallel_for_depth(0);
+
+namespace {
+
+// counts a ParallelFor as running from start to end, exceptions included
+class ParallelForScope {
+public:
+    explicit ParallelForScope(std::atomic<unsigned int> &depth) : depth(depth) {
+        ++depth;
+    }
+
+    ~ParallelForScope() {
+        --depth;
+    }
+
+private:
+    std::atomic<unsigned int> &depth;
+};
+
+}
+
+WorkerPool::WorkerPool(unsigned int workers) :
+        job(NULL),
+        job_count(0),
+        chunk_size(1),
+        job_simulation_atom(0.0f),
+        next_index(0),
+        generation(0),
+        busy_workers(0),
+        stopping(false) {
+    threads.reserve(workers);
+    for (unsigned int i = 0; i < workers; ++i) {
+        threads.push_back(std::thread(&WorkerPool::WorkerLoop, this));
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    start_work.notify_all();
+    for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+}
+
+void WorkerPool::ParallelFor(size_t count, const Job &job) {
+    ParallelForScope scope(parallel_for_depth);
+    if (threads.empty() || count < 2) {
+        for (size_t i = 0; i < count; ++i) {
+            job(i);
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->job = &job;
+        job_count = count;
+        // several chunks per thread, so that threads which finish early can take over the rest
+        chunk_size = std::max<size_t>(1, count / (8 * (threads.size() + 1)));
+        job_simulation_atom = simulation_atom_var;
+        next_index = 0;
+        busy_workers = static_cast<unsigned int>(threads.size());
+        error = std::exception_ptr();
+        ++generation;
+    }
+    start_work.notify_all();
+    RunChunks();
+
+    std::exception_ptr failure;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        work_done.wait(lock, [this] { return busy_workers == 0; });
+        this->job = NULL;
+        failure = error;
+        error = std::exception_ptr();
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+void WorkerPool::RunChunks() {
+    for (;;) {
+        const size_t begin = next_index.fetch_add(chunk_size);
+        if (begin >= job_count) {
+            return;
+        }
+        const size_t end = std::min(begin + chunk_size, job_count);
+        for (size_t i = begin; i < end; ++i) {
+            try {
+                (*job)(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next_index = job_count;
+                return;
+            }
+        }
+    }
+}
+
+void WorkerPool::WorkerLoop() {
+    unsigned int seen_generation = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start_work.wait(lock, [this, seen_generation] { return stopping || generation != seen_generation; });
+            if (stopping) {
+                return;
+            }
+            seen_generation = generation;
+            simulation_atom_var = job_simulation_atom;
+        }
+        RunChunks();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busy_workers == 0) {
+                work_done.notify_one();
+            }
+        }
+    }
+}
+
+WorkerPool *WorkerPool::GetPhysicsPool() {
+    static std::unique_ptr<WorkerPool> physics_pool;
+    static bool initialized = false;
+    if (!initialized) {
+        initialized = true;
+        const unsigned int workers = configuration()->physics_config.worker_threads;
+        if (workers > 0) {
+            VS_LOG(info, (boost::format("Integrating unit physics on %1% worker threads") % workers));
+            physics_pool.reset(new WorkerPool(workers));
+        }
+    }
+    return physics_pool.get();
+}
+
+static thread_local std::vector<DeferredCommands::Command> *deferred_commands = NULL;
+
+DeferredCommands::DeferredCommands(std::vector<Command> *target) : previous(deferred_commands) {
+    deferred_commands = target;
+}
+
+DeferredCommands::~DeferredCommands() {
+    deferred_commands = previous;
+}
+
+void DeferredCommands::RunOrDefer(const Command &command) {
+    if (deferred_commands) {
+        deferred_commands->push_back(command);
+    } else {
+        command();
+    }
+}
@@ -0,0 +1,128 @@
+/*
+ * worker_pool.h
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * A fixed set of threads that run the iterations of a loop in parallel.
+ *
+ * ParallelFor hands out the iterations in small chunks from a shared
+ * counter, so a thread that finishes early keeps taking work from the
+ * others; the calling thread takes part as well. The simulation atom of the
+ * calling thread is copied to the workers before they start, since
+ * simulation_atom_var is per-thread.
+ */
+class WorkerPool {
+public:
+    typedef std::function<void(size_t)> Job;
+
+    explicit WorkerPool(unsigned int workers);
+    ~WorkerPool();
+
+    unsigned int GetWorkerCount() const {
+        return static_cast<unsigned int>(threads.size());
+    }
+
+    /*
+     * Runs job(i) for every i in [0, count) and returns when all of them are done.
+     * If a job throws, the remaining iterations are skipped and the first
+     * exception is rethrown on the calling thread.
+     */
+    void ParallelFor(size_t count, const Job &job);
+
+    /* The pool used for unit physics, sized by physics.worker_threads; NULL when that is 0 */
+    static WorkerPool *GetPhysicsPool();
+
+    /*
+     * Whether a ParallelFor of any pool is running, on any thread. While one is, the jobs may only
+     * read what is shared, and only what the calling thread set up for them beforehand: the
+     * configuration, the missions and the universe are read on the simulation thread and handed
+     * over (see Movable::CaptureMotionSettings), and must not be changed until ParallelFor returns.
+     * Logging is fine, the logger is thread-safe. Code that must not run then asserts on this.
+     */
+    static bool InParallelFor() {
+        return parallel_for_depth.load() > 0;
+    }
+
+private:
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    void WorkerLoop();
+    void RunChunks();
+
+    static std::atomic<unsigned int> parallel_for_depth;
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable start_work;
+    std::condition_variable work_done;
+
+    // the batch being run; guarded by mutex except for next_index
+    const Job *job;
+    size_t job_count;
+    size_t chunk_size;
+    float job_simulation_atom;
+    std::atomic<size_t> next_index;
+    unsigned int generation;
+    unsigned int busy_workers;
+    bool stopping;
+    std::exception_ptr error;
+};
+
+/*
+ * Side effects that must stay on the main thread (sound, animations, anything
+ * touching shared containers) go through RunOrDefer. While a DeferredCommands
+ * scope is active on the current thread the command is appended to its list,
+ * to be run later by the main thread in a deterministic order; otherwise it
+ * runs right away.
+ */
+class DeferredCommands {
+public:
+    typedef std::function<void()> Command;
+
+    explicit DeferredCommands(std::vector<Command> *target);
+    ~DeferredCommands();
+
+    static void RunOrDefer(const Command &command);
+
+private:
+    DeferredCommands(const DeferredCommands &) = delete;
+    DeferredCommands &operator=(const DeferredCommands &) = delete;
+
+    std::vector<Command> *previous;
+};
+
+#endif // WORKER_POOL_H
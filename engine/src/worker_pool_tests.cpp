@@ -0,0 +1,148 @@
+/*
+ * worker_pool_tests.cpp
+ *
+ * Copyright (C) 2001-2023 Daniel Horn, pyramid3d, Stephen G. Tuggy,
+ * and other Vega Strike contributors.
+ *
+ * https://github.com/vegastrike/Vega-Strike-Engine-Source
+ *
+ * This file is part of Vega Strike.
+ *
+ * Vega Strike is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Vega Strike is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Vega Strike. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "vegastrike.h"
+#include "worker_pool.h"
+
+// the game's is in vs_globals.cpp, which drags in too much for the tests
+thread_local float simulation_atom_var = 0.1f;
+
+TEST(WorkerPool, RunsEveryIterationOnce) {
+    WorkerPool pool(3);
+    EXPECT_EQ(3u, pool.GetWorkerCount());
+    for (size_t count : {0u, 1u, 2u, 7u, 1000u}) {
+        std::vector<std::atomic<int>> runs(count);
+        for (std::atomic<int> &run : runs) {
+            run = 0;
+        }
+        pool.ParallelFor(count, [&runs](size_t i) {
+            ++runs[i];
+        });
+        for (size_t i = 0; i < count; ++i) {
+            EXPECT_EQ(1, runs[i].load()) << "iteration " << i << " of " << count;
+        }
+    }
+}
+
+TEST(WorkerPool, ReturnsOnlyOnceEveryIterationIsDone) {
+    WorkerPool pool(4);
+    std::atomic<int> finished(0);
+    std::mutex threads_mutex;
+    std::set<std::thread::id> threads;
+    pool.ParallelFor(64, [&](size_t) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        {
+            std::lock_guard<std::mutex> lock(threads_mutex);
+            threads.insert(std::this_thread::get_id());
+        }
+        ++finished;
+    });
+    EXPECT_EQ(64, finished.load());
+    // the calling thread takes part, and at least one worker did too
+    EXPECT_GE(threads.size(), 2u);
+}
+
+TEST(WorkerPool, HandsTheSimulationAtomToTheWorkers) {
+    WorkerPool pool(2);
+    const float backup = simulation_atom_var;
+    simulation_atom_var = 0.25f;
+    std::atomic<int> wrong(0);
+    pool.ParallelFor(200, [&wrong](size_t) {
+        if (simulation_atom_var != 0.25f) {
+            ++wrong;
+        }
+    });
+    simulation_atom_var = backup;
+    EXPECT_EQ(0, wrong.load());
+}
+
+TEST(WorkerPool, KnowsWhenAParallelForIsRunning) {
+    WorkerPool pool(2);
+    EXPECT_FALSE(WorkerPool::InParallelFor());
+    std::atomic<int> outside(0);
+    pool.ParallelFor(100, [&outside](size_t) {
+        if (!WorkerPool::InParallelFor()) {
+            ++outside;
+        }
+    });
+    EXPECT_EQ(0, outside.load());
+    EXPECT_FALSE(WorkerPool::InParallelFor());
+}
+
+TEST(WorkerPool, RethrowsTheFirstExceptionAndKeepsWorking) {
+    WorkerPool pool(3);
+    std::atomic<int> ran(0);
+    EXPECT_THROW(pool.ParallelFor(1000, [&ran](size_t i) {
+        ++ran;
+        if (i == 37) {
+            throw std::runtime_error("iteration 37");
+        }
+    }), std::runtime_error);
+    // the iterations not started yet were skipped
+    EXPECT_LT(ran.load(), 1000);
+    EXPECT_FALSE(WorkerPool::InParallelFor());
+
+    std::atomic<int> after(0);
+    pool.ParallelFor(500, [&after](size_t) {
+        ++after;
+    });
+    EXPECT_EQ(500, after.load());
+}
+
+TEST(WorkerPool, ShutsDownIdleAndAfterWork) {
+    for (int round = 0; round < 20; ++round) {
+        std::unique_ptr<WorkerPool> pool(new WorkerPool(4));
+        if (round % 2) {
+            std::atomic<int> done(0);
+            pool->ParallelFor(100, [&done](size_t) {
+                ++done;
+            });
+            EXPECT_EQ(100, done.load());
+        }
+        pool.reset();
+    }
+    // a pool without workers runs everything on the calling thread
+    WorkerPool inline_pool(0);
+    EXPECT_EQ(0u, inline_pool.GetWorkerCount());
+    const std::thread::id caller = std::this_thread::get_id();
+    std::atomic<int> elsewhere(0);
+    inline_pool.ParallelFor(10, [&](size_t) {
+        if (std::this_thread::get_id() != caller) {
+            ++elsewhere;
+        }
+    });
+    EXPECT_EQ(0, elsewhere.load());
+}